@@ -0,0 +1,127 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+#include <optional>
+#include <thread>
+#include <godby/Barrier.h>
+#include <godby/Topology.h>
+#include "Bench.h"
+
+namespace godby::bench
+{
+Runner::Runner(const Options &options) : M_options(options), M_perf(options.perf && PerfCounters::Open())
+{
+	if (options.pin) {
+		auto topology = CpuTopology::Detect();
+		for (const auto &cpu : topology.cpus()) { M_cpus.push_back(cpu.cpu); }
+	}
+}
+
+static double Percentile(const std::vector<double> &sorted, double p)
+{
+	if (sorted.empty()) { return 0; }
+	size_t rank = static_cast<size_t>(std::ceil(p * sorted.size()));
+	return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+}
+
+Result Runner::Run(const Benchmark &benchmark, unsigned threads)
+{
+	std::unique_ptr<Case> c = benchmark.make(threads);
+	std::atomic<bool> stop{false};
+	std::vector<std::unique_ptr<Worker>> workers;
+	for (unsigned i = 0; i < threads; ++i) { workers.push_back(std::make_unique<Worker>(i, threads, M_options.sample_every, stop)); }
+
+	// The threads and this one, which starts the clock once all of them are pinned and ready
+	SenseBarrier ready(threads + 1);
+	std::vector<std::thread> pool;
+	std::vector<PerfReading> readings(threads);
+	for (unsigned i = 0; i < threads; ++i) {
+		pool.emplace_back([&, i]() {
+			if (!M_cpus.empty()) { CpuTopology::Pin(M_cpus[i % M_cpus.size()]); }
+			std::optional<PerfCounters> counters; // Per thread, they count the thread that opened them
+			if (M_perf) {
+				if (auto opened = PerfCounters::Open()) { counters.emplace(std::move(*opened)); }
+			}
+			ready.arrive_and_wait();
+			{
+				PerfScope scope(counters ? &*counters : nullptr);
+				c->Run(*workers[i]);
+			}
+			if (counters) { readings[i] = counters->Read(); }
+		});
+	}
+
+	ready.arrive_and_wait();
+	auto start = std::chrono::steady_clock::now();
+	std::this_thread::sleep_for(M_options.duration);
+	stop.store(true, std::memory_order_relaxed);
+	for (auto &thread : pool) { thread.join(); }
+	c->Drain();
+	auto end = std::chrono::steady_clock::now();
+
+	Result result;
+	result.suite = benchmark.suite, result.name = benchmark.name, result.impl = benchmark.impl;
+	result.threads = threads;
+	std::vector<double> samples;
+	for (unsigned i = 0; i < threads; ++i) { result.events += readings[i]; }
+	for (const auto &worker : workers) {
+		result.ops += worker->M_ops;
+		samples.insert(samples.end(), worker->M_samples.begin(), worker->M_samples.end());
+	}
+	std::sort(samples.begin(), samples.end());
+	result.seconds = std::chrono::duration<double>(end - start).count();
+	result.samples = samples.size();
+	result.p50_ns = Percentile(samples, 0.5), result.p90_ns = Percentile(samples, 0.9), result.p99_ns = Percentile(samples, 0.99);
+	result.p999_ns = Percentile(samples, 0.999), result.max_ns = samples.empty() ? 0 : samples.back();
+	return result;
+}
+
+static std::string Quote(const std::string &text)
+{
+	std::string quoted = "\"";
+	for (char ch : text) {
+		if (ch == '"' || ch == '\\') {
+			quoted += '\\', quoted += ch;
+		} else if (static_cast<unsigned char>(ch) < 0x20) {
+			char escaped[8];
+			snprintf(escaped, sizeof(escaped), "\\u%04x", ch);
+			quoted += escaped;
+		} else {
+			quoted += ch;
+		}
+	}
+	return quoted + "\"";
+}
+
+std::string ToJson(const Options &options, bool counted, const std::vector<Result> &results)
+{
+	char buffer[512];
+	std::string json = "{\n";
+	snprintf(buffer, sizeof(buffer), "  \"version\": 1,\n  \"timestamp\": %lld,\n  \"hardware_concurrency\": %u,\n  \"duration_ms\": %lld,\n  \"sample_every\": %u,\n  \"pinned\": %s,\n  \"perf\": %s,\n",
+			 static_cast<long long>(std::time(nullptr)), std::thread::hardware_concurrency(), static_cast<long long>(options.duration.count()), options.sample_every,
+			 options.pin ? "true" : "false", counted ? "true" : "false");
+	json += buffer;
+	json += "  \"results\": [";
+	for (size_t i = 0; i < results.size(); ++i) {
+		const Result &r = results[i];
+		json += i ? ",\n    {" : "\n    {";
+		json += "\"suite\": " + Quote(r.suite) + ", \"name\": " + Quote(r.name) + ", \"impl\": " + Quote(r.impl);
+		snprintf(buffer, sizeof(buffer),
+				 ", \"threads\": %u, \"ops\": %llu, \"seconds\": %.6f, \"ops_per_sec\": %.1f, \"latency_ns\": {\"samples\": %llu, \"p50\": %.1f, \"p90\": %.1f, \"p99\": %.1f, \"p999\": %.1f, \"max\": %.1f}", r.threads,
+				 static_cast<unsigned long long>(r.ops), r.seconds, r.OpsPerSecond(), static_cast<unsigned long long>(r.samples), r.p50_ns, r.p90_ns, r.p99_ns, r.p999_ns, r.max_ns);
+		json += buffer;
+		if (r.events.size) {
+			json += ", \"events_per_op\": {";
+			for (unsigned e = 0; e < r.events.size; ++e) {
+				snprintf(buffer, sizeof(buffer), "%s\"%s\": %.4f", e ? ", " : "", PerfEventName(r.events.events[e]), r.PerOp(r.events.events[e]));
+				json += buffer;
+			}
+			json += r.events.multiplexed ? "}, \"events_multiplexed\": true" : "}";
+		}
+		json += "}";
+	}
+	json += results.empty() ? "]\n}\n" : "\n  ]\n}\n";
+	return json;
+}
+} // namespace godby::bench
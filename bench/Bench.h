@@ -0,0 +1,182 @@
+#pragma once
+
+#include <atomic>				// std::atomic
+#include <chrono>				// std::chrono
+#include <cstdint>				// uint64_t
+#include <functional>			// std::function
+#include <memory>				// std::unique_ptr
+#include <string>				// std::string
+#include <utility>				// std::forward
+#include <vector>				// std::vector
+#include <godby/PerfCounters.h>	// godby::PerfReading
+#include <godby/Portability.h>	// godby::TscClock
+
+//! godby-bench
+namespace godby::bench
+{
+struct Options {
+	std::vector<unsigned> threads; // Swept in order, powers of two up to the hardware by default
+	std::chrono::milliseconds duration{200};
+	unsigned sample_every = 64; // Time one operation in that many, for the latency percentiles
+	bool pin = true;			// One thread per CPU, in CpuTopology order
+	bool perf = true;			// Count hardware events on the benchmark threads, where perf_event_open() allows it
+	std::string filter;			// Only benchmarks whose suite/name/impl contains it
+	std::string json;			// Write the results there, "-" for stdout
+};
+
+struct Result {
+	std::string suite;
+	std::string name;
+	std::string impl;
+	unsigned threads = 0;
+	uint64_t ops = 0;
+	double seconds = 0;
+	uint64_t samples = 0;
+	double p50_ns = 0, p90_ns = 0, p99_ns = 0, p999_ns = 0, max_ns = 0;
+	PerfReading events; // Summed over the benchmark threads, empty without counters
+
+	double OpsPerSecond() const noexcept
+	{
+		return seconds > 0 ? ops / seconds : 0;
+	}
+
+	// Negative if the event was not counted.
+	double PerOp(PerfEvent event) const noexcept
+	{
+		for (unsigned i = 0; i < events.size; ++i) {
+			if (events.events[i] == event) { return ops ? static_cast<double>(events.values[i]) / ops : 0; }
+		}
+		return -1;
+	}
+};
+
+/**
+ * @class: Worker
+ *
+ * @brief: what a benchmark thread sees of the run
+ *
+ * Loop while Running() and wrap each operation in Op(), which counts it and times one in
+ * sample_every on the TscClock. Random() is a per-thread xorshift, cheap enough to pick keys
+ * inside the loop.
+ */
+class Worker {
+  public:
+	Worker(unsigned index, unsigned threads, unsigned sample_every, const std::atomic<bool> &stop) noexcept
+		: M_index(index), M_threads(threads), M_sample_every(sample_every), M_stop(stop), M_seed(0x9e3779b97f4a7c15ull * (index + 1))
+	{
+	}
+
+	unsigned Index() const noexcept
+	{
+		return M_index;
+	}
+
+	unsigned Threads() const noexcept
+	{
+		return M_threads;
+	}
+
+	inline bool Running() const noexcept
+	{
+		return !M_stop.load(std::memory_order_relaxed);
+	}
+
+	template <typename F>
+	inline void Op(F &&op)
+	{
+		if (GODBY_UNLIKELY(++M_ops % M_sample_every == 0)) {
+			uint64_t start = TscClock::Ticks();
+			std::forward<F>(op)();
+			M_samples.push_back(static_cast<double>(TscClock::ToNanoseconds(TscClock::Ticks() - start)));
+		} else {
+			std::forward<F>(op)();
+		}
+	}
+
+	inline uint64_t Random() noexcept
+	{
+		M_seed ^= M_seed << 13, M_seed ^= M_seed >> 7, M_seed ^= M_seed << 17;
+		return M_seed;
+	}
+
+  private:
+	friend class Runner;
+
+	unsigned M_index;
+	unsigned M_threads;
+	unsigned M_sample_every;
+	const std::atomic<bool> &M_stop;
+	uint64_t M_seed;
+	uint64_t M_ops = 0;
+	std::vector<double> M_samples;
+};
+
+// One implementation under test, built for a number of threads and run on each of them.
+class Case {
+  public:
+	virtual ~Case() = default;
+
+	virtual void Run(Worker &worker) = 0;
+
+	// After every thread returned from Run(), still timed: wait for work handed off to finish.
+	virtual void Drain() {}
+};
+
+struct Benchmark {
+	std::string suite; // queue, map, lock or executor
+	std::string name;  // The workload
+	std::string impl;  // What it runs on, godby's or a reference implementation
+	unsigned min_threads = 1;
+	std::function<std::unique_ptr<Case>(unsigned threads)> make;
+};
+
+class Registry {
+  public:
+	template <typename C>
+	void Add(std::string suite, std::string name, std::string impl, unsigned min_threads = 1)
+	{
+		M_benchmarks.push_back({std::move(suite), std::move(name), std::move(impl), min_threads, [](unsigned threads) -> std::unique_ptr<Case> { return std::make_unique<C>(threads); }});
+	}
+
+	const std::vector<Benchmark> &Benchmarks() const noexcept
+	{
+		return M_benchmarks;
+	}
+
+  private:
+	std::vector<Benchmark> M_benchmarks;
+};
+
+// Start the threads of a case together, stop them after the duration and merge what they measured.
+class Runner {
+  public:
+	explicit Runner(const Options &options);
+
+	Result Run(const Benchmark &benchmark, unsigned threads);
+
+	// Options::perf and the counters could be opened.
+	bool Counting() const noexcept
+	{
+		return M_perf;
+	}
+
+  private:
+	const Options &M_options;
+	std::vector<int> M_cpus;
+	bool M_perf;
+};
+
+// Keep the compiler from dropping a computation whose result is unused.
+template <typename T>
+inline void DoNotOptimize(T const &value)
+{
+	asm volatile("" : : "r,m"(value) : "memory");
+}
+
+void RegisterQueues(Registry &registry);
+void RegisterMaps(Registry &registry);
+void RegisterLocks(Registry &registry);
+void RegisterExecutors(Registry &registry);
+
+std::string ToJson(const Options &options, bool counted, const std::vector<Result> &results);
+} // namespace godby::bench
@@ -0,0 +1,83 @@
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <godby/StealingExecutor.h>
+#include "contrib/BS_thread_pool.hpp"
+#include "Bench.h"
+
+namespace godby::bench
+{
+namespace
+{
+constexpr uint64_t IN_FLIGHT = 1024;
+
+struct TaskExecutor {
+	template <typename F>
+	void Submit(F &&task)
+	{
+		executor.Submit(std::forward<F>(task));
+	}
+
+	void Wait()
+	{
+		executor.WaitAll();
+	}
+
+	godby::TaskExecutor<> executor;
+};
+
+struct ThreadPool {
+	template <typename F>
+	void Submit(F &&task)
+	{
+		pool.detach_task(std::forward<F>(task));
+	}
+
+	void Wait()
+	{
+		pool.wait();
+	}
+
+	BS::thread_pool pool;
+};
+
+// The benchmark threads submit small tasks to a pool of one worker per CPU, each keeping at most
+// IN_FLIGHT of its tasks queued. Drained before the clock stops, so ops/s counts executed tasks.
+template <typename Executor>
+class Submit final : public Case {
+	struct alignas(CACHE_LINE_SIZE) Pending {
+		std::atomic<uint64_t> count{0};
+	};
+
+  public:
+	explicit Submit(unsigned threads) : M_executor(std::make_unique<Executor>()), M_pending(threads) {}
+
+	void Run(Worker &worker) override
+	{
+		Pending &pending = M_pending[worker.Index()];
+		while (worker.Running()) {
+			while (pending.count.load(std::memory_order_relaxed) >= IN_FLIGHT) { std::this_thread::yield(); }
+			pending.count.fetch_add(1, std::memory_order_relaxed);
+			worker.Op([&] { M_executor->Submit([&pending]() { pending.count.fetch_sub(1, std::memory_order_relaxed); }); });
+		}
+	}
+
+	void Drain() override
+	{
+		M_executor->Wait();
+	}
+
+  private:
+	std::unique_ptr<Executor> M_executor;
+	std::vector<Pending> M_pending;
+};
+} // namespace
+
+void RegisterExecutors(Registry &registry)
+{
+	registry.Add<Submit<TaskExecutor>>("executor", "submit", "TaskExecutor");
+	registry.Add<Submit<ThreadPool>>("executor", "submit", "BS::thread_pool");
+}
+} // namespace godby::bench
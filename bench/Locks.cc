@@ -0,0 +1,74 @@
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <godby/SharedMutex.h>
+#include <godby/Spinlock.h>
+#include "Bench.h"
+
+namespace godby::bench
+{
+namespace
+{
+// A short critical section on data shared by every thread: the lock's hand-off is what is measured.
+template <typename Lock>
+class Exclusive final : public Case {
+  public:
+	explicit Exclusive(unsigned) {}
+
+	void Run(Worker &worker) override
+	{
+		while (worker.Running()) {
+			worker.Op([&] {
+				std::lock_guard<Lock> lock(M_lock);
+				M_counter = M_counter * 33 + worker.Index();
+			});
+		}
+		DoNotOptimize(M_counter);
+	}
+
+  private:
+	alignas(CACHE_LINE_SIZE) Lock M_lock;
+	uint64_t M_counter = 0;
+};
+
+// Readers take the lock shared, one operation in twenty writes.
+template <typename Lock>
+class ReadMostly final : public Case {
+  public:
+	explicit ReadMostly(unsigned) {}
+
+	void Run(Worker &worker) override
+	{
+		while (worker.Running()) {
+			bool write = worker.Random() % 20 == 0;
+			worker.Op([&] {
+				if (write) {
+					std::unique_lock<Lock> lock(M_lock);
+					++M_counter;
+				} else {
+					std::shared_lock<Lock> lock(M_lock);
+					DoNotOptimize(M_counter);
+				}
+			});
+		}
+	}
+
+  private:
+	alignas(CACHE_LINE_SIZE) Lock M_lock;
+	uint64_t M_counter = 0;
+};
+} // namespace
+
+void RegisterLocks(Registry &registry)
+{
+	registry.Add<Exclusive<godby::Spinlock>>("lock", "exclusive", "Spinlock");
+	registry.Add<Exclusive<godby::TtasSpinlock<>>>("lock", "exclusive", "TtasSpinlock");
+	registry.Add<Exclusive<godby::McsLock>>("lock", "exclusive", "McsLock");
+	registry.Add<Exclusive<godby::DistributedSharedMutex<>>>("lock", "exclusive", "DistributedSharedMutex");
+	registry.Add<Exclusive<std::mutex>>("lock", "exclusive", "std::mutex");
+	registry.Add<Exclusive<std::shared_mutex>>("lock", "exclusive", "std::shared_mutex");
+
+	registry.Add<ReadMostly<godby::DistributedSharedMutex<>>>("lock", "read-95%", "DistributedSharedMutex");
+	registry.Add<ReadMostly<std::shared_mutex>>("lock", "read-95%", "std::shared_mutex");
+}
+} // namespace godby::bench
@@ -0,0 +1,129 @@
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <godby/AtomicHashmap.h>
+#include <godby/ConcurrentLruCache.h>
+#include "contrib/unordered_dense.h"
+#include "Bench.h"
+
+namespace godby::bench
+{
+namespace
+{
+constexpr uint64_t KEYS = 65536;
+
+struct AtomicHashmap {
+	AtomicHashmap() : map(KEYS * 2) {}
+
+	bool Get(uint64_t key, uint64_t &value)
+	{
+		auto accessor = map.Get(key);
+		if (accessor) { value = accessor.value(); }
+		return accessor;
+	}
+
+	void Set(uint64_t key, uint64_t value)
+	{
+		map.Set(key, value);
+	}
+
+	godby::AtomicHashmap<uint64_t, uint64_t> map;
+};
+
+struct ConcurrentLruCache {
+	ConcurrentLruCache() : cache(KEYS) {}
+
+	bool Get(uint64_t key, uint64_t &value)
+	{
+		return cache.Get(key, value);
+	}
+
+	void Set(uint64_t key, uint64_t value)
+	{
+		cache.Set(key, value);
+	}
+
+	godby::ConcurrentLruCache<uint64_t, uint64_t> cache;
+};
+
+template <typename Map, typename Mutex>
+struct Locked {
+	bool Get(uint64_t key, uint64_t &value)
+	{
+		std::shared_lock<Mutex> lock(mutex);
+		auto it = map.find(key);
+		if (it == map.end()) { return false; }
+		value = it->second;
+		return true;
+	}
+
+	void Set(uint64_t key, uint64_t value)
+	{
+		std::unique_lock<Mutex> lock(mutex);
+		map[key] = value;
+	}
+
+	Mutex mutex;
+	Map map;
+};
+
+// std::mutex has no shared side, lookups take it exclusively.
+struct SharedMutex : std::mutex {
+	void lock_shared()
+	{
+		lock();
+	}
+
+	void unlock_shared()
+	{
+		unlock();
+	}
+};
+
+// Uniform keys over a filled map, one Set in WritePermille / 1000 operations.
+template <typename Map, unsigned WritePermille>
+class ReadMostly final : public Case {
+  public:
+	explicit ReadMostly(unsigned) : M_map(std::make_unique<Map>())
+	{
+		for (uint64_t key = 0; key < KEYS; ++key) { M_map->Set(key, key); }
+	}
+
+	void Run(Worker &worker) override
+	{
+		while (worker.Running()) {
+			uint64_t random = worker.Random();
+			uint64_t key = random % KEYS;
+			worker.Op([&] {
+				if ((random >> 32) % 1000 < WritePermille) {
+					M_map->Set(key, random);
+				} else {
+					uint64_t value = 0;
+					DoNotOptimize(M_map->Get(key, value));
+					DoNotOptimize(value);
+				}
+			});
+		}
+	}
+
+  private:
+	std::unique_ptr<Map> M_map;
+};
+
+template <unsigned WritePermille>
+void RegisterMix(Registry &registry, const char *name)
+{
+	registry.Add<ReadMostly<AtomicHashmap, WritePermille>>("map", name, "AtomicHashmap");
+	registry.Add<ReadMostly<ConcurrentLruCache, WritePermille>>("map", name, "ConcurrentLruCache");
+	registry.Add<ReadMostly<Locked<ankerl::unordered_dense::map<uint64_t, uint64_t>, SharedMutex>, WritePermille>>("map", name, "std::mutex+unordered_dense");
+	registry.Add<ReadMostly<Locked<std::unordered_map<uint64_t, uint64_t>, std::shared_mutex>, WritePermille>>("map", name, "std::shared_mutex+std::unordered_map");
+}
+} // namespace
+
+void RegisterMaps(Registry &registry)
+{
+	RegisterMix<100>(registry, "read-90%");
+	RegisterMix<500>(registry, "read-50%");
+}
+} // namespace godby::bench
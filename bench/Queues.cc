@@ -0,0 +1,197 @@
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <queue>
+#include <vector>
+#include <godby/AtomicQueue.h>
+#include <godby/BroadcastRing.h>
+#include <godby/ByteRing.h>
+#include <godby/StealingQueue.h>
+#include <godby/UnboundedAtomicQueue.h>
+#include "Bench.h"
+
+namespace godby::bench
+{
+namespace
+{
+constexpr unsigned CAPACITY = 65536;
+
+// Pops by polling try_pop, for the queues that have no blocking pop.
+template <typename Queue>
+struct Polling : Queue {
+	template <typename... Args>
+	explicit Polling(Args &&...args) : Queue(std::forward<Args>(args)...)
+	{
+	}
+
+	uint32_t pop()
+	{
+		uint32_t value;
+		while (!this->try_pop(value)) { spin_loop_pause(); }
+		return value;
+	}
+};
+
+struct AtomicQueueB : godby::AtomicQueueB<uint32_t> {
+	AtomicQueueB() : godby::AtomicQueueB<uint32_t>(CAPACITY) {}
+};
+
+struct AtomicQueueB2 : godby::AtomicQueueB2<uint32_t> {
+	AtomicQueueB2() : godby::AtomicQueueB2<uint32_t>(CAPACITY) {}
+};
+
+struct MutexQueue {
+	bool try_pop(uint32_t &value)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (queue.empty()) { return false; }
+		value = queue.front();
+		queue.pop();
+		return true;
+	}
+
+	void push(uint32_t value)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		queue.push(value);
+	}
+
+	std::mutex mutex;
+	std::queue<uint32_t> queue;
+};
+
+// Every thread pushes one element then pops one, so each pop has an element to wait for.
+template <typename Queue>
+class PushPop final : public Case {
+  public:
+	explicit PushPop(unsigned) : M_queue(std::make_unique<Queue>()) {}
+
+	void Run(Worker &worker) override
+	{
+		const uint32_t value = worker.Index() + 1; // Never the NIL of the queue
+		while (worker.Running()) {
+			worker.Op([&] {
+				M_queue->push(uint32_t(value));
+				DoNotOptimize(M_queue->pop());
+			});
+		}
+	}
+
+  private:
+	std::unique_ptr<Queue> M_queue;
+};
+
+// The threads pair up, the even one of a pair writes records of 8 to 64 bytes into their ring and
+// the odd one reads them back. An op is a record read, the last thread sits out on an odd count.
+class SpscByteRingPairs final : public Case {
+	struct alignas(CACHE_LINE_SIZE) Pair {
+		godby::SpscByteRing ring{CAPACITY};
+	};
+
+  public:
+	explicit SpscByteRingPairs(unsigned threads) : M_pairs(threads / 2) {}
+
+	void Run(Worker &worker) override
+	{
+		if (worker.Index() / 2 >= M_pairs.size()) { return; }
+		godby::SpscByteRing &ring = M_pairs[worker.Index() / 2].ring;
+
+		if (worker.Index() % 2 == 0) {
+			for (uint64_t i = 0; worker.Running(); ++i) {
+				std::size_t const n = sizeof(i) + i % 57;
+				auto span = ring.reserve(n);
+				if (span.empty()) {
+					spin_loop_pause();
+					continue;
+				}
+				std::memcpy(span.data(), &i, sizeof(i));
+				ring.commit();
+			}
+		} else {
+			while (worker.Running()) {
+				auto record = ring.peek();
+				if (record.empty()) {
+					spin_loop_pause();
+					continue;
+				}
+				worker.Op([&] {
+					uint64_t value;
+					std::memcpy(&value, record.data(), sizeof(value));
+					DoNotOptimize(value);
+					ring.release();
+				});
+			}
+		}
+	}
+
+  private:
+	std::vector<Pair> M_pairs;
+};
+
+// Thread 0 publishes as fast as it can, every other thread reads with its own cursor and skips
+// what it was lapped on. An op is an item read.
+class BroadcastRingFanOut final : public Case {
+  public:
+	explicit BroadcastRingFanOut(unsigned) : M_ring(std::make_unique<godby::BroadcastRing<uint64_t, 1024>>()) {}
+
+	void Run(Worker &worker) override
+	{
+		if (worker.Index() == 0) {
+			for (uint64_t i = 0; worker.Running(); ++i) { M_ring->publish(i); }
+		} else {
+			auto reader = M_ring->subscribe();
+			uint64_t value;
+			while (worker.Running()) {
+				if (reader.try_read(value)) {
+					worker.Op([&] { DoNotOptimize(value); });
+				} else {
+					spin_loop_pause();
+				}
+			}
+		}
+	}
+
+  private:
+	std::unique_ptr<godby::BroadcastRing<uint64_t, 1024>> M_ring;
+};
+
+// Thread 0 owns the deque and pushes one element then pops one, the other threads steal from it.
+// An op is an owner push-pop or a steal attempt.
+class StealingQueueOwnerSteal final : public Case {
+  public:
+	explicit StealingQueueOwnerSteal(unsigned) : M_queue(std::make_unique<godby::StealingQueue<uint32_t>>()) {}
+
+	void Run(Worker &worker) override
+	{
+		if (worker.Index() == 0) {
+			for (uint32_t i = 0; worker.Running(); ++i) {
+				worker.Op([&] {
+					M_queue->push(i);
+					DoNotOptimize(M_queue->pop());
+				});
+			}
+		} else {
+			while (worker.Running()) {
+				worker.Op([&] { DoNotOptimize(M_queue->steal()); });
+			}
+		}
+	}
+
+  private:
+	std::unique_ptr<godby::StealingQueue<uint32_t>> M_queue;
+};
+} // namespace
+
+void RegisterQueues(Registry &registry)
+{
+	registry.Add<PushPop<godby::AtomicQueue<uint32_t, CAPACITY>>>("queue", "push-pop", "AtomicQueue");
+	registry.Add<PushPop<godby::AtomicQueue2<uint32_t, CAPACITY>>>("queue", "push-pop", "AtomicQueue2");
+	registry.Add<PushPop<AtomicQueueB>>("queue", "push-pop", "AtomicQueueB");
+	registry.Add<PushPop<AtomicQueueB2>>("queue", "push-pop", "AtomicQueueB2");
+	registry.Add<PushPop<Polling<godby::UnboundedAtomicQueue<uint32_t>>>>("queue", "push-pop", "UnboundedAtomicQueue");
+	registry.Add<PushPop<Polling<MutexQueue>>>("queue", "push-pop", "std::mutex+std::queue");
+	registry.Add<SpscByteRingPairs>("queue", "spsc-pairs", "SpscByteRing", 2);
+	registry.Add<BroadcastRingFanOut>("queue", "broadcast", "BroadcastRing", 2);
+	registry.Add<StealingQueueOwnerSteal>("queue", "owner-push-pop+steal", "StealingQueue");
+}
+} // namespace godby::bench
@@ -0,0 +1,124 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include "Bench.h"
+
+using namespace godby::bench;
+using godby::PerfEvent;
+
+static void Usage(const char *program)
+{
+	printf("Usage: %s [options]\n"
+		   "  --threads=1,2,4   thread counts to sweep (default: powers of two up to the hardware)\n"
+		   "  --duration=MS     run time of each benchmark and thread count (default: 200)\n"
+		   "  --sample=N        time one operation in N for the latency percentiles (default: 64)\n"
+		   "  --filter=TEXT     only benchmarks whose suite/name/impl contains TEXT\n"
+		   "  --json=PATH       write the results as JSON to PATH, - for stdout\n"
+		   "  --no-pin          let the scheduler place the threads\n"
+		   "  --no-perf         do not count cycles, cache and branch misses per operation\n"
+		   "  --list            print the benchmarks and exit\n",
+		   program);
+}
+
+static bool Parse(int argc, char *argv[], Options &options, bool &list)
+{
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		auto value = [&arg](const char *key) -> const char * {
+			size_t n = strlen(key);
+			return arg.compare(0, n, key) == 0 ? arg.c_str() + n : nullptr;
+		};
+		if (const char *v = value("--threads=")) {
+			options.threads.clear();
+			for (char *next = const_cast<char *>(v); *next;) {
+				unsigned threads = strtoul(next, &next, 10);
+				if (threads == 0) { return false; }
+				options.threads.push_back(threads);
+				if (*next == ',') { ++next; }
+			}
+		} else if (const char *v = value("--duration=")) {
+			options.duration = std::chrono::milliseconds(atoll(v));
+		} else if (const char *v = value("--sample=")) {
+			options.sample_every = std::max(1, atoi(v));
+		} else if (const char *v = value("--filter=")) {
+			options.filter = v;
+		} else if (const char *v = value("--json=")) {
+			options.json = v;
+		} else if (arg == "--no-pin") {
+			options.pin = false;
+		} else if (arg == "--no-perf") {
+			options.perf = false;
+		} else if (arg == "--list") {
+			list = true;
+		} else {
+			return false;
+		}
+	}
+	return true;
+}
+
+int main(int argc, char *argv[])
+{
+	Options options;
+	bool list = false;
+	if (!Parse(argc, argv, options, list)) {
+		Usage(argv[0]);
+		return 1;
+	}
+	if (options.threads.empty()) {
+		unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+		for (unsigned threads = 1; threads < hardware; threads *= 2) { options.threads.push_back(threads); }
+		options.threads.push_back(hardware);
+	}
+
+	Registry registry;
+	RegisterQueues(registry);
+	RegisterMaps(registry);
+	RegisterLocks(registry);
+	RegisterExecutors(registry);
+
+	Runner runner(options);
+	std::vector<Result> results;
+	FILE *out = options.json == "-" ? stderr : stdout; // Keep stdout for the JSON
+	if (options.perf && !runner.Counting() && !list) { fprintf(stderr, "No hardware counters (perf_event_open failed), reporting without events\n"); }
+	if (!list) { fprintf(out, "%-9s %-22s %-34s %7s %14s %9s %9s %9s %9s %9s %9s %9s %9s\n", "suite", "name", "impl", "threads", "ops/s", "p50 ns", "p99 ns", "p99.9 ns", "max ns", "cycles", "l1d-miss", "llc-miss", "br-miss"); }
+	for (const auto &benchmark : registry.Benchmarks()) {
+		std::string id = benchmark.suite + "/" + benchmark.name + "/" + benchmark.impl;
+		if (!options.filter.empty() && id.find(options.filter) == std::string::npos) { continue; }
+		if (list) {
+			fprintf(out, "%s\n", id.c_str());
+			continue;
+		}
+		for (unsigned threads : options.threads) {
+			if (threads < benchmark.min_threads) { continue; }
+			const Result &r = results.emplace_back(runner.Run(benchmark, threads));
+			fprintf(out, "%-9s %-22s %-34s %7u %14.0f %9.0f %9.0f %9.0f %9.0f", r.suite.c_str(), r.name.c_str(), r.impl.c_str(), r.threads, r.OpsPerSecond(), r.p50_ns, r.p99_ns, r.p999_ns, r.max_ns);
+			for (PerfEvent event : {PerfEvent::Cycles, PerfEvent::L1dMisses, PerfEvent::LlcMisses, PerfEvent::BranchMisses}) {
+				if (double per_op = r.PerOp(event); per_op >= 0) {
+					fprintf(out, " %9.2f", per_op);
+				} else {
+					fprintf(out, " %9s", "-");
+				}
+			}
+			fputc('\n', out);
+			fflush(out);
+		}
+	}
+
+	if (!options.json.empty() && !list) {
+		std::string json = ToJson(options, runner.Counting(), results);
+		if (options.json == "-") {
+			std::cout << json;
+		} else if (std::ofstream file(options.json); file << json) {
+			fprintf(out, "Results written to %s\n", options.json.c_str());
+		} else {
+			fprintf(stderr, "Failed to write %s\n", options.json.c_str());
+			return 1;
+		}
+	}
+	return 0;
+}
@@ -1,11 +1,16 @@
 #pragma once
 
-#include <atomic>			   // std::atomic
-#include <memory>			   // std::unique_ptr, std::make_unique
-#include <type_traits>		   // std::is_arithmetic
-#include <utility>			   // std::forward
-#include <godby/Portability.h> // Portability
-#include <godby/Concept.h>	   // Concepts
+#include <atomic>				  // std::atomic
+#include <cstdint>				  // uint64_t
+#include <cstring>				  // std::memcpy, std::memcmp
+#include <memory>				  // std::unique_ptr
+#include <new>					  // std::launder
+#include <type_traits>			  // std::is_arithmetic
+#include <utility>				  // std::forward
+#include <godby/Portability.h>	  // Portability
+#include <godby/Concept.h>		  // Concepts
+#include <godby/HazardPointers.h> // godby::get_hazard_list
+#include <godby/SlabAllocator.h>  // godby::SlabAllocator
 
 static_assert(__cplusplus >= 202002L, "Requires C++20 or higher");
 
@@ -47,113 +52,195 @@ class Atomic<T> : protected std::atomic<T> {
 	using atomic::operator^=;
 };
 
-template <NonArithmetic T>
-class Atomic<T> : protected std::atomic<T *> {
-  private:
-	using atomic = std::atomic<T *>;
+// Small trivially copyable types the hardware handles natively (pointers, enums, 8-byte structs).
+template <typename T>
+concept LockFreeAtomic = NonArithmetic<T> && TriviallyCopyable<T> && std::atomic<T>::is_always_lock_free;
+
+// Larger trivially copyable types, kept inline behind a sequence counter.
+template <typename T>
+concept SeqlockAtomic = NonArithmetic<T> && TriviallyCopyable<T> && !std::atomic<T>::is_always_lock_free && (sizeof(T) <= 4 * CACHE_LINE_SIZE);
+
+namespace details
+{
+// Multi-writer seqlock over relaxed atomic words: readers never write shared memory and retry
+// while a writer is active, writers take the sequence from even to odd with a CAS.
+template <TriviallyCopyable T>
+class SeqlockWords {
+	static constexpr size_t WORDS = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
 
   public:
-	using atomic::is_lock_free;
-	using atomic::is_always_lock_free;
+	explicit SeqlockWords(const T &initial) noexcept
+	{
+		put(initial);
+	}
 
-	Atomic() : atomic::atomic(new T()) {}
-	explicit Atomic(T initial) : atomic::atomic(new T(std::move(initial))) {}
-	explicit Atomic(T &&initial) : atomic::atomic(new T(std::forward<T>(initial))) {}
+	inline T load() const noexcept
+	{
+		for (;;) {
+			uint64_t seq0 = M_seq.load(std::memory_order_acquire);
+			if (GODBY_UNLIKELY(seq0 & 1)) {
+				spin_loop_pause();
+				continue;
+			}
+			T copy = get();
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (GODBY_LIKELY(M_seq.load(std::memory_order_relaxed) == seq0)) { return copy; }
+		}
+	}
 
-	~Atomic()
+	// Calls f(current) with the writer lock held, f returns whether to replace current with desired.
+	template <typename F>
+	inline T update(const T &desired, F &&f) noexcept
 	{
-		delete atomic::load(std::memory_order_relaxed);
+		uint64_t seq = lock();
+		T current = get();
+		if (f(current)) { put(desired); }
+		M_seq.store(seq + 2, std::memory_order_release);
+		return current;
 	}
 
-	inline T load(std::memory_order order = std::memory_order_seq_cst) const noexcept
+  private:
+	inline uint64_t lock() noexcept
 	{
-		return *atomic::load(order);
+		uint64_t seq = M_seq.load(std::memory_order_relaxed);
+		for (;;) {
+			if (!(seq & 1) && M_seq.compare_exchange_weak(seq, seq + 1, std::memory_order_acquire, std::memory_order_relaxed)) { break; }
+			spin_loop_pause();
+			seq = M_seq.load(std::memory_order_relaxed);
+		}
+		std::atomic_thread_fence(std::memory_order_release); // Keep the data stores after the odd sequence
+		return seq;
 	}
 
-	inline T load(std::memory_order order = std::memory_order_seq_cst) const volatile noexcept
+	inline T get() const noexcept
 	{
-		return *atomic::load(order);
+		uint64_t words[WORDS];
+		for (size_t i = 0; i < WORDS; ++i) { words[i] = M_words[i].load(std::memory_order_relaxed); }
+		alignas(T) unsigned char storage[sizeof(T)];
+		std::memcpy(storage, words, sizeof(T));
+		return *std::launder(reinterpret_cast<T *>(storage));
 	}
 
-	inline void store(const T &desired, std::memory_order order = std::memory_order_seq_cst)
+	inline void put(const T &value) noexcept
 	{
-		auto new_value = std::make_unique<T>(desired);
-		delete atomic::exchange(new_value.release(), order);
+		uint64_t words[WORDS] = {};
+		std::memcpy(words, &value, sizeof(T));
+		for (size_t i = 0; i < WORDS; ++i) { M_words[i].store(words[i], std::memory_order_relaxed); }
 	}
 
-	inline void store(T &&desired, std::memory_order order = std::memory_order_seq_cst)
+	std::atomic<uint64_t> M_seq{0};
+	std::atomic<uint64_t> M_words[WORDS];
+};
+
+// Heap copy of a value, retired through HazardPointers once it has been replaced. Every store
+// allocates one, from the slab of its size class.
+template <typename T>
+struct AtomicNode {
+	template <typename... Args>
+	explicit AtomicNode(Args &&...args) : value(std::forward<Args>(args)...)
 	{
-		auto new_value = std::make_unique<T>(std::forward<T>(desired));
-		delete atomic::exchange(new_value.release(), order);
 	}
 
-	inline void store(std::unique_ptr<T> desired, std::memory_order order = std::memory_order_seq_cst)
+	static void *operator new(size_t)
 	{
-		delete atomic::exchange(desired.release(), order);
+		return SlabAllocator<AtomicNode>::Allocate();
 	}
 
-	inline T exchange(const T &desired, std::memory_order order = std::memory_order_seq_cst) noexcept
+	static void operator delete(void *p) noexcept
 	{
-		auto new_value = std::make_unique<T>(desired);
-		auto old_value = atomic::exchange(new_value.release(), order);
-		T result = std::move(*old_value);
-		delete old_value;
-		return result;
+		SlabAllocator<AtomicNode>::Deallocate(p);
 	}
 
-	inline T exchange(const T &desired, std::memory_order order = std::memory_order_seq_cst) volatile noexcept
+	T value;
+	AtomicNode *next{nullptr};
+
+	AtomicNode *get_next() const noexcept
 	{
-		auto new_value = std::make_unique<T>(desired);
-		auto old_value = atomic::exchange(new_value.release(), order);
-		T result = std::move(*old_value);
-		delete old_value;
-		return result;
+		return next;
 	}
 
-	inline T exchange(T &&desired, std::memory_order order = std::memory_order_seq_cst) noexcept
+	void set_next(AtomicNode *next_) noexcept
 	{
-		auto new_value = std::make_unique<T>(std::forward<T>(desired));
-		auto old_value = atomic::exchange(new_value.release(), order);
-		T result = std::move(*old_value);
-		delete old_value;
-		return result;
+		next = next_;
 	}
 
-	inline T exchange(T &&desired, std::memory_order order = std::memory_order_seq_cst) volatile noexcept
+	void destroy() noexcept
 	{
-		auto new_value = std::make_unique<T>(std::forward<T>(desired));
-		auto old_value = atomic::exchange(new_value.release(), order);
-		T result = std::move(*old_value);
-		delete old_value;
-		return result;
+		delete this;
 	}
+};
+} // namespace details
 
-	inline bool compare_exchange_weak(std::unique_ptr<T> &expected, std::unique_ptr<T> desired, std::memory_order success, std::memory_order failure) noexcept
+template <LockFreeAtomic T>
+class Atomic<T> : protected std::atomic<T> {
+  private:
+	using atomic = std::atomic<T>;
+
+  public:
+	using value_type = T;
+	using atomic::atomic;
+
+	Atomic() noexcept : atomic::atomic(T{}) {}
+
+	using atomic::load;
+	using atomic::store;
+	using atomic::exchange;
+	using atomic::is_lock_free;
+	using atomic::is_always_lock_free;
+	using atomic::compare_exchange_weak;
+	using atomic::compare_exchange_strong;
+	using atomic::operator=;
+	using atomic::operator T;
+};
+
+template <SeqlockAtomic T>
+class Atomic<T> {
+  public:
+	using value_type = T;
+
+	static constexpr bool is_always_lock_free = false;
+
+	Atomic() noexcept : M_storage(T{}) {}
+	explicit Atomic(const T &initial) noexcept : M_storage(initial) {}
+
+	Atomic(const Atomic &) = delete;
+	Atomic &operator=(const Atomic &) = delete;
+
+	bool is_lock_free() const noexcept
 	{
-		return atomic::compare_exchange_weak(expected, desired.release(), success, failure);
+		return false; // Readers are, writers serialize on the sequence counter
 	}
 
-	inline bool compare_exchange_weak(std::unique_ptr<T> &expected, std::unique_ptr<T> desired, std::memory_order success, std::memory_order failure) volatile noexcept
+	inline T load(std::memory_order = std::memory_order_seq_cst) const noexcept
 	{
-		return atomic::compare_exchange_weak(expected, desired.release(), success, failure);
+		return M_storage.load();
 	}
 
-	inline bool compare_exchange_strong(std::unique_ptr<T> &expected, std::unique_ptr<T> desired, std::memory_order success, std::memory_order failure) noexcept
+	inline void store(const T &desired, std::memory_order = std::memory_order_seq_cst) noexcept
 	{
-		return atomic::compare_exchange_strong(expected, desired.release(), success, failure);
+		M_storage.update(desired, [](const T &) { return true; });
 	}
 
-	inline bool compare_exchange_strong(std::unique_ptr<T> &expected, std::unique_ptr<T> desired, std::memory_order success, std::memory_order failure) volatile noexcept
+	inline T exchange(const T &desired, std::memory_order = std::memory_order_seq_cst) noexcept
 	{
-		return atomic::compare_exchange_strong(expected, desired.release(), success, failure);
+		return M_storage.update(desired, [](const T &) { return true; });
 	}
 
-	inline operator T() const noexcept
+	// Compares object representations, like std::atomic.
+	inline bool compare_exchange_strong(T &expected, const T &desired, std::memory_order = std::memory_order_seq_cst, std::memory_order = std::memory_order_seq_cst) noexcept
 	{
-		return load();
+		bool equal = false;
+		T current = M_storage.update(desired, [&](const T &value) { return equal = std::memcmp(&value, &expected, sizeof(T)) == 0; });
+		if (!equal) { expected = current; }
+		return equal;
 	}
 
-	inline operator T() const volatile noexcept
+	inline bool compare_exchange_weak(T &expected, const T &desired, std::memory_order success = std::memory_order_seq_cst, std::memory_order failure = std::memory_order_seq_cst) noexcept
+	{
+		return compare_exchange_strong(expected, desired, success, failure);
+	}
+
+	inline operator T() const noexcept
 	{
 		return load();
 	}
@@ -163,30 +250,137 @@ class Atomic<T> : protected std::atomic<T *> {
 		store(desired);
 	}
 
-	inline void operator=(const T &desired) volatile noexcept
+  private:
+	details::SeqlockWords<T> M_storage;
+};
+
+/**
+ * Any other type lives in a heap node. Readers protect the node with their hazard pointer while
+ * copying the value out, writers swap in a fresh node and retire the old one, which is only freed
+ * once no reader protects it anymore.
+ */
+template <NonArithmetic T>
+class Atomic<T> {
+  private:
+	using node_type = details::AtomicNode<T>;
+
+  public:
+	using value_type = T;
+
+	static constexpr bool is_always_lock_free = std::atomic<node_type *>::is_always_lock_free;
+
+	Atomic() : M_node(new node_type()) {}
+	explicit Atomic(const T &initial) : M_node(new node_type(initial)) {}
+	explicit Atomic(T &&initial) : M_node(new node_type(std::move(initial))) {}
+
+	Atomic(const Atomic &) = delete;
+	Atomic &operator=(const Atomic &) = delete;
+
+	~Atomic()
 	{
-		store(desired);
+		delete M_node.load(std::memory_order_relaxed);
 	}
 
-	inline void operator=(T &&desired) noexcept
+	bool is_lock_free() const noexcept
 	{
-		store(std::forward<T>(desired));
+		return M_node.is_lock_free();
 	}
 
-	inline void operator=(T &&desired) volatile noexcept
+	inline T load(std::memory_order = std::memory_order_seq_cst) const
+	{
+		auto &hazptr = get_hazard_list<node_type>();
+		T value = hazptr.protect(M_node)->value;
+		hazptr.release();
+		return value;
+	}
+
+	inline void store(const T &desired, std::memory_order order = std::memory_order_seq_cst)
+	{
+		replace(new node_type(desired), order);
+	}
+
+	inline void store(T &&desired, std::memory_order order = std::memory_order_seq_cst)
+	{
+		replace(new node_type(std::move(desired)), order);
+	}
+
+	inline void store(std::unique_ptr<T> desired, std::memory_order order = std::memory_order_seq_cst)
 	{
-		store(std::forward<T>(desired));
+		replace(new node_type(std::move(*desired)), order);
 	}
 
-	inline void operator=(std::unique_ptr<T> desired) noexcept
+	inline T exchange(const T &desired, std::memory_order order = std::memory_order_seq_cst)
+	{
+		return exchange(new node_type(desired), order);
+	}
+
+	inline T exchange(T &&desired, std::memory_order order = std::memory_order_seq_cst)
+	{
+		return exchange(new node_type(std::move(desired)), order);
+	}
+
+	// Compares values with operator==.
+	inline bool compare_exchange_strong(T &expected, const T &desired, std::memory_order success = std::memory_order_seq_cst, std::memory_order failure = std::memory_order_seq_cst)
+	{
+		auto &hazptr = get_hazard_list<node_type>();
+		node_type *fresh = nullptr;
+		for (;;) {
+			node_type *current = hazptr.protect(M_node);
+			if (!(current->value == expected)) {
+				expected = current->value;
+				hazptr.release();
+				delete fresh;
+				return false;
+			}
+			if (fresh == nullptr) { fresh = new node_type(desired); }
+			if (M_node.compare_exchange_strong(current, fresh, success, failure)) {
+				hazptr.release();
+				hazptr.retire(current);
+				return true;
+			}
+		}
+	}
+
+	inline bool compare_exchange_weak(T &expected, const T &desired, std::memory_order success = std::memory_order_seq_cst, std::memory_order failure = std::memory_order_seq_cst)
+	{
+		return compare_exchange_strong(expected, desired, success, failure);
+	}
+
+	inline operator T() const
+	{
+		return load();
+	}
+
+	inline void operator=(const T &desired)
+	{
+		store(desired);
+	}
+
+	inline void operator=(T &&desired)
 	{
 		store(std::move(desired));
 	}
 
-	inline void operator=(std::unique_ptr<T> desired) volatile noexcept
+	inline void operator=(std::unique_ptr<T> desired)
 	{
 		store(std::move(desired));
 	}
+
+  private:
+	inline void replace(node_type *fresh, std::memory_order order)
+	{
+		get_hazard_list<node_type>().retire(M_node.exchange(fresh, order));
+	}
+
+	inline T exchange(node_type *fresh, std::memory_order order)
+	{
+		node_type *old = M_node.exchange(fresh, order); // Only we retire it, readers still copying hold their own hazard
+		T value = old->value;
+		get_hazard_list<node_type>().retire(old);
+		return value;
+	}
+
+	std::atomic<node_type *> M_node;
 };
 } // namespace godby
 
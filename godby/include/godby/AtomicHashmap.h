@@ -1,13 +1,28 @@
 #pragma once
 
-#include <utility>		  // std::forward
-#include <cmath>		  // std::log
-#include <cstdlib>		  // std::abort
-#include <functional>	  // std::function
-#include <stdexcept>	  // std::runtime_error
-#include <vector>		  // std::vector
-#include <godby/Atomic.h> // godby::Atomic
-#include <godby/Math.h>	  // godby::NextPrime
+#include <utility>			   // std::forward
+#include <algorithm>		   // std::min
+#include <atomic>			   // std::atomic
+#include <cerrno>			   // ENOENT, ENOMEM
+#include <cmath>			   // std::log
+#include <cstddef>			   // std::nullptr_t
+#include <cstdlib>			   // std::abort
+#include <functional>		   // std::hash
+#include <memory>			   // std::unique_ptr
+#include <new>				   // std::nothrow
+#include <type_traits>		   // std::is_invocable_v
+#include <stdexcept>		   // std::runtime_error
+#include <string>			   // std::string
+#include <vector>			   // std::vector
+#include <godby/Atomic.h>	   // godby::Atomic, godby::SlabAllocator
+#include <godby/Concept.h>	   // godby::Transparent
+#include <godby/Expected.h>	   // godby::Expected
+#include <godby/Math.h>		   // godby::NextPrime, godby::FastMod
+#include <godby/Portability.h> // Portability
+#include <fcntl.h>			   // open
+#include <unistd.h>			   // pwrite, fsync
+#include <sys/mman.h>		   // mmap, munmap
+#include <sys/stat.h>		   // fstat
 
 static_assert(__cplusplus >= 202002L, "Requires C++20 or higher");
 
@@ -26,6 +41,17 @@ struct Referenced {
 	using Composed = Referenced<T>;
 	Referenced() : __ref(1) {}
 
+	// Every composed key or value inserted and later replaced or erased is a block of the slab
+	static void *operator new(size_t)
+	{
+		return SlabAllocator<Composed>::Allocate();
+	}
+
+	static void operator delete(void *p) noexcept
+	{
+		SlabAllocator<Composed>::Deallocate(p);
+	}
+
 	static Composed *clone(const T &other)
 	{
 		auto *composed = new Composed;
@@ -38,7 +64,7 @@ struct Referenced {
 	{
 		auto *composed = new Composed;
 		if (composed != nullptr) {
-			new (composed) Composed();
+			::new (composed) Composed();
 			composed->__value = std::forward<T>(other);
 		}
 
@@ -127,6 +153,7 @@ struct Referenced {
 
 template <typename Key, typename Value>
 struct ConcurrentMapBucket {
+	static constexpr bool inline_storage = false;
 	size_t key = 0;
 	size_t value = 0;
 
@@ -134,6 +161,7 @@ struct ConcurrentMapBucket {
 	using ComposedValue = Referenced<Value>;
 	using KeyAccessor = typename ComposedKey::Accessor;
 	using ValueAccessor = typename ComposedValue::Accessor;
+	using Pending = ComposedKey *; // The key cloned by the first Claim(), reused for the other levels
 
 	ConcurrentMapBucket() = default;
 
@@ -187,14 +215,69 @@ struct ConcurrentMapBucket {
 		return __atomic_load_n(&key, __ATOMIC_RELAXED) != 0;
 	}
 
-	inline bool IsOccupied(const Key &rhs) noexcept
+	// Claim an empty bucket for rhs: 1 if claimed, 0 if any key (possibly an equal one) got there first.
+	template <typename K>
+	inline int Claim(const K &rhs, Pending &pending) noexcept
+	{
+		GODBY_ASSERT(__atomic_is_lock_free(sizeof(key), &key));
+		if (pending == nullptr) {
+			if constexpr (std::is_same_v<K, Key>) {
+				pending = ComposedKey::clone(rhs);
+			} else {
+				pending = ComposedKey::clone(Key(rhs));
+			}
+			if (pending == nullptr) {
+				// TRACE("Out of memory");
+				return -ENOMEM;
+			}
+		}
+
+		size_t orig = 0;
+		if (__atomic_compare_exchange_n(&key, &orig, size_t(uintptr_t(pending)), false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+			pending = nullptr;
+			return 1;
+		}
+		return 0;
+	}
+
+	static inline void Discard(Pending &pending) noexcept
+	{
+		if (pending != nullptr) { ComposedKey::deallocate(std::exchange(pending, nullptr)); }
+	}
+
+	// Empty the bucket, returns true only for the caller which actually removed the key.
+	inline bool Erase() noexcept
+	{
+		ComposedKey *oldcomposed = nullptr;
+		if (Exchange<key_tag, ComposedKey>(nullptr, oldcomposed) && oldcomposed) {
+			ComposedKey::deallocate(oldcomposed);
+			Exchange<value_tag, ComposedValue>(nullptr);
+			return true;
+		}
+		return false;
+	}
+
+	inline int Assign(const Value &value) noexcept
+	{
+		ComposedValue *composed = ComposedValue::clone(value);
+		if (composed == nullptr) {
+			// TRACE("Out of memory");
+			return -ENOMEM;
+		}
+		Exchange<value_tag, ComposedValue>(composed);
+		return 0;
+	}
+
+	template <typename K>
+	inline bool IsOccupied(const K &rhs) noexcept
 	{
 		GODBY_ASSERT(__atomic_is_lock_free(sizeof(key), &key));
 		auto accessor = AccessKey();
 		return accessor.has() && accessor.value() == rhs;
 	}
 
-	inline bool IsAvailable(const Key &rhs) noexcept
+	template <typename K>
+	inline bool IsAvailable(const K &rhs) noexcept
 	{
 		GODBY_ASSERT(__atomic_is_lock_free(sizeof(key), &key));
 		auto accessor = AccessKey();
@@ -229,29 +312,342 @@ struct ConcurrentMapBucket {
 		return false;
 	}
 };
+
+// Inline buckets need no allocation and no refcounting, which pays off for small plain keys and values.
+template <typename T>
+concept InlineStorable = TriviallyCopyable<T> && std::is_trivially_default_constructible_v<T>;
+
+/**
+ * @class: InlineMapBucket
+ *
+ * @brief: bucket storing a small trivially-copyable key and value in place
+ *
+ * Writers serialize on the version: an odd version owns the bucket, like a spinlock. Readers copy
+ * the fields optimistically and retry when the version was odd or moved meanwhile, as Seqlock does.
+ * Accessors hold copies, so they stay valid whatever happens to the bucket afterwards.
+ */
+template <typename Key, typename Value>
+struct InlineMapBucket {
+	static constexpr bool inline_storage = true;
+	static constexpr uint32_t HAS_KEY = 1;
+	static constexpr uint32_t HAS_VALUE = 2;
+
+	template <typename T>
+	struct Accessor {
+		T M_value;
+		bool M_has = false;
+
+		Accessor(std::nullptr_t = nullptr) noexcept : M_value() {}
+
+		explicit Accessor(const T &value) noexcept : M_value(value), M_has(true) {}
+
+		inline bool has() const noexcept
+		{
+			return M_has;
+		}
+
+		inline operator bool() const noexcept
+		{
+			return M_has;
+		}
+
+		inline T &value() noexcept
+		{
+			return M_value;
+		}
+	};
+
+	using KeyAccessor = Accessor<Key>;
+	using ValueAccessor = Accessor<Value>;
+	struct Pending {};
+
+	std::atomic<uint32_t> version{0};
+	uint32_t flags = 0;
+	Key key;
+	Value value;
+
+	InlineMapBucket() noexcept = default;
+
+	inline KeyAccessor AccessKey() const noexcept
+	{
+		KeyAccessor accessor;
+		Read([&] { accessor = flags & HAS_KEY ? KeyAccessor(key) : KeyAccessor(); });
+		return accessor;
+	}
+
+	inline ValueAccessor AccessValue() const noexcept
+	{
+		ValueAccessor accessor;
+		Read([&] { accessor = flags & HAS_VALUE ? ValueAccessor(value) : ValueAccessor(); });
+		return accessor;
+	}
+
+	inline bool IsOccupied() const noexcept
+	{
+		uint32_t f;
+		Read([&] { f = flags; });
+		return f & HAS_KEY;
+	}
+
+	template <typename K>
+	inline bool IsOccupied(const K &rhs) const noexcept
+	{
+		auto accessor = AccessKey();
+		return accessor.has() && accessor.value() == rhs;
+	}
+
+	template <typename K>
+	inline bool IsAvailable(const K &rhs) const noexcept
+	{
+		auto accessor = AccessKey();
+		return !accessor.has() || accessor.value() == rhs;
+	}
+
+	template <typename K>
+	inline int Claim(const K &rhs, Pending &) noexcept
+	{
+		return Write([&] {
+			if (flags & HAS_KEY) { return 0; }
+			key = Key(rhs);
+			flags = HAS_KEY;
+			return 1;
+		});
+	}
+
+	static inline void Discard(Pending &) noexcept {}
+
+	// Consistent copy of the fields for a snapshot, with an idle version.
+	inline void CopyTo(InlineMapBucket &copy) const noexcept
+	{
+		Read([&] {
+			copy.flags = flags;
+			copy.key = key;
+			copy.value = value;
+		});
+		copy.version.store(0, std::memory_order_relaxed);
+	}
+
+	inline bool Erase() noexcept
+	{
+		return Write([&] { return std::exchange(flags, 0) & HAS_KEY; });
+	}
+
+	inline void Cleanup() noexcept
+	{
+		Erase();
+	}
+
+	inline int Assign(const Value &desired) noexcept
+	{
+		return Write([&] {
+			if (!(flags & HAS_KEY)) { return -ENOENT; } // Erased since it was claimed
+			value = desired;
+			flags |= HAS_VALUE;
+			return 0;
+		});
+	}
+
+  private:
+	template <typename F>
+	inline void Read(F &&copy) const noexcept
+	{
+		for (;;) {
+			uint32_t seq0 = version.load(std::memory_order_acquire);
+			if (GODBY_UNLIKELY(seq0 & 1)) {
+				spin_loop_pause();
+				continue;
+			}
+			copy();
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (GODBY_LIKELY(version.load(std::memory_order_relaxed) == seq0)) { return; }
+		}
+	}
+
+	template <typename F>
+	inline auto Write(F &&update) noexcept
+	{
+		uint32_t seq = version.load(std::memory_order_relaxed);
+		for (;;) {
+			if (GODBY_UNLIKELY(seq & 1)) {
+				spin_loop_pause();
+				seq = version.load(std::memory_order_relaxed);
+			} else if (version.compare_exchange_weak(seq, seq + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+				break;
+			}
+		}
+		std::atomic_thread_fence(std::memory_order_release); // Readers seeing the new fields see the odd version
+		auto result = update();
+		version.store(seq + 2, std::memory_order_release);
+		return result;
+	}
+};
+
+// Small plain keys and values are stored inline, everything else behind refcounted pooled nodes.
+template <typename Key, typename Value>
+using DefaultMapBucket = std::conditional_t<InlineStorable<Key> && InlineStorable<Value> && sizeof(Key) + sizeof(Value) <= 2 * sizeof(size_t),
+											InlineMapBucket<Key, Value>, ConcurrentMapBucket<Key, Value>>;
+
+// Layout of AtomicHashmap::Snapshot() files, followed by the buckets of every level.
+struct ConcurrentMapSnapshotHeader {
+	static constexpr uint64_t MAGIC = 0x70616d6879626f67; // "gobyhmap"
+	static constexpr size_t MAX_LEVELS = 64;
+
+	uint64_t magic;
+	uint64_t bucket_size;
+	uint64_t key_size;
+	uint64_t value_size;
+	uint64_t level_count;
+	uint64_t last_occupied;
+	uint64_t capacities[MAX_LEVELS];
+	uint64_t offsets[MAX_LEVELS];
+};
+
+template <typename Bucket>
+struct ConcurrentMapLevel {
+	const size_t capacity;
+	const FastMod modulo; // Of capacity, probing a level costs no division
+	Bucket *const buckets;
+	const bool owned; // False for buckets living in a mapped snapshot
+	std::atomic<size_t> occupied{0}; // Claimed buckets, only tracked for the last level
+
+	explicit ConcurrentMapLevel(size_t capacity) : capacity(capacity), modulo(capacity), buckets(new Bucket[capacity]), owned(true) {}
+
+	ConcurrentMapLevel(size_t capacity, Bucket *buckets, bool owned = true) noexcept : capacity(capacity), modulo(capacity), buckets(buckets), owned(owned) {}
+
+	~ConcurrentMapLevel()
+	{
+		if (owned) { delete[] buckets; }
+	}
+
+	static ConcurrentMapLevel *allocate(size_t capacity) noexcept
+	{
+		Bucket *buckets = new (std::nothrow) Bucket[capacity];
+		if (buckets == nullptr) { return nullptr; }
+		auto *level = new (std::nothrow) ConcurrentMapLevel(capacity, buckets);
+		if (level == nullptr) { delete[] buckets; }
+		return level;
+	}
+
+	inline bool Contains(const Bucket *bucket) const noexcept
+	{
+		return bucket >= buckets && bucket < buckets + capacity;
+	}
+};
 } // namespace details
 
-template <typename Key, typename Value, typename Hasher = std::hash<Key>>
+template <typename Key, typename Value, typename Hasher = std::hash<Key>, typename BucketType = details::DefaultMapBucket<Key, Value>>
 class AtomicHashmap {
   public:
-	using Bucket = details::ConcurrentMapBucket<Key, Value>;
-	using ComposedKey = typename Bucket::ComposedKey;
-	using ComposedValue = typename Bucket::ComposedValue;
+	using Bucket = BucketType;
+	using Level = details::ConcurrentMapLevel<Bucket>;
 	using KeyAccessor = typename Bucket::KeyAccessor;
 	using ValueAccessor = typename Bucket::ValueAccessor;
 
-	AtomicHashmap(size_t expected_capacity, size_t level_size = 13) : M_capacity(0), M_level_size(level_size)
+	static constexpr size_t MAX_LEVELS = details::ConcurrentMapSnapshotHeader::MAX_LEVELS;
+
+	// Levels are appended online once the last level is `grow_ratio` occupied (or an insert finds every
+	// candidate bucket taken), so expected_capacity no longer has to cover the peak size.
+	AtomicHashmap(size_t expected_capacity, size_t level_size = 13, double grow_ratio = 0.5) : M_level_size(level_size), M_grow_ratio(grow_ratio)
 	{
-		if (GenMultiLevelSize(expected_capacity, level_size, M_level_capacity, M_capacity) != 0) { throw std::runtime_error("Invalid capacity or level-size"); }
-		size_t n = (unsigned long long)(expected_capacity)*expected_capacity / M_capacity;
-		if (GenMultiLevelSize(n, level_size, M_level_capacity, M_capacity) != 0) { throw std::runtime_error("Invalid capacity or level-size"); }
+		size_t capacity = 0;
+		std::vector<size_t> capacities;
+		if (GenMultiLevelSize(expected_capacity, level_size, capacities, capacity) != 0) { throw std::runtime_error("Invalid capacity or level-size"); }
+		size_t n = (unsigned long long)(expected_capacity)*expected_capacity / capacity;
+		if (GenMultiLevelSize(n, level_size, capacities, capacity) != 0 || capacities.size() > MAX_LEVELS) {
+			throw std::runtime_error("Invalid capacity or level-size");
+		}
 
-		M_buckets = new Bucket[M_capacity];
+		for (size_t i = 0; i < capacities.size(); ++i) { M_levels[i].store(new Level(capacities[i]), std::memory_order_relaxed); }
+		M_level_count.store(capacities.size(), std::memory_order_release);
 	}
 
 	~AtomicHashmap()
 	{
-		if (M_buckets) { delete[] M_buckets; }
+		if constexpr (!Bucket::inline_storage) { Cleanup(); }
+		for (auto &level : M_levels) { delete level.load(std::memory_order_relaxed); }
+		if (M_snapshot) { ::munmap(M_snapshot, M_snapshot_size); }
+	}
+
+	// Write the level layout and buckets to `path` (through a temporary file renamed over it), <0 errno.
+	// Every bucket is copied consistently; the map as a whole is consistent if writers are quiescent.
+	int Snapshot(const char *path) const
+		requires Bucket::inline_storage
+	{
+		using Header = details::ConcurrentMapSnapshotHeader;
+		Header header = {Header::MAGIC, sizeof(Bucket), sizeof(Key), sizeof(Value), LevelCount(), 0, {}, {}};
+		size_t offset = SnapshotAlign(sizeof(Header));
+		for (size_t i = 0; i < header.level_count; ++i) {
+			Level *level = M_levels[i].load(std::memory_order_relaxed);
+			header.capacities[i] = level->capacity;
+			header.offsets[i] = offset;
+			offset = SnapshotAlign(offset + level->capacity * sizeof(Bucket));
+		}
+		header.last_occupied = M_levels[header.level_count - 1].load(std::memory_order_relaxed)->occupied.load(std::memory_order_relaxed);
+
+		std::string temporary = std::string(path) + ".tmp";
+		int fd = ::open(temporary.c_str(), O_CREAT | O_TRUNC | O_WRONLY | O_CLOEXEC, 0644);
+		if (fd < 0) { return -errno; }
+
+		int rc = SnapshotWrite(fd, 0, &header, sizeof(header));
+		std::vector<Bucket> chunk(std::min<size_t>(4096, Capacity()));
+		for (size_t i = 0; rc == 0 && i < header.level_count; ++i) {
+			Level *level = M_levels[i].load(std::memory_order_relaxed);
+			for (size_t j = 0; rc == 0 && j < level->capacity; j += chunk.size()) {
+				size_t n = std::min(chunk.size(), level->capacity - j);
+				for (size_t k = 0; k < n; ++k) { level->buckets[j + k].CopyTo(chunk[k]); }
+				rc = SnapshotWrite(fd, header.offsets[i] + j * sizeof(Bucket), chunk.data(), n * sizeof(Bucket));
+			}
+		}
+		if (rc == 0 && (::ftruncate(fd, static_cast<off_t>(offset)) != 0 || ::fsync(fd) != 0)) { rc = -errno; }
+		::close(fd);
+		if (rc == 0 && ::rename(temporary.c_str(), path) != 0) { rc = -errno; }
+		if (rc != 0) { ::unlink(temporary.c_str()); }
+		return rc;
+	}
+
+	// Map a Snapshot() file back copy-on-write: the buckets are used in place, so startup costs neither
+	// per-entry inserts nor reading pages that are never touched.
+	static Expected<std::unique_ptr<AtomicHashmap>, int> Load(const char *path, double grow_ratio = 0.5)
+		requires Bucket::inline_storage
+	{
+		using Header = details::ConcurrentMapSnapshotHeader;
+		int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+		if (fd < 0) { return Unexpected<int>(errno); }
+
+		struct stat st;
+		if (::fstat(fd, &st) != 0) {
+			int error = errno;
+			::close(fd);
+			return Unexpected<int>(error);
+		}
+		size_t size = static_cast<size_t>(st.st_size);
+		void *mapping = size >= sizeof(Header) ? ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+		int error = mapping == MAP_FAILED ? (size >= sizeof(Header) ? errno : EINVAL) : 0;
+		::close(fd);
+		if (error) { return Unexpected<int>(error); }
+
+		auto const *header = static_cast<Header const *>(mapping);
+		bool valid = header->magic == Header::MAGIC && header->bucket_size == sizeof(Bucket) && header->key_size == sizeof(Key) &&
+					 header->value_size == sizeof(Value) && header->level_count > 0 && header->level_count <= MAX_LEVELS;
+		for (size_t i = 0; valid && i < header->level_count; ++i) {
+			valid = header->capacities[i] > 0 && header->offsets[i] % CACHE_LINE_SIZE == 0 && header->offsets[i] <= size &&
+					header->capacities[i] <= (size - header->offsets[i]) / sizeof(Bucket);
+		}
+		if (!valid) {
+			::munmap(mapping, size);
+			return Unexpected<int>(EINVAL);
+		}
+
+		std::unique_ptr<AtomicHashmap> map(new AtomicHashmap(snapshot_tag{}, header->level_count, grow_ratio));
+		map->M_snapshot = mapping;
+		map->M_snapshot_size = size;
+		for (size_t i = 0; i < header->level_count; ++i) {
+			Bucket *buckets = reinterpret_cast<Bucket *>(static_cast<char *>(mapping) + header->offsets[i]);
+			map->M_levels[i].store(new Level(header->capacities[i], buckets, false), std::memory_order_relaxed);
+		}
+		map->M_levels[header->level_count - 1].load(std::memory_order_relaxed)->occupied.store(header->last_occupied, std::memory_order_relaxed);
+		map->M_level_count.store(header->level_count, std::memory_order_release);
+		return map;
 	}
 
 	AtomicHashmap(AtomicHashmap &other) = delete;
@@ -259,30 +655,97 @@ class AtomicHashmap {
 	AtomicHashmap &operator=(AtomicHashmap &other) = delete;
 	AtomicHashmap &operator=(AtomicHashmap &&other) = delete;
 
+	// The hash every keyed operation starts with. Callers holding it can pass it to the overloads taking
+	// a precomputed hash, which must then be Hash(key).
+	size_t Hash(const Key &key) const noexcept
+	{
+		return Hasher()(key);
+	}
+
 	ValueAccessor Get(const Key &key) noexcept
 	{
-		Bucket *bucket = Lookup(key);
+		return Get(key, Hash(key));
+	}
+
+	ValueAccessor Get(const Key &key, size_t hash) noexcept
+	{
+		Bucket *bucket = Lookup(key, hash);
 		return bucket ? bucket->AccessValue() : ValueAccessor{nullptr};
 	}
 
 	// <0, error code
 	int Set(const Key &key, const Value &value) noexcept
 	{
-		Bucket *bucket = Occupy(key);
-		if (bucket == nullptr) { return -ENOENT; }
+		return Set(key, Hash(key), value);
+	}
 
-		ComposedValue *composed = Bucket::ComposedValue::clone(value);
-		if (composed == nullptr) {
-			// TRACE("Out of memory");
-			return -ENOMEM;
-		}
-		bucket->template Exchange<details::value_tag>(composed);
-		return 0;
+	int Set(const Key &key, size_t hash, const Value &value) noexcept
+	{
+		return Assign(Occupy(key, hash), value);
 	}
 
 	int Delete(const Key &key) noexcept
 	{
-		WalkKey(key, [](Bucket *bucket) { bucket->Cleanup(); });
+		return Delete(key, Hash(key));
+	}
+
+	int Delete(const Key &key, size_t hash) noexcept
+	{
+		WalkKey(key, hash, [this](Bucket *bucket) { Cleanup(bucket); });
+		return 0;
+	}
+
+	// Heterogeneous overloads, enabled when the hasher is transparent (defines is_transparent), e.g. to
+	// look up std::string keys by std::string_view. K must hash like and compare equal to Key; Set()
+	// only builds a Key from it when the key is not present yet.
+	template <typename K>
+		requires Transparent<Hasher>
+	size_t Hash(const K &key) const noexcept
+	{
+		return Hasher()(key);
+	}
+
+	template <typename K>
+		requires Transparent<Hasher>
+	ValueAccessor Get(const K &key) noexcept
+	{
+		return Get(key, Hash(key));
+	}
+
+	template <typename K>
+		requires Transparent<Hasher>
+	ValueAccessor Get(const K &key, size_t hash) noexcept
+	{
+		Bucket *bucket = Lookup(key, hash);
+		return bucket ? bucket->AccessValue() : ValueAccessor{nullptr};
+	}
+
+	template <typename K>
+		requires Transparent<Hasher>
+	int Set(const K &key, const Value &value) noexcept
+	{
+		return Set(key, Hash(key), value);
+	}
+
+	template <typename K>
+		requires Transparent<Hasher>
+	int Set(const K &key, size_t hash, const Value &value) noexcept
+	{
+		return Assign(Occupy(key, hash), value);
+	}
+
+	template <typename K>
+		requires Transparent<Hasher>
+	int Delete(const K &key) noexcept
+	{
+		return Delete(key, Hash(key));
+	}
+
+	template <typename K>
+		requires Transparent<Hasher>
+	int Delete(const K &key, size_t hash) noexcept
+	{
+		WalkKey(key, hash, [this](Bucket *bucket) { Cleanup(bucket); });
 		return 0;
 	}
 
@@ -291,66 +754,109 @@ class AtomicHashmap {
 		return bucket->IsOccupied();
 	}
 
-	inline bool IsOccupied(Bucket *bucket, const Key &key)
+	template <typename K>
+	inline bool IsOccupied(Bucket *bucket, const K &key)
 	{
 		return bucket->IsOccupied(key);
 	}
 
-	inline bool IsAvailable(Bucket *bucket, const Key &key)
+	template <typename K>
+	inline bool IsAvailable(Bucket *bucket, const K &key)
 	{
 		return bucket->IsAvailable(key);
 	}
 
 	inline void Cleanup()
 	{
-		for (size_t i = 0; i < M_capacity; ++i) {
-			Bucket *bucket = M_buckets + i;
-			if (bucket->IsOccupied()) { bucket->Cleanup(); }
+		for (size_t i = 0, n = LevelCount(); i < n; ++i) {
+			Level *level = M_levels[i].load(std::memory_order_relaxed);
+			for (size_t j = 0; j < level->capacity; ++j) {
+				Bucket *bucket = level->buckets + j;
+				if (bucket->IsOccupied()) { bucket->Cleanup(); }
+			}
+			level->occupied.store(0, std::memory_order_relaxed);
 		}
 	}
 
 	inline void Cleanup(Bucket *bucket)
 	{
-		if (bucket && bucket->IsOccupied()) { bucket->Cleanup(); }
+		// Only the thread which actually emptied the bucket gives it back to the last level.
+		if (bucket && bucket->IsOccupied() && bucket->Erase()) {
+			Level *last = M_levels[LevelCount() - 1].load(std::memory_order_relaxed);
+			if (last->Contains(bucket)) { last->occupied.fetch_sub(1, std::memory_order_relaxed); }
+		}
 	}
 
-	void WalkAll(std::function<void(Bucket *)> walker)
+	inline size_t LevelCount() const noexcept
 	{
-		for (size_t i = 0; i < M_capacity; ++i) {
-			Bucket *bucket = M_buckets + i;
-			if (bucket->IsOccupied()) { walker(bucket); }
-		}
+		return M_level_count.load(std::memory_order_acquire);
 	}
 
-	void WalkKey(const Key &key, std::function<void(Bucket *)> walker)
+	// Total number of buckets over all levels.
+	inline size_t Capacity() const noexcept
 	{
-		for (size_t i = 0; i < M_capacity; ++i) {
-			Bucket *bucket = M_buckets + i;
-			if (bucket->IsOccupied(key)) { walker(bucket); }
+		size_t capacity = 0;
+		for (size_t i = 0, n = LevelCount(); i < n; ++i) { capacity += M_levels[i].load(std::memory_order_relaxed)->capacity; }
+		return capacity;
+	}
+
+	// The visitor is called either with the occupied Bucket * or with its (KeyAccessor, ValueAccessor).
+	template <typename Visitor>
+	void WalkAll(Visitor &&visitor)
+	{
+		for (size_t i = 0, n = LevelCount(); i < n; ++i) {
+			Level *level = M_levels[i].load(std::memory_order_relaxed);
+			WalkRange(level, 0, level->capacity, visitor);
 		}
 	}
 
-	void WalkAll(std::function<void(KeyAccessor key, ValueAccessor value)> walker)
+	// A key can only live in its candidate bucket of each level, so only those are visited.
+	template <typename Visitor>
+	void WalkKey(const Key &key, Visitor &&visitor)
 	{
-		for (size_t i = 0; i < M_capacity; ++i) {
-			Bucket *bucket = M_buckets + i;
-			if (bucket->IsOccupied()) { walker(bucket->AccessKey(), bucket->AccessValue()); }
+		WalkKey(key, Hash(key), visitor);
+	}
+
+	template <typename K, typename Visitor>
+		requires(std::is_same_v<K, Key> || Transparent<Hasher>)
+	void WalkKey(const K &key, size_t hash, Visitor &&visitor)
+	{
+		for (size_t i = 0, n = LevelCount(); i < n; ++i) {
+			Level *level = M_levels[i].load(std::memory_order_relaxed);
+			Bucket *bucket = level->buckets + level->modulo.mod(hash);
+			if (bucket->IsOccupied(key)) { Visit(bucket, visitor); }
 		}
 	}
 
-	void WalkKey(const Key &key, std::function<void(KeyAccessor key, ValueAccessor value)> walker)
+	// Split every level into ranges of `grain` buckets and walk them on the executor's workers,
+	// returns once all ranges are done. The visitor is called concurrently and must be thread-safe.
+	// Executor is a waitable StealingExecutor whose tasks are callables, e.g. godby::TaskExecutor.
+	template <typename Executor, typename Visitor>
+	void ParallelWalk(Executor &executor, Visitor &&visitor, size_t grain = 1 << 16)
 	{
-		for (size_t i = 0; i < M_capacity; ++i) {
-			Bucket *bucket = M_buckets + i;
-			if (bucket->IsOccupied(key)) { walker(bucket->AccessKey(), bucket->AccessValue()); }
+		using Task = typename Executor::value_type;
+		typename Executor::waiter_type waiter;
+		grain = grain ? grain : 1;
+		for (size_t i = 0, n = LevelCount(); i < n; ++i) {
+			Level *level = M_levels[i].load(std::memory_order_relaxed);
+			for (size_t begin = 0; begin < level->capacity; begin += grain) {
+				size_t end = std::min(begin + grain, level->capacity);
+				executor.Submit(waiter, Task([this, &visitor, level, begin, end]() { WalkRange(level, begin, end, visitor); }));
+			}
 		}
+		waiter.wait();
 	}
 
 	class iterator {
 	  public:
-		iterator(Bucket *current, Bucket *end) : current(current), end(end)
+		iterator(AtomicHashmap *map, size_t level) : map(map), level(level), current(nullptr), end(nullptr)
 		{
-			advance_to_next_valid();
+			if (level < map->LevelCount()) {
+				Level *l = map->M_levels[level].load(std::memory_order_relaxed);
+				current = l->buckets;
+				end = l->buckets + l->capacity;
+				advance_to_next_valid();
+			}
 		}
 
 		Bucket &operator*() const
@@ -382,29 +888,63 @@ class AtomicHashmap {
 		}
 
 	  private:
+		AtomicHashmap *map;
+		size_t level;
 		Bucket *current, *end;
 
 		inline void advance_to_next_valid()
 		{
-			while (current != end && !current->IsOccupied()) { ++current; }
+			for (;;) {
+				while (current != end && !current->IsOccupied()) { ++current; }
+				if (current != end) { return; }
+				if (++level >= map->LevelCount()) {
+					current = end = nullptr;
+					return;
+				}
+				Level *l = map->M_levels[level].load(std::memory_order_relaxed);
+				current = l->buckets;
+				end = l->buckets + l->capacity;
+			}
 		}
 	};
 
 	iterator begin()
 	{
-		return iterator(M_buckets, M_buckets + M_capacity);
+		return iterator(this, 0);
 	}
 
 	iterator end()
 	{
-		return iterator(M_buckets + M_capacity, M_buckets + M_capacity);
+		return iterator(this, MAX_LEVELS);
 	}
 
   protected:
-	size_t M_capacity;
 	size_t M_level_size;
-	std::vector<size_t> M_level_capacity;
-	Bucket *M_buckets = nullptr;
+	double M_grow_ratio;
+	void *M_snapshot = nullptr; // The mapped Snapshot() this map was loaded from
+	size_t M_snapshot_size = 0;
+	// Levels never move once published, so readers only need the count to see a consistent prefix.
+	std::atomic<size_t> M_level_count{0};
+	std::atomic<Level *> M_levels[MAX_LEVELS] = {};
+
+	struct snapshot_tag {};
+	AtomicHashmap(snapshot_tag, size_t level_size, double grow_ratio) noexcept : M_level_size(level_size), M_grow_ratio(grow_ratio) {}
+
+	static constexpr size_t SnapshotAlign(size_t offset) noexcept
+	{
+		return (offset + CACHE_LINE_SIZE - 1) & ~size_t(CACHE_LINE_SIZE - 1);
+	}
+
+	static int SnapshotWrite(int fd, size_t offset, const void *data, size_t size) noexcept
+	{
+		for (const char *p = static_cast<const char *>(data); size > 0;) {
+			ssize_t n = ::pwrite(fd, p, size, static_cast<off_t>(offset));
+			if (n < 0 && errno == EINTR) { continue; }
+			if (n <= 0) { return n < 0 ? -errno : -EIO; }
+			p += n, offset += n, size -= n;
+		}
+		return 0;
+	}
 
 	static int GenMultiLevelSize(size_t n, size_t level, std::vector<size_t> &capacities, size_t &sum)
 	{
@@ -423,43 +963,97 @@ class AtomicHashmap {
 		return 0;
 	}
 
-	inline Bucket *Lookup(const Key &key)
+	// Publish level `count` unless another thread already did, each new level holding half as many
+	// buckets as all the previous ones together. Returns false once MAX_LEVELS is reached.
+	bool Grow(size_t count) noexcept
+	{
+		if (count >= MAX_LEVELS) { return false; }
+
+		Level *level = M_levels[count].load(std::memory_order_acquire);
+		if (level == nullptr) {
+			size_t capacity = 0;
+			for (size_t i = 0; i < count; ++i) { capacity += M_levels[i].load(std::memory_order_relaxed)->capacity; }
+			Level *fresh = Level::allocate(godby::NextPrime(capacity / 2 + 1));
+			if (fresh == nullptr) { return false; }
+			if (M_levels[count].compare_exchange_strong(level, fresh, std::memory_order_acq_rel, std::memory_order_acquire)) {
+				level = fresh;
+			} else {
+				delete fresh;
+			}
+		}
+		M_level_count.compare_exchange_strong(count, count + 1, std::memory_order_release, std::memory_order_relaxed);
+		return true;
+	}
+
+	template <typename Visitor>
+	inline void WalkRange(Level *level, size_t begin, size_t end, Visitor &visitor)
 	{
-		size_t hash = Hasher()(key);
-		Bucket *base = this->M_buckets;
-		for (size_t i = 0; i < M_level_capacity.size(); ++i) {
-			size_t capacity = M_level_capacity[i];
-			Bucket *bucket = base + (hash % capacity);
+		for (Bucket *bucket = level->buckets + begin, *last = level->buckets + end; bucket != last; ++bucket) {
+			if (bucket->IsOccupied()) { Visit(bucket, visitor); }
+		}
+	}
+
+	template <typename Visitor>
+	static inline void Visit(Bucket *bucket, Visitor &visitor)
+	{
+		if constexpr (std::is_invocable_v<Visitor &, Bucket *>) {
+			visitor(bucket);
+		} else {
+			visitor(bucket->AccessKey(), bucket->AccessValue());
+		}
+	}
+
+	inline int Assign(Bucket *bucket, const Value &value) noexcept
+	{
+		if (bucket == nullptr) { return -ENOENT; }
+		return bucket->Assign(value);
+	}
+
+	template <typename K>
+	inline Bucket *Lookup(const K &key, size_t hash)
+	{
+		for (size_t i = 0, n = LevelCount(); i < n; ++i) {
+			Level *level = M_levels[i].load(std::memory_order_relaxed);
+			Bucket *bucket = level->buckets + level->modulo.mod(hash);
 			if (this->IsOccupied(bucket, key)) { return bucket; }
-			base += capacity;
 		}
 
 		return nullptr;
 	}
 
-	inline Bucket *Occupy(const Key &key)
-	{
-		size_t hash = Hasher()(key);
-		Bucket *base = this->M_buckets;
-		ComposedKey *composed = nullptr;
-		for (size_t i = 0; i < M_level_capacity.size(); ++i) {
-			size_t capacity = M_level_capacity[i];
-			Bucket *bucket = base + (hash % capacity);
-			if (this->IsAvailable(bucket, key)) {
-				if (composed == nullptr) {
-					composed = Bucket::ComposedKey::clone(key);
-					if (composed == nullptr) {
-						// TRACE("Out of memory");
-						return nullptr;
+	template <typename K>
+	inline Bucket *Occupy(const K &key, size_t hash)
+	{
+		typename Bucket::Pending pending{};
+		Bucket *occupied = nullptr;
+		for (size_t i = 0;; ++i) {
+			size_t count = LevelCount();
+			if (i == count && !Grow(count)) { break; } // Every candidate bucket is taken
+
+			Level *level = M_levels[i].load(std::memory_order_acquire);
+			Bucket *bucket = level->buckets + level->modulo.mod(hash);
+			if (!bucket->IsOccupied()) {
+				int claimed = bucket->Claim(key, pending);
+				if (claimed < 0) { break; }
+				if (claimed > 0) {
+					if (i + 1 == count) {
+						// A fresh bucket in the last level: append the next level before this one fills up.
+						size_t n = level->occupied.fetch_add(1, std::memory_order_relaxed) + 1;
+						if (n > level->capacity * M_grow_ratio) { Grow(count); }
 					}
+					return bucket;
 				}
-				if (bucket->template Exchange<details::key_tag>(composed)) { return bucket; }
 			}
-			base += capacity;
+
+			// Occupied, possibly by a concurrent insert of the same key.
+			if (this->IsOccupied(bucket, key)) {
+				occupied = bucket;
+				break;
+			}
 		}
-		if (composed != nullptr) { Bucket::ComposedKey::deallocate(composed); }
+		Bucket::Discard(pending);
 
-		return nullptr;
+		return occupied;
 	}
 };
 } // namespace godby
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <optional>		  // std::optional
+#include <utility>		  // std::move
 #include <godby/Atomic.h> // godby::Atomic
 
 static_assert(__cplusplus >= 202002L, "Requires C++20 or higher");
@@ -8,12 +9,13 @@ static_assert(__cplusplus >= 202002L, "Requires C++20 or higher");
 //! AtomicOptional
 namespace godby
 {
+// The value and whether it is set are one Atomic, readers never see a value that was reset.
 template <typename T>
 class AtomicOptional {
   public:
 	AtomicOptional() {}
 
-	explicit AtomicOptional(T val) : M_value(val), M_has(true) {}
+	explicit AtomicOptional(T val) : M_value(std::optional<T>(std::move(val))) {}
 
 	AtomicOptional &operator=(const T &desired)
 	{
@@ -34,38 +36,36 @@ class AtomicOptional {
 
 	bool has() const
 	{
-		return M_has.load();
+		return M_value.load().has_value();
 	}
 
+	// T{} when empty.
 	T value() const
 	{
-		return M_value.load();
+		return M_value.load().value_or(T{});
 	}
 
 	std::optional<T> load() const
 	{
-		return M_has.load() ? std::optional<T>(M_value.load()) : std::nullopt;
+		return M_value.load();
 	}
 
 	void store(T val, std::memory_order order = std::memory_order_seq_cst)
 	{
-		M_value.store(val, order);
-		M_has.store(true, order);
+		M_value.store(std::optional<T>(std::move(val)), order);
 	}
 
 	void store(std::nullopt_t, std::memory_order order = std::memory_order_seq_cst)
 	{
-		M_value.store(T{}, order);
-		M_has.store(false, order);
+		M_value.store(std::optional<T>(), order);
 	}
 
 	operator T() const
 	{
-		return M_value.load();
+		return value();
 	}
 
   private:
-	Atomic<T> M_value;
-	std::atomic<bool> M_has{false};
+	Atomic<std::optional<T>> M_value;
 };
 } // namespace godby
@@ -1,11 +1,14 @@
 #pragma once
 
-#include <atomic>		  // std::atomic
-#include <type_traits>	  // std::is_arithmetic
-#include <utility>		  // std::forward
-#include <optional>		  // std::optional, std::nullopt
-#include <godby/Atomic.h> // godby::Atomic
-#include <godby/Math.h>	  // godby::MSB, godby::NextPowerOfTwo
+#include <algorithm>		  // std::min, std::max
+#include <atomic>			  // std::atomic
+#include <iterator>			  // std::distance
+#include <type_traits>		  // std::is_arithmetic
+#include <utility>			  // std::forward
+#include <optional>			  // std::optional, std::nullopt
+#include <godby/Atomic.h>	  // godby::Atomic
+#include <godby/Math.h>		  // godby::MSB, godby::NextPowerOfTwo
+#include <godby/WaitPolicy.h> // godby::BusyWait, godby::SpinThenPark
 
 static_assert(__cplusplus >= 202002L, "Requires C++20 or higher");
 
@@ -72,13 +75,21 @@ inline void destroy_n(T *p, unsigned n) noexcept
 	for (auto q = p + n; p != q;) { (p++)->~T(); }
 }
 
-template <class Derived>
+template <class Derived, class WaitPolicy = BusyWait>
 class AtomicQueueCommon {
   protected:
 	// Put these on different cache lines to avoid false sharing between readers and writers.
 	alignas(CACHE_LINE_SIZE) std::atomic<unsigned> head_ = {};
 	alignas(CACHE_LINE_SIZE) std::atomic<unsigned> tail_ = {};
 
+	// Number of threads parked on a slot. Only present for parking wait policies; it lives on its own
+	// cache line so the check done by every push/pop stays a read of a shared line.
+	struct alignas(CACHE_LINE_SIZE) Sleepers {
+		std::atomic<unsigned> count = {};
+	};
+	struct NoSleepers {};
+	[[no_unique_address]] std::conditional_t<WaitPolicy::parking, Sleepers, NoSleepers> sleepers_ = {};
+
 	// The special member functions are not thread-safe.
 
 	AtomicQueueCommon() noexcept = default;
@@ -102,59 +113,120 @@ class AtomicQueueCommon {
 		b.tail_.store(t, std::memory_order_relaxed);
 	}
 
+	// Park on q_element until its value is no longer old. The sleeper registration and the re-check
+	// pair with the fence in wake(), so a concurrent store either is observed here or observes us.
+	template <class A, class V>
+	GODBY_NOINLINE void park(A &q_element, V old) noexcept
+	{
+		sleepers_.count.fetch_add(1, std::memory_order_seq_cst);
+		if (q_element.load(std::memory_order_seq_cst) == old) { q_element.wait(old, std::memory_order_relaxed); }
+		sleepers_.count.fetch_sub(1, std::memory_order_relaxed);
+	}
+
+	// Issue a wake on q_element after it has been stored into, but only if somebody is parked.
+	template <class A>
+	GODBY_ALWAYS_INLINE void wake(A &q_element) noexcept
+	{
+		if constexpr (WaitPolicy::parking) {
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if (GODBY_UNLIKELY(sleepers_.count.load(std::memory_order_relaxed) != 0)) { q_element.notify_all(); }
+		}
+	}
+
+	// One iteration of a busy-wait on q_element which currently holds old.
+	// Spins, unless the spin budget of a parking policy is exhausted, in which case it parks.
+	template <class A, class V>
+	GODBY_ALWAYS_INLINE void spin_or_park(A &q_element, V old, unsigned &spins) noexcept
+	{
+		if constexpr (WaitPolicy::parking) {
+			if (GODBY_UNLIKELY(++spins >= WaitPolicy::spin_budget)) {
+				spins = 0;
+				park(q_element, old);
+				return;
+			}
+		}
+		spin_loop_pause();
+	}
+
 	template <class T, T NIL>
-	static T do_pop_atomic(std::atomic<T> &q_element) noexcept
+	T do_pop_atomic(std::atomic<T> &q_element) noexcept
 	{
+		unsigned spins = 0;
 		if (Derived::spsc_) {
 			for (;;) {
 				T element = q_element.load(std::memory_order_acquire);
 				if (GODBY_LIKELY(element != NIL)) {
 					q_element.store(NIL, std::memory_order_relaxed);
+					wake(q_element);
 					return element;
 				}
-				if (Derived::maximize_throughput_) { spin_loop_pause(); }
+				if (WaitPolicy::parking) {
+					spin_or_park(q_element, NIL, spins);
+				} else if (Derived::maximize_throughput_) {
+					spin_loop_pause();
+				}
 			}
 		} else {
 			for (;;) {
 				T element = q_element.exchange(NIL, std::memory_order_acquire); // (2) The store to wait for.
-				if (GODBY_LIKELY(element != NIL)) { return element; }
+				if (GODBY_LIKELY(element != NIL)) {
+					wake(q_element);
+					return element;
+				}
 				// Do speculative loads while busy-waiting to avoid broadcasting RFO messages.
 				do {
-					spin_loop_pause();
+					spin_or_park(q_element, NIL, spins);
 				} while (Derived::maximize_throughput_ && q_element.load(std::memory_order_relaxed) == NIL);
 			}
 		}
 	}
 
 	template <class T, T NIL>
-	static void do_push_atomic(T element, std::atomic<T> &q_element) noexcept
+	void do_push_atomic(T element, std::atomic<T> &q_element) noexcept
 	{
 		GODBY_ASSERT(element != NIL);
+		unsigned spins = 0;
 		if (Derived::spsc_) {
-			while (GODBY_UNLIKELY(q_element.load(std::memory_order_relaxed) != NIL)) {
-				if (Derived::maximize_throughput_) { spin_loop_pause(); }
+			for (T current; GODBY_UNLIKELY((current = q_element.load(std::memory_order_relaxed)) != NIL);) {
+				if (WaitPolicy::parking) {
+					spin_or_park(q_element, current, spins);
+				} else if (Derived::maximize_throughput_) {
+					spin_loop_pause();
+				}
 			}
 			q_element.store(element, std::memory_order_release);
 		} else {
 			for (T expected = NIL; GODBY_UNLIKELY(!q_element.compare_exchange_weak(expected, element, std::memory_order_release, std::memory_order_relaxed)); expected = NIL) {
 				do {
-					spin_loop_pause(); // (1) Wait for store (2) to complete.
-				} while (Derived::maximize_throughput_ && q_element.load(std::memory_order_relaxed) != NIL);
+					// (1) Wait for store (2) to complete. A spurious CAS failure leaves expected == NIL, never park on that.
+					if (expected != NIL) {
+						spin_or_park(q_element, expected, spins);
+					} else {
+						spin_loop_pause();
+					}
+				} while (Derived::maximize_throughput_ && (expected = q_element.load(std::memory_order_relaxed)) != NIL);
 			}
 		}
+		wake(q_element);
 	}
 
 	enum State : unsigned char { EMPTY, STORING, STORED, LOADING };
 
 	template <class T>
-	static T do_pop_any(std::atomic<unsigned char> &state, T &q_element) noexcept
+	T do_pop_any(std::atomic<unsigned char> &state, T &q_element) noexcept
 	{
+		unsigned spins = 0;
 		if (Derived::spsc_) {
-			while (GODBY_UNLIKELY(state.load(std::memory_order_acquire) != STORED)) {
-				if (Derived::maximize_throughput_) { spin_loop_pause(); }
+			for (unsigned char current; GODBY_UNLIKELY((current = state.load(std::memory_order_acquire)) != STORED);) {
+				if (WaitPolicy::parking) {
+					spin_or_park(state, current, spins);
+				} else if (Derived::maximize_throughput_) {
+					spin_loop_pause();
+				}
 			}
 			T element{std::move(q_element)};
 			state.store(EMPTY, std::memory_order_release);
+			wake(state);
 			return element;
 		} else {
 			for (;;) {
@@ -162,37 +234,53 @@ class AtomicQueueCommon {
 				if (GODBY_LIKELY(state.compare_exchange_weak(expected, LOADING, std::memory_order_acquire, std::memory_order_relaxed))) {
 					T element{std::move(q_element)};
 					state.store(EMPTY, std::memory_order_release);
+					wake(state);
 					return element;
 				}
 				// Do speculative loads while busy-waiting to avoid broadcasting RFO messages.
 				do {
-					spin_loop_pause();
-				} while (Derived::maximize_throughput_ && state.load(std::memory_order_relaxed) != STORED);
+					if (expected != STORED) {
+						spin_or_park(state, expected, spins);
+					} else {
+						spin_loop_pause();
+					}
+				} while (Derived::maximize_throughput_ && (expected = state.load(std::memory_order_relaxed)) != STORED);
 			}
 		}
 	}
 
 	template <class U, class T>
-	static void do_push_any(U &&element, std::atomic<unsigned char> &state, T &q_element) noexcept
+	void do_push_any(U &&element, std::atomic<unsigned char> &state, T &q_element) noexcept
 	{
+		unsigned spins = 0;
 		if (Derived::spsc_) {
-			while (GODBY_UNLIKELY(state.load(std::memory_order_acquire) != EMPTY)) {
-				if (Derived::maximize_throughput_) { spin_loop_pause(); }
+			for (unsigned char current; GODBY_UNLIKELY((current = state.load(std::memory_order_acquire)) != EMPTY);) {
+				if (WaitPolicy::parking) {
+					spin_or_park(state, current, spins);
+				} else if (Derived::maximize_throughput_) {
+					spin_loop_pause();
+				}
 			}
 			q_element = std::forward<U>(element);
 			state.store(STORED, std::memory_order_release);
+			wake(state);
 		} else {
 			for (;;) {
 				unsigned char expected = EMPTY;
 				if (GODBY_LIKELY(state.compare_exchange_weak(expected, STORING, std::memory_order_acquire, std::memory_order_relaxed))) {
 					q_element = std::forward<U>(element);
 					state.store(STORED, std::memory_order_release);
+					wake(state);
 					return;
 				}
 				// Do speculative loads while busy-waiting to avoid broadcasting RFO messages.
 				do {
-					spin_loop_pause();
-				} while (Derived::maximize_throughput_ && state.load(std::memory_order_relaxed) != EMPTY);
+					if (expected != EMPTY) {
+						spin_or_park(state, expected, spins);
+					} else {
+						spin_loop_pause();
+					}
+				} while (Derived::maximize_throughput_ && (expected = state.load(std::memory_order_relaxed)) != EMPTY);
 			}
 		}
 	}
@@ -232,6 +320,53 @@ class AtomicQueueCommon {
 		return true;
 	}
 
+	// Reserve up to std::distance(first, last) contiguous slots with a single update of head_, then fill them.
+	// Returns the number of elements pushed, which is less than requested when the queue is nearly full.
+	template <class ForwardIt>
+	unsigned try_push_n(ForwardIt first, ForwardIt last) noexcept
+	{
+		int const n = static_cast<int>(std::distance(first, last));
+		int const size = static_cast<int>(static_cast<Derived &>(*this).size_);
+		int count;
+		auto head = head_.load(std::memory_order_relaxed);
+		if (Derived::spsc_) {
+			count = std::min(n, size - static_cast<int>(head - tail_.load(std::memory_order_relaxed)));
+			if (count <= 0) { return 0; }
+			head_.store(head + count, std::memory_order_relaxed);
+		} else {
+			do {
+				count = std::min(n, size - static_cast<int>(head - tail_.load(std::memory_order_relaxed)));
+				if (count <= 0) { return 0; }
+			} while (GODBY_UNLIKELY(!head_.compare_exchange_weak(head, head + count, std::memory_order_relaxed, std::memory_order_relaxed)));
+		}
+
+		for (int i = 0; i < count; ++i, ++first) { static_cast<Derived &>(*this).do_push(*first, head + i); }
+		return count;
+	}
+
+	// Claim up to max contiguous slots with a single update of tail_, then drain them into out.
+	// Returns the number of elements popped.
+	template <class OutputIt>
+	unsigned try_pop_n(OutputIt out, unsigned max) noexcept
+	{
+		int const n = static_cast<int>(max);
+		int count;
+		auto tail = tail_.load(std::memory_order_relaxed);
+		if (Derived::spsc_) {
+			count = std::min(n, static_cast<int>(head_.load(std::memory_order_relaxed) - tail));
+			if (count <= 0) { return 0; }
+			tail_.store(tail + count, std::memory_order_relaxed);
+		} else {
+			do {
+				count = std::min(n, static_cast<int>(head_.load(std::memory_order_relaxed) - tail));
+				if (count <= 0) { return 0; }
+			} while (GODBY_UNLIKELY(!tail_.compare_exchange_weak(tail, tail + count, std::memory_order_relaxed, std::memory_order_relaxed)));
+		}
+
+		for (int i = 0; i < count; ++i, ++out) { *out = static_cast<Derived &>(*this).do_pop(tail + i); }
+		return count;
+	}
+
 	template <class T>
 	void push(T &&element) noexcept
 	{
@@ -282,9 +417,10 @@ class AtomicQueueCommon {
 };
 } // namespace details
 
-template <class T, unsigned SIZE, T NIL = details::nil<T>(), bool MINIMIZE_CONTENTION = true, bool MAXIMIZE_THROUGHPUT = true, bool TOTAL_ORDER = false, bool SPSC = false>
-class AtomicQueue : public details::AtomicQueueCommon<AtomicQueue<T, SIZE, NIL, MINIMIZE_CONTENTION, MAXIMIZE_THROUGHPUT, TOTAL_ORDER, SPSC>> {
-	using Base = details::AtomicQueueCommon<AtomicQueue<T, SIZE, NIL, MINIMIZE_CONTENTION, MAXIMIZE_THROUGHPUT, TOTAL_ORDER, SPSC>>;
+template <class T, unsigned SIZE, T NIL = details::nil<T>(), bool MINIMIZE_CONTENTION = true, bool MAXIMIZE_THROUGHPUT = true, bool TOTAL_ORDER = false, bool SPSC = false,
+		  class WAIT_POLICY = BusyWait>
+class AtomicQueue : public details::AtomicQueueCommon<AtomicQueue<T, SIZE, NIL, MINIMIZE_CONTENTION, MAXIMIZE_THROUGHPUT, TOTAL_ORDER, SPSC, WAIT_POLICY>, WAIT_POLICY> {
+	using Base = details::AtomicQueueCommon<AtomicQueue<T, SIZE, NIL, MINIMIZE_CONTENTION, MAXIMIZE_THROUGHPUT, TOTAL_ORDER, SPSC, WAIT_POLICY>, WAIT_POLICY>;
 	friend Base;
 
 	static constexpr unsigned size_ = MINIMIZE_CONTENTION ? godby::NextPowerOfTwo(SIZE) : SIZE;
@@ -320,9 +456,9 @@ class AtomicQueue : public details::AtomicQueueCommon<AtomicQueue<T, SIZE, NIL,
 	AtomicQueue &operator=(AtomicQueue const &) = delete;
 };
 
-template <class T, unsigned SIZE, bool MINIMIZE_CONTENTION = true, bool MAXIMIZE_THROUGHPUT = true, bool TOTAL_ORDER = false, bool SPSC = false>
-class AtomicQueue2 : public details::AtomicQueueCommon<AtomicQueue2<T, SIZE, MINIMIZE_CONTENTION, MAXIMIZE_THROUGHPUT, TOTAL_ORDER, SPSC>> {
-	using Base = details::AtomicQueueCommon<AtomicQueue2<T, SIZE, MINIMIZE_CONTENTION, MAXIMIZE_THROUGHPUT, TOTAL_ORDER, SPSC>>;
+template <class T, unsigned SIZE, bool MINIMIZE_CONTENTION = true, bool MAXIMIZE_THROUGHPUT = true, bool TOTAL_ORDER = false, bool SPSC = false, class WAIT_POLICY = BusyWait>
+class AtomicQueue2 : public details::AtomicQueueCommon<AtomicQueue2<T, SIZE, MINIMIZE_CONTENTION, MAXIMIZE_THROUGHPUT, TOTAL_ORDER, SPSC, WAIT_POLICY>, WAIT_POLICY> {
+	using Base = details::AtomicQueueCommon<AtomicQueue2<T, SIZE, MINIMIZE_CONTENTION, MAXIMIZE_THROUGHPUT, TOTAL_ORDER, SPSC, WAIT_POLICY>, WAIT_POLICY>;
 	using State = typename Base::State;
 	friend Base;
 
@@ -356,11 +492,12 @@ class AtomicQueue2 : public details::AtomicQueueCommon<AtomicQueue2<T, SIZE, MIN
 	AtomicQueue2 &operator=(AtomicQueue2 const &) = delete;
 };
 
-template <class T, class Allocator = std::allocator<T>, T NIL = details::nil<T>(), bool MAXIMIZE_THROUGHPUT = true, bool TOTAL_ORDER = false, bool SPSC = false>
+template <class T, class Allocator = std::allocator<T>, T NIL = details::nil<T>(), bool MAXIMIZE_THROUGHPUT = true, bool TOTAL_ORDER = false, bool SPSC = false,
+		  class WAIT_POLICY = BusyWait>
 class AtomicQueueB : private std::allocator_traits<Allocator>::template rebind_alloc<std::atomic<T>>,
-					 public details::AtomicQueueCommon<AtomicQueueB<T, Allocator, NIL, MAXIMIZE_THROUGHPUT, TOTAL_ORDER, SPSC>> {
+					 public details::AtomicQueueCommon<AtomicQueueB<T, Allocator, NIL, MAXIMIZE_THROUGHPUT, TOTAL_ORDER, SPSC, WAIT_POLICY>, WAIT_POLICY> {
 	using AllocatorElements = typename std::allocator_traits<Allocator>::template rebind_alloc<std::atomic<T>>;
-	using Base = details::AtomicQueueCommon<AtomicQueueB<T, Allocator, NIL, MAXIMIZE_THROUGHPUT, TOTAL_ORDER, SPSC>>;
+	using Base = details::AtomicQueueCommon<AtomicQueueB<T, Allocator, NIL, MAXIMIZE_THROUGHPUT, TOTAL_ORDER, SPSC, WAIT_POLICY>, WAIT_POLICY>;
 	friend Base;
 
 	static constexpr bool total_order_ = TOTAL_ORDER;
@@ -447,11 +584,11 @@ class AtomicQueueB : private std::allocator_traits<Allocator>::template rebind_a
 	}
 };
 
-template <class T, class Allocator = std::allocator<T>, bool MAXIMIZE_THROUGHPUT = true, bool TOTAL_ORDER = false, bool SPSC = false>
+template <class T, class Allocator = std::allocator<T>, bool MAXIMIZE_THROUGHPUT = true, bool TOTAL_ORDER = false, bool SPSC = false, class WAIT_POLICY = BusyWait>
 class AtomicQueueB2 : private std::allocator_traits<Allocator>::template rebind_alloc<unsigned char>,
-					  public details::AtomicQueueCommon<AtomicQueueB2<T, Allocator, MAXIMIZE_THROUGHPUT, TOTAL_ORDER, SPSC>> {
+					  public details::AtomicQueueCommon<AtomicQueueB2<T, Allocator, MAXIMIZE_THROUGHPUT, TOTAL_ORDER, SPSC, WAIT_POLICY>, WAIT_POLICY> {
 	using StorageAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<unsigned char>;
-	using Base = details::AtomicQueueCommon<AtomicQueueB2<T, Allocator, MAXIMIZE_THROUGHPUT, TOTAL_ORDER, SPSC>>;
+	using Base = details::AtomicQueueCommon<AtomicQueueB2<T, Allocator, MAXIMIZE_THROUGHPUT, TOTAL_ORDER, SPSC, WAIT_POLICY>, WAIT_POLICY>;
 	using State = typename Base::State;
 	using AtomicState = std::atomic<unsigned char>;
 	friend Base;
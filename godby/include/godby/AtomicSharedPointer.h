@@ -4,6 +4,7 @@
 #include <vector>				  // std::vector
 #include <mutex>				  // std::mutex
 #include <thread>				  // std::thread::hardware_concurrency
+#include <utility>				  // std::exchange
 #include <godby/Atomic.h>		  // godby::Atomic
 #include <godby/HazardPointers.h> // godby::HazardPointers
 
@@ -155,9 +156,9 @@ struct ControlBlockBase {
 	// Destroy the managed object.  Called when the strong count hits zero
 	virtual void dispose() noexcept = 0;
 
-	// Destroy the control block.  dispose() must have been called prior to
-	// calling destroy.  Called when the weak count hits zero.
-	virtual void destroy() noexcept = 0;
+	// Free the control block.  dispose() must have been called prior to
+	// calling deallocate.  Called when the weak count hits zero.
+	virtual void deallocate() noexcept = 0;
 
 	// Delay the destroy using hazard pointers in case there are in in-flight increments.
 	void retire() noexcept
@@ -166,6 +167,26 @@ struct ControlBlockBase {
 		godby::get_hazard_list<ControlBlockBase>().retire(this);
 	}
 
+	// Called by the hazard pointers once no thread protects this block anymore.
+	void destroy() noexcept
+	{
+		if (std::exchange(disposing, false)) {
+			dispose();
+			// Still unprotected, and nothing can protect it again since no AtomicSharedPtr holds it,
+			// so there is no need to go through the retired list a second time.
+			if (weak_count.fetch_sub(1, std::memory_order_acq_rel) == 1) { deallocate(); }
+		} else {
+			deallocate();
+		}
+	}
+
+	// Blocks that were ever held by an AtomicSharedPtr may be read through a Snapshot, which
+	// only holds the hazard pointer, so their object is disposed through the retired list too.
+	void publish() noexcept
+	{
+		if (!published.load(std::memory_order_relaxed)) { published.store(true, std::memory_order_relaxed); }
+	}
+
 	// Return the custom deleter for this object if the deleter has the type,
 	// indicated by the argument, otherwise return nullptr
 	virtual void *get_deleter(std::type_info &) const noexcept
@@ -190,7 +211,8 @@ struct ControlBlockBase {
 
 	// Release a strong reference to the object. If the strong reference count hits zero,
 	// the object is disposed and the weak reference count is decremented. If the weak
-	// reference count also reaches zero, the object is immediately destroyed.
+	// reference count also reaches zero, the object is immediately destroyed. Objects of
+	// published blocks are disposed once no hazard pointer protects their block.
 	void decrement_strong_count() noexcept
 	{
 		// A decrement-release + an acquire fence is recommended by Boost's documentation:
@@ -201,8 +223,13 @@ struct ControlBlockBase {
 			std::atomic_thread_fence(std::memory_order_acquire);
 
 			// The strong reference count has hit zero, so the managed object can be disposed of.
-			dispose();
-			decrement_weak_count();
+			if (published.load(std::memory_order_relaxed)) {
+				disposing = true;
+				retire();
+			} else {
+				dispose();
+				decrement_weak_count();
+			}
 		}
 	}
 
@@ -219,8 +246,16 @@ struct ControlBlockBase {
 		if (weak_count.fetch_sub(1, std::memory_order_release) == 1) { retire(); }
 	}
 
-	[[nodiscard]] virtual ControlBlockBase *get_next() const noexcept = 0;
-	virtual void set_next(ControlBlockBase *next) noexcept = 0;
+	// Intrusive pointer used by Hazard Pointers. Published blocks are retired while their object
+	// is still alive, so it can not share storage with the object anymore.
+	[[nodiscard]] ControlBlockBase *get_next() const noexcept
+	{
+		return next;
+	}
+	void set_next(ControlBlockBase *next_) noexcept
+	{
+		next = next_;
+	}
 
 	[[nodiscard]] virtual void *get_ptr() const noexcept = 0;
 
@@ -236,6 +271,9 @@ struct ControlBlockBase {
   private:
 	WaitFreeCounter<ref_cnt_type> strong_count;
 	std::atomic<ref_cnt_type> weak_count;
+	std::atomic<bool> published{false};
+	bool disposing{false}; // Only touched by the retiring thread
+	ControlBlockBase *next{nullptr};
 };
 
 
@@ -257,23 +295,12 @@ struct ControlBlockInplaceBase : public ControlBlockBase {
 		return static_cast<void *>(get());
 	}
 
-	// Expose intrusive pointers used by Hazard Pointers
-	[[nodiscard]] ControlBlockBase *get_next() const noexcept override
-	{
-		return next_;
-	}
-	void set_next(ControlBlockBase *next) noexcept override
-	{
-		next_ = next;
-	}
-
 	~ControlBlockInplaceBase() override {}
 
 
 	union {
 		std::monostate empty{};
-		T object;				 // Since the object is inside a union, we get precise control over its lifetime
-		ControlBlockBase *next_; // Intrusive ptr used for garbage collection by Hazard Pointers
+		T object; // Since the object is inside a union, we get precise control over its lifetime
 	};
 };
 
@@ -285,13 +312,13 @@ struct ControlBlockInplace final : public ControlBlockInplaceBase<T> {
 	static void *operator new(std::size_t sz)
 	{
 		GODBY_ASSERT(sz == sizeof(ControlBlockInplace));
-		return new ControlBlockInplace;
+		return ::operator new(sz);
 		// return parlay::type_allocator<ControlBlockInplace>::alloc();
 	}
 
 	static void operator delete(void *ptr)
 	{
-		delete static_cast<ControlBlockInplace *>(ptr);
+		::operator delete(ptr);
 		// parlay::type_allocator<ControlBlockInplace>::free(static_cast<ControlBlockInplace *>(ptr));
 	}
 
@@ -312,7 +339,7 @@ struct ControlBlockInplace final : public ControlBlockInplaceBase<T> {
 		this->get()->~T();
 	}
 
-	void destroy() noexcept override
+	void deallocate() noexcept override
 	{
 		delete this;
 	}
@@ -344,7 +371,7 @@ struct ControlBlockInplaceAllocator final : public ControlBlockInplaceBase<T> {
 		std::allocator_traits<object_allocator_t>::destroy(alloc, this->get());
 	}
 
-	void destroy() noexcept override
+	void deallocate() noexcept override
 	{
 		cb_allocator_t a{alloc};
 		this->~ControlBlockInplaceAllocator();
@@ -367,7 +394,7 @@ struct ControlBlockWithPtr : public ControlBlockBase {
 		delete get();
 	}
 
-	void destroy() noexcept override
+	void deallocate() noexcept override
 	{
 		delete this;
 	}
@@ -382,20 +409,7 @@ struct ControlBlockWithPtr : public ControlBlockBase {
 		return const_cast<T *>(ptr);
 	}
 
-	// Expose intrusive pointers used by Hazard Pointers
-	[[nodiscard]] ControlBlockBase *get_next() const noexcept override
-	{
-		return next_;
-	}
-	void set_next(ControlBlockBase *next) noexcept override
-	{
-		next_ = next;
-	}
-
-	union {
-		ControlBlockBase *next_; // Intrusive ptr used for garbage collection by Hazard pointers
-		T *ptr;					 // Pointer to the managed object while it is alive
-	};
+	T *ptr; // Pointer to the managed object while it is alive
 };
 
 // A control block pointing to a dynamically allocated object with a custom deleter
@@ -438,7 +452,7 @@ struct ControlBlockWithAllocator final : public ControlBlockWithDeleter<T, Delet
 	~ControlBlockWithAllocator() noexcept override = default;
 
 	// Deallocate the control block using the provided custom allocator
-	void destroy() noexcept override
+	void deallocate() noexcept override
 	{
 		allocator_t a{alloc};				// We must copy the allocator otherwise it gets destroyed
 		this->~ControlBlockWithAllocator(); // on the next line, then we can't use it on the final line
@@ -1119,6 +1133,7 @@ class AtomicSharedPtr {
 	explicit(false) AtomicSharedPtr(shared_ptr_type desired)
 	{ // NOLINT(google-explicit-constructor)
 		auto [ptr_, control_block_] = desired.release_internals();
+		if (control_block_) { control_block_->publish(); }
 		control_block.store(control_block_, std::memory_order_relaxed);
 	}
 
@@ -1137,6 +1152,84 @@ class AtomicSharedPtr {
 
 	constexpr static bool is_always_lock_free = std::atomic<control_block_type *>::is_always_lock_free;
 
+	// A read-only view of the object held when snapshot() was called. It only occupies one of the
+	// thread's hazard pointers, the reference counts are not touched unless shared() is called, so
+	// concurrent readers do not contend on the control block. The object stays alive while the
+	// Snapshot does, even if it is replaced and every SharedPtr to it is dropped.
+	//
+	// A thread can hold HazardPointers::hazard_pointers_per_thread - 1 Snapshots (of any
+	// AtomicSharedPtr) at once, snapshot() throws std::length_error beyond that.
+	class Snapshot {
+	  public:
+		constexpr Snapshot() noexcept = default;
+
+		Snapshot(Snapshot &&other) noexcept : holder(std::move(other.holder)), ptr(std::exchange(other.ptr, nullptr)), block(std::exchange(other.block, nullptr)) {}
+
+		Snapshot &operator=(Snapshot &&other) noexcept
+		{
+			if (this != &other) {
+				holder = std::move(other.holder);
+				ptr = std::exchange(other.ptr, nullptr);
+				block = std::exchange(other.block, nullptr);
+			}
+			return *this;
+		}
+
+		[[nodiscard]] T *get() const noexcept
+		{
+			return ptr;
+		}
+
+		T &operator*() const noexcept
+		{
+			return *ptr;
+		}
+
+		T *operator->() const noexcept
+		{
+			return ptr;
+		}
+
+		explicit operator bool() const noexcept
+		{
+			return ptr != nullptr;
+		}
+
+		// A strong reference to the same object, which may outlive the Snapshot. Empty if the object
+		// has been replaced and released by all its owners since (it is still readable through *this).
+		[[nodiscard]] shared_ptr_type shared() const
+		{
+			if (block == nullptr || !block->increment_strong_count_if_nonzero()) { return shared_ptr_type{nullptr}; }
+			return make_shared_from_ctrl_block(block);
+		}
+
+		void reset() noexcept
+		{
+			holder = holder_type{};
+			ptr = nullptr;
+			block = nullptr;
+		}
+
+	  private:
+		friend class AtomicSharedPtr;
+
+		using holder_type = typename HazardPointers<control_block_type>::Holder;
+
+		Snapshot(holder_type holder_, T *ptr_, control_block_type *block_) noexcept : holder(std::move(holder_)), ptr(ptr_), block(block_) {}
+
+		holder_type holder;
+		T *ptr{nullptr};
+		control_block_type *block{nullptr};
+	};
+
+	[[nodiscard]] Snapshot snapshot() const
+	{
+		auto holder = godby::get_hazard_list<control_block_type>().make_holder();
+		control_block_type *current_control_block = holder.protect(control_block);
+		if (current_control_block == nullptr) { return Snapshot{}; }
+		return Snapshot{std::move(holder), static_cast<T *>(current_control_block->get_ptr()), current_control_block};
+	}
+
 	[[nodiscard]] shared_ptr_type load([[maybe_unused]] std::memory_order order = std::memory_order_seq_cst) const
 	{
 		control_block_type *current_control_block = nullptr;
@@ -1154,6 +1247,7 @@ class AtomicSharedPtr {
 	void store(shared_ptr_type desired, std::memory_order order = std::memory_order_seq_cst)
 	{
 		auto [ptr_, control_block_] = desired.release_internals();
+		if (control_block_) { control_block_->publish(); }
 		auto old_control_block = control_block.exchange(control_block_, order);
 		if (old_control_block) { old_control_block->decrement_strong_count(); }
 	}
@@ -1161,6 +1255,7 @@ class AtomicSharedPtr {
 	shared_ptr_type exchange(shared_ptr_type desired, std::memory_order order = std::memory_order_seq_cst) noexcept
 	{
 		auto [ptr_, control_block_] = desired.release_internals();
+		if (control_block_) { control_block_->publish(); }
 		auto old_control_block = control_block.exchange(control_block_, order);
 		return make_shared_from_ctrl_block(old_control_block);
 	}
@@ -1169,6 +1264,7 @@ class AtomicSharedPtr {
 	{
 		auto expected_ctrl_block = expected.control_block;
 		auto desired_ctrl_block = desired.control_block;
+		if (desired_ctrl_block) { desired_ctrl_block->publish(); }
 
 		if (control_block.compare_exchange_weak(expected_ctrl_block, desired_ctrl_block, success, failure)) {
 			if (expected_ctrl_block) { expected_ctrl_block->decrement_strong_count(); }
@@ -1,7 +1,12 @@
 #pragma once
 
+#include <algorithm>
 #include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
 #include <godby/Portability.h> // Portability
+#include <godby/WaitPolicy.h>  // godby::BusyWait, godby::SpinThenPark
 
 namespace godby
 {
@@ -21,4 +26,183 @@ class Barrier {
 		counter_.store(0, std::memory_order_release);
 	}
 };
+
+namespace details
+{
+// The episode number of a barrier, the generalized sense: waiters wait for it to move past the
+// episode they arrived in, the last thread to arrive moves it.
+template <typename WaitPolicy>
+class BarrierEpisode {
+  public:
+	uint32_t current() const noexcept
+	{
+		return M_episode.load(std::memory_order_acquire);
+	}
+
+	void wait(uint32_t episode) noexcept
+	{
+		for (unsigned spins = 0; M_episode.load(std::memory_order_acquire) == episode; ++spins) {
+			if constexpr (WaitPolicy::parking) {
+				if (GODBY_UNLIKELY(spins >= WaitPolicy::spin_budget)) {
+					// The registration and the re-check pair with the seq_cst store and load in advance()
+					M_sleepers.fetch_add(1, std::memory_order_seq_cst);
+					if (M_episode.load(std::memory_order_seq_cst) == episode) { M_episode.wait(episode, std::memory_order_acquire); }
+					M_sleepers.fetch_sub(1, std::memory_order_relaxed);
+					continue;
+				}
+			}
+			spin_loop_pause();
+		}
+	}
+
+	void advance(uint32_t episode) noexcept
+	{
+		if constexpr (WaitPolicy::parking) {
+			M_episode.store(episode + 1, std::memory_order_seq_cst);
+			if (GODBY_UNLIKELY(M_sleepers.load(std::memory_order_seq_cst) != 0)) { M_episode.notify_all(); }
+		} else {
+			M_episode.store(episode + 1, std::memory_order_release);
+		}
+	}
+
+  private:
+	alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> M_episode{0};
+	std::atomic<unsigned> M_sleepers{0};
+};
+} // namespace details
+
+/**
+ * @class: SenseBarrier
+ *
+ * @brief: self-resetting centralized barrier for a fixed number of threads
+ *
+ * Threads count down a shared counter and wait for the episode to change, the last one resets
+ * the counter before moving the episode on, so the barrier is ready for the next round as soon as
+ * anyone is released and no master thread is needed. All threads decrement the same line, which
+ * is fine up to a few dozen threads; beyond that see TreeBarrier.
+ *
+ *     godby::SenseBarrier<godby::SpinThenPark<>> barrier(threads);
+ *     for (auto &step : steps) {
+ *         step(me);
+ *         barrier.arrive_and_wait();
+ *     }
+ */
+template <typename WaitPolicy = BusyWait>
+class SenseBarrier {
+  public:
+	explicit SenseBarrier(unsigned participants) noexcept : M_participants(participants), M_remaining(participants)
+	{
+		GODBY_ASSERT(participants > 0);
+	}
+
+	SenseBarrier(const SenseBarrier &) = delete;
+	SenseBarrier &operator=(const SenseBarrier &) = delete;
+
+	void arrive_and_wait() noexcept
+	{
+		uint32_t episode = M_episode.current(); // Cannot change before we arrive
+		if (M_remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			M_remaining.store(M_participants, std::memory_order_relaxed);
+			M_episode.advance(episode);
+		} else {
+			M_episode.wait(episode);
+		}
+	}
+
+	unsigned participants() const noexcept
+	{
+		return M_participants;
+	}
+
+  private:
+	const unsigned M_participants;
+	alignas(CACHE_LINE_SIZE) std::atomic<unsigned> M_remaining;
+	details::BarrierEpisode<WaitPolicy> M_episode;
+};
+
+/**
+ * @class: TreeBarrier
+ *
+ * @brief: combining tree barrier for high core counts
+ *
+ * Threads arrive at a leaf shared by FanIn of them, the last to arrive at a node carries on to its
+ * parent, and the last to arrive at the root releases everyone. Each node is on its own cache line,
+ * so at most FanIn threads contend on any line instead of all of them. Each thread passes its own
+ * id in [0, participants), threads with neighbouring ids should share a core or a cache.
+ */
+template <typename WaitPolicy = BusyWait, unsigned FanIn = 4>
+class TreeBarrier {
+	static_assert(FanIn >= 2, "A tree needs a fan-in of at least two");
+
+	struct alignas(CACHE_LINE_SIZE) Node {
+		std::atomic<unsigned> remaining{0};
+		unsigned children{0};
+		unsigned parent{0}; // Index of the parent node, the root is its own parent
+	};
+
+  public:
+	explicit TreeBarrier(unsigned participants) : M_participants(participants), M_nodes(count_nodes(participants))
+	{
+		GODBY_ASSERT(participants > 0);
+
+		// Levels are stored leaves first, the root last
+		for (unsigned begin = 0, width = participants; width > 1 || begin == 0;) {
+			unsigned nodes = (width + FanIn - 1) / FanIn;
+			for (unsigned i = 0; i < nodes; ++i) {
+				Node &node = M_nodes[begin + i];
+				node.children = std::min(FanIn, width - i * FanIn);
+				node.remaining.store(node.children, std::memory_order_relaxed);
+			}
+			if (begin != 0) {
+				unsigned below = begin - width; // First node of the level below
+				for (unsigned i = 0; i < width; ++i) { M_nodes[below + i].parent = begin + i / FanIn; }
+			}
+			begin += nodes;
+			width = nodes;
+		}
+		M_nodes.back().parent = static_cast<unsigned>(M_nodes.size() - 1);
+	}
+
+	TreeBarrier(const TreeBarrier &) = delete;
+	TreeBarrier &operator=(const TreeBarrier &) = delete;
+
+	void arrive_and_wait(unsigned id) noexcept
+	{
+		GODBY_ASSERT(id < M_participants);
+
+		uint32_t episode = M_episode.current(); // Cannot change before we arrive
+		unsigned index = id / FanIn;
+		for (;;) {
+			Node &node = M_nodes[index];
+			if (node.remaining.fetch_sub(1, std::memory_order_acq_rel) != 1) { break; }
+			node.remaining.store(node.children, std::memory_order_relaxed); // Last one here, up we go
+			if (node.parent == index) {
+				M_episode.advance(episode);
+				return;
+			}
+			index = node.parent;
+		}
+		M_episode.wait(episode);
+	}
+
+	unsigned participants() const noexcept
+	{
+		return M_participants;
+	}
+
+  private:
+	static std::size_t count_nodes(unsigned participants) noexcept
+	{
+		std::size_t count = 0;
+		for (unsigned width = participants; count == 0 || width > 1;) {
+			width = (width + FanIn - 1) / FanIn;
+			count += width;
+		}
+		return count;
+	}
+
+	const unsigned M_participants;
+	std::vector<Node> M_nodes;
+	details::BarrierEpisode<WaitPolicy> M_episode;
+};
 } // namespace godby
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <atomic>			   // std::atomic
+#include <cstddef>			   // std::size_t
+#include <cstdint>			   // uint64_t
+#include <godby/Portability.h> // Portability
+#include <godby/Seqlock.h>	   // godby::Seqlockable
+
+static_assert(__cplusplus >= 202002L, "Requires C++20 or higher");
+
+//! BroadcastRing
+namespace godby
+{
+/**
+ * @class: BroadcastRing
+ *
+ * @brief: single-producer/multi-consumer ring where every reader sees every item it keeps up with
+ *
+ * The writer never waits for readers: it overwrites the oldest slot. Each slot is a small seqlock,
+ * its version is 2 * (index + 1) once item `index` is published there and odd while it is being
+ * written, so a reader holding its own cursor can tell a published item from one not written yet
+ * and from one already overwritten. A reader that was lapped jumps forward to the oldest item still
+ * in the ring, counting what it missed in lost().
+ *
+ *     godby::BroadcastRing<Tick, 4096> ring;             // Usually heap allocated
+ *     ring.publish(tick);                                // Writer
+ *
+ *     auto reader = ring.subscribe();                    // Each reader thread
+ *     Tick tick;
+ *     while (reader.try_read(tick)) { handle(tick); }
+ */
+template <Seqlockable T, std::size_t N>
+class BroadcastRing {
+	static_assert(N >= 2 && (N & (N - 1)) == 0, "N must be a power of two");
+
+	struct alignas(CACHE_LINE_SIZE) Slot {
+		std::atomic<uint64_t> version{0};
+		T value;
+	};
+
+  public:
+	class Reader {
+	  public:
+		// Copy the next item into out, false if the reader is caught up with the writer.
+		bool try_read(T &out) noexcept
+		{
+			for (;;) {
+				const Slot &slot = M_ring->M_slots[M_next & (N - 1)];
+				const uint64_t expected = 2 * (M_next + 1);
+
+				uint64_t version = slot.version.load(std::memory_order_acquire);
+				if (version < expected) { return false; } // Not published yet (or being written)
+				if (version == expected) {
+					out = slot.value;
+					std::atomic_thread_fence(std::memory_order_acquire);
+					if (GODBY_LIKELY(slot.version.load(std::memory_order_relaxed) == expected)) {
+						++M_next;
+						return true;
+					}
+				}
+				skip(); // Overwritten before or while we copied it
+			}
+		}
+
+		// Items published and not read yet, those overwritten included.
+		uint64_t lag() const noexcept
+		{
+			return M_ring->published() - M_next;
+		}
+
+		// Items overwritten before this reader got to them.
+		uint64_t lost() const noexcept
+		{
+			return M_lost;
+		}
+
+	  private:
+		friend class BroadcastRing;
+
+		Reader(const BroadcastRing *ring, uint64_t next) noexcept : M_ring(ring), M_next(next) {}
+
+		void skip() noexcept
+		{
+			// The slot of published() - N may be the one being written, start right after it.
+			uint64_t published = M_ring->published();
+			uint64_t oldest = published >= N ? published - N + 1 : 0;
+			if (oldest > M_next) {
+				M_lost += oldest - M_next;
+				M_next = oldest;
+			} else {
+				spin_loop_pause(); // Our slot was rewritten but published() is not updated yet
+			}
+		}
+
+		const BroadcastRing *M_ring;
+		uint64_t M_next;
+		uint64_t M_lost{0};
+	};
+
+	BroadcastRing() = default;
+	BroadcastRing(const BroadcastRing &) = delete;
+	BroadcastRing &operator=(const BroadcastRing &) = delete;
+
+	static constexpr std::size_t capacity() noexcept
+	{
+		return N;
+	}
+
+	// Only one thread may publish.
+	void publish(const T &value) noexcept
+	{
+		uint64_t index = M_published.load(std::memory_order_relaxed);
+		Slot &slot = M_slots[index & (N - 1)];
+		slot.version.store(2 * index + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release); // The odd version is visible before any of the new value
+		slot.value = value;
+		slot.version.store(2 * (index + 1), std::memory_order_release);
+		M_published.store(index + 1, std::memory_order_release);
+	}
+
+	uint64_t published() const noexcept
+	{
+		return M_published.load(std::memory_order_acquire);
+	}
+
+	// A reader starting with the next item published.
+	Reader subscribe() const noexcept
+	{
+		return Reader(this, published());
+	}
+
+	// A reader starting with the oldest item still in the ring.
+	Reader subscribe_oldest() const noexcept
+	{
+		uint64_t published = this->published();
+		return Reader(this, published > N ? published - N + 1 : 0);
+	}
+
+  private:
+	alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> M_published{0};
+	Slot M_slots[N];
+};
+} // namespace godby
@@ -0,0 +1,194 @@
+#pragma once
+
+#include <algorithm>		   // std::max
+#include <atomic>			   // std::atomic
+#include <cstddef>			   // std::byte, std::size_t
+#include <cstdint>			   // uint32_t
+#include <cstring>			   // std::memcpy
+#include <new>				   // std::align_val_t
+#include <span>				   // std::span
+#include <godby/Math.h>		   // godby::NextPowerOfTwo
+#include <godby/Portability.h> // Portability
+
+static_assert(__cplusplus >= 202002L, "Requires C++20 or higher");
+
+//! ByteRing
+namespace godby
+{
+/**
+ * @class: SpscByteRing
+ *
+ * @brief: single-producer/single-consumer ring of variable-length byte records
+ *
+ * The producer serializes straight into the ring:
+ *
+ *     auto span = ring.reserve(n);     // empty span if there is not enough room
+ *     encode(span.data(), ...);
+ *     ring.commit();                   // or commit(used) to publish fewer bytes
+ *
+ * and the consumer parses in place:
+ *
+ *     auto span = ring.peek();         // empty span if the ring is empty
+ *     decode(span.data(), span.size());
+ *     ring.release();
+ *
+ * Each record is an 8-byte header followed by its payload, padded to 8 bytes. A record never wraps:
+ * when it does not fit before the end of the buffer, a padding record fills the tail and the record
+ * starts again at offset 0, so spans are always contiguous. The largest payload is max_size(), and
+ * records are never empty, so an empty span always means a full (or empty) ring.
+ *
+ * As in the SPSC mode of AtomicQueueCommon, each side keeps a cached copy of the other side's index
+ * and only reloads it (pulling the other side's cache line) when the cached copy says full/empty.
+ */
+class SpscByteRing {
+	struct Header {
+		uint32_t size;
+		uint32_t padding; // non-zero for the filler record in front of a wrap-around
+	};
+
+	static constexpr std::size_t ALIGNMENT = sizeof(Header);
+
+	static constexpr std::size_t align_up(std::size_t n) noexcept
+	{
+		return (n + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+	}
+
+  public:
+	// The special member functions are not thread-safe.
+
+	explicit SpscByteRing(std::size_t capacity)
+		: M_capacity(godby::NextPowerOfTwo(std::max<std::size_t>(capacity, 2 * CACHE_LINE_SIZE))),
+		  M_mask(M_capacity - 1),
+		  M_buffer(static_cast<std::byte *>(::operator new(M_capacity, std::align_val_t(CACHE_LINE_SIZE))))
+	{
+	}
+
+	SpscByteRing(const SpscByteRing &) = delete;
+	SpscByteRing &operator=(const SpscByteRing &) = delete;
+
+	~SpscByteRing()
+	{
+		::operator delete(M_buffer, std::align_val_t(CACHE_LINE_SIZE));
+	}
+
+	// Largest payload reserve() can ever satisfy. Keeping records within half of the buffer guarantees
+	// that a record plus the padding in front of it always fits into an empty ring.
+	std::size_t max_size() const noexcept
+	{
+		return M_capacity / 2 - sizeof(Header);
+	}
+
+	std::size_t capacity() const noexcept
+	{
+		return M_capacity;
+	}
+
+	//! Producer
+
+	// Reserve n (> 0) contiguous bytes. Returns an empty span if the ring has not enough free room right now.
+	std::span<std::byte> reserve(std::size_t n) noexcept
+	{
+		GODBY_ASSERT(n != 0 && n <= max_size());
+		GODBY_ASSERT(M_reserved == 0); // The previous reservation must be committed first
+
+		std::size_t const head = M_head.load(std::memory_order_relaxed);
+		std::size_t const offset = head & M_mask;
+		std::size_t const needed = align_up(sizeof(Header) + n);
+		std::size_t const rest = M_capacity - offset;
+		std::size_t const skip = rest < needed ? rest : 0;
+
+		if (M_capacity - (head - M_cached_tail) < skip + needed) {
+			M_cached_tail = M_tail.load(std::memory_order_acquire);
+			if (M_capacity - (head - M_cached_tail) < skip + needed) { return {}; }
+		}
+
+		if (skip) {
+			Header padding{static_cast<uint32_t>(skip - sizeof(Header)), 1};
+			std::memcpy(M_buffer + offset, &padding, sizeof(Header));
+		}
+
+		M_reserved = n;
+		M_reserved_at = head + skip;
+		return {M_buffer + ((M_reserved_at & M_mask) + sizeof(Header)), n};
+	}
+
+	// Publish the last reservation, or only its first `used` (> 0) bytes.
+	void commit(std::size_t used) noexcept
+	{
+		GODBY_ASSERT(used != 0 && used <= M_reserved);
+		Header header{static_cast<uint32_t>(used), 0};
+		std::memcpy(M_buffer + (M_reserved_at & M_mask), &header, sizeof(Header));
+		M_head.store(M_reserved_at + align_up(sizeof(Header) + used), std::memory_order_release);
+		M_reserved = 0;
+	}
+
+	void commit() noexcept
+	{
+		commit(M_reserved);
+	}
+
+	// Copying convenience on top of reserve/commit. Fails on a full ring, and on an empty record.
+	bool try_push(const void *data, std::size_t n) noexcept
+	{
+		if (n == 0) { return false; }
+		auto span = reserve(n);
+		if (span.empty()) { return false; }
+		std::memcpy(span.data(), data, n);
+		commit();
+		return true;
+	}
+
+	//! Consumer
+
+	// The oldest record, or an empty span if the ring is empty. Stays valid until release().
+	std::span<const std::byte> peek() noexcept
+	{
+		for (;;) {
+			std::size_t const tail = M_tail.load(std::memory_order_relaxed);
+			if (tail == M_cached_head) {
+				M_cached_head = M_head.load(std::memory_order_acquire);
+				if (tail == M_cached_head) { return {}; }
+			}
+
+			Header header;
+			std::memcpy(&header, M_buffer + (tail & M_mask), sizeof(Header));
+			if (GODBY_UNLIKELY(header.padding)) {
+				M_tail.store(tail + sizeof(Header) + header.size, std::memory_order_release);
+				continue;
+			}
+
+			M_peeked = align_up(sizeof(Header) + header.size);
+			return {M_buffer + ((tail & M_mask) + sizeof(Header)), header.size};
+		}
+	}
+
+	// Drop the record returned by the last peek(), handing its bytes back to the producer.
+	void release() noexcept
+	{
+		GODBY_ASSERT(M_peeked != 0);
+		M_tail.store(M_tail.load(std::memory_order_relaxed) + M_peeked, std::memory_order_release);
+		M_peeked = 0;
+	}
+
+	bool was_empty() const noexcept
+	{
+		return M_head.load(std::memory_order_relaxed) == M_tail.load(std::memory_order_relaxed);
+	}
+
+  private:
+	// Producer and consumer state on different cache lines to avoid false sharing.
+	alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> M_head{0};
+	std::size_t M_cached_tail = 0;
+	std::size_t M_reserved = 0;
+	std::size_t M_reserved_at = 0;
+
+	alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> M_tail{0};
+	std::size_t M_cached_head = 0;
+	std::size_t M_peeked = 0;
+
+	// Immutable members on another cache line which never gets invalidated by stores.
+	alignas(CACHE_LINE_SIZE) const std::size_t M_capacity;
+	const std::size_t M_mask;
+	std::byte *const M_buffer;
+};
+} // namespace godby
@@ -21,4 +21,8 @@ concept NonTriviallyCopyable = !std::is_trivially_copyable_v<T>;
 
 template <typename T>
 concept NothrowCopyAssignable = std::is_nothrow_copy_assignable_v<T>;
+
+// Hashers and comparators opting into heterogeneous lookup, as for std::unordered_map.
+template <typename T>
+concept Transparent = requires { typename T::is_transparent; };
 } // namespace godby
@@ -0,0 +1,327 @@
+#pragma once
+
+#include <algorithm>			 // std::clamp, std::min
+#include <atomic>				 // std::atomic
+#include <bit>					 // std::bit_ceil, std::countr_zero
+#include <chrono>				 // std::chrono
+#include <condition_variable>	 // std::condition_variable
+#include <cstddef>				 // size_t
+#include <cstdint>				 // uint64_t
+#include <functional>			 // std::hash, std::equal_to
+#include <memory>				 // std::unique_ptr
+#include <mutex>				 // std::mutex, std::unique_lock
+#include <optional>				 // std::optional
+#include <shared_mutex>			 // std::shared_lock
+#include <thread>				 // std::thread
+#include <unordered_map>		 // std::unordered_map
+#include <utility>				 // std::exchange, std::as_const
+#include <vector>				 // std::vector
+#include <godby/Portability.h>	 // Portability
+#include <godby/SharedMutex.h>	 // godby::DistributedSharedMutex
+#include <godby/SlabAllocator.h> // godby::SlabAllocator
+#include <godby/TimerWheel.h>	 // godby::TimerShard
+
+static_assert(__cplusplus >= 202002L, "Requires C++20 or higher");
+
+//! ConcurrentLruCache
+namespace godby
+{
+// What a ConcurrentLruCache did since it was built, see ConcurrentLruCache::Stats().
+struct LruCacheStats {
+	uint64_t hits = 0;
+	uint64_t misses = 0;
+	uint64_t evictions = 0;	  // Made room for another key
+	uint64_t expirations = 0; // Outlived their time to live
+};
+
+/**
+ * @class: ConcurrentLruCache
+ *
+ * @brief: a bounded cache sharded by hash, with CLOCK eviction and expiry on a TimerShard
+ *
+ * Each shard holds a fixed array of entries, an index over them and a DistributedSharedMutex.
+ * Get() takes it shared and, on a hit, only sets the entry's reference bit: nothing is spliced
+ * or relinked, lookups from many threads do not serialize. Set() takes it exclusively; a full
+ * shard evicts with CLOCK (second chance), its hand sweeps the entries, clearing the reference
+ * bits it finds set, and takes the first entry that was not looked up since the last sweep.
+ *
+ * With a time to live, an entry expires ttl after it was last Set(). The setting thread arms the
+ * deadline on a TimerShard, lock-free, and a reaper thread owning it removes the entry when it
+ * fires, so lookups never read the clock. Counters are striped over cache lines by thread.
+ *
+ *     godby::ConcurrentLruCache<std::string, Session> sessions(100000, std::chrono::minutes(30));
+ *     Session session;
+ *     if (!sessions.Get(token, session)) { sessions.Set(token, session = Load(token)); }
+ */
+template <typename K, typename V, typename Hash = std::hash<K>, typename KeyEqual = std::equal_to<K>>
+class ConcurrentLruCache {
+	using expiry_tick = std::chrono::milliseconds;
+
+	constexpr static size_t READER_SLOTS = 8;
+	constexpr static size_t STRIPES = 16;
+
+	class Shard;
+
+	class Entry final : public TimerEvent {
+	  protected:
+		void execute() override
+		{
+			M_shard->Expire(this);
+		}
+
+	  private:
+		friend class ConcurrentLruCache;
+
+		Shard *M_shard = nullptr;
+		std::optional<K> M_key; // Empty while the entry is free
+		std::optional<V> M_value;
+		TickType M_expires_at = 0;
+		std::atomic<bool> M_referenced{false};
+		Entry *M_free_next = nullptr;
+	};
+
+	struct alignas(CACHE_LINE_SIZE) Counters {
+		std::atomic<uint64_t> hits{0};
+		std::atomic<uint64_t> misses{0};
+		std::atomic<uint64_t> evictions{0};
+		std::atomic<uint64_t> expirations{0};
+	};
+
+	class alignas(CACHE_LINE_SIZE) Shard {
+	  public:
+		Shard(ConcurrentLruCache *cache, size_t capacity) : M_cache(cache), M_capacity(capacity), M_entries(new Entry[capacity])
+		{
+			for (size_t i = 0; i < capacity; ++i) { M_entries[i].M_shard = this; }
+			M_index.reserve(capacity);
+		}
+
+	  private:
+		friend class ConcurrentLruCache;
+		friend class Entry;
+
+		// A free entry, or the one CLOCK evicts. Exclusive lock held.
+		Entry *Acquire()
+		{
+			if (M_free) { return std::exchange(M_free, M_free->M_free_next); }
+			if (M_used < M_capacity) { return &M_entries[M_used++]; }
+
+			// Every entry is in use, the sweep finds one within two turns
+			for (;;) {
+				Entry *entry = &M_entries[M_hand];
+				M_hand = M_hand + 1 == M_capacity ? 0 : M_hand + 1;
+				if (entry->M_referenced.exchange(false, std::memory_order_relaxed)) { continue; }
+				M_index.erase(*entry->M_key);
+				entry->M_key.reset();
+				entry->M_value.reset();
+				M_cache->Count(&Counters::evictions);
+				return entry;
+			}
+		}
+
+		// Exclusive lock held.
+		void Release(Entry *entry)
+		{
+			M_index.erase(*entry->M_key);
+			entry->M_key.reset();
+			entry->M_value.reset();
+			entry->M_referenced.store(false, std::memory_order_relaxed);
+			entry->M_free_next = std::exchange(M_free, entry);
+		}
+
+		// On the reaper, the entry may have been set again, or freed, since the timer was armed.
+		void Expire(Entry *entry)
+		{
+			std::unique_lock<decltype(M_mutex)> lock(M_mutex);
+			if (!entry->M_key || entry->M_expires_at > Now()) { return; }
+			Release(entry);
+			M_cache->Count(&Counters::expirations);
+		}
+
+		ConcurrentLruCache *M_cache;
+		DistributedSharedMutex<READER_SLOTS> M_mutex;
+		std::unordered_map<K, Entry *, Hash, KeyEqual, SlabAllocator<std::pair<const K, Entry *>>> M_index;
+		size_t M_capacity;
+		std::unique_ptr<Entry[]> M_entries;
+		size_t M_used = 0; // Entries handed out at least once
+		size_t M_hand = 0;
+		Entry *M_free = nullptr;
+	};
+
+  public:
+	// Capacity is split evenly over the shards, a power of two. Without a ttl entries only leave
+	// when evicted or deleted, and no reaper thread is started.
+	explicit ConcurrentLruCache(size_t capacity, expiry_tick ttl = expiry_tick::zero(), size_t shards = 16) : M_ttl(ttl.count()), M_expiry(Now())
+	{
+		GODBY_ASSERT(capacity > 0 && shards > 0);
+		shards = std::bit_ceil(std::min(shards, capacity));
+		M_shard_shift = shards > 1 ? 64 - std::countr_zero(shards) : 63;
+		M_shard_mask = shards - 1;
+		M_shards.reserve(shards);
+		for (size_t i = 0; i < shards; ++i) { M_shards.emplace_back(std::make_unique<Shard>(this, (capacity + shards - 1) / shards)); }
+
+		if (M_ttl > 0) {
+			M_reaper = std::thread([this] { Reap(); });
+			M_expiry_bound.wait(false); // Until then the constructing thread would be taken for the owner of the timers
+		}
+	}
+
+	ConcurrentLruCache(const ConcurrentLruCache &) = delete;
+	ConcurrentLruCache &operator=(const ConcurrentLruCache &) = delete;
+
+	~ConcurrentLruCache()
+	{
+		if (M_reaper.joinable()) {
+			{
+				std::lock_guard<std::mutex> lock(M_reaper_mutex);
+				M_reaper_stop = true;
+			}
+			M_reaper_wakeup.notify_one();
+			M_reaper.join();
+		}
+	}
+
+	// Copy the value of key out, and give it a second chance against eviction.
+	bool Get(const K &key, V &value)
+	{
+		Shard &shard = ShardOf(key);
+		std::shared_lock<decltype(shard.M_mutex)> lock(shard.M_mutex);
+		auto it = std::as_const(shard.M_index).find(key);
+		if (it == shard.M_index.end()) {
+			Count(&Counters::misses);
+			return false;
+		}
+
+		Entry *entry = it->second;
+		if (!entry->M_referenced.load(std::memory_order_relaxed)) { entry->M_referenced.store(true, std::memory_order_relaxed); } // Hot keys stay read-mostly
+		value = *entry->M_value;
+		Count(&Counters::hits);
+		return true;
+	}
+
+	// Insert or replace the value of key, and restart its time to live. True if key was not cached.
+	bool Set(const K &key, const V &value)
+	{
+		Shard &shard = ShardOf(key);
+		std::unique_lock<decltype(shard.M_mutex)> lock(shard.M_mutex);
+		Entry *entry = nullptr;
+		bool inserted = false;
+		if (auto it = shard.M_index.find(key); it != shard.M_index.end()) {
+			entry = it->second;
+			*entry->M_value = value;
+			entry->M_referenced.store(true, std::memory_order_relaxed);
+		} else {
+			entry = shard.Acquire();
+			entry->M_key.emplace(key);
+			entry->M_value.emplace(value);
+			shard.M_index.emplace(key, entry);
+			inserted = true;
+		}
+
+		if (M_ttl > 0) {
+			TickType now = Now(), base = M_expiry.now();
+			entry->M_expires_at = now + M_ttl;
+			M_expiry.schedule(entry, (now > base ? now - base : 0) + M_ttl); // Posted to the reaper, the last deadline armed wins
+		}
+		return inserted;
+	}
+
+	bool Delete(const K &key)
+	{
+		Shard &shard = ShardOf(key);
+		std::unique_lock<decltype(shard.M_mutex)> lock(shard.M_mutex);
+		auto it = shard.M_index.find(key);
+		if (it == shard.M_index.end()) { return false; }
+
+		Entry *entry = it->second;
+		if (M_ttl > 0) { M_expiry.cancel(entry); }
+		shard.Release(entry);
+		return true;
+	}
+
+	size_t Size()
+	{
+		size_t size = 0;
+		for (auto &shard : M_shards) {
+			std::shared_lock<decltype(shard->M_mutex)> lock(shard->M_mutex);
+			size += shard->M_index.size();
+		}
+		return size;
+	}
+
+	size_t Capacity() const noexcept
+	{
+		return M_shards.size() * M_shards.front()->M_capacity;
+	}
+
+	LruCacheStats Stats() const noexcept
+	{
+		LruCacheStats stats;
+		for (const auto &counters : M_counters) {
+			stats.hits += counters.hits.load(std::memory_order_relaxed);
+			stats.misses += counters.misses.load(std::memory_order_relaxed);
+			stats.evictions += counters.evictions.load(std::memory_order_relaxed);
+			stats.expirations += counters.expirations.load(std::memory_order_relaxed);
+		}
+		return stats;
+	}
+
+  private:
+	static TickType Now() noexcept
+	{
+		return std::chrono::duration_cast<expiry_tick>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	// Threads are spread over the stripes round robin, in the order they first count something.
+	static size_t Stripe() noexcept
+	{
+		static std::atomic<size_t> next_stripe{0};
+		static thread_local size_t stripe = next_stripe.fetch_add(1, std::memory_order_relaxed) % STRIPES;
+		return stripe;
+	}
+
+	inline void Count(std::atomic<uint64_t> Counters::*counter) noexcept
+	{
+		(M_counters[Stripe()].*counter).fetch_add(1, std::memory_order_relaxed);
+	}
+
+	// The top bits of a Fibonacci hash, the index of each shard uses the low bits of the same hash.
+	inline Shard &ShardOf(const K &key) noexcept
+	{
+		uint64_t mixed = static_cast<uint64_t>(M_hash(key)) * 0x9e3779b97f4a7c15ull;
+		return *M_shards[(mixed >> M_shard_shift) & M_shard_mask];
+	}
+
+	// The owner of M_expiry: sleeps until its next deadline, at most a ttl since later arms can't be
+	// due any sooner, then runs what is due.
+	void Reap()
+	{
+		M_expiry.bind();
+		M_expiry_bound.store(true);
+		M_expiry_bound.notify_all();
+
+		std::unique_lock<std::mutex> lock(M_reaper_mutex);
+		while (!M_reaper_stop) {
+			lock.unlock();
+			TickType now = Now();
+			if (now > M_expiry.now()) { M_expiry.advance(now - M_expiry.now()); }
+			TickType sleep = std::clamp<TickType>(M_expiry.ticks_to_wakeup(M_ttl), 1, M_ttl);
+			lock.lock();
+			M_reaper_wakeup.wait_for(lock, expiry_tick(sleep), [this] { return M_reaper_stop; });
+		}
+	}
+
+	Hash M_hash;
+	TickType M_ttl;
+	int M_shard_shift;
+	size_t M_shard_mask;
+	TimerShard M_expiry; // Outlives the entries, they cancel themselves on destruction
+	std::vector<std::unique_ptr<Shard>> M_shards;
+	Counters M_counters[STRIPES];
+
+	std::atomic_bool M_expiry_bound{false};
+	std::thread M_reaper;
+	std::mutex M_reaper_mutex;
+	std::condition_variable M_reaper_wakeup;
+	bool M_reaper_stop = false;
+};
+} // namespace godby
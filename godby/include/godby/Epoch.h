@@ -0,0 +1,269 @@
+#pragma once
+
+#include <atomic>				  // std::atomic
+#include <cstddef>				  // std::size_t
+#include <cstdint>				  // uint64_t
+#include <new>					  // placement new
+#include <utility>				  // std::exchange
+#include <godby/HazardPointers.h> // godby::GarbageCollectible
+#include <godby/Portability.h>	  // Portability
+
+static_assert(__cplusplus >= 202002L, "Requires C++20 or higher");
+
+//! Epoch
+namespace godby
+{
+template <GarbageCollectible GarbageType>
+class Epoch;
+
+template <typename GarbageType>
+extern inline Epoch<GarbageType> &get_epoch_domain();
+
+// What lock-free structures need from a reclamation scheme, satisfied by both HazardPointers and Epoch:
+//
+//     auto guard = reclaimer.pin();          // Critical section, free for hazard pointers
+//     Node *node = reclaimer.protect(head);  // A hazard pointer announcement, a plain load for epochs
+//     ...
+//     reclaimer.release();
+//     reclaimer.retire(unlinked);
+template <typename R>
+concept Reclaimer = requires(R &r, typename R::garbage_type *p, const std::atomic<typename R::garbage_type *> &src) {
+	{ r.pin() };
+	{ r.protect(src) } -> std::convertible_to<typename R::garbage_type *>;
+	{ r.release() };
+	{ r.retire(p) };
+};
+
+/**
+ * @class: Epoch
+ *
+ * @brief: Epoch-based deferred reclamation
+ *
+ * Threads pin the domain around a critical section: pinning announces the global epoch in the
+ * thread's record, one store and one (light) fence for the whole section, however many pointers
+ * it reads. Objects retired in epoch e are destroyed once the global epoch reaches e + 2, and the
+ * epoch only advances when every pinned thread has announced the current one, so no thread can
+ * still hold a pointer to them.
+ *
+ * Much cheaper than HazardPointers for long read-mostly traversals. In exchange a thread stalled
+ * inside a critical section stops all reclamation, so sections must be short and never block.
+ * Guards nest, and must be destroyed by the thread that pinned.
+ */
+template <GarbageCollectible GarbageType>
+class Epoch {
+  public:
+	using garbage_type = GarbageType;
+
+	// After this many retires, a thread tries to advance the epoch and destroy what became safe.
+	constexpr static std::size_t collect_threshold = 64;
+
+  private:
+	struct Bucket {
+		uint64_t epoch{0};
+		garbage_type *head{nullptr};
+	};
+
+	// Each thread owns a record with its announced epoch and its retired objects, three buckets
+	// of them since only the last two epochs can still be in use.
+	struct alignas(CACHE_LINE_ALIGNMENT) Record {
+		explicit Record(bool in_use_) : in_use(in_use_) {}
+
+		// (epoch << 1) | 1 while pinned, 0 otherwise
+		std::atomic<uint64_t> announced{0};
+
+		std::atomic<Record *> next{nullptr};
+		std::atomic<bool> in_use;
+
+		unsigned depth{0};
+		unsigned retires_since_collect{0};
+		Bucket buckets[3];
+	};
+
+	struct RecordOwner {
+		explicit RecordOwner(Epoch &domain) : my_record(domain.get_record()) {}
+
+		~RecordOwner()
+		{
+			my_record->in_use.store(false);
+		}
+
+		Record *const my_record;
+	};
+
+  public:
+	Epoch() = default;
+	Epoch(const Epoch &) = delete;
+	Epoch &operator=(const Epoch &) = delete;
+
+	~Epoch()
+	{
+		for (Record *current = list_head.load(); current;) {
+			for (auto &bucket : current->buckets) { destroy(bucket); }
+			delete std::exchange(current, current->next.load());
+		}
+	}
+
+	class Guard {
+	  public:
+		constexpr Guard() noexcept = default;
+
+		Guard(Guard &&other) noexcept : record(std::exchange(other.record, nullptr)) {}
+
+		Guard &operator=(Guard &&other) noexcept
+		{
+			if (this != &other) {
+				reset();
+				record = std::exchange(other.record, nullptr);
+			}
+			return *this;
+		}
+
+		Guard(const Guard &) = delete;
+		Guard &operator=(const Guard &) = delete;
+
+		~Guard()
+		{
+			reset();
+		}
+
+		void reset() noexcept
+		{
+			if (record && --record->depth == 0) { record->announced.store(0, std::memory_order_release); }
+			record = nullptr;
+		}
+
+	  private:
+		friend class Epoch;
+
+		explicit Guard(Record *record_) noexcept : record(record_) {}
+
+		Record *record{nullptr};
+	};
+
+	// Enter a critical section, pointers read until the Guard is destroyed stay valid.
+	[[nodiscard]] Guard pin() noexcept
+	{
+		Record *record = local_record.my_record;
+		if (record->depth++ == 0) {
+			uint64_t epoch = global_epoch.load(std::memory_order_relaxed);
+			for (;;) {
+				record->announced.store((epoch << 1) | 1, std::memory_order_relaxed);
+				details::asymmetric_thread_fence_light(std::memory_order_seq_cst); /*  Fast-side fence  */
+				uint64_t current = global_epoch.load(std::memory_order_seq_cst);
+				if (GODBY_LIKELY(current == epoch)) { break; }
+				epoch = current;
+			}
+		}
+		return Guard(record);
+	}
+
+	bool pinned() const noexcept
+	{
+		return local_record.my_record->depth != 0;
+	}
+
+	// HazardPointers compatible protection: the critical section already protects everything.
+	template <template <typename> typename Atomic, typename U, typename F>
+	U protect(const Atomic<U> &src, F &&)
+	{
+		GODBY_ASSERT(pinned());
+		return src.load(std::memory_order_acquire);
+	}
+
+	template <template <typename> typename Atomic, typename U>
+	U protect(const Atomic<U> &src)
+	{
+		GODBY_ASSERT(pinned());
+		return src.load(std::memory_order_acquire);
+	}
+
+	void release() noexcept {}
+
+	// Retire an object that no longer is reachable from the shared structure.
+	void retire(garbage_type *p) noexcept
+	{
+		Record &record = *local_record.my_record;
+		uint64_t epoch = global_epoch.load(std::memory_order_seq_cst);
+
+		Bucket &bucket = record.buckets[epoch % 3];
+		if (bucket.epoch != epoch) {
+			destroy(bucket); // At least three epochs old
+			bucket.epoch = epoch;
+		}
+		p->set_next(bucket.head);
+		bucket.head = p;
+
+		if (++record.retires_since_collect >= collect_threshold) [[unlikely]] { collect(record); }
+	}
+
+	// Try to advance the epoch and destroy the calling thread's retired objects that became safe.
+	void reclaim() noexcept
+	{
+		collect(*local_record.my_record);
+	}
+
+	uint64_t epoch() const noexcept
+	{
+		return global_epoch.load(std::memory_order_relaxed);
+	}
+
+  private:
+	Record *get_record()
+	{
+		Record *current = list_head.load();
+		for (; current; current = current->next.load()) {
+			if (!current->in_use.load() && !current->in_use.exchange(true)) { return current; }
+		}
+
+		auto record = new Record{true};
+		Record *head = list_head.load();
+		do { record->next.store(head, std::memory_order_relaxed); } while (!list_head.compare_exchange_weak(head, record));
+		return record;
+	}
+
+	// Advance from the current epoch if every pinned thread has announced it.
+	bool try_advance() noexcept
+	{
+		details::asymmetric_thread_fence_heavy(std::memory_order_seq_cst);
+		uint64_t epoch = global_epoch.load(std::memory_order_seq_cst);
+		for (Record *current = list_head.load(); current; current = current->next.load()) {
+			uint64_t announced = current->announced.load(std::memory_order_seq_cst);
+			if ((announced & 1) && (announced >> 1) != epoch) { return false; }
+		}
+		return global_epoch.compare_exchange_strong(epoch, epoch + 1);
+	}
+
+	void collect(Record &record) noexcept
+	{
+		record.retires_since_collect = 0;
+		try_advance();
+		uint64_t epoch = global_epoch.load(std::memory_order_seq_cst);
+		for (auto &bucket : record.buckets) {
+			if (bucket.head && bucket.epoch + 2 <= epoch) { destroy(bucket); }
+		}
+	}
+
+	static void destroy(Bucket &bucket) noexcept
+	{
+		for (garbage_type *current = std::exchange(bucket.head, nullptr); current;) {
+			garbage_type *next = current->get_next();
+			current->destroy();
+			current = next;
+		}
+	}
+
+	alignas(CACHE_LINE_ALIGNMENT) std::atomic<uint64_t> global_epoch{0};
+	std::atomic<Record *> list_head{nullptr};
+
+	static inline const thread_local RecordOwner local_record{get_epoch_domain<garbage_type>()};
+};
+
+// Global singleton, never destructed for the same reason as get_hazard_list().
+template <typename GarbageType>
+Epoch<GarbageType> &get_epoch_domain()
+{
+	alignas(Epoch<GarbageType>) static char buffer[sizeof(Epoch<GarbageType>)];
+	static auto *domain = new (&buffer) Epoch<GarbageType>{};
+	return *domain;
+}
+} // namespace godby
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <atomic>			   // std::atomic
+#include <cstdint>			   // uint32_t
+#include <godby/Portability.h> // Portability
+
+static_assert(__cplusplus >= 202002L, "Requires C++20 or higher");
+
+//! EventCount
+namespace godby
+{
+/**
+ * @class: EventCount
+ *
+ * @brief: condition-variable replacement for lock-free code, parking on a futex
+ *
+ * A waiter announces itself, re-checks its condition and only then parks:
+ *
+ *     while (!condition()) {
+ *         auto key = ec.prepare_wait();
+ *         if (condition()) { ec.cancel_wait(); break; }
+ *         ec.wait(key);
+ *     }
+ *
+ * while the notifier makes the condition true and calls notify_one()/notify_all(). Notifying costs a
+ * fence and a load unless somebody is registered, so producers on a busy system never make a syscall
+ * and never touch a mutex. The seq_cst ordering of both sides guarantees that either the notifier
+ * sees the waiter, or the waiter's re-check sees the new state.
+ */
+class EventCount {
+  public:
+	using Key = uint32_t;
+
+	EventCount() noexcept = default;
+	EventCount(const EventCount &) = delete;
+	EventCount &operator=(const EventCount &) = delete;
+
+	inline Key prepare_wait() noexcept
+	{
+		M_waiters.fetch_add(1, std::memory_order_seq_cst);
+		return M_epoch.load(std::memory_order_seq_cst);
+	}
+
+	inline void cancel_wait() noexcept
+	{
+		M_waiters.fetch_sub(1, std::memory_order_relaxed);
+	}
+
+	// Blocks until a notification issued after prepare_wait() returned `key`.
+	inline void wait(Key key) noexcept
+	{
+		M_epoch.wait(key, std::memory_order_acquire);
+		M_waiters.fetch_sub(1, std::memory_order_relaxed);
+	}
+
+	inline void notify_one() noexcept
+	{
+		if (has_waiters()) {
+			M_epoch.fetch_add(1, std::memory_order_release);
+			M_epoch.notify_one();
+		}
+	}
+
+	inline void notify_all() noexcept
+	{
+		if (has_waiters()) {
+			M_epoch.fetch_add(1, std::memory_order_release);
+			M_epoch.notify_all();
+		}
+	}
+
+	inline uint32_t waiters() const noexcept
+	{
+		return M_waiters.load(std::memory_order_relaxed);
+	}
+
+  private:
+	inline bool has_waiters() noexcept
+	{
+		std::atomic_thread_fence(std::memory_order_seq_cst); // Orders the caller's state change before the check
+		return GODBY_UNLIKELY(M_waiters.load(std::memory_order_relaxed) != 0);
+	}
+
+	std::atomic<uint32_t> M_epoch{0};
+	std::atomic<uint32_t> M_waiters{0};
+};
+} // namespace godby
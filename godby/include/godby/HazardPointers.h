@@ -1,7 +1,13 @@
 #pragma once
 
+#include <algorithm>
 #include <atomic>
+#include <bit>
+#include <cstdint>
 #include <memory>
+#include <stdexcept>
+#include <thread>
+#include <utility>
 #include <godby/Portability.h> // Portability
 
 namespace godby
@@ -48,32 +54,35 @@ extern inline HazardPointers<GarbageType> &get_hazard_list();
 
 // A simple and efficient implementation of Hazard Pointer deferred reclamation
 //
-// Each live thread owns *exactly one* Hazard Pointer, which is sufficient for most
-// (but not all) algorithms that use them. In particular, it is sufficient for lock-
-// free atomic shared ptrs. This makes it much simpler and slightly more efficient
-// than a general-purpose Hazard Pointer implementation, like the one in Folly, which
-// supports each thread having an arbitrary number of Hazard Pointers.
+// Each live thread owns a small fixed array of hazard_pointers_per_thread Hazard Pointers
+// in one cache line. The first one is used by protect()/release(), which is sufficient
+// for most algorithms (in particular lock-free atomic shared ptrs). Algorithms that
+// need several objects protected at once, e.g. the current and next node of a list,
+// take the others as RAII Holders from make_holder(). Holders are cached per thread,
+// taking one is a bit operation on thread-local state.
 //
-// Each thread keeps a local retired list of objects that are pending deletion.
-// This means that a stalled thread can delay the destruction of its retired objects
-// indefinitely, however, since each thread is only allowed to protect a single object
-// at a time, it is guaranteed that there are at most O(P^2) total unreclaimed objects
-// at any given point, so the memory usage is theoretically bounded.
+// Each thread keeps a local retired list of objects that are pending deletion, and scans
+// all Hazard Pointers once it has retired a number of objects proportional to the number
+// of Hazard Pointers, so each scan frees a constant fraction of the list and the scan
+// cost per retire stays constant as threads are added. A stalled thread can delay the
+// destruction of its retired objects indefinitely, however, since there are at most
+// O(P) Hazard Pointers, there are at most O(P^2) total unreclaimed objects at any given
+// point, so the memory usage is theoretically bounded.
 //
 template <GarbageCollectible GarbageType>
 class HazardPointers {
-	// After this many retires, a thread will attempt to clean up the contents of
-	// its local retired list, deleting any retired objects that are not protected.
+	// After max(cleanup_threshold, 2 * number of hazard pointers) retires, a thread will attempt to
+	// clean up the contents of its local retired list, deleting any retired objects that are not protected.
 	constexpr static std::size_t cleanup_threshold = 2000;
 
+  public:
 	using garbage_type = GarbageType;
+
+  private:
 	using protected_set_type = godby::hashset<garbage_type *>;
 
-	// The retired list is an intrusive linked list of retired blocks. It takes advantage
-	// of the available managed object pointer in the control block to store the next pointers.
-	// (since, after retirement, it is guaranteed that the object has been freed, and thus
-	// the managed object pointer is no longer used.  Furthermore, it does not have to be
-	// kept as null since threads never read the pointer unless they own a reference count.)
+	// The retired list is an intrusive linked list of retired blocks, linked through the
+	// get_next/set_next pointer of the garbage type, so retiring never allocates.
 	//
 	struct RetiredList {
 		constexpr RetiredList() noexcept = default;
@@ -84,6 +93,7 @@ class HazardPointers {
 		{
 			GODBY_ASSERT(head == nullptr);
 			head = head_;
+			return *this;
 		}
 
 		RetiredList(const RetiredList &) = delete;
@@ -171,8 +181,12 @@ class HazardPointers {
 
 	struct DeamortizedReclaimer;
 
-	// Each thread owns a hazard entry slot which contains a single hazard pointer
-	// (called protected_pointer) and the thread's local retired list.
+  public:
+	constexpr static std::size_t hazard_pointers_per_thread = CACHE_LINE_SIZE / sizeof(void *);
+
+  private:
+	// Each thread owns a hazard entry slot which contains its hazard pointers
+	// and the thread's local retired list.
 	//
 	// The slots are linked together to form a linked list so that threads can scan
 	// for the set of currently protected pointers.
@@ -180,9 +194,13 @@ class HazardPointers {
 	struct alignas(CACHE_LINE_ALIGNMENT) HazardSlot {
 		explicit HazardSlot(bool in_use_) : in_use(in_use_) {}
 
-		// The *actual* "Hazard Pointer" that protects the object that it points to.
+		// The *actual* "Hazard Pointers" that protect the objects that they point to.
 		// Other threads scan for the set of all such pointers before they clean up.
-		std::atomic<garbage_type *> protected_ptr{nullptr};
+		// protected_ptrs[0] belongs to protect()/release(), the others to Holders.
+		std::atomic<garbage_type *> protected_ptrs[hazard_pointers_per_thread]{};
+
+		// Hazard pointers not taken by a Holder, only touched by the owning thread.
+		uint32_t free_holders{((uint32_t(1) << hazard_pointers_per_thread) - 1) & ~uint32_t(1)};
 
 		// Link together all existing slots into a big global linked list
 		std::atomic<HazardSlot *> next{nullptr};
@@ -217,6 +235,7 @@ class HazardPointers {
 			if (current->next.load() == nullptr) {
 				auto my_slot = new HazardSlot{true};
 				if (mode == ReclamationMethod::deamortized_reclamation) { my_slot->deamortized_reclaimer = std::make_unique<DeamortizedReclaimer>(*my_slot, list_head); }
+				num_slots.fetch_add(1, std::memory_order_relaxed);
 				HazardSlot *next = nullptr;
 				while (!current->next.compare_exchange_weak(next, my_slot)) {
 					current = next;
@@ -263,6 +282,87 @@ class HazardPointers {
 			current->next = new HazardSlot{false};
 			current = current->next;
 		}
+		num_slots.store(std::max(1u, std::thread::hardware_concurrency()), std::memory_order_relaxed);
+	}
+
+	// One of the calling thread's hazard pointers, given back when the Holder is destroyed. A Holder
+	// must be used and destroyed by the thread that made it.
+	class Holder {
+	  public:
+		constexpr Holder() noexcept = default;
+
+		Holder(Holder &&other) noexcept : slot(std::exchange(other.slot, nullptr)), index(other.index) {}
+
+		Holder &operator=(Holder &&other) noexcept
+		{
+			if (this != &other) {
+				reset();
+				slot = std::exchange(other.slot, nullptr);
+				index = other.index;
+			}
+			return *this;
+		}
+
+		Holder(const Holder &) = delete;
+		Holder &operator=(const Holder &) = delete;
+
+		~Holder()
+		{
+			reset();
+		}
+
+		// Same as HazardPointers::protect, with this Holder's hazard pointer.
+		template <template <typename> typename Atomic, typename U, typename F>
+		U protect(const Atomic<U> &src, F &&f)
+		{
+			GODBY_ASSERT(slot != nullptr);
+			return get_hazard_list<garbage_type>().protect(slot->protected_ptrs[index], src, std::forward<F>(f));
+		}
+
+		template <template <typename> typename Atomic, typename U>
+		U protect(const Atomic<U> &src)
+		{
+			return protect(src, [](auto &&x) { return std::forward<decltype(x)>(x); });
+		}
+
+		// Unprotect the currently protected object, the Holder keeps its hazard pointer.
+		void release() noexcept
+		{
+			if (slot) { slot->protected_ptrs[index].store(nullptr, std::memory_order_release); }
+		}
+
+		explicit operator bool() const noexcept
+		{
+			return slot != nullptr;
+		}
+
+	  private:
+		friend class HazardPointers;
+
+		Holder(HazardSlot *slot_, unsigned index_) noexcept : slot(slot_), index(index_) {}
+
+		void reset() noexcept
+		{
+			if (slot) {
+				release();
+				slot->free_holders |= uint32_t(1) << index;
+				slot = nullptr;
+			}
+		}
+
+		HazardSlot *slot{nullptr};
+		unsigned index{0};
+	};
+
+	// Take one of the calling thread's free hazard pointers, throws std::length_error if all
+	// hazard_pointers_per_thread - 1 of them are held.
+	Holder make_holder()
+	{
+		HazardSlot *slot = local_slot();
+		if (GODBY_UNLIKELY(slot->free_holders == 0)) { throw std::length_error("HazardPointers: no free hazard pointer"); }
+		unsigned index = static_cast<unsigned>(std::countr_zero(slot->free_holders));
+		slot->free_holders &= slot->free_holders - 1;
+		return Holder(slot, index);
 	}
 
 	~HazardPointers()
@@ -283,25 +383,7 @@ class HazardPointers {
 	template <template <typename> typename Atomic, typename U, typename F>
 	U protect(const Atomic<U> &src, F &&f)
 	{
-		static_assert(std::is_convertible_v<std::invoke_result_t<F, U>, garbage_type *>);
-		auto &slot = local_slot.my_slot->protected_ptr;
-
-		U result = src.load(std::memory_order_acquire);
-
-		while (true) {
-			auto ptr_to_protect = f(result);
-			if (ptr_to_protect == nullptr) { return result; }
-			GODBY_PREFETCH(ptr_to_protect, 0, 0);
-			slot.store(ptr_to_protect, protection_order);
-			details::asymmetric_thread_fence_light(std::memory_order_seq_cst); /*  Fast-side fence  */
-
-			U current_value = src.load(std::memory_order_acquire);
-			if (current_value == result) [[likely]] {
-				return result;
-			} else {
-				result = std::move(current_value);
-			}
-		}
+		return protect(local_slot()->protected_ptrs[0], src, std::forward<F>(f));
 	}
 
 	// Protect the object pointed to by the pointer currently stored at src.
@@ -314,7 +396,16 @@ class HazardPointers {
 	// Unprotect the currently protected object
 	void release()
 	{
-		local_slot.my_slot->protected_ptr.store(nullptr, std::memory_order_release);
+		local_slot()->protected_ptrs[0].store(nullptr, std::memory_order_release);
+	}
+
+	// Hazard pointers protect objects one at a time, a critical section needs no announcement.
+	// Lets code written against the Reclaimer concept (see Epoch.h) run on either scheme.
+	struct Guard {};
+
+	[[nodiscard]] Guard pin() const noexcept
+	{
+		return Guard{};
 	}
 
 	// Retire the given object
@@ -322,17 +413,24 @@ class HazardPointers {
 	// The object managed by p must have reference count zero.
 	void retire(garbage_type *p) noexcept
 	{
-		HazardSlot &my_slot = *local_slot.my_slot;
+		HazardSlot &my_slot = *local_slot();
 		my_slot.retired_list.push(p);
 
 		if (mode == ReclamationMethod::deamortized_reclamation) {
 			GODBY_ASSERT(my_slot.deamortized_reclaimer != nullptr);
 			my_slot.deamortized_reclaimer->do_reclamation_work();
-		} else if (++my_slot.num_retires_since_cleanup >= cleanup_threshold) [[unlikely]] {
+		} else if (++my_slot.num_retires_since_cleanup >= cleanup_threshold_now()) [[unlikely]] {
 			cleanup(my_slot);
 		}
 	}
 
+	// Destroy the calling thread's retired objects that are not protected right now, without waiting
+	// for cleanup_threshold retires. Worth it for objects that are few but large.
+	void reclaim()
+	{
+		cleanup(*local_slot());
+	}
+
 	void enable_deamortized_reclamation()
 	{
 		GODBY_ASSERT(mode == ReclamationMethod::amortized_reclamation);
@@ -342,6 +440,30 @@ class HazardPointers {
 	}
 
   private:
+	// Announce the value of src in the given hazard pointer, until it is still stored at src after announcing.
+	template <template <typename> typename Atomic, typename U, typename F>
+	U protect(std::atomic<garbage_type *> &slot, const Atomic<U> &src, F &&f)
+	{
+		static_assert(std::is_convertible_v<std::invoke_result_t<F, U>, garbage_type *>);
+
+		U result = src.load(std::memory_order_acquire);
+
+		while (true) {
+			auto ptr_to_protect = f(result);
+			if (ptr_to_protect == nullptr) { return result; }
+			GODBY_PREFETCH(ptr_to_protect, 0, 0);
+			slot.store(ptr_to_protect, protection_order);
+			details::asymmetric_thread_fence_light(std::memory_order_seq_cst); /*  Fast-side fence  */
+
+			U current_value = src.load(std::memory_order_acquire);
+			if (current_value == result) [[likely]] {
+				return result;
+			} else {
+				result = std::move(current_value);
+			}
+		}
+	}
+
 	struct DeamortizedReclaimer {
 		explicit DeamortizedReclaimer(HazardSlot &slot_, HazardSlot *const head_) : my_slot(slot_), head_slot(head_) {}
 
@@ -372,7 +494,9 @@ class HazardPointers {
 			eligible.eject_and_move(2, my_slot.retired_list, [&](auto p) { return protected_set.count(p) > 0; });
 
 			next_num_hazard_ptrs++;
-			next_protected_set.insert(current_slot->protected_ptr.load());
+			for (auto &hazard : current_slot->protected_ptrs) {
+				if (auto p = hazard.load()) { next_protected_set.insert(p); }
+			}
 			current_slot = current_slot->next;
 		}
 
@@ -386,7 +510,7 @@ class HazardPointers {
 		RetiredList eligible{};
 		RetiredList next_eligible{};
 
-		// A local estimate of the number of active hazard pointers
+		// A local estimate of the number of active hazard slots (each with hazard_pointers_per_thread pointers)
 		unsigned int num_hazard_ptrs{std::thread::hardware_concurrency()};
 		unsigned int next_num_hazard_ptrs{std::thread::hardware_concurrency()};
 
@@ -408,8 +532,10 @@ class HazardPointers {
 	void scan_hazard_pointers(F &&f) noexcept(std::is_nothrow_invocable_v<F &, garbage_type *>)
 	{
 		for_each_slot([&, f = std::forward<F>(f)](HazardSlot &slot) {
-			auto p = slot.protected_ptr.load();
-			if (p) { f(p); }
+			for (auto &hazard : slot.protected_ptrs) {
+				auto p = hazard.load();
+				if (p) { f(p); }
+			}
 		});
 	}
 
@@ -422,11 +548,22 @@ class HazardPointers {
 		slot.protected_set.clear(); // Does not free memory, only clears contents
 	}
 
+	std::size_t cleanup_threshold_now() const noexcept
+	{
+		return std::max(cleanup_threshold, 2 * hazard_pointers_per_thread * num_slots.load(std::memory_order_relaxed));
+	}
+
 	ReclamationMethod mode{ReclamationMethod::amortized_reclamation};
+	std::atomic<std::size_t> num_slots{0};
 	std::memory_order protection_order{std::memory_order_relaxed};
 	HazardSlot *const list_head;
 
-	static inline const thread_local HazardSlotOwner local_slot{get_hazard_list<garbage_type>()};
+	// Function-local: a thread_local static member next to another one trips GCC 12 (duplicate __tls_guard)
+	static HazardSlot *local_slot()
+	{
+		thread_local const HazardSlotOwner owner{get_hazard_list<garbage_type>()};
+		return owner.my_slot;
+	}
 };
 
 
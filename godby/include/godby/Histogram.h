@@ -0,0 +1,244 @@
+#pragma once
+
+#include <algorithm>		   // std::max, std::min
+#include <array>			   // std::array
+#include <atomic>			   // std::atomic
+#include <bit>				   // std::bit_width
+#include <cstdint>			   // uint64_t
+#include <limits>			   // std::numeric_limits
+#include <utility>			   // std::exchange
+#include <godby/Portability.h> // Portability
+
+static_assert(__cplusplus >= 202002L, "Requires C++20 or higher");
+
+//! Histogram
+namespace godby
+{
+namespace details
+{
+// Log-linear buckets: values below 2^(Precision + 1) get a bucket each, every power of two above that
+// is split into 2^Precision buckets, so a bucket is at most 2^-Precision of the values it holds.
+template <unsigned Precision>
+struct HistogramLayout {
+	static_assert(Precision >= 1 && Precision <= 16, "Precision is the number of significant bits kept");
+
+	static constexpr unsigned SUB_BUCKETS = 1u << Precision;
+	static constexpr unsigned BUCKETS = (64 - Precision + 1) * SUB_BUCKETS;
+
+	static constexpr unsigned IndexOf(uint64_t value) noexcept
+	{
+		unsigned shift = std::max<unsigned>(std::bit_width(value), Precision + 1) - (Precision + 1);
+		return (shift << Precision) + static_cast<unsigned>(value >> shift);
+	}
+
+	static constexpr uint64_t LowestOf(unsigned index) noexcept
+	{
+		unsigned shift = index >> Precision;
+		if (shift <= 1) { return index; }
+		return (uint64_t(index & (SUB_BUCKETS - 1)) + SUB_BUCKETS) << (shift - 1);
+	}
+
+	static constexpr uint64_t HighestOf(unsigned index) noexcept
+	{
+		unsigned shift = index >> Precision;
+		return LowestOf(index) + (shift <= 1 ? 0 : (uint64_t(1) << (shift - 1)) - 1);
+	}
+};
+} // namespace details
+
+/**
+ * @class: HistogramSnapshot
+ *
+ * @brief: a copy of the counts of one or more Histograms, to merge and query
+ *
+ * Percentile() answers with the highest value of the bucket holding the rank, clamped to the largest
+ * value recorded, so it overstates by at most 2^-Precision.
+ */
+template <unsigned Precision = 7>
+class HistogramSnapshot {
+	using Layout = details::HistogramLayout<Precision>;
+
+  public:
+	void Merge(const HistogramSnapshot &b) noexcept
+	{
+		for (unsigned i = 0; i < Layout::BUCKETS; ++i) { M_counts[i] += b.M_counts[i]; }
+		M_count += b.M_count, M_sum += b.M_sum;
+		M_min = std::min(M_min, b.M_min), M_max = std::max(M_max, b.M_max);
+	}
+
+	uint64_t Count() const noexcept
+	{
+		return M_count;
+	}
+
+	uint64_t Min() const noexcept
+	{
+		return M_count ? M_min : 0;
+	}
+
+	uint64_t Max() const noexcept
+	{
+		return M_max;
+	}
+
+	double Mean() const noexcept
+	{
+		return M_count ? static_cast<double>(M_sum) / M_count : 0;
+	}
+
+	// p in [0, 1], Percentile(0.99) is the value 99% of the recorded ones are at or below.
+	uint64_t Percentile(double p) const noexcept
+	{
+		if (M_count == 0) { return 0; }
+		uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(p * M_count + 0.5)), seen = 0;
+		for (unsigned i = 0; i < Layout::BUCKETS; ++i) {
+			// Not std::clamp: a snapshot racing Record() may see the counts before min/max, and Min() > M_max.
+			if ((seen += M_counts[i]) >= rank) { return std::min(std::max(Layout::HighestOf(i), Min()), M_max); }
+		}
+		return M_max;
+	}
+
+	// Calls f(lowest, highest, count) for every bucket holding values, in increasing order.
+	template <typename F>
+	void ForEach(F &&f) const
+	{
+		for (unsigned i = 0; i < Layout::BUCKETS; ++i) {
+			if (M_counts[i]) { f(Layout::LowestOf(i), Layout::HighestOf(i), M_counts[i]); }
+		}
+	}
+
+  private:
+	template <unsigned>
+	friend class Histogram;
+
+	std::array<uint64_t, Layout::BUCKETS> M_counts{};
+	uint64_t M_count = 0;
+	uint64_t M_sum = 0;
+	uint64_t M_min = std::numeric_limits<uint64_t>::max();
+	uint64_t M_max = 0;
+};
+
+/**
+ * @class: Histogram
+ *
+ * @brief: HDR histogram with a single writer, from which any thread can take a snapshot
+ *
+ * Record() is a handful of relaxed loads and stores, no read-modify-write, as only the owning
+ * thread writes. Snapshot() may run concurrently and sees every bucket at some point of the run,
+ * which is what aggregating in-flight metrics needs; the count it reports is the sum of the buckets.
+ * Give each thread its own histogram, through HistogramSet when threads come and go.
+ */
+template <unsigned Precision = 7>
+class Histogram {
+	using Layout = details::HistogramLayout<Precision>;
+
+  public:
+	using Snapshot_t = HistogramSnapshot<Precision>;
+
+	Histogram() = default;
+	Histogram(const Histogram &) = delete;
+	Histogram &operator=(const Histogram &) = delete;
+
+	inline void Record(uint64_t value, uint64_t count = 1) noexcept
+	{
+		auto &bucket = M_counts[Layout::IndexOf(value)];
+		bucket.store(bucket.load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
+		M_sum.store(M_sum.load(std::memory_order_relaxed) + value * count, std::memory_order_relaxed);
+		if (GODBY_UNLIKELY(value < M_min.load(std::memory_order_relaxed))) { M_min.store(value, std::memory_order_relaxed); }
+		if (GODBY_UNLIKELY(value > M_max.load(std::memory_order_relaxed))) { M_max.store(value, std::memory_order_relaxed); }
+	}
+
+	// Owner only: racing with Record() would lose counts.
+	void Reset() noexcept
+	{
+		for (auto &bucket : M_counts) { bucket.store(0, std::memory_order_relaxed); }
+		M_sum.store(0, std::memory_order_relaxed);
+		M_min.store(std::numeric_limits<uint64_t>::max(), std::memory_order_relaxed);
+		M_max.store(0, std::memory_order_relaxed);
+	}
+
+	Snapshot_t Snapshot() const noexcept
+	{
+		Snapshot_t snapshot;
+		SnapshotInto(snapshot);
+		return snapshot;
+	}
+
+	// Merge the counts into an existing snapshot, without a temporary of a few KiB.
+	void SnapshotInto(Snapshot_t &snapshot) const noexcept
+	{
+		uint64_t count = 0;
+		for (unsigned i = 0; i < Layout::BUCKETS; ++i) {
+			uint64_t n = M_counts[i].load(std::memory_order_relaxed);
+			snapshot.M_counts[i] += n, count += n;
+		}
+		snapshot.M_count += count;
+		snapshot.M_sum += M_sum.load(std::memory_order_relaxed);
+		if (count) {
+			snapshot.M_min = std::min(snapshot.M_min, M_min.load(std::memory_order_relaxed));
+			snapshot.M_max = std::max(snapshot.M_max, M_max.load(std::memory_order_relaxed));
+		}
+	}
+
+  private:
+	std::array<std::atomic<uint64_t>, Layout::BUCKETS> M_counts{};
+	std::atomic<uint64_t> M_sum{0};
+	std::atomic<uint64_t> M_min{std::numeric_limits<uint64_t>::max()};
+	std::atomic<uint64_t> M_max{0};
+};
+
+/**
+ * @class: HistogramSet
+ *
+ * @brief: per-thread Histograms, merged on demand
+ *
+ * Acquire() links a new histogram into a lock-free list and hands it to the caller, which records
+ * into it for as long as it likes. Histograms live until the set is destroyed, so Snapshot() can
+ * walk the list without synchronizing with writers:
+ *
+ *     HistogramSet<> latencies;
+ *     // on each worker
+ *     auto &local = latencies.Acquire();
+ *     local.Record(end - start);
+ *     // anywhere
+ *     auto p99 = latencies.Snapshot().Percentile(0.99);
+ */
+template <unsigned Precision = 7>
+class HistogramSet {
+	struct Node {
+		Histogram<Precision> histogram;
+		Node *next = nullptr;
+	};
+
+  public:
+	using Histogram_t = Histogram<Precision>;
+	using Snapshot_t = HistogramSnapshot<Precision>;
+
+	HistogramSet() = default;
+	HistogramSet(const HistogramSet &) = delete;
+	HistogramSet &operator=(const HistogramSet &) = delete;
+
+	~HistogramSet()
+	{
+		for (Node *node = M_head.load(std::memory_order_acquire); node;) { delete std::exchange(node, node->next); }
+	}
+
+	Histogram_t &Acquire()
+	{
+		Node *node = new Node;
+		node->next = M_head.load(std::memory_order_relaxed);
+		while (!M_head.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed)) {}
+		return node->histogram;
+	}
+
+	Snapshot_t Snapshot() const noexcept
+	{
+		Snapshot_t snapshot;
+		for (Node *node = M_head.load(std::memory_order_acquire); node; node = node->next) { node->histogram.SnapshotInto(snapshot); }
+		return snapshot;
+	}
+
+  private:
+	std::atomic<Node *> M_head{nullptr};
+};
+} // namespace godby
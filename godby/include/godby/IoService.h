@@ -5,19 +5,29 @@
 #include <atomic>
 #include <concepts>
 #include <coroutine>
+#include <cstdint>
+#include <deque>
 #include <functional>
 #include <future>
 #include <iostream>
+#include <limits>
 #include <liburing.h>
 #include <liburing/io_uring.h>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <stop_token>
 #include <sys/timerfd.h>
 #include <thread>
 #include <type_traits>
 #include <variant>
 #include <vector>
+#include <godby/EventCount.h>
+#include <godby/SlabAllocator.h>
+#include <godby/Spinlock.h>
+#include <godby/StealingQueue.h>
+#include <godby/TimerWheel.h>
+#include <godby/UnboundedAtomicQueue.h>
 
 namespace godby::co
 {
@@ -175,193 +185,27 @@ class io_work_queue {
 	}
 };
 
+// Typed front of the SlabAllocator of T: uring_data are allocated by the submitting thread and
+// freed by whichever thread lets go of the operation last.
 template <typename T>
-class work_stealing_queue {
-	std::atomic<size_t> M_front;
-	std::atomic<size_t> M_back;
-	std::atomic<circular_array<T> *> M_data{nullptr};
-	std::atomic<circular_array<T> *> M_old{nullptr};
-
-  public:
-	explicit work_stealing_queue(size_t capacity)
-	{
-		M_front.store(0, std::memory_order_relaxed);
-		M_back.store(0, std::memory_order_relaxed);
-		M_data.store(new circular_array<T>(capacity), std::memory_order_relaxed);
-	}
-
-	~work_stealing_queue()
-	{
-		delete M_data.load(std::memory_order_relaxed);
-	}
-
-	bool empty() const noexcept
-	{
-		size_t back = M_back.load(std::memory_order_relaxed);
-		size_t front = M_front.load(std::memory_order_relaxed);
-		return back == front;
-	}
-
-	void enqueue(const T &item)
-	{
-		size_t back = M_back.load(std::memory_order_relaxed);
-		size_t front = M_front.load(std::memory_order_acquire);
-		circular_array<T> *data = M_data.load(std::memory_order_relaxed);
-
-		if (data->size() - 1 < static_cast<size_t>(back - front)) [[unlikely]] {
-			if (front - 1 != back) {
-				if (back < (front - 1)) {
-					size_t a = 0;
-					auto size = (back + ((a - 1) - front)) + 1;
-					if (data->size() - 1 < size) { data = resize(data, back, front); }
-				} else {
-					data = resize(data, back, front);
-				}
-			}
-		}
-
-		data->push(back, item);
-		M_back.store(back + 1, std::memory_order_release);
-	}
-
-	bool dequeue(T &item)
-	{
-		size_t back = M_back.load(std::memory_order_relaxed);
-		circular_array<T> *data = M_data.load(std::memory_order_relaxed);
-		size_t front = M_front.load(std::memory_order_seq_cst);
-
-		if (front == back || front == back + 1) { return false; }
-		M_back.store(--back, std::memory_order_seq_cst);
-
-		bool status = true;
-
-		item = data->pop(back);
-		if (front == back) {
-			M_back.store(back + 1, std::memory_order_seq_cst);
-			if (!M_front.compare_exchange_strong(front, front + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) { status = false; }
-		}
-
-		return status;
-	}
-
-	bool steal(T &item)
-	{
-		size_t front = M_front.load();
-		size_t back = M_back.load();
-
-		if (back == front || back + 1 == front) { return false; }
-
-		circular_array<T> *data = M_data.load(std::memory_order_consume);
-		item = data->pop(front);
-		return M_front.compare_exchange_strong(front, front + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
-	}
-
-  protected:
-	circular_array<T> *resize(circular_array<T> *data, size_t back, size_t front)
-	{
-		circular_array<T> *new_data = data->resize(back, front);
-		delete M_old.load(std::memory_order_relaxed);
-		M_old.store(data, std::memory_order_relaxed);
-		M_data.store(new_data, std::memory_order_relaxed);
-		return new_data;
-	}
-};
-
-template <unsigned int size>
-union chunk_item {
-	char M_data[size];
-	chunk_item *M_next = nullptr;
-};
-
-template <typename T, unsigned int block_size>
 class pool_allocator {
-	using chunk = chunk_item<sizeof(T)>;
-	struct block_ptr {
-		chunk *M_ptr = nullptr;
-		unsigned int M_tag = 0;
-	};
-	std::atomic<block_ptr> M_allocator_head;
-	std::vector<chunk *> M_allocated_blocks{nullptr};
-
-	std::atomic_bool M_block_allocating{false};
-
   public:
-	pool_allocator()
-	{
-		block_ptr ptr{nullptr, 0};
-		M_allocator_head.store(ptr);
-		allocate_block();
-	}
-	~pool_allocator()
-	{
-		for (auto &block : M_allocated_blocks) { delete[] block; }
-	}
-
-	void allocate_block()
-	{
-		if (M_block_allocating.exchange(true) == false) {
-			chunk *new_block = new chunk[block_size];
-			M_allocated_blocks.push_back(new_block);
-			for (unsigned int i = 0; i < block_size - 1; ++i) { new_block[i].M_next = &new_block[i + 1]; }
-			block_ptr new_head{new_block, 0};
-			block_ptr curr_head = M_allocator_head.load();
-			do {
-				new_block[block_size - 1].M_next = curr_head.M_ptr;
-				new_head.M_tag = curr_head.M_tag + 1;
-			} while (!M_allocator_head.compare_exchange_strong(curr_head, new_head));
-
-			M_block_allocating.store(false);
-		}
-	}
-
-	template <typename O = T>
-	O *allocate()
-	{
-		block_ptr head = M_allocator_head.load();
-		block_ptr new_head{nullptr, 0};
-		do {
-			while (head.M_ptr == nullptr) [[unlikely]] {
-				allocate_block();
-				head = M_allocator_head.load();
-			}
-			new_head.M_ptr = head.M_ptr->M_next;
-			new_head.M_tag = head.M_tag + 1;
-		} while (!M_allocator_head.compare_exchange_strong(head, new_head));
-
-		return new (head.M_ptr) O;
-	}
-
 	template <typename O = T, typename... Args>
 	O *allocate(Args &&...args)
 	{
-		block_ptr head = M_allocator_head.load();
-		block_ptr new_head{nullptr, 0};
-		do {
-			while (head.M_ptr == nullptr) [[unlikely]] {
-				allocate_block();
-				head = M_allocator_head.load();
-			}
-			new_head.M_ptr = head.M_ptr->M_next;
-			new_head.M_tag = head.M_tag + 1;
-		} while (!M_allocator_head.compare_exchange_strong(head, new_head));
-
-		return new (head.M_ptr) O(args...);
+		static_assert(sizeof(O) <= sizeof(T) && alignof(O) <= alignof(T), "Blocks are sized for T");
+		return new (godby::SlabAllocator<T>::Allocate()) O(std::forward<Args>(args)...);
 	}
 
 	template <typename O = T>
 	void deallocate(O *ptr)
 	{
 		ptr->~O();
-		block_ptr new_head{reinterpret_cast<chunk *>(ptr), 0};
-		block_ptr head = M_allocator_head.load();
-		do {
-			new_head.M_ptr->M_next = head.M_ptr;
-			new_head.M_tag = head.M_tag + 1;
-		} while (!M_allocator_head.compare_exchange_strong(head, new_head));
+		godby::SlabAllocator<T>::Deallocate(ptr);
 	}
 };
 
-using task_queue = work_stealing_queue<std::coroutine_handle<>>;
+using task_queue = godby::StealingQueue<std::coroutine_handle<>>;
 
 struct thread_status {
 	enum class STATUS { NEW, READY, RUNNING, SUSPENDED };
@@ -399,37 +243,67 @@ struct scheduler_task {
 	}
 };
 
+class io_context;
+
+// Rings of a scheduler created with them, one per worker thread. SINGLE_ISSUER|DEFER_TASKRUN by
+// default: only the worker ever enters its ring, and completions are only posted when it asks
+// for them (TASKRUN_FLAG is added, so that it knows when to ask). IORING_SETUP_SQPOLL (with
+// sq_thread_idle in milliseconds) trades a kernel thread polling each ring for submissions without
+// a syscall, it does not go with DEFER_TASKRUN.
+struct ring_options {
+	unsigned int entries = 256;
+	unsigned int flags = IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_DEFER_TASKRUN;
+	unsigned int sq_thread_idle = 0;
+};
+
 struct thread_context {
 	std::thread M_thread;
 	thread_status M_thread_status;
 	std::coroutine_handle<> M_waiting_channel;
-	task_queue *M_tasks;
+	task_queue M_tasks{64}; // Pushed and popped by the worker, stolen from by the others
+	std::coroutine_handle<> M_lifo; // The coroutine the worker woke last, runs next; worker only
+	unsigned int M_lifo_streak = 0; // Coroutines run from M_lifo in a row
+	uint64_t M_seed = 0; // Victim selection, xorshift
+	std::atomic<io_context *> M_ring{nullptr};
+	std::atomic_bool M_started{false};
 };
 
+// Workers pop their own StealingQueue, steal from the injection queue the other threads schedule
+// into, then from each other, like the workers of godby::StealingExecutor. What a worker wakes
+// goes to its LIFO slot and runs next, while its frame is still in cache, the coroutine it
+// displaces to the deque; after LIFO_BUDGET in a row the deque goes first, so two coroutines
+// waking each other cannot starve it. Idle workers park on an EventCount, scheduling takes no lock.
 class scheduler {
 	static thread_local unsigned int M_thread_id;
 	static thread_local unsigned int M_coro_scheduler_id;
-	static unsigned int M_coro_scheduler_count;
+	static std::atomic_uint M_coro_scheduler_count;
 	unsigned int M_id = 0;
 
-	std::atomic_uint M_total_threads{0};
+	static constexpr unsigned int MAX_WORKERS = 128;
+	static constexpr unsigned int LIFO_BUDGET = 3;
+
+	std::atomic_uint M_total_threads{0}; // Workers are M_thread_contexts[1, M_total_threads], null until published
 	std::atomic_uint M_total_suspended_threads{0};
 	std::atomic_uint M_total_ready_threads{0};
 	std::atomic_uint M_total_running_threads{0};
 
-	std::vector<thread_context *> M_thread_contexts;
+	std::vector<std::atomic<thread_context *>> M_thread_contexts;
 
-	std::mutex M_task_mutex;
+	godby::UnboundedAtomicQueue<void *> M_inject; // Addresses of coroutines scheduled from other threads
+	godby::EventCount M_idle;					   // Workers park here when there is no work
 
-	std::mutex M_spawn_thread_mutex;
-	std::mutex M_global_task_queue_mutex;
-	std::atomic_flag M_task_wait_flag = ATOMIC_FLAG_INIT;
+	std::atomic_bool M_stop_requested{false};
 
-	bool M_stop_requested = false;
+	std::optional<ring_options> M_ring_options;
+	std::atomic_uint M_next_ring{0};
 
   public:
 	scheduler();
-	scheduler(unsigned int threa);
+	explicit scheduler(unsigned int threads);
+	// One io_context per worker: coroutines submit to the ring of the thread they run on, and
+	// their completions are reaped there and queued locally, so they resume on that thread;
+	// idle workers sleep in their ring instead of on the task flag.
+	explicit scheduler(const ring_options &rings, unsigned int threads = std::thread::hardware_concurrency());
 	~scheduler();
 
 	void schedule(const std::coroutine_handle<> &handle) noexcept;
@@ -439,7 +313,11 @@ class scheduler {
 	void spawn_workers(const unsigned int &count);
 
   protected:
-	void init_thread();
+	thread_context *init_thread(unsigned int id);
+	thread_context *context(unsigned int id) const noexcept
+	{
+		return M_thread_contexts[id].load(std::memory_order_acquire);
+	}
 	void set_thread_suspended() noexcept;
 	void set_thread_ready() noexcept;
 	void set_thread_running() noexcept;
@@ -449,10 +327,13 @@ class scheduler {
 	std::coroutine_handle<> get_waiting_channel() noexcept;
 	bool peek_next_coroutine(std::coroutine_handle<> &handle) noexcept;
 	bool steal_task(std::coroutine_handle<> &handle) noexcept;
+
+	io_context *local_ring() const noexcept;
+	void wake_ring() noexcept;
 };
 
 struct uring_data {
-	using allocator = pool_allocator<uring_data, 128>;
+	using allocator = pool_allocator<uring_data>;
 
 	scheduler *M_scheduler = nullptr;
 	allocator *M_allocator = nullptr;
@@ -554,6 +435,207 @@ concept IO_URING_OP = requires(T a, io_uring *const uring, uring_data::allocator
 	{ a.get_future(alloc) } -> std::same_as<uring_awaiter>;
 };
 
+// Ring-mapped provided buffers (a buffer group registered with io_uring_setup_buf_ring): the
+// kernel picks a buffer when data arrives instead of every recv posting its own, and a buffer
+// goes back to the group with a store to the ring, no SQE. Created by io_service::create_buffer_ring(),
+// must not outlive it.
+class buffer_ring {
+	io_uring *M_uring;
+	io_uring_buf_ring *M_ring;
+	int M_bgid;
+	unsigned int M_entries;
+	unsigned int M_buffer_size;
+	std::unique_ptr<char[]> M_memory;
+	godby::Spinlock M_lock; // Buffers come back from any thread
+
+  public:
+	buffer_ring(io_uring *uring, io_uring_buf_ring *ring, int bgid, unsigned int entries, unsigned int buffer_size)
+		: M_uring{uring}, M_ring{ring}, M_bgid{bgid}, M_entries{entries}, M_buffer_size{buffer_size}, M_memory{new char[size_t(entries) * buffer_size]}
+	{
+		for (unsigned int bid = 0; bid < M_entries; ++bid) { io_uring_buf_ring_add(M_ring, buffer(bid), M_buffer_size, bid, io_uring_buf_ring_mask(M_entries), bid); }
+		io_uring_buf_ring_advance(M_ring, M_entries);
+	}
+
+	buffer_ring(const buffer_ring &) = delete;
+	buffer_ring &operator=(const buffer_ring &) = delete;
+
+	~buffer_ring()
+	{
+		io_uring_free_buf_ring(M_uring, M_ring, M_entries, M_bgid);
+	}
+
+	int group() const noexcept
+	{
+		return M_bgid;
+	}
+
+	unsigned int buffer_size() const noexcept
+	{
+		return M_buffer_size;
+	}
+
+	char *buffer(unsigned int bid) const noexcept
+	{
+		return M_memory.get() + size_t(bid) * M_buffer_size;
+	}
+
+	// The buffer a completion with IORING_CQE_F_BUFFER was given.
+	static unsigned int buffer_id(unsigned int cqe_flags) noexcept
+	{
+		return cqe_flags >> IORING_CQE_BUFFER_SHIFT;
+	}
+
+	void recycle(unsigned int bid) noexcept
+	{
+		std::lock_guard guard(M_lock);
+		io_uring_buf_ring_add(M_ring, buffer(bid), M_buffer_size, bid, io_uring_buf_ring_mask(M_entries), 0);
+		io_uring_buf_ring_advance(M_ring, 1);
+	}
+};
+
+// One completion of an operation, as resumed with.
+struct io_result {
+	int result;
+	unsigned int flags;
+
+	operator int() const noexcept
+	{
+		return result;
+	}
+};
+
+// State of a multishot operation, shared by the operation in flight, which queues its
+// completions, and the multishot_stream reading them; freed by whichever lets go last.
+struct multishot_data {
+	godby::Spinlock M_lock;
+	std::deque<io_result> M_results;
+	std::coroutine_handle<> M_handle;
+	scheduler *M_scheduler = nullptr;
+	buffer_ring *M_buffers = nullptr;
+	bool M_done = false;	  // The last completion came, without IORING_CQE_F_MORE
+	bool M_abandoned = false; // The stream is gone, completions only give their buffers back
+	std::atomic_int M_refs{2};
+
+	// The low bit of the user data tells completions of multishot_data from those of uring_data
+	void *user_data() noexcept
+	{
+		return reinterpret_cast<void *>(reinterpret_cast<uintptr_t>(this) | 1);
+	}
+
+	static multishot_data *from(void *user_data) noexcept
+	{
+		auto value = reinterpret_cast<uintptr_t>(user_data);
+		return (value & 1) ? reinterpret_cast<multishot_data *>(value & ~uintptr_t(1)) : nullptr;
+	}
+
+	// Runs on the completion thread
+	void push(int result, unsigned int flags)
+	{
+		std::coroutine_handle<> handle;
+		scheduler *schd = nullptr;
+		bool done = !(flags & IORING_CQE_F_MORE);
+		{
+			std::lock_guard guard(M_lock);
+			M_done = done;
+			if (M_abandoned) {
+				if (M_buffers && (flags & IORING_CQE_F_BUFFER)) { M_buffers->recycle(buffer_ring::buffer_id(flags)); }
+			} else {
+				M_results.push_back({result, flags});
+				handle = std::exchange(M_handle, nullptr);
+				schd = M_scheduler;
+			}
+		}
+		if (handle) { schd->schedule(handle); }
+		if (done) { release(); }
+	}
+
+	void release() noexcept
+	{
+		if (M_refs.fetch_sub(1, std::memory_order_acq_rel) == 1) { delete this; }
+	}
+};
+
+// Awaitable next completion of a multishot_stream, std::nullopt once the operation has ended.
+class multishot_next {
+	multishot_data *M_data;
+	scheduler *M_scheduler = nullptr;
+
+  public:
+	explicit multishot_next(multishot_data *data) : M_data{data} {}
+
+	auto operator co_await() const noexcept
+	{
+		struct {
+			multishot_data *M_data;
+			scheduler *M_scheduler;
+
+			bool await_ready() const noexcept
+			{
+				std::lock_guard guard(M_data->M_lock);
+				return !M_data->M_results.empty() || M_data->M_done;
+			}
+
+			auto await_suspend(const std::coroutine_handle<> &handle) noexcept -> std::coroutine_handle<>
+			{
+				auto schd = M_scheduler;
+				{
+					std::lock_guard guard(M_data->M_lock);
+					if (!M_data->M_results.empty() || M_data->M_done) { return handle; }
+					M_data->M_handle = handle;
+					M_data->M_scheduler = schd;
+				}
+				return schd->get_next_coroutine();
+			}
+
+			auto await_resume() const noexcept -> std::optional<io_result>
+			{
+				std::lock_guard guard(M_data->M_lock);
+				if (M_data->M_results.empty()) { return std::nullopt; }
+				io_result result = M_data->M_results.front();
+				M_data->M_results.pop_front();
+				return result;
+			}
+		} awaiter{M_data, M_scheduler};
+
+		return awaiter;
+	}
+
+	void via(scheduler *s)
+	{
+		M_scheduler = s;
+	}
+};
+
+class io_service;
+
+// Completions of a multishot accept or recv, one SQE for all of them:
+//
+//     auto connections = io.accept_multishot(listener);
+//     while (auto client = co_await connections.next()) { serve(client->result); }
+//
+// Destroying the stream before the operation ended cancels it.
+class multishot_stream {
+	io_service *M_io;
+	multishot_data *M_data;
+
+  public:
+	multishot_stream(io_service *io, multishot_data *data) : M_io{io}, M_data{data} {}
+
+	multishot_stream(const multishot_stream &) = delete;
+	multishot_stream &operator=(const multishot_stream &) = delete;
+
+	multishot_stream(multishot_stream &&other) noexcept : M_io{other.M_io}, M_data{std::exchange(other.M_data, nullptr)} {}
+
+	inline ~multishot_stream();
+
+	auto next() -> multishot_next
+	{
+		return multishot_next(M_data);
+	}
+
+	inline void cancel();
+};
+
 struct io_uring_future {
 	uring_data *M_data;
 
@@ -966,6 +1048,76 @@ struct io_uring_op_send_t : public io_uring_future {
 	}
 };
 
+struct io_uring_op_send_zc_t : public io_uring_future {
+	int M_fd;
+	const void *M_buffer;
+	size_t M_length;
+	int M_flags;
+	unsigned char M_sqe_flags;
+
+	io_uring_op_send_zc_t() = default;
+
+	io_uring_op_send_zc_t(const int &fd, const void *const &buffer, const size_t &length, const int &flags, unsigned char &sqe_flags)
+		: M_fd{fd}, M_buffer{buffer}, M_length{length}, M_flags{flags}, M_sqe_flags{sqe_flags}
+	{
+	}
+
+	bool run(io_uring *const uring)
+	{
+		io_uring_sqe *sqe;
+		if ((sqe = io_uring_get_sqe(uring)) == nullptr) { return false; }
+		io_uring_prep_send_zc(sqe, M_fd, M_buffer, M_length, M_flags, 0);
+		sqe->flags |= M_sqe_flags;
+		io_uring_sqe_set_data(sqe, M_data);
+		return true;
+	}
+};
+
+struct io_uring_op_accept_multishot_t : public io_uring_future {
+	int M_fd;
+	multishot_data *M_stream;
+	unsigned char M_sqe_flags;
+
+	io_uring_op_accept_multishot_t() = default;
+
+	io_uring_op_accept_multishot_t(const int &fd, multishot_data *stream, unsigned char &sqe_flags) : M_fd{fd}, M_stream{stream}, M_sqe_flags{sqe_flags} {}
+
+	bool run(io_uring *const uring)
+	{
+		io_uring_sqe *sqe;
+		if ((sqe = io_uring_get_sqe(uring)) == nullptr) { return false; }
+		io_uring_prep_multishot_accept(sqe, M_fd, nullptr, nullptr, 0);
+		sqe->flags |= M_sqe_flags;
+		io_uring_sqe_set_data(sqe, M_stream->user_data());
+		return true;
+	}
+};
+
+struct io_uring_op_recv_multishot_t : public io_uring_future {
+	int M_fd;
+	multishot_data *M_stream;
+	int M_flags;
+	unsigned char M_sqe_flags;
+
+	io_uring_op_recv_multishot_t() = default;
+
+	io_uring_op_recv_multishot_t(const int &fd, multishot_data *stream, const int &flags, unsigned char &sqe_flags)
+		: M_fd{fd}, M_stream{stream}, M_flags{flags}, M_sqe_flags{sqe_flags}
+	{
+	}
+
+	bool run(io_uring *const uring)
+	{
+		io_uring_sqe *sqe;
+		if ((sqe = io_uring_get_sqe(uring)) == nullptr) { return false; }
+		io_uring_prep_recv_multishot(sqe, M_fd, nullptr, 0, M_flags);
+		io_uring_sqe_set_flags(sqe, M_sqe_flags | IOSQE_BUFFER_SELECT);
+		sqe->buf_group = M_stream->M_buffers->group();
+		io_uring_sqe_set_data(sqe, M_stream->user_data());
+		return true;
+	}
+};
+
 struct io_uring_op_close_t : public io_uring_future {
 	int M_fd;
 	unsigned char M_sqe_flags;
@@ -1040,7 +1192,8 @@ struct io_uring_op_provide_buffer_t : public io_uring_future {
 using io_uring_op = std::variant<io_uring_op_timeout_t, io_uring_op_openat_t, io_uring_op_read_t, io_uring_op_close_t, io_uring_op_cancel_t, io_uring_op_statx_t,
 								 io_uring_op_write_t, io_uring_op_recv_t, io_uring_op_accept_t, io_uring_op_read_provide_buffer_t, io_uring_op_write_fixed_t, io_uring_op_writev_t,
 								 io_uring_op_nop_t, io_uring_op_send_t, io_uring_op_recv_provide_buffer_t, io_uring_op_poll_add_t, io_uring_op_provide_buffer_t,
-								 io_uring_op_read_fixed_t, io_uring_op_readv_t, io_uring_op_link_timeout_t>;
+								 io_uring_op_read_fixed_t, io_uring_op_readv_t, io_uring_op_link_timeout_t, io_uring_op_send_zc_t, io_uring_op_accept_multishot_t,
+								 io_uring_op_recv_multishot_t>;
 
 template <typename IO_SERVICE>
 class io_operation {
@@ -1146,6 +1299,13 @@ class io_operation {
 		return M_io->submit_io(io_uring_op_send_t(fd, buffer, length, flags, sqe_flags));
 	}
 
+	// Zero-copy send, resumes once the kernel is done with buffer (the notification came), with
+	// the result of the send.
+	auto send_zc(const int &fd, const void *const &buffer, const size_t &length, const int &flags, unsigned char sqe_flags = 0) -> uring_awaiter
+	{
+		return M_io->submit_io(io_uring_op_send_zc_t(fd, buffer, length, flags, sqe_flags));
+	}
+
 	auto close(const int &fd, unsigned char sqe_flags = 0) -> uring_awaiter
 	{
 		return M_io->submit_io(io_uring_op_close_t(fd, sqe_flags));
@@ -1254,6 +1414,57 @@ class io_op_pipeline {
 	}
 };
 
+// The timer event that resumes the awaiting coroutine on its scheduler once the wheel of an
+// io_service reaches its tick, lives in the coroutine frame while it waits.
+class timer_wait : public TimerEvent {
+	io_service *M_io;
+	TickType M_tick;
+	scheduler *M_scheduler;
+	std::coroutine_handle<> M_handle;
+	std::atomic_bool M_handle_ctl{false};
+
+  public:
+	timer_wait(io_service *io, TickType tick, scheduler *s) : M_io{io}, M_tick{tick}, M_scheduler{s} {}
+
+	timer_wait(const timer_wait &) = delete;
+	timer_wait &operator=(const timer_wait &) = delete;
+
+	inline bool await_ready() const noexcept;
+
+	inline auto await_suspend(const std::coroutine_handle<> &handle) noexcept -> std::coroutine_handle<>;
+
+	constexpr void await_resume() const noexcept {}
+
+  protected:
+	// Runs on the completion thread of the io_service
+	void execute() override
+	{
+		auto handle = M_handle;
+		auto schd = M_scheduler;
+		if (M_handle_ctl.exchange(true, std::memory_order_acq_rel)) { schd->schedule(handle); }
+	}
+};
+
+// Returned by io_service::sleep_for() and sleep_until().
+class timer_awaiter {
+	io_service *M_io;
+	TickType M_tick;
+	scheduler *M_scheduler = nullptr;
+
+  public:
+	timer_awaiter(io_service *io, TickType tick) : M_io{io}, M_tick{tick} {}
+
+	timer_wait operator co_await() const noexcept
+	{
+		return timer_wait(M_io, M_tick, M_scheduler);
+	}
+
+	void via(scheduler *s)
+	{
+		M_scheduler = s;
+	}
+};
+
 class io_service : public io_operation<io_service> {
 	static thread_local unsigned int M_thread_id;
 	static thread_local uring_data::allocator *M_uio_data_allocator;
@@ -1275,7 +1486,23 @@ class io_service : public io_operation<io_service> {
 
 	std::atomic_bool M_stop_requested{false};
 
+	// One timer wheel per io_service, owned by the completion thread, which keeps a single
+	// IORING_OP_TIMEOUT armed for the next event instead of one timerfd per sleeping coroutine.
+	struct armed_timeout {
+		__kernel_timespec M_time;
+		TickType M_deadline;
+		std::optional<uring_awaiter> M_wait;
+	};
+
+	TimerShard M_timers;
+	std::chrono::steady_clock::time_point M_timer_epoch;
+	std::atomic_bool M_timers_bound{false};
+	std::atomic<TickType> M_timer_armed_at{std::numeric_limits<TickType>::max()}; // Earliest deadline with a timeout in flight
+	std::vector<std::unique_ptr<armed_timeout>> M_armed_timeouts;
+
   public:
+	using timer_tick = std::chrono::milliseconds; // Resolution of the timer wheel
+
 	io_service(const u_int &entries, const u_int &flags);
 	io_service(const u_int &entries, io_uring_params &params);
 
@@ -1287,6 +1514,33 @@ class io_service : public io_operation<io_service> {
 		return io_uring_register_buffers(&M_uring, io_vec, n) == 0 ? true : false;
 	}
 
+	// Registered files are named by their index, with IOSQE_FIXED_FILE in sqe_flags, which saves
+	// the file table lookup and reference count of every operation. -1 leaves a slot empty.
+	bool register_files(const int *fds, unsigned int count)
+	{
+		return io_uring_register_files(&M_uring, fds, count) == 0;
+	}
+
+	bool update_files(unsigned int offset, const int *fds, unsigned int count)
+	{
+		return io_uring_register_files_update(&M_uring, offset, fds, count) >= 0;
+	}
+
+	bool unregister_files()
+	{
+		return io_uring_unregister_files(&M_uring) == 0;
+	}
+
+	// entries buffers of buffer_size bytes as group bgid, entries must be a power of two. Null on failure.
+	auto create_buffer_ring(int bgid, unsigned int entries, unsigned int buffer_size) -> std::unique_ptr<buffer_ring>;
+
+	// Every connection accepted on fd, until cancelled or failed.
+	auto accept_multishot(const int &fd, unsigned char sqe_flags = 0) -> multishot_stream;
+
+	// Every chunk received on fd, each in a buffer of buffers that must be recycled, until the
+	// peer closes (a result of 0), cancelled, failed or out of buffers.
+	auto recv_multishot(const int &fd, buffer_ring &buffers, const int &flags = 0, unsigned char sqe_flags = 0) -> multishot_stream;
+
 	auto batch()
 	{
 		return io_batch<io_service>(this);
@@ -1326,11 +1580,36 @@ class io_service : public io_operation<io_service> {
 		return flag >> 16;
 	}
 
+	// Ticks of timer_tick since the io_service was created.
+	TickType timer_now() const noexcept
+	{
+		return std::chrono::duration_cast<timer_tick>(std::chrono::steady_clock::now() - M_timer_epoch).count();
+	}
+
+	// Run event on the completion thread once timer_now() reaches tick, from any thread.
+	void schedule_timer_at(TimerEvent *event, TickType tick);
+
+	// Awaitable, resumes the coroutine after delay (rounded up to timer_tick).
+	template <typename Rep, typename Period>
+	auto sleep_for(std::chrono::duration<Rep, Period> delay) -> timer_awaiter
+	{
+		return timer_awaiter(this, timer_now() + std::chrono::ceil<timer_tick>(delay).count());
+	}
+
+	// Awaitable, resumes the coroutine once deadline has passed.
+	auto sleep_until(std::chrono::steady_clock::time_point deadline) -> timer_awaiter
+	{
+		return timer_awaiter(this, std::chrono::ceil<timer_tick>(deadline - M_timer_epoch).count());
+	}
+
   protected:
 	void submit();
 
 	void loop() noexcept;
 
+	// Advance the wheel to timer_now() and arm a timeout for its next event if none is in flight.
+	void run_timers();
+
 	bool io_queue_empty() const noexcept;
 
 	void setup_thread_context();
@@ -1338,6 +1617,144 @@ class io_service : public io_operation<io_service> {
 	void handle_completion(io_uring_cqe *cqe);
 };
 
+// One io_uring owned by one thread, the io of a scheduler created with ring_options (see
+// io_context::current()). Operations are prepared straight into the SQ of the calling thread's
+// ring, no pipeline and no lock, and go to the kernel together when the thread next looks for
+// work; completions are reaped by the same thread, so nothing crosses threads on the I/O path.
+// Other threads reach a ring with post(), an IORING_OP_MSG_RING from their own ring, or wake().
+class io_context : public io_operation<io_context> {
+	static thread_local io_context *M_current;
+	static constexpr uintptr_t M_wake_tag = 2; // user_data of the eventfd read, or'ed into handed off handles
+
+	io_uring M_uring;
+	scheduler *M_scheduler;
+	uring_data::allocator M_allocator;
+	int M_wake_fd = -1;
+	uint64_t M_wake_value = 0;
+	godby::Spinlock M_inbox_lock;
+	std::vector<std::coroutine_handle<>> M_inbox; // Posted by threads without a ring
+
+  public:
+	// Creates the ring of the calling thread, which owns it from then on.
+	io_context(const ring_options &options, scheduler *owner);
+
+	io_context(const io_context &) = delete;
+	io_context &operator=(const io_context &) = delete;
+
+	~io_context();
+
+	// The ring of the calling thread, null outside the workers of a scheduler with rings. A
+	// coroutine asks again after every suspension point, it may have been stolen meanwhile.
+	static io_context *current() noexcept
+	{
+		return M_current;
+	}
+
+	int fd() const noexcept
+	{
+		return M_uring.ring_fd;
+	}
+
+	uring_data::allocator *get_awaiter_allocator()
+	{
+		return &M_allocator;
+	}
+
+	// Must run on the owning thread, submitted with the next poll() or wait().
+	template <IO_URING_OP OP>
+	auto submit_io(OP &&operation) -> uring_awaiter
+	{
+		GODBY_ASSERT(M_current == this);
+		auto future = operation.get_future(&M_allocator);
+		while (!operation.run(&M_uring)) { io_uring_submit(&M_uring); } // SQ full
+		return future;
+	}
+
+	// Resume handle on the thread owning this ring, from any thread.
+	void post(std::coroutine_handle<> handle);
+
+	// Awaitable moving the coroutine over to the thread owning this ring.
+	auto resume_here() noexcept
+	{
+		struct {
+			io_context *M_ring;
+
+			bool await_ready() const noexcept
+			{
+				return M_current == M_ring;
+			}
+
+			auto await_suspend(const std::coroutine_handle<> &handle) noexcept -> std::coroutine_handle<>
+			{
+				auto ring = M_ring; // The target may resume, and free, us before post() returns
+				auto schd = ring->M_scheduler;
+				ring->post(handle);
+				return schd->get_next_coroutine();
+			}
+
+			constexpr void await_resume() const noexcept {}
+		} awaiter{this};
+
+		return awaiter;
+	}
+
+	// Get the owning thread out of wait(), from any thread.
+	void wake() noexcept;
+
+	// Owning thread: submit what is pending and handle what completed, without blocking. With
+	// DEFER_TASKRUN completions only reach the CQ when the owner enters the ring: poll() enters
+	// when the kernel flags some as pending (IORING_SQ_TASKRUN), or every time without TASKRUN_FLAG.
+	unsigned int poll();
+
+	// Owning thread: submit what is pending and block until something completes or wake().
+	unsigned int wait();
+
+  private:
+	unsigned int reap();
+
+	void arm_wake();
+};
+
+multishot_stream::~multishot_stream()
+{
+	if (M_data == nullptr) { return; }
+
+	bool done = false;
+	{
+		std::lock_guard guard(M_data->M_lock);
+		done = M_data->M_done;
+		M_data->M_abandoned = true;
+		if (M_data->M_buffers) {
+			for (auto &pending : M_data->M_results) {
+				if (pending.flags & IORING_CQE_F_BUFFER) { M_data->M_buffers->recycle(buffer_ring::buffer_id(pending.flags)); }
+			}
+		}
+		M_data->M_results.clear();
+	}
+	if (!done) { cancel(); }
+	M_data->release();
+}
+
+void multishot_stream::cancel()
+{
+	unsigned char sqe_flags = 0;
+	M_io->submit_io(io_uring_op_cancel_t(M_data->user_data(), 0, sqe_flags));
+}
+
+bool timer_wait::await_ready() const noexcept
+{
+	return M_tick <= M_io->timer_now();
+}
+
+auto timer_wait::await_suspend(const std::coroutine_handle<> &handle) noexcept -> std::coroutine_handle<>
+{
+	M_handle = handle;
+	auto schd = M_scheduler;
+	M_io->schedule_timer_at(this, M_tick);
+	if (M_handle_ctl.exchange(true, std::memory_order_acq_rel)) { return handle; }
+	return schd->get_next_coroutine();
+}
+
 template <typename T>
 concept Resume_VIA = requires(T a, scheduler *s) {
 	{ a.via(s) };
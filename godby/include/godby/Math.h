@@ -1,5 +1,10 @@
 #pragma once
 
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
 #include <numeric>
 #include <type_traits>
 
@@ -38,7 +43,162 @@ inline constexpr T NextPowerOfTwo(T x)
 #endif
 }
 
+namespace details
+{
+__extension__ typedef unsigned __int128 uint128_t;
+} // namespace details
+
+/**
+ * @class: FastMod
+ *
+ * @brief: x % d for a divisor fixed at runtime, with multiplies instead of a division
+ *
+ * Lemire's fastmod: M = ceil(2^128 / d), then x % d is the high 64 bits of d times the low 128
+ * bits of M * x. Exact for every 64-bit x and d, so it can replace % where the bucket a hash maps
+ * to must not change.
+ */
+class FastMod {
+  public:
+	constexpr explicit FastMod(uint64_t divisor) noexcept : M_multiplier(~details::uint128_t(0) / divisor + 1), M_divisor(divisor) {}
+
+	constexpr uint64_t divisor() const noexcept
+	{
+		return M_divisor;
+	}
+
+	constexpr uint64_t mod(uint64_t x) const noexcept
+	{
+		details::uint128_t fraction = M_multiplier * x; // Wraps around, only the fractional part of x / d is kept
+		details::uint128_t low = static_cast<uint64_t>(fraction) * static_cast<details::uint128_t>(M_divisor);
+		details::uint128_t high = static_cast<uint64_t>(fraction >> 64) * static_cast<details::uint128_t>(M_divisor);
+		return static_cast<uint64_t>((high + (low >> 64)) >> 64);
+	}
+
+  private:
+	details::uint128_t M_multiplier;
+	uint64_t M_divisor;
+};
+
 //? Prime
+namespace details
+{
+
+template <unsigned N>
+constexpr unsigned CountOddPrimes()
+{
+	std::array<bool, N> composite{};
+	unsigned count = 0;
+	for (unsigned i = 3; i < N; i += 2) {
+		if (composite[i]) { continue; }
+		++count;
+		for (unsigned j = i * i; j < N; j += 2 * i) { composite[j] = true; }
+	}
+	return count;
+}
+
+// Odd primes below N, by a sieve run at compile time.
+template <unsigned N>
+constexpr auto SievePrimes()
+{
+	std::array<uint16_t, CountOddPrimes<N>()> primes{};
+	std::array<bool, N> composite{};
+	unsigned count = 0;
+	for (unsigned i = 3; i < N; i += 2) {
+		if (composite[i]) { continue; }
+		primes[count++] = static_cast<uint16_t>(i);
+		for (unsigned j = i * i; j < N; j += 2 * i) { composite[j] = true; }
+	}
+	return primes;
+}
+
+inline constexpr auto kSmallPrimes = SievePrimes<256>();
+
+// Arithmetic modulo an odd n in Montgomery form, x is stored as x * 2^64 mod n.
+class Montgomery {
+  public:
+	constexpr explicit Montgomery(uint64_t n) : M_n(n), M_inverse(Inverse(n)), M_r2(static_cast<uint64_t>((static_cast<uint128_t>(-n % n) << 64) % n)) {}
+
+	constexpr uint64_t to(uint64_t x) const
+	{
+		return multiply(x, M_r2);
+	}
+
+	constexpr uint64_t one() const
+	{
+		return -M_n % M_n;
+	}
+
+	constexpr uint64_t multiply(uint64_t a, uint64_t b) const
+	{
+		uint128_t t = static_cast<uint128_t>(a) * b;
+		uint64_t m = static_cast<uint64_t>(t) * M_inverse;
+		uint64_t high = static_cast<uint64_t>(t >> 64), mn = static_cast<uint64_t>((static_cast<uint128_t>(m) * M_n) >> 64);
+		return high >= mn ? high - mn : high - mn + M_n; // The low halves cancel out
+	}
+
+	constexpr uint64_t power(uint64_t base, uint64_t exponent) const
+	{
+		uint64_t result = one();
+		for (; exponent; exponent >>= 1) {
+			if (exponent & 1) { result = multiply(result, base); }
+			base = multiply(base, base);
+		}
+		return result;
+	}
+
+  private:
+	static constexpr uint64_t Inverse(uint64_t n)
+	{
+		uint64_t x = n; // Correct to 3 bits for odd n, each Newton step doubles that
+		for (int i = 0; i < 5; ++i) { x *= 2 - n * x; }
+		return x;
+	}
+
+	uint64_t M_n, M_inverse, M_r2;
+};
+} // namespace details
+
+// Deterministic for every 64-bit n: trial division by the primes below 256, then Miller-Rabin
+// with the seven bases of Jim Sinclair, which no composite below 2^64 passes.
+constexpr bool ConstexprIsPrime(uint64_t n)
+{
+	if (n < 2) { return false; }
+	if (!(n & 1)) { return n == 2; }
+	for (uint64_t p : details::kSmallPrimes) {
+		if (n % p == 0) { return n == p; }
+	}
+	if (n < 256 * 256) { return true; }
+
+	uint64_t d = n - 1;
+	unsigned s = 0;
+	while (!(d & 1)) {
+		d >>= 1;
+		++s;
+	}
+
+	const details::Montgomery mont(n);
+	const uint64_t one = mont.one(), minus_one = n - one;
+	for (uint64_t base : {2ull, 325ull, 9375ull, 28178ull, 450775ull, 9780504ull, 1795265022ull}) {
+		base %= n;
+		if (base == 0) { continue; }
+
+		uint64_t x = mont.power(mont.to(base), d);
+		if (x == one || x == minus_one) { continue; }
+		for (unsigned i = 1; i < s && x != minus_one; ++i) { x = mont.multiply(x, x); }
+		if (x != minus_one) { return false; }
+	}
+	return true;
+}
+
+// The smallest prime not below n, n must not exceed the largest 64-bit prime.
+constexpr uint64_t ConstexprNextPrime(uint64_t n)
+{
+	if (n <= 2) { return 2; }
+	for (n |= 1;; n += 2) {
+		if (ConstexprIsPrime(n)) { return n; }
+	}
+}
+
 bool IsPrime(size_t n);
 size_t NextPrime(size_t n);
 } // namespace godby
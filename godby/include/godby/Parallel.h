@@ -0,0 +1,159 @@
+#pragma once
+
+#include <algorithm>				// std::sort, std::partition
+#include <atomic>					// std::atomic
+#include <cstddef>					// std::size_t
+#include <functional>				// std::less
+#include <iterator>					// std::random_access_iterator
+#include <optional>					// std::optional
+#include <thread>					// std::this_thread
+#include <type_traits>				// std::type_identity_t
+#include <utility>					// std::forward, std::move
+#include <godby/Concept.h>			// godby::Integral
+#include <godby/Portability.h>		// spin_loop_pause
+#include <godby/StealingExecutor.h>	// godby::TaskExecutor
+
+static_assert(__cplusplus >= 202002L, "Requires C++20 or higher");
+
+//! Parallel
+namespace godby
+{
+/**
+ * Fork-join algorithms on a TaskExecutor (or any executor with Submit(task) and Help()).
+ *
+ * Ranges are split in halves recursively: the calling thread keeps the left half and submits the
+ * right one, until pieces are at most `grain` long. Joining never blocks: the joining thread runs
+ * queued tasks (its own first when it is a worker) until everything it forked is done, so the
+ * algorithms nest, and idle workers balance irregular pieces by stealing.
+ *
+ *     godby::TaskExecutor<> executor;
+ *     godby::parallel::parallel_for(executor, 0, n, [&](int i) { out[i] = f(in[i]); }, 1024);
+ *     auto sum = godby::parallel::parallel_reduce(executor, 0, n, 0.0, [&](int i) { return in[i]; }, std::plus<>());
+ *
+ * Tasks must not throw.
+ */
+namespace parallel
+{
+namespace details
+{
+class ForkJoin {
+  public:
+	ForkJoin() noexcept = default;
+	ForkJoin(const ForkJoin &) = delete;
+	ForkJoin &operator=(const ForkJoin &) = delete;
+
+	// Tasks forked by forked tasks may join the same ForkJoin, they are added before their parent is done.
+	template <typename Executor, typename F>
+	void fork(Executor &executor, F &&f)
+	{
+		M_pending.fetch_add(1, std::memory_order_relaxed);
+		executor.Submit([this, f = std::forward<F>(f)]() mutable {
+			f();
+			M_pending.fetch_sub(1, std::memory_order_release);
+		});
+	}
+
+	template <typename Executor>
+	void join(Executor &executor)
+	{
+		for (size_t spins = 0; M_pending.load(std::memory_order_acquire) != 0;) {
+			if (executor.Help()) {
+				spins = 0;
+			} else if (++spins < 64) {
+				spin_loop_pause();
+			} else {
+				std::this_thread::yield();
+			}
+		}
+	}
+
+  private:
+	std::atomic<size_t> M_pending{0};
+};
+
+template <typename Executor, typename Index, typename Body>
+void SplitFor(Executor &executor, ForkJoin &join, Index begin, Index end, Index grain, Body &body)
+{
+	while (end - begin > grain) {
+		Index mid = begin + (end - begin) / 2;
+		join.fork(executor, [&executor, &join, mid, end, grain, &body]() { SplitFor(executor, join, mid, end, grain, body); });
+		end = mid;
+	}
+	for (Index i = begin; i < end; ++i) { body(i); }
+}
+
+template <typename Executor, typename Index, typename T, typename Map, typename Reduce>
+T SplitReduce(Executor &executor, Index begin, Index end, Index grain, T const &identity, Map &map, Reduce &reduce)
+{
+	if (end - begin <= grain) {
+		T result = identity;
+		for (Index i = begin; i < end; ++i) { result = reduce(std::move(result), map(i)); }
+		return result;
+	}
+
+	Index mid = begin + (end - begin) / 2;
+	std::optional<T> right;
+	ForkJoin join;
+	join.fork(executor, [&]() { right.emplace(SplitReduce(executor, mid, end, grain, identity, map, reduce)); });
+	T left = SplitReduce(executor, begin, mid, grain, identity, map, reduce);
+	join.join(executor);
+	return reduce(std::move(left), std::move(*right));
+}
+
+template <typename Executor, typename Iterator, typename Compare>
+void SplitSort(Executor &executor, ForkJoin &join, Iterator first, Iterator last, std::size_t grain, Compare &comp)
+{
+	while (static_cast<std::size_t>(last - first) > grain) {
+		// Median of three, then a three-way partition so runs of equal keys do not degrade the split.
+		Iterator a = first, b = first + (last - first) / 2, c = last - 1;
+		if (comp(*b, *a)) { std::swap(a, b); }
+		if (comp(*c, *b)) { b = comp(*c, *a) ? a : c; }
+		auto pivot = *b;
+
+		Iterator lower = std::partition(first, last, [&](auto const &x) { return comp(x, pivot); });
+		Iterator upper = std::partition(lower, last, [&](auto const &x) { return !comp(pivot, x); });
+		join.fork(executor, [&executor, &join, upper, last, grain, &comp]() { SplitSort(executor, join, upper, last, grain, comp); });
+		last = lower;
+	}
+	std::sort(first, last, comp);
+}
+} // namespace details
+
+// Calls body(i) for every i in [begin, end).
+template <typename Executor, Integral Index, typename Body>
+void parallel_for(Executor &executor, Index begin, std::type_identity_t<Index> end, Body &&body, std::type_identity_t<Index> grain = 1)
+{
+	if (end <= begin) { return; }
+	details::ForkJoin join;
+	details::SplitFor(executor, join, begin, end, grain ? grain : Index(1), body);
+	join.join(executor);
+}
+
+// reduce(...reduce(reduce(identity, map(begin)), map(begin + 1))..., map(end - 1)), with reduce associative.
+template <typename Executor, Integral Index, typename T, typename Map, typename Reduce>
+T parallel_reduce(Executor &executor, Index begin, std::type_identity_t<Index> end, T identity, Map &&map, Reduce &&reduce, std::type_identity_t<Index> grain = 1)
+{
+	if (end <= begin) { return identity; }
+	return details::SplitReduce(executor, begin, end, grain ? grain : Index(1), identity, map, reduce);
+}
+
+// Not stable, the value type must be copyable (pivots are copies).
+template <typename Executor, std::random_access_iterator Iterator, typename Compare = std::less<>>
+void parallel_sort(Executor &executor, Iterator first, Iterator last, Compare comp = {}, std::size_t grain = 2048)
+{
+	details::ForkJoin join;
+	details::SplitSort(executor, join, first, last, grain ? grain : 1, comp);
+	join.join(executor);
+}
+
+// Runs all functions, the first one on the calling thread.
+template <typename Executor, typename F, typename... Fs>
+void parallel_invoke(Executor &executor, F &&f, Fs &&...fs)
+{
+	details::ForkJoin join;
+	(join.fork(executor, std::forward<Fs>(fs)), ...);
+	std::forward<F>(f)();
+	join.join(executor);
+}
+} // namespace parallel
+} // namespace godby
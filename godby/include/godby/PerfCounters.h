@@ -0,0 +1,125 @@
+#pragma once
+
+#include <cstdint>			   // uint64_t
+#include <initializer_list>	   // std::initializer_list
+#include <utility>			   // std::exchange, std::swap
+#include <godby/Expected.h>	   // godby::Expected
+#include <godby/Portability.h> // Portability
+
+static_assert(__cplusplus >= 202002L, "Requires C++20 or higher");
+
+//! PerfCounters
+namespace godby
+{
+enum class PerfEvent : uint8_t {
+	Cycles,
+	Instructions,
+	L1dMisses, // L1 data cache read misses
+	LlcMisses, // Last level cache read misses
+	BranchMisses,
+};
+
+const char *PerfEventName(PerfEvent event) noexcept;
+
+// Counts of the events a PerfCounters opened, scaled up if the kernel multiplexed the group.
+struct PerfReading {
+	static constexpr unsigned MAX_EVENTS = 8;
+
+	unsigned size = 0;
+	PerfEvent events[MAX_EVENTS];
+	uint64_t values[MAX_EVENTS] = {};
+	bool multiplexed = false; // The group was not on the PMU all the time, values are estimates
+
+	// Accumulate the reading of another thread with the same events.
+	PerfReading &operator+=(const PerfReading &b) noexcept
+	{
+		if (size == 0) { return *this = b; }
+		for (unsigned i = 0; i < size && i < b.size; ++i) { values[i] += b.values[i]; }
+		multiplexed |= b.multiplexed;
+		return *this;
+	}
+};
+
+/**
+ * @class: PerfCounters
+ *
+ * @brief: a group of hardware counters of the calling thread, from perf_event_open()
+ *
+ * The events are opened as one group so they are scheduled on the PMU together and their ratios
+ * are meaningful. Events the CPU or the hypervisor does not have are left out; Open() fails only
+ * if none is available (no PMU, perf_event_paranoid > 2, seccomp) and callers are expected to go
+ * on without counters. Only user space is counted, which perf_event_paranoid <= 2 allows.
+ *
+ * Counters follow the thread that opened them. Start() and Stop() are one ioctl each, Read() one
+ * read; nothing is done between them, so code measured through a PerfScope on a null PerfCounters
+ * pays a branch:
+ *
+ *     auto counters = PerfCounters::Open();
+ *     {
+ *         PerfScope scope(counters ? &*counters : nullptr);
+ *         ... // work
+ *     }
+ *     PerfReading reading = counters->Read();
+ */
+class PerfCounters {
+  public:
+	// Failures are errno values.
+	static Expected<PerfCounters, int> Open(std::initializer_list<PerfEvent> events = {PerfEvent::Cycles, PerfEvent::Instructions, PerfEvent::L1dMisses, PerfEvent::LlcMisses, PerfEvent::BranchMisses});
+
+	PerfCounters(PerfCounters &&b) noexcept : M_reading(b.M_reading)
+	{
+		for (unsigned i = 0; i < PerfReading::MAX_EVENTS; ++i) { M_fds[i] = std::exchange(b.M_fds[i], -1); }
+	}
+
+	PerfCounters &operator=(PerfCounters &&b) noexcept
+	{
+		std::swap(M_reading, b.M_reading);
+		std::swap(M_fds, b.M_fds);
+		return *this;
+	}
+
+	~PerfCounters();
+
+	unsigned size() const noexcept
+	{
+		return M_reading.size;
+	}
+
+	// Reset the counts to zero and start counting.
+	void Start() noexcept;
+
+	void Stop() noexcept;
+
+	// The counts since the last Start(), whether stopped or still counting.
+	PerfReading Read() const noexcept;
+
+  private:
+	PerfCounters() noexcept
+	{
+		for (int &fd : M_fds) { fd = -1; }
+	}
+
+	PerfReading M_reading; // The events that were opened
+	int M_fds[PerfReading::MAX_EVENTS];
+};
+
+// Counts from construction to destruction, nothing if counters is nullptr.
+class PerfScope {
+  public:
+	explicit PerfScope(PerfCounters *counters) noexcept : M_counters(counters)
+	{
+		if (M_counters) { M_counters->Start(); }
+	}
+
+	PerfScope(const PerfScope &) = delete;
+	PerfScope &operator=(const PerfScope &) = delete;
+
+	~PerfScope()
+	{
+		if (M_counters) { M_counters->Stop(); }
+	}
+
+  private:
+	PerfCounters *M_counters;
+};
+} // namespace godby
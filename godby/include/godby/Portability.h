@@ -124,6 +124,145 @@ static inline void spin_loop_pause() noexcept {}
 
 #endif
 
+#include <chrono> // std::chrono
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <x86intrin.h> // __rdtsc
+#endif
+
+namespace godby
+{
+namespace details
+{
+struct TscCalibration {
+	bool invariant; // Constant rate across frequency changes, sleep states and cores
+	bool waitpkg;	// tpause, which waits for a counter value in a light sleep state
+	double ticks_per_second;
+	uint64_t to_ns;	  // nanoseconds = ticks * to_ns >> 32
+	uint64_t to_tick; // ticks = nanoseconds * to_tick >> 32
+	uint64_t ticks;	  // The counter and the system clock at calibration, for TscClock::to_sys
+	int64_t system_ns;
+};
+
+// Runs once: reads the CPU features and times the counter against steady_clock for 10ms.
+TscCalibration CalibrateTsc() noexcept;
+
+// Not static: one calibration for the program, not one per translation unit.
+inline const TscCalibration &Tsc() noexcept
+{
+	static const TscCalibration calibration = CalibrateTsc();
+	return calibration;
+}
+
+static inline uint64_t ReadTsc() noexcept
+{
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+	return __rdtsc();
+#elif defined(__aarch64__)
+	uint64_t ticks;
+	asm volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+	return ticks;
+#else
+	return 0;
+#endif
+}
+} // namespace details
+
+/**
+ * @class: TscClock
+ *
+ * @brief: steady clock on the CPU timestamp counter (x86 TSC, aarch64 virtual counter)
+ *
+ * Ticks() is one instruction and a check of the calibration, no system call or vDSO; now() adds a
+ * 128-bit multiply to get nanoseconds. The rate is measured once per process. Without an invariant
+ * counter (old CPUs, some hypervisors) the ticks are steady_clock nanoseconds instead, so timestamps
+ * stay comparable across cores either way.
+ */
+struct TscClock {
+	using rep = int64_t;
+	using period = std::nano;
+	using duration = std::chrono::nanoseconds;
+	using time_point = std::chrono::time_point<TscClock>;
+	static constexpr bool is_steady = true;
+
+	static inline uint64_t Ticks() noexcept
+	{
+		if (GODBY_LIKELY(details::Tsc().invariant)) { return details::ReadTsc(); }
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	static inline time_point now() noexcept
+	{
+		return time_point(duration(ToNanoseconds(Ticks())));
+	}
+
+	static inline uint64_t ToNanoseconds(uint64_t ticks) noexcept
+	{
+		return static_cast<uint64_t>((static_cast<unsigned __int128>(ticks) * details::Tsc().to_ns) >> 32);
+	}
+
+	static inline uint64_t FromNanoseconds(uint64_t ns) noexcept
+	{
+		return static_cast<uint64_t>((static_cast<unsigned __int128>(ns) * details::Tsc().to_tick) >> 32);
+	}
+
+	static double TicksPerSecond() noexcept
+	{
+		return details::Tsc().ticks_per_second;
+	}
+
+	static bool Invariant() noexcept
+	{
+		return details::Tsc().invariant;
+	}
+
+	// Anchored at calibration, it drifts by whatever NTP corrects the system clock since.
+	static std::chrono::system_clock::time_point to_sys(time_point t) noexcept
+	{
+		const auto &tsc = details::Tsc();
+		int64_t ns = tsc.system_ns + (t.time_since_epoch().count() - static_cast<int64_t>(ToNanoseconds(tsc.ticks)));
+		return std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(ns)));
+	}
+};
+
+namespace details
+{
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+// tpause ecx with EDX:EAX the counter value to wake at, ecx = 1 for C0.1 (faster wake-up). Encoded
+// by hand so the callers need no -mwaitpkg; the OS caps each wait (IA32_UMWAIT_CONTROL).
+static inline void Tpause(uint64_t deadline) noexcept
+{
+	asm volatile(".byte 0x66, 0x0f, 0xae, 0xf1" : : "c"(1u), "a"(static_cast<uint32_t>(deadline)), "d"(static_cast<uint32_t>(deadline >> 32)) : "cc", "memory");
+}
+#endif
+
+static inline void SpinUntilTicks(uint64_t deadline) noexcept
+{
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+	// Sleep through most of the wait, short of the wake-up latency, and spin the rest
+	constexpr uint64_t TPAUSE_SLACK = 512;
+	if (Tsc().waitpkg) {
+		while (ReadTsc() + TPAUSE_SLACK < deadline) { Tpause(deadline - TPAUSE_SLACK); }
+	}
+#endif
+	while (TscClock::Ticks() < deadline) { spin_loop_pause(); }
+}
+} // namespace details
+
+// Busy-wait until the deadline, for pacing below the resolution of sleeping; never yields the CPU.
+template <typename Duration>
+static inline void spin_until(std::chrono::time_point<TscClock, Duration> deadline) noexcept
+{
+	details::SpinUntilTicks(TscClock::FromNanoseconds(std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch()).count()));
+}
+
+template <typename Rep, typename Period>
+static inline void spin_for(std::chrono::duration<Rep, Period> duration) noexcept
+{
+	details::SpinUntilTicks(TscClock::Ticks() + TscClock::FromNanoseconds(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count()));
+}
+} // namespace godby
+
 #if defined(__has_include) && __has_include(<ankerl/unordered_dense.h>)
 
 #include <ankerl/unordered_dense.h> // ankerl::unordered_dense::set/map
@@ -0,0 +1,295 @@
+#pragma once
+
+#include <atomic>				  // std::atomic
+#include <cstddef>				  // std::size_t
+#include <cstdint>				  // uintptr_t
+#include <functional>			  // std::function
+#include <memory>				  // std::unique_ptr
+#include <mutex>				  // std::mutex
+#include <new>					  // placement new
+#include <thread>				  // std::this_thread
+#include <utility>				  // std::exchange, std::move
+#include <vector>				  // std::vector
+#include <godby/HazardPointers.h> // details::asymmetric_thread_fence_*
+#include <godby/Portability.h>	  // Portability
+
+static_assert(__cplusplus >= 202002L, "Requires C++20 or higher");
+
+//! Rcu
+namespace godby
+{
+/**
+ * Userspace RCU, readers signal nothing but a thread-local counter.
+ *
+ * rcu_read_lock() stores the current grace period phase in the thread's record, separated from
+ * the reads by asymmetric_thread_fence_light (a compiler barrier where membarrier is available).
+ * synchronize_rcu() pays for it with asymmetric_thread_fence_heavy, flips the phase and waits for
+ * the readers that are still in the old one, twice, so every read-side critical section that
+ * started before the call has ended when it returns.
+ *
+ * call_rcu() queues callbacks per thread and runs them in batches, one grace period per batch.
+ *
+ *     godby::RcuProtected<Config> config{std::make_unique<Config>()};
+ *     {
+ *         godby::RcuReadLock lock;
+ *         use(config.read()->routes);
+ *     }
+ *     config.update(std::make_unique<Config>(next)); // The old one is deleted after a grace period
+ *
+ * Read-side critical sections nest, must not block and must not call synchronize_rcu().
+ */
+class Rcu {
+  public:
+	// Callbacks queued by a thread before it runs them under a single grace period.
+	constexpr static std::size_t call_batch = 128;
+
+  private:
+	constexpr static uintptr_t COUNT = 1;
+	constexpr static uintptr_t PHASE = uintptr_t(1) << (sizeof(uintptr_t) * 8 - 1);
+
+	struct alignas(CACHE_LINE_ALIGNMENT) Record {
+		explicit Record(bool in_use_) : in_use(in_use_) {}
+
+		// Phase and nesting count of the read-side critical section, 0 when not reading
+		std::atomic<uintptr_t> ctr{0};
+
+		std::atomic<Record *> next{nullptr};
+		std::atomic<bool> in_use;
+
+		std::vector<std::function<void()>> callbacks;
+	};
+
+	struct RecordOwner {
+		explicit RecordOwner(Rcu &rcu_) : rcu(rcu_), my_record(rcu.get_record()) {}
+
+		~RecordOwner()
+		{
+			rcu.flush(*my_record);
+			my_record->in_use.store(false);
+		}
+
+	  private:
+		Rcu &rcu;
+
+	  public:
+		Record *const my_record;
+	};
+
+  public:
+	Rcu() = default;
+	Rcu(const Rcu &) = delete;
+	Rcu &operator=(const Rcu &) = delete;
+
+	static Rcu &instance()
+	{
+		// Never destructed, threads may still exit after static destruction.
+		alignas(Rcu) static char buffer[sizeof(Rcu)];
+		static auto *rcu = new (&buffer) Rcu{};
+		return *rcu;
+	}
+
+	inline void read_lock() noexcept
+	{
+		Record &record = *local_record.my_record;
+		uintptr_t ctr = record.ctr.load(std::memory_order_relaxed);
+		if (GODBY_LIKELY((ctr & ~PHASE) == 0)) {
+			record.ctr.store(gp_ctr.load(std::memory_order_relaxed), std::memory_order_relaxed);
+		} else {
+			record.ctr.store(ctr + COUNT, std::memory_order_relaxed);
+		}
+		details::asymmetric_thread_fence_light(std::memory_order_seq_cst); /*  Fast-side fence  */
+	}
+
+	inline void read_unlock() noexcept
+	{
+		Record &record = *local_record.my_record;
+		details::asymmetric_thread_fence_light(std::memory_order_seq_cst); /*  Fast-side fence  */
+		uintptr_t ctr = record.ctr.load(std::memory_order_relaxed);
+		record.ctr.store((ctr & ~PHASE) == COUNT ? 0 : ctr - COUNT, std::memory_order_relaxed);
+	}
+
+	bool reading() const noexcept
+	{
+		return (local_record.my_record->ctr.load(std::memory_order_relaxed) & ~PHASE) != 0;
+	}
+
+	// Wait until every read-side critical section that started before the call has ended.
+	void synchronize()
+	{
+		GODBY_ASSERT(!reading());
+		wait_for_readers();
+	}
+
+	// Run callback after a grace period, from this thread once it has queued call_batch of them.
+	void call(std::function<void()> callback)
+	{
+		Record &record = *local_record.my_record;
+		record.callbacks.push_back(std::move(callback));
+		if (record.callbacks.size() >= call_batch && !reading()) { flush(record); }
+	}
+
+	// Run the callbacks queued by this thread, after a grace period.
+	void barrier()
+	{
+		GODBY_ASSERT(!reading());
+		flush(*local_record.my_record);
+	}
+
+  private:
+	void wait_for_readers()
+	{
+		std::lock_guard<std::mutex> guard(gp_lock);
+
+		details::asymmetric_thread_fence_heavy(std::memory_order_seq_cst); /*  Slow-side fence  */
+		// Two flips: a reader may have loaded the phase just before the first one and store it
+		// after the wait, it is then waited for by the second.
+		for (int flip = 0; flip < 2; ++flip) {
+			uintptr_t phase = gp_ctr.fetch_xor(PHASE, std::memory_order_relaxed) ^ PHASE;
+			details::asymmetric_thread_fence_heavy(std::memory_order_seq_cst);
+			for (Record *current = list_head.load(); current; current = current->next.load()) {
+				for (unsigned spins = 0; ongoing(current->ctr.load(std::memory_order_relaxed), phase); ++spins) {
+					if (spins < 64) {
+						spin_loop_pause();
+					} else {
+						std::this_thread::yield();
+					}
+				}
+			}
+		}
+		details::asymmetric_thread_fence_heavy(std::memory_order_seq_cst);
+	}
+
+	static bool ongoing(uintptr_t ctr, uintptr_t phase) noexcept
+	{
+		return (ctr & ~PHASE) != 0 && ((ctr ^ phase) & PHASE) != 0;
+	}
+
+	Record *get_record()
+	{
+		Record *current = list_head.load();
+		for (; current; current = current->next.load()) {
+			if (!current->in_use.load() && !current->in_use.exchange(true)) { return current; }
+		}
+
+		auto record = new Record{true};
+		Record *head = list_head.load();
+		do { record->next.store(head, std::memory_order_relaxed); } while (!list_head.compare_exchange_weak(head, record));
+		return record;
+	}
+
+	void flush(Record &record)
+	{
+		while (!record.callbacks.empty()) {
+			std::vector<std::function<void()>> batch;
+			batch.swap(record.callbacks);
+			wait_for_readers();
+			for (auto &callback : batch) { callback(); } // May queue more callbacks
+		}
+	}
+
+	std::atomic<uintptr_t> gp_ctr{COUNT};
+	std::mutex gp_lock;
+	std::atomic<Record *> list_head{nullptr};
+
+	static inline const thread_local RecordOwner local_record{instance()};
+};
+
+inline void rcu_read_lock() noexcept
+{
+	Rcu::instance().read_lock();
+}
+
+inline void rcu_read_unlock() noexcept
+{
+	Rcu::instance().read_unlock();
+}
+
+inline void synchronize_rcu()
+{
+	Rcu::instance().synchronize();
+}
+
+template <typename F>
+inline void call_rcu(F &&callback)
+{
+	Rcu::instance().call(std::function<void()>(std::forward<F>(callback)));
+}
+
+inline void rcu_barrier()
+{
+	Rcu::instance().barrier();
+}
+
+// RAII read-side critical section.
+class RcuReadLock {
+  public:
+	RcuReadLock() noexcept
+	{
+		rcu_read_lock();
+	}
+
+	~RcuReadLock()
+	{
+		rcu_read_unlock();
+	}
+
+	RcuReadLock(const RcuReadLock &) = delete;
+	RcuReadLock &operator=(const RcuReadLock &) = delete;
+};
+
+/**
+ * @class: RcuProtected
+ *
+ * @brief: an owning pointer whose readers use RCU
+ *
+ * read() may only be called inside a read-side critical section, and the pointer stays valid
+ * until it ends. Updates publish the new object with a release store, the old one is deleted
+ * after a grace period, by update() through call_rcu and by update_sync() before it returns.
+ */
+template <typename T>
+class RcuProtected {
+  public:
+	RcuProtected() noexcept = default;
+	explicit RcuProtected(std::unique_ptr<T> initial) noexcept : M_ptr(initial.release()) {}
+
+	RcuProtected(const RcuProtected &) = delete;
+	RcuProtected &operator=(const RcuProtected &) = delete;
+
+	// No reader may be left when the owner is destroyed.
+	~RcuProtected()
+	{
+		delete M_ptr.load(std::memory_order_relaxed);
+	}
+
+	inline T *read() const noexcept
+	{
+		GODBY_ASSERT(Rcu::instance().reading());
+		return M_ptr.load(std::memory_order_acquire);
+	}
+
+	// f(T const *) inside its own read-side critical section.
+	template <typename F>
+	inline decltype(auto) read(F &&f) const
+	{
+		RcuReadLock lock;
+		return std::forward<F>(f)(static_cast<T const *>(M_ptr.load(std::memory_order_acquire)));
+	}
+
+	void update(std::unique_ptr<T> desired)
+	{
+		T *old = M_ptr.exchange(desired.release(), std::memory_order_acq_rel);
+		if (old) {
+			call_rcu([old]() { delete old; });
+		}
+	}
+
+	void update_sync(std::unique_ptr<T> desired)
+	{
+		std::unique_ptr<T> old(M_ptr.exchange(desired.release(), std::memory_order_acq_rel));
+		if (old) { synchronize_rcu(); }
+	}
+
+  private:
+	std::atomic<T *> M_ptr{nullptr};
+};
+} // namespace godby
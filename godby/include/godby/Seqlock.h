@@ -1,6 +1,10 @@
 #pragma once
 
+#include <algorithm>
 #include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <functional>
 #include <type_traits>
 #include <godby/Concept.h>
 #include <godby/Portability.h>
@@ -10,9 +14,21 @@ namespace godby
 template <typename T>
 concept Seqlockable = TriviallyCopyable<T> && NothrowCopyAssignable<T>;
 
-template <Seqlockable T>
+/**
+ * Readers never write to shared memory: they read the sequence, the value, then the sequence
+ * again, and retry while a writer is in the middle of a store (odd sequence) or was in between.
+ *
+ * By default there is a single writer. With MultiWriter the writers serialize on the sequence
+ * word: a store takes it from even to odd with a CAS, no extra lock word is needed.
+ *
+ * Values larger than large_copy_size are copied in chunks, with the sequence checked between
+ * them, so a conflicting store costs the chunk in progress instead of the whole copy.
+ */
+template <Seqlockable T, bool MultiWriter = false>
 class Seqlock {
   public:
+	static constexpr std::size_t large_copy_size = 4 * CACHE_LINE_SIZE;
+
 	Seqlock() : M_seq(0) {}
 
 	Seqlock(const Seqlock &) = delete;
@@ -24,30 +40,105 @@ class Seqlock {
 	inline T load() const noexcept
 	{
 		T copy;
-		std::size_t seq0, seq1;
+		std::size_t seq0;
 		do {
 			seq0 = M_seq.load(std::memory_order_acquire);
-			std::atomic_signal_fence(std::memory_order_acq_rel);
-			copy = M_value;
-			std::atomic_signal_fence(std::memory_order_acq_rel);
-			seq1 = M_seq.load(std::memory_order_acquire);
-		} while (seq0 != seq1 || seq0 & 1);
+			if (GODBY_UNLIKELY(seq0 & 1)) {
+				spin_loop_pause();
+				continue;
+			}
+			if (!copy_to(copy, seq0)) { continue; }
+			std::atomic_thread_fence(std::memory_order_acquire);
+		} while (seq0 & 1 || M_seq.load(std::memory_order_relaxed) != seq0);
 		return copy;
 	}
 
+	// Visit the value in place, without copying it out, and return what f returns for a consistent
+	// value. f may see a torn value, in which case it is called again: it must only read the value
+	// (no pointers followed, no side effects) and must not rely on invariants between its fields.
+	template <typename F>
+	inline auto read(F &&f) const -> std::invoke_result_t<F &, const T &>
+	{
+		for (;;) {
+			std::size_t seq0 = M_seq.load(std::memory_order_acquire);
+			if (GODBY_UNLIKELY(seq0 & 1)) {
+				spin_loop_pause();
+				continue;
+			}
+			if constexpr (std::is_void_v<std::invoke_result_t<F &, const T &>>) {
+				std::invoke(f, M_value);
+				std::atomic_thread_fence(std::memory_order_acquire);
+				if (GODBY_LIKELY(M_seq.load(std::memory_order_relaxed) == seq0)) { return; }
+			} else {
+				auto result = std::invoke(f, M_value);
+				std::atomic_thread_fence(std::memory_order_acquire);
+				if (GODBY_LIKELY(M_seq.load(std::memory_order_relaxed) == seq0)) { return result; }
+			}
+		}
+	}
+
 	inline void store(const T &desired) noexcept
 	{
-		std::size_t seq0 = M_seq.load(std::memory_order_relaxed);
-		M_seq.store(seq0 + 1, std::memory_order_release);
-		std::atomic_signal_fence(std::memory_order_acq_rel);
+		std::size_t seq0 = lock();
 		M_value = desired;
-		std::atomic_signal_fence(std::memory_order_acq_rel);
 		M_seq.store(seq0 + 2, std::memory_order_release);
 	}
 
+	// Modify the value in place with f(T &), readers see either the old or the new value.
+	// If f throws, the sequence still turns even again and readers see whatever f left behind.
+	template <typename F>
+	inline void update(F &&f) noexcept(std::is_nothrow_invocable_v<F &, T &>)
+	{
+		struct Unlock {
+			std::atomic<std::size_t> &seq;
+			std::size_t next;
+			~Unlock()
+			{
+				seq.store(next, std::memory_order_release);
+			}
+		} unlock{M_seq, lock() + 2};
+		std::invoke(f, M_value);
+	}
+
   private:
+	// Make the sequence odd, returns its previous (even) value.
+	inline std::size_t lock() noexcept
+	{
+		std::size_t seq0 = M_seq.load(std::memory_order_relaxed);
+		if constexpr (MultiWriter) {
+			for (;;) {
+				if (!(seq0 & 1) && M_seq.compare_exchange_weak(seq0, seq0 + 1, std::memory_order_relaxed, std::memory_order_relaxed)) { break; }
+				spin_loop_pause();
+				seq0 = M_seq.load(std::memory_order_relaxed);
+			}
+		} else {
+			M_seq.store(seq0 + 1, std::memory_order_relaxed);
+		}
+		std::atomic_thread_fence(std::memory_order_release); // The odd sequence is visible before any of the new value
+		return seq0;
+	}
+
+	// Copy the value, returns false if a store was seen to start during a chunked copy.
+	inline bool copy_to(T &copy, [[maybe_unused]] std::size_t seq0) const noexcept
+	{
+		if constexpr (sizeof(T) <= large_copy_size) {
+			copy = M_value;
+			return true;
+		} else {
+			constexpr std::size_t CHUNK = large_copy_size;
+			auto *dst = reinterpret_cast<unsigned char *>(&copy);
+			auto *src = reinterpret_cast<const unsigned char *>(&M_value);
+			for (std::size_t offset = 0; offset < sizeof(T); offset += CHUNK) {
+				std::memcpy(dst + offset, src + offset, std::min(CHUNK, sizeof(T) - offset));
+				std::atomic_thread_fence(std::memory_order_acquire);
+				if (GODBY_UNLIKELY(M_seq.load(std::memory_order_relaxed) != seq0)) { return false; }
+			}
+			return true;
+		}
+	}
+
 	// Align to prevent false sharing with adjecent data
-	alignas(CACHE_LINE_SIZE) T M_value;
+	alignas(CACHE_LINE_SIZE) T M_value{};
 	std::atomic<std::size_t> M_seq;
 	// Padding to prevent false sharing with adjecent data
 	char M_padding[CACHE_LINE_SIZE - ((sizeof(M_value) + sizeof(M_seq)) % CACHE_LINE_SIZE)];
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <atomic>			   // std::atomic
+#include <cstddef>			   // std::size_t
+#include <cstdint>			   // uint64_t
+#include <limits>			   // std::numeric_limits
+#include <new>				   // std::bad_alloc, std::bad_array_new_length
+#include <utility>			   // std::exchange, std::forward
+#include <godby/Expected.h>	   // godby::Expected
+#include <godby/Portability.h> // Portability
+
+static_assert(__cplusplus >= 202002L, "Requires C++20 or higher");
+
+//! SharedMemory
+namespace godby
+{
+namespace details
+{
+// Lives at the start of every segment. Processes map a segment at the address it was created at,
+// so raw pointers into it (and allocators referring to this header) are valid in all of them.
+struct SharedMemoryHeader {
+	static constexpr uint64_t MAGIC = 0x79626f4467686d73; // "smhgDoby"
+
+	std::atomic<uint64_t> magic; // Stored last by the creator, the other fields are set once it reads MAGIC
+	std::size_t size;
+	void *base;
+	std::atomic<std::size_t> used;
+	std::atomic<void *> root;
+
+	void *allocate(std::size_t bytes, std::size_t alignment)
+	{
+		std::size_t offset = used.load(std::memory_order_relaxed), aligned;
+		do {
+			aligned = (offset + alignment - 1) & ~(alignment - 1);
+			if (GODBY_UNLIKELY(aligned + bytes > size)) { throw std::bad_alloc(); }
+		} while (!used.compare_exchange_weak(offset, aligned + bytes, std::memory_order_relaxed, std::memory_order_relaxed));
+		return static_cast<char *>(base) + aligned;
+	}
+};
+} // namespace details
+
+struct SharedMemoryOptions {
+	bool huge_pages = false; // Back the segment with huge pages (MFD_HUGETLB / hugetlbfs)
+	bool populate = false;	 // Pre-fault the whole segment with MAP_POPULATE
+	void *address = nullptr; // Address to map the segment at in every process
+};
+
+/**
+ * @class: SharedMemory
+ *
+ * @brief: a memory segment several processes attach to, at the same virtual address in each of them
+ *
+ * Named segments come from shm_open(), or from a file under hugetlbfs (/dev/hugepages) when huge
+ * pages are requested. Anonymous segments (name == nullptr) come from memfd_create() and are shared
+ * through fork() or by passing fd() over a unix socket.
+ *
+ * The creator maps the segment at Options::address (or wherever the kernel puts it) and records that
+ * address in the segment; Open() maps it at the same address with MAP_FIXED_NOREPLACE and fails with
+ * EEXIST if the range is taken in the attaching process. Pick an explicit address for deployments.
+ *
+ * Memory is handed out by a bump allocator and only returned when the segment is unlinked:
+ *
+ *     // producer process
+ *     auto shm = SharedMemory::Create("/orders", 64 << 20, {.address = (void *)0x7e0000000000});
+ *     using Queue = AtomicQueueB<uint64_t, SharedMemoryAllocator<uint64_t>>;
+ *     Queue *q = shm->construct<Queue>(65536, shm->get_allocator<uint64_t>());
+ *
+ *     // consumer process
+ *     auto shm = SharedMemory::Open("/orders");
+ *     Queue *q = shm->root<Queue>();
+ *
+ * Only address-free lock-free atomics work across processes, which AtomicQueueB asserts on. Use the
+ * BusyWait policy: std::atomic::wait may be backed by a process-private futex.
+ */
+class SharedMemory {
+  public:
+	using Options = SharedMemoryOptions;
+
+	// All functions report failures as errno values. Open(fd) takes ownership of fd.
+	static Expected<SharedMemory, int> Create(const char *name, std::size_t size, Options options = {});
+	static Expected<SharedMemory, int> Open(const char *name, Options options = {});
+	static Expected<SharedMemory, int> Open(int fd, Options options = {});
+	static int Unlink(const char *name, bool huge_pages = false);
+
+	SharedMemory(SharedMemory &&b) noexcept : M_header(std::exchange(b.M_header, nullptr)), M_fd(std::exchange(b.M_fd, -1)) {}
+
+	SharedMemory &operator=(SharedMemory &&b) noexcept
+	{
+		std::swap(M_header, b.M_header);
+		std::swap(M_fd, b.M_fd);
+		return *this;
+	}
+
+	~SharedMemory();
+
+	void *data() const noexcept
+	{
+		return M_header;
+	}
+
+	std::size_t size() const noexcept
+	{
+		return M_header->size;
+	}
+
+	std::size_t available() const noexcept
+	{
+		return M_header->size - M_header->used.load(std::memory_order_relaxed);
+	}
+
+	int fd() const noexcept
+	{
+		return M_fd;
+	}
+
+	void *allocate(std::size_t bytes, std::size_t alignment = alignof(std::max_align_t))
+	{
+		return M_header->allocate(bytes, alignment);
+	}
+
+	// Construct the object other processes look up with root<T>().
+	template <class T, class... Args>
+	T *construct(Args &&...args)
+	{
+		T *p = new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+		M_header->root.store(p, std::memory_order_release);
+		return p;
+	}
+
+	// The object set by construct(), nullptr until the creator has finished constructing it.
+	template <class T>
+	T *root() const noexcept
+	{
+		return static_cast<T *>(M_header->root.load(std::memory_order_acquire));
+	}
+
+	template <class T>
+	auto get_allocator() const noexcept;
+
+  private:
+	SharedMemory(details::SharedMemoryHeader *header, int fd) noexcept : M_header(header), M_fd(fd) {}
+
+	static Expected<SharedMemory, int> Map(int fd, std::size_t size, Options options, bool create);
+
+	details::SharedMemoryHeader *M_header;
+	int M_fd;
+};
+
+// Allocator handing out memory from a SharedMemory segment, deallocate() is a no-op.
+template <class T>
+class SharedMemoryAllocator {
+	template <class U>
+	friend class SharedMemoryAllocator;
+
+  public:
+	using value_type = T;
+
+	explicit SharedMemoryAllocator(details::SharedMemoryHeader *header) noexcept : M_header(header) {}
+
+	template <class U>
+	SharedMemoryAllocator(SharedMemoryAllocator<U> const &b) noexcept : M_header(b.M_header)
+	{
+	}
+
+	T *allocate(std::size_t n)
+	{
+		if (n > std::numeric_limits<std::size_t>::max() / sizeof(T)) { throw std::bad_array_new_length(); }
+		return static_cast<T *>(M_header->allocate(n * sizeof(T), alignof(T) < CACHE_LINE_SIZE ? CACHE_LINE_SIZE : alignof(T)));
+	}
+
+	void deallocate(T *, std::size_t) noexcept {}
+
+	template <class U>
+	bool operator==(SharedMemoryAllocator<U> const &b) const noexcept
+	{
+		return M_header == b.M_header;
+	}
+
+  private:
+	details::SharedMemoryHeader *M_header;
+};
+
+template <class T>
+auto SharedMemory::get_allocator() const noexcept
+{
+	return SharedMemoryAllocator<T>(M_header);
+}
+} // namespace godby
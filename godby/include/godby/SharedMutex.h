@@ -0,0 +1,116 @@
+#pragma once
+
+#include <atomic>			   // std::atomic
+#include <cstddef>			   // std::size_t
+#include <mutex>			   // std::mutex
+#include <thread>			   // std::this_thread
+#include <godby/Portability.h> // Portability
+
+static_assert(__cplusplus >= 202002L, "Requires C++20 or higher");
+
+//! DistributedSharedMutex
+namespace godby
+{
+/**
+ * @class: DistributedSharedMutex
+ *
+ * @brief: reader-writer lock whose readers do not share a cache line
+ *
+ * Readers count themselves in one of Slots cache-line sized counters, picked per thread, so
+ * concurrent lock_shared() calls from different threads touch different lines instead of all
+ * bouncing the single reader count of std::shared_mutex. A writer pays for it: it announces
+ * itself, then waits for every slot to drain. Writers are preferred, readers arriving while
+ * one is announced step back until it is done.
+ *
+ * Meets the SharedMutex requirements, use it with std::shared_lock and std::unique_lock.
+ */
+template <std::size_t Slots = 64>
+class DistributedSharedMutex {
+	static_assert(Slots >= 1, "Need at least one reader slot");
+
+	struct alignas(CACHE_LINE_SIZE) Slot {
+		std::atomic<std::size_t> readers{0};
+	};
+
+  public:
+	DistributedSharedMutex() = default;
+	DistributedSharedMutex(const DistributedSharedMutex &) = delete;
+	DistributedSharedMutex &operator=(const DistributedSharedMutex &) = delete;
+
+	void lock()
+	{
+		M_writers.lock();
+		M_writing.store(true, std::memory_order_seq_cst);
+		for (auto &slot : M_slots) {
+			for (unsigned spins = 0; slot.readers.load(std::memory_order_seq_cst) != 0; ++spins) { backoff(spins); }
+		}
+	}
+
+	bool try_lock()
+	{
+		if (!M_writers.try_lock()) { return false; }
+		M_writing.store(true, std::memory_order_seq_cst);
+		for (auto &slot : M_slots) {
+			if (slot.readers.load(std::memory_order_seq_cst) != 0) {
+				unlock();
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void unlock()
+	{
+		M_writing.store(false, std::memory_order_release);
+		M_writers.unlock();
+	}
+
+	void lock_shared() noexcept
+	{
+		Slot &slot = M_slots[slot_index()];
+		for (;;) {
+			// seq_cst on both sides: either the writer sees our count or we see its flag
+			slot.readers.fetch_add(1, std::memory_order_seq_cst);
+			if (GODBY_LIKELY(!M_writing.load(std::memory_order_seq_cst))) { return; }
+			slot.readers.fetch_sub(1, std::memory_order_release);
+			for (unsigned spins = 0; M_writing.load(std::memory_order_relaxed); ++spins) { backoff(spins); }
+		}
+	}
+
+	bool try_lock_shared() noexcept
+	{
+		Slot &slot = M_slots[slot_index()];
+		slot.readers.fetch_add(1, std::memory_order_seq_cst);
+		if (GODBY_LIKELY(!M_writing.load(std::memory_order_seq_cst))) { return true; }
+		slot.readers.fetch_sub(1, std::memory_order_release);
+		return false;
+	}
+
+	void unlock_shared() noexcept
+	{
+		M_slots[slot_index()].readers.fetch_sub(1, std::memory_order_release);
+	}
+
+  private:
+	// Threads are spread over the slots round robin, in the order they first take a shared lock.
+	static std::size_t slot_index() noexcept
+	{
+		static std::atomic<std::size_t> next_index{0};
+		static thread_local std::size_t index = next_index.fetch_add(1, std::memory_order_relaxed) % Slots;
+		return index;
+	}
+
+	static void backoff(unsigned spins) noexcept
+	{
+		if (spins < 64) {
+			spin_loop_pause();
+		} else {
+			std::this_thread::yield();
+		}
+	}
+
+	Slot M_slots[Slots];
+	alignas(CACHE_LINE_SIZE) std::atomic<bool> M_writing{false};
+	std::mutex M_writers; // Serializes writers
+};
+} // namespace godby
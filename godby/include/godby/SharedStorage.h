@@ -1,6 +1,8 @@
 #pragma once
 
 #include <atomic>
+#include <cstdint>
+#include <cstdio>
 #include <cstring>
 #include <iostream>
 #include <memory>
@@ -10,15 +12,16 @@
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <unordered_map>
 #include <thread>
 
-#include <godby/TimerWheel.h>
+#include <godby/AtomicSharedPointer.h>
+#include <godby/SharedMutex.h>
 
 #ifndef TRACE
 #include <time.h>
-#include <unistd.h>
-#include <sys/time.h>
 
 #define TOSTRING(line)		 #line
 #define LOCATION(file, line) &file ":" TOSTRING(line)[(__builtin_strrchr(file, '/') ? (__builtin_strrchr(file, '/') - file + 1) : 0)]
@@ -27,11 +30,12 @@
 	do {                                                                                                \
 		char buff[32];                                                                                  \
 		struct tm tm;                                                                                   \
-		struct timeval tv;                                                                              \
-		gettimeofday(&tv, NULL);                                                                        \
-		localtime_r(&tv.tv_sec, &tm);                                                                   \
+		auto now = godby::TscClock::to_sys(godby::TscClock::now()).time_since_epoch();                  \
+		int64_t ms = std::chrono::duration_cast<std::chrono::milliseconds>(now).count();                \
+		time_t seconds = static_cast<time_t>(ms / 1000);                                                \
+		localtime_r(&seconds, &tm);                                                                     \
 		size_t len = strftime(buff, sizeof(buff), "%Y-%m-%d %H:%M:%S", &tm);                            \
-		snprintf(&buff[len], sizeof(buff) - len, ".%03d", (int)(((tv.tv_usec + 500) / 1000) % 1000));   \
+		snprintf(&buff[len], sizeof(buff) - len, ".%03d", static_cast<int>(ms % 1000));                 \
 		printf("\033[2;3m%s\033[0m <%s> " fmt "\n", buff, LOCATION(__FILE__, __LINE__), ##__VA_ARGS__); \
 	} while (0);
 #endif
@@ -94,6 +98,107 @@ std::string MakeKey(Tags &&...tags)
 	return key;
 }
 
+namespace details
+{
+constexpr uint64_t kFnvOffsetBasis = 14695981039346656037ull;
+constexpr uint64_t kFnvPrime = 1099511628211ull;
+
+constexpr uint64_t Fnv1a(uint64_t hash, std::string_view bytes)
+{
+	for (char c : bytes) { hash = (hash ^ static_cast<unsigned char>(c)) * kFnvPrime; }
+	return hash;
+}
+
+// Hashes the text MakeKey() streams for a tag, so 7 and "7" still name the same value. Strings,
+// characters and integers are hashed in place and at compile time, anything else is streamed.
+template <typename Tag>
+constexpr uint64_t HashTag(uint64_t hash, const Tag &tag)
+{
+	using U = std::remove_cvref_t<Tag>;
+	if constexpr (std::is_convertible_v<const Tag &, std::string_view>) {
+		return Fnv1a(hash, std::string_view(tag));
+	} else if constexpr (std::is_same_v<U, char> || std::is_same_v<U, signed char> || std::is_same_v<U, unsigned char>) {
+		char c = static_cast<char>(tag);
+		return Fnv1a(hash, std::string_view(&c, 1));
+	} else if constexpr (std::is_same_v<U, bool>) {
+		return Fnv1a(hash, tag ? "1" : "0");
+	} else if constexpr (std::is_integral_v<U>) {
+		using Unsigned = std::make_unsigned_t<U>;
+		Unsigned value = static_cast<Unsigned>(tag);
+		if constexpr (std::is_signed_v<U>) {
+			if (tag < 0) {
+				hash = Fnv1a(hash, "-");
+				value = Unsigned(0) - value;
+			}
+		}
+		char digits[24];
+		std::size_t count = 0;
+		do {
+			digits[count++] = static_cast<char>('0' + value % 10);
+			value /= 10;
+		} while (value);
+		while (count) { hash = (hash ^ static_cast<unsigned char>(digits[--count])) * kFnvPrime; }
+		return hash;
+	} else {
+		std::ostringstream oss;
+		oss << tag;
+		return Fnv1a(hash, oss.str());
+	}
+}
+} // namespace details
+
+// Compile-time id of a type, the hash of its name.
+template <typename T>
+constexpr uint64_t TypeId()
+{
+	return details::Fnv1a(details::kFnvOffsetBasis, ConstexprGetType<T>());
+}
+
+// Hash of the tags of a key, in order.
+template <typename... Tags>
+constexpr uint64_t TagHash(const Tags &...tags)
+{
+	uint64_t hash = details::kFnvOffsetBasis;
+	bool first = true;
+	((hash = details::HashTag(first ? hash : details::Fnv1a(hash, "."), tags), first = false), ...);
+	return hash;
+}
+
+/**
+ * @class: StorageKey
+ *
+ * @brief: 64-bit key of a value of type T in SharedStorage
+ *
+ * Replaces MakeKey() on the lookup path: no stream, no string, and when the tags are literals the
+ * whole key is computed at compile time.
+ *
+ *     static constexpr godby::StorageKey<Config> kConfig("service", 3);
+ *     auto config = godby::SharedStorage::Singlon().GetOrCreate(kConfig);
+ */
+template <typename T>
+class StorageKey {
+  public:
+	template <typename... Tags>
+	constexpr explicit StorageKey(const Tags &...tags) : M_value(Combine(TypeId<T>(), TagHash(tags...)))
+	{
+	}
+
+	constexpr uint64_t value() const noexcept
+	{
+		return M_value;
+	}
+
+	constexpr bool operator==(const StorageKey &) const = default;
+
+  private:
+	static constexpr uint64_t Combine(uint64_t type, uint64_t tags)
+	{
+		return type ^ (tags + 0x9e3779b97f4a7c15ull + (type << 6) + (type >> 2));
+	}
+
+	uint64_t M_value;
+};
+
 #define INC(name) name.fetch_add(1, std::memory_order_relaxed)
 
 std::atomic<size_t> local_hits{0};
@@ -104,20 +209,20 @@ std::atomic<size_t> shared_misses{0};
 template <typename T>
 class ThreadLocalCache {
   public:
-	static inline std::shared_ptr<T> Get(const std::string &key)
+	static inline std::shared_ptr<T> Get(uint64_t key)
 	{
 		auto &ins = Singlon();
 		auto it = ins.cached.find(key);
 		return (it != ins.cached.end()) ? (INC(local_hits), it->second) : (INC(local_misses), nullptr);
 	}
 
-	static inline void Set(const std::string &key, std::shared_ptr<T> value)
+	static inline void Set(uint64_t key, std::shared_ptr<T> value)
 	{
 		auto &ins = Singlon();
 		ins.cached[key] = std::move(value);
 	}
 
-	static inline bool Has(const std::string &key)
+	static inline bool Has(uint64_t key)
 	{
 		auto &ins = Singlon();
 		return ins.cached.find(key) != ins.cached.end();
@@ -137,89 +242,101 @@ class ThreadLocalCache {
 		thread_local ThreadLocalCache instance;
 		return instance;
 	}
-	std::unordered_map<std::string, std::shared_ptr<T>> cached;
+	std::unordered_map<uint64_t, std::shared_ptr<T>> cached;
 };
 
+// Bumped by every reload, a thread keeps using the versions it cached while this has not moved.
+inline std::atomic<uint64_t> &ReloadGeneration() noexcept
+{
+	static std::atomic<uint64_t> generation{0};
+	return generation;
+}
+
+/**
+ * @class: Reloadable
+ *
+ * @brief: value that writers replace as a whole while readers keep the version they hold
+ *
+ * publish() swaps in the new version and bumps ReloadGeneration(), readers going through
+ * SharedStorage revalidate the version they cached with one relaxed load of that counter, so a
+ * reload is seen on the next lookup without any polling thread.
+ */
 template <typename T>
-struct Reloadable {
-	Reloadable(unsigned int seconds) : interval(seconds) {}
+class Reloadable {
+  public:
+	Reloadable() : M_current(godby::make_shared<T>()) {}
 
-	unsigned int interval;
-	T ping, pong, *curr = &ping;
-	std::atomic<time_t> last_time{0};
+	Reloadable(const Reloadable &) = delete;
+	Reloadable &operator=(const Reloadable &) = delete;
 
-	inline std::shared_ptr<T> which()
+	SharedPtr<T> load() const
 	{
-		return std::shared_ptr<T>(curr, [](T *) {});
+		return M_current.load();
 	}
 
-	inline bool reload()
+	void publish(SharedPtr<T> next)
 	{
-		if (curr == &ping) {
-			curr = &pong;
-			TRACE("Use pong");
-		} else {
-			curr = &ping;
-			TRACE("Use ping");
-		}
-		return true;
+		M_current.store(std::move(next));
+		ReloadGeneration().fetch_add(1, std::memory_order_release); // After the store, readers acquire it
 	}
+
+  private:
+	AtomicSharedPtr<T> M_current;
 };
 
+// The version of each Reloadable<T> the calling thread last looked up, with the generation it was loaded in.
 template <typename T>
-class ReloadableTimerEvent : public TimerEvent {
+class ReloadableViews {
   public:
-	explicit ReloadableTimerEvent(TimerWheel &time_wheel, std::shared_ptr<Reloadable<T>> reloadable) : time_wheel_(time_wheel), reloadable_(reloadable) {}
+	struct View {
+		uint64_t generation = 0;
+		std::shared_ptr<T> value;
+	};
 
-  protected:
-	void execute() override
+	static inline View &Get(uint64_t key)
 	{
-		reloadable_->reload();
-		time_wheel_.schedule(this, reloadable_->interval);
+		thread_local std::unordered_map<uint64_t, View> views;
+		return views[key];
 	}
 
-  private:
-	TimerWheel &time_wheel_;
-	std::shared_ptr<Reloadable<T>> reloadable_;
-};
-
-class ReloadableManager {
-  public:
-	static ReloadableManager &Singlon()
+	static inline void Load(View &view, const Reloadable<T> &reloadable)
 	{
-		static ReloadableManager instance;
-		return instance;
+		view.generation = ReloadGeneration().load(std::memory_order_acquire);
+		auto current = reloadable.load();
+		view.value = current ? std::shared_ptr<T>(current.get(), [current](T *) {}) : nullptr;
 	}
+};
 
-	template <typename T>
-	void AddReloadable(std::shared_ptr<Reloadable<T>> &reloadable)
-	{
-		TimerEvent *event = new ReloadableTimerEvent<T>(M_timer_wheel, reloadable);
-		M_timer_wheel.schedule(event, reloadable->interval);
-	}
+/**
+ * @class: StorageHandle
+ *
+ * @brief: resolved entry of SharedStorage, for lookups that skip hashing and the map
+ *
+ * Keeps the value alive; get() returns null once the entry was deleted.
+ */
+template <typename T>
+class StorageHandle {
+  public:
+	StorageHandle() = default;
 
-	ReloadableManager()
+	std::shared_ptr<T> get() const noexcept
 	{
-		M_worker = std::thread([&] {
-			TickType seconds = 0;
-			while (!stop) {
-				if (seconds > 0) { M_timer_wheel.advance(seconds); }
-				seconds = M_timer_wheel.ticks_to_wakeup();
-				sleep(seconds);
-			}
-		});
+		if (!M_erased || M_erased->load(std::memory_order_acquire)) { return nullptr; }
+		return M_value;
 	}
 
-	~ReloadableManager()
+	explicit operator bool() const noexcept
 	{
-		stop = true;
-		M_worker.join();
+		return M_erased && !M_erased->load(std::memory_order_acquire);
 	}
 
   private:
-	bool stop = false;
-	std::thread M_worker;
-	TimerWheel M_timer_wheel;
+	friend class SharedStorage;
+
+	StorageHandle(std::shared_ptr<T> value, std::shared_ptr<std::atomic<bool>> erased) : M_value(std::move(value)), M_erased(std::move(erased)) {}
+
+	std::shared_ptr<T> M_value;
+	std::shared_ptr<std::atomic<bool>> M_erased;
 };
 
 class SharedStorage {
@@ -238,151 +355,229 @@ class SharedStorage {
 	SharedStorage(SharedStorage &&) = delete;
 	SharedStorage &operator=(SharedStorage &&) = delete;
 
-	template <typename T, typename... Tags>
-	std::shared_ptr<T> GetOrNull(Tags &&...tags)
+	template <typename T>
+	std::shared_ptr<T> GetOrNull(StorageKey<T> key)
 	{
-		auto key = MakeKey<T>(std::forward<Tags>(tags)...);
-		if (auto cached = ThreadLocalCache<T>::Get(key)) { return cached; }
+		if (auto cached = ThreadLocalCache<T>::Get(key.value())) { return cached; }
 
 		std::shared_lock guard(M_mutex);
-		auto it = M_storage.find(key);
+		auto it = M_storage.find(key.value());
 		if (it != M_storage.end()) {
-			if (it->second.type != ConstexprGetType<T>()) { throw std::runtime_error("Type mismatch for key: [" + key + "]"); }
+			CheckType<T>(key.value(), it->second);
 			return std::static_pointer_cast<T>(it->second.value);
 		}
 		return nullptr;
 	}
 
-	template <typename T, typename... Tags>
-	std::shared_ptr<T> GetOrCreate(Tags &&...tags)
+	template <typename T>
+	std::shared_ptr<T> GetOrCreate(StorageKey<T> key)
 	{
-		auto key = MakeKey<T>(std::forward<Tags>(tags)...);
-		if (auto cached = ThreadLocalCache<T>::Get(key)) { return cached; }
-
-		std::unique_lock guard(M_mutex);
-		auto &entry = M_storage[key];
-		if (!entry.value) {
-			INC(shared_misses);
-			entry.type = ConstexprGetType<T>();
-			entry.value = std::make_shared<T>();
-		} else {
-			INC(shared_hits);
-			if (entry.type != ConstexprGetType<T>()) { throw std::runtime_error("Type mismatch for key: [" + key + "]"); }
+		if (auto cached = ThreadLocalCache<T>::Get(key.value())) { return cached; }
+
+		{
+			std::shared_lock guard(M_mutex);
+			auto it = M_storage.find(key.value());
+			if (it != M_storage.end() && it->second.value) {
+				INC(shared_hits);
+				CheckType<T>(key.value(), it->second);
+				if (!it->second.deletable) { ThreadLocalCache<T>::Set(key.value(), std::static_pointer_cast<T>(it->second.value)); }
+				return std::static_pointer_cast<T>(it->second.value);
+			}
 		}
 
-		if (!entry.deletable) { ThreadLocalCache<T>::Set(key, std::static_pointer_cast<T>(entry.value)); }
+		std::unique_lock guard(M_mutex);
+		auto &entry = Create<T>(key.value());
+		if (!entry.deletable) { ThreadLocalCache<T>::Set(key.value(), std::static_pointer_cast<T>(entry.value)); }
 
 		return std::static_pointer_cast<T>(entry.value);
 	}
 
-	template <typename T, typename... Tags>
-	bool Has(Tags &&...tags)
+	// Like GetOrCreate(), but returns a handle that later lookups can use instead of the key.
+	template <typename T>
+	StorageHandle<T> Resolve(StorageKey<T> key)
 	{
-		auto key = MakeKey<T>(std::forward<Tags>(tags)...);
-		if (ThreadLocalCache<T>::Has(key)) { return true; }
+		{
+			std::shared_lock guard(M_mutex);
+			auto it = M_storage.find(key.value());
+			if (it != M_storage.end() && it->second.value && it->second.erased) {
+				CheckType<T>(key.value(), it->second);
+				return StorageHandle<T>(std::static_pointer_cast<T>(it->second.value), it->second.erased);
+			}
+		}
+
+		std::unique_lock guard(M_mutex);
+		auto &entry = Create<T>(key.value());
+		if (!entry.erased) { entry.erased = std::make_shared<std::atomic<bool>>(false); }
+		return StorageHandle<T>(std::static_pointer_cast<T>(entry.value), entry.erased);
+	}
+
+	template <typename T>
+	bool Has(StorageKey<T> key)
+	{
+		if (ThreadLocalCache<T>::Has(key.value())) { return true; }
 
 		std::shared_lock guard(M_mutex);
-		auto it = M_storage.find(key);
+		auto it = M_storage.find(key.value());
 		return it != M_storage.end() && it->second.type == ConstexprGetType<T>();
 	}
 
-	template <typename T, typename... Tags>
-	bool Delete(Tags &&...tags)
+	template <typename T>
+	bool Delete(StorageKey<T> key)
 	{
-		auto key = MakeKey<T>(std::forward<Tags>(tags)...);
-
 		std::unique_lock guard(M_mutex);
-		auto it = M_storage.find(key);
+		auto it = M_storage.find(key.value());
 		if (it != M_storage.end()) {
-			if (it->second.type != ConstexprGetType<T>()) { throw std::runtime_error("Type mismatch for key: [" + key + "]"); }
+			CheckType<T>(key.value(), it->second);
 			if (it->second.deletable) {
+				if (it->second.erased) { it->second.erased->store(true, std::memory_order_release); }
+				bool reloadable = it->second.reloadable;
 				M_storage.erase(it);
+				if (reloadable) { ReloadGeneration().fetch_add(1, std::memory_order_release); } // Drop the cached versions
 				return true;
 			} else {
-				throw std::runtime_error("Attempted to delete a non-deletable value for key: [" + key + "]");
+				throw std::runtime_error("Attempted to delete a non-deletable value for key: [" + KeyName(key.value()) + "]");
 			}
 		}
 		return false;
 	}
 
-	template <typename T, typename... Tags>
-	void Deletable(Tags &&...tags)
+	template <typename T>
+	void Deletable(StorageKey<T> key)
 	{
-		auto key = MakeKey<T>(std::forward<Tags>(tags)...);
 		std::unique_lock guard(M_mutex);
-		auto it = M_storage.find(key);
+		auto it = M_storage.find(key.value());
 		if (it != M_storage.end()) {
-			if (it->second.type != ConstexprGetType<T>()) { throw std::runtime_error("Type mismatch for key: [" + key + "]"); }
+			CheckType<T>(key.value(), it->second);
 			it->second.deletable = true;
 		} else {
-			auto &entry = M_storage[key];
-			entry.type = key;
+			auto &entry = M_storage[key.value()];
+			entry.type = ConstexprGetType<T>();
 			entry.deletable = true;
 		}
 	}
 
 	template <typename T, typename... Tags>
-	std::shared_ptr<T> GetOrNull_Reloadable(Tags &&...tags)
+	std::shared_ptr<T> GetOrNull(Tags &&...tags)
 	{
-		using U = Reloadable<T>;
-		auto key = MakeKey<U>(std::forward<Tags>(tags)...);
-		if (auto cached = ThreadLocalCache<U>::Get(key)) { return cached; }
+		return GetOrNull(StorageKey<T>(tags...));
+	}
 
-		std::shared_lock guard(M_mutex);
-		auto it = M_storage.find(key);
-		if (it != M_storage.end()) {
-			if (it->second.type != ConstexprGetType<U>()) { throw std::runtime_error("Type mismatch for key: [" + key + "]"); }
-			return std::static_pointer_cast<U>(it->second.value)->which();
-		}
-		return nullptr;
+	template <typename T, typename... Tags>
+	std::shared_ptr<T> GetOrCreate(Tags &&...tags)
+	{
+		return GetOrCreate(StorageKey<T>(tags...));
 	}
 
 	template <typename T, typename... Tags>
-	std::shared_ptr<T> GetOrCreate_Reloadable(time_t interval, Tags &&...tags)
+	StorageHandle<T> Resolve(Tags &&...tags)
 	{
-		using U = Reloadable<T>;
-		auto key = MakeKey<U>(std::forward<Tags>(tags)...);
-		if (auto cached = ThreadLocalCache<U>::Get(key)) { return cached->which(); }
-		++shared_hits;
+		return Resolve(StorageKey<T>(tags...));
+	}
 
-		std::unique_lock guard(M_mutex);
-		auto &entry = M_storage[key];
-		if (!entry.value) {
-			auto value = std::make_shared<U>(interval);
-			entry.type = ConstexprGetType<U>();
-			entry.value = value;
-			entry.reloadable = true;
-			ReloadableManager::Singlon().AddReloadable(value);
-		} else {
-			INC(shared_hits);
-			if (entry.type != ConstexprGetType<U>()) { throw std::runtime_error("Type mismatch for key: [" + key + "]"); }
-		}
+	template <typename T, typename... Tags>
+	bool Has(Tags &&...tags)
+	{
+		return Has(StorageKey<T>(tags...));
+	}
 
-		if (!entry.deletable) { ThreadLocalCache<U>::Set(key, std::static_pointer_cast<U>(entry.value)); }
+	template <typename T, typename... Tags>
+	bool Delete(Tags &&...tags)
+	{
+		return Delete(StorageKey<T>(tags...));
+	}
 
-		return std::static_pointer_cast<U>(entry.value)->which();
+	template <typename T, typename... Tags>
+	void Deletable(Tags &&...tags)
+	{
+		Deletable(StorageKey<T>(tags...));
 	}
 
 	template <typename T, typename... Tags>
-	bool Has_Reloadable(Tags &&...tags)
+	std::shared_ptr<T> GetOrNull_Reloadable(Tags &&...tags)
 	{
 		using U = Reloadable<T>;
-		auto key = MakeKey<U>(std::forward<Tags>(tags)...);
-		if (ThreadLocalCache<U>::Has(key)) { return true; }
+		const StorageKey<U> key(tags...);
+		auto &view = ReloadableViews<T>::Get(key.value());
+		if (GODBY_LIKELY(view.value && view.generation == ReloadGeneration().load(std::memory_order_relaxed))) { return view.value; }
+
+		auto reloadable = GetOrNull(key);
+		if (!reloadable) { return nullptr; }
+		ReloadableViews<T>::Load(view, *reloadable);
+		return view.value;
+	}
 
-		std::shared_lock guard(M_mutex);
-		auto it = M_storage.find(key);
-		return it != M_storage.end() && it->second.type == ConstexprGetType<U>();
+	template <typename T, typename... Tags>
+	std::shared_ptr<T> GetOrCreate_Reloadable(Tags &&...tags)
+	{
+		using U = Reloadable<T>;
+		const StorageKey<U> key(tags...);
+		auto &view = ReloadableViews<T>::Get(key.value());
+		if (GODBY_LIKELY(view.value && view.generation == ReloadGeneration().load(std::memory_order_relaxed))) { return view.value; }
+
+		ReloadableViews<T>::Load(view, *GetOrCreate(key));
+		return view.value;
+	}
+
+	// Replace the value of a Reloadable, threads see it on their next lookup.
+	template <typename T, typename... Tags>
+	void Publish_Reloadable(SharedPtr<T> value, Tags &&...tags)
+	{
+		GetOrCreate(StorageKey<Reloadable<T>>(tags...))->publish(std::move(value));
+	}
+
+	template <typename T, typename... Tags>
+	bool Has_Reloadable(Tags &&...tags)
+	{
+		return Has(StorageKey<Reloadable<T>>(tags...));
 	}
 
   private:
 	struct Entry {
 		std::string_view type;
 		std::shared_ptr<void> value;
+		std::shared_ptr<std::atomic<bool>> erased; // Shared with the handles, set when deleted
 		bool deletable = false;
 		bool reloadable = false;
 	};
-	std::shared_mutex M_mutex;
-	std::unordered_map<std::string, Entry> M_storage;
+
+	template <typename T>
+	struct IsReloadable : std::false_type {};
+
+	template <typename T>
+	struct IsReloadable<Reloadable<T>> : std::true_type {};
+
+	static std::string KeyName(uint64_t key)
+	{
+		char name[19];
+		snprintf(name, sizeof(name), "0x%016llx", static_cast<unsigned long long>(key));
+		return name;
+	}
+
+	// Keys carry the type, so this only trips on a 64-bit hash collision.
+	template <typename T>
+	static void CheckType(uint64_t key, const Entry &entry)
+	{
+		if (GODBY_UNLIKELY(entry.type != ConstexprGetType<T>())) { throw std::runtime_error("Type mismatch for key: [" + KeyName(key) + "]"); }
+	}
+
+	// Called with the unique lock held.
+	template <typename T>
+	Entry &Create(uint64_t key)
+	{
+		auto &entry = M_storage[key];
+		if (!entry.value) {
+			INC(shared_misses);
+			entry.type = ConstexprGetType<T>();
+			entry.value = std::make_shared<T>();
+			entry.reloadable = IsReloadable<T>::value;
+		} else {
+			INC(shared_hits);
+			CheckType<T>(key, entry);
+		}
+		return entry;
+	}
+
+	DistributedSharedMutex<> M_mutex; // Lookups from many threads must not share the reader count
+	std::unordered_map<uint64_t, Entry> M_storage;
 };
 } // namespace godby
@@ -1,36 +1,76 @@
 #pragma once
 
-#include <vector>			   // std::vector
-#include <variant>			   // std::variant
-#include <functional>		   // std::function
-#include <unordered_map>	   // std::unordered_map
-#include <godby/Spinlock.h>	   // godby::Spinlock
-#include <godby/Portability.h> // Portability
+#include <atomic>					   // std::atomic
+#include <thread>					   // std::thread
+#include <vector>					   // std::vector
+#include <variant>					   // std::variant
+#include <functional>				   // std::function
+#include <unordered_map>			   // std::unordered_map
+#include <signal.h>					   // sigset_t
+#include <godby/Spinlock.h>			   // godby::Spinlock
+#include <godby/Portability.h>		   // Portability
+#include <godby/AtomicSharedPointer.h> // godby::AtomicSharedPtr
 
 namespace godby
 {
+/**
+ * Handlers are kept in a copy-on-write table: Register and Unregister copy it under a lock and
+ * publish the copy, dispatching reads a snapshot and never takes the lock.
+ *
+ * Signals reach the handlers in one of two ways:
+ *  - Install(sig): a classic signal handler runs them in signal context, on whichever thread was
+ *    interrupted.
+ *  - Block(sig): the signal is blocked and queued on a signalfd instead, the handlers run when
+ *    Dispatch() drains it, from an event loop polling Fd() or from the thread StartDispatcher()
+ *    starts. Nothing runs in signal context and no thread is interrupted. Block from main before
+ *    starting other threads, they inherit the mask; send with kill(), a signal raise()d by another
+ *    thread is pending on that thread only.
+ */
 class Signal {
   public:
 	static int Install(int sig);
 
+	static int Block(int sig);
+
 	static int Register(std::function<void(int)> handler);
 
 	static int Register(int sig, std::function<void()> handler);
 
 	static int Unregister(int id, const char *file = __builtin_FILE(), int line = __builtin_LINE());
 
+	// The non-blocking signalfd of the blocked signals, -1 until the first Block().
+	static int Fd();
+
+	// Run the handlers of every blocked signal pending, returns how many or -errno.
+	static int Dispatch();
+
+	static int StartDispatcher();
+
+	static void StopDispatcher();
+
   private:
+	struct Table {
+		std::unordered_map<int, std::vector<int>> handlers_by_sig;
+		std::unordered_map<int, std::variant<std::function<void()>, std::function<void(int)>>> id_to_handler;
+	};
+
 	int id = 0;
-	godby::Spinlock lock;
-	std::unordered_map<int, std::vector<int>> handlers_by_sig;
-	std::unordered_map<int, std::variant<std::function<void()>, std::function<void(int)>>> id_to_handler;
+	godby::Spinlock lock; // Serializes writers of the table, and of the signalfd
+	godby::AtomicSharedPtr<Table> table;
+	sigset_t blocked;
+	std::atomic<int> signal_fd{-1};
+	int stop_fd = -1;
+	std::thread dispatcher;
 
-	Signal() = default;
-	~Signal() = default;
+	Signal();
+	~Signal();
 
 	static Signal &Instance();
 	static void sig_handler(int sig);
 
+	template <typename Update>
+	void Modify(Update &&update);
+
 	int Add(std::function<void(int)> handler);
 
 	int Add(int sig, std::function<void()> handler);
@@ -0,0 +1,318 @@
+#pragma once
+
+#include <algorithm>		   // std::min, std::max
+#include <atomic>			   // std::atomic
+#include <cstddef>			   // size_t
+#include <cstdint>			   // uintptr_t
+#include <mutex>			   // std::lock_guard
+#include <new>				   // std::align_val_t, std::bad_alloc
+#include <type_traits>		   // std::true_type
+#include <utility>			   // std::exchange, std::swap
+#include <sys/mman.h>		   // mmap, munmap, madvise
+#include <godby/Portability.h> // Portability
+#include <godby/Spinlock.h>	   // godby::Spinlock
+
+#if defined(__SANITIZE_ADDRESS__)
+#include <sanitizer/lsan_interface.h> // __lsan_register_root_region
+#define GODBY_SLAB_ROOT_REGION(p, size) __lsan_register_root_region(p, size)
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#include <sanitizer/lsan_interface.h> // __lsan_register_root_region
+#define GODBY_SLAB_ROOT_REGION(p, size) __lsan_register_root_region(p, size)
+#endif
+#endif
+#ifndef GODBY_SLAB_ROOT_REGION
+#define GODBY_SLAB_ROOT_REGION(p, size)
+#endif
+
+static_assert(__cplusplus >= 202002L, "Requires C++20 or higher");
+
+//! SlabAllocator
+namespace godby
+{
+namespace details
+{
+// A free block. The first block of a batch on the depot also links the next batch, with the
+// length of its own batch in the top 16 bits, which user space pointers leave clear.
+struct SlabBlock {
+	SlabBlock *next;
+	std::atomic<uintptr_t> batch;
+};
+
+inline constexpr unsigned int SLAB_TAG_SHIFT = 48;
+
+inline uintptr_t SlabPack(SlabBlock *block, uintptr_t tag) noexcept
+{
+	return reinterpret_cast<uintptr_t>(block) | (tag << SLAB_TAG_SHIFT);
+}
+
+inline SlabBlock *SlabPointer(uintptr_t packed) noexcept
+{
+	return reinterpret_cast<SlabBlock *>(packed & ((uintptr_t(1) << SLAB_TAG_SHIFT) - 1));
+}
+
+inline uintptr_t SlabTag(uintptr_t packed) noexcept
+{
+	return packed >> SLAB_TAG_SHIFT;
+}
+
+/**
+ * @class: SlabPool
+ * @brief: Blocks of one size class, shared by every type that rounds up to it.
+ *
+ * Each thread keeps two magazines of up to BATCH blocks: allocating pops the loaded one, freeing
+ * pushes it, and the two swap when one runs dry or full. Only then does the thread go to the
+ * depot, a lock-free stack of whole batches (tagged against ABA), to trade a batch at once; a
+ * block freed by another thread than the one that allocated it just joins that thread's
+ * magazine. Batches are carved from slabs mapped on demand and never unmapped, which is what
+ * lets the depot read a batch that was popped concurrently.
+ */
+template <size_t BlockSize, size_t Align, bool HugePages>
+class SlabPool {
+	static_assert(BlockSize >= sizeof(SlabBlock) && BlockSize % Align == 0, "Blocks must hold a free block and keep the alignment");
+
+	struct Slab {
+		char *base;
+		size_t capacity;
+		std::atomic<size_t> used{0};
+	};
+
+	struct Magazine {
+		SlabBlock *head = nullptr;
+		size_t count = 0;
+	};
+
+	struct Cache {
+		Magazine loaded;
+		Magazine spare; // Empty or full
+
+		~Cache()
+		{
+			// The thread exits, its blocks go back for the others
+			if (loaded.count) { PushBatch(loaded); }
+			if (spare.count) { PushBatch(spare); }
+			M_exited = true;
+		}
+	};
+
+  public:
+	static constexpr size_t SLAB_SIZE = HugePages ? (size_t(2) << 20) : (size_t(256) << 10);
+	static constexpr size_t BATCH = std::min<size_t>(std::max<size_t>((size_t(16) << 10) / BlockSize, 8), 256);
+
+	static void *Allocate()
+	{
+		if (GODBY_UNLIKELY(M_exited)) { return AllocateExited(); }
+		Cache &cache = Local();
+		if (GODBY_UNLIKELY(cache.loaded.count == 0)) { Refill(cache); }
+		--cache.loaded.count;
+		return std::exchange(cache.loaded.head, cache.loaded.head->next);
+	}
+
+	static void Deallocate(void *p) noexcept
+	{
+		if (GODBY_UNLIKELY(M_exited)) {
+			Magazine single{new (p) SlabBlock{nullptr, 0}, 1};
+			PushBatch(single);
+			return;
+		}
+		Cache &cache = Local();
+		if (GODBY_UNLIKELY(cache.loaded.count == BATCH)) {
+			if (cache.spare.count) { PushBatch(cache.spare); }
+			cache.spare = std::exchange(cache.loaded, Magazine{});
+		}
+		cache.loaded.head = new (p) SlabBlock{cache.loaded.head, 0};
+		++cache.loaded.count;
+	}
+
+  private:
+	static inline std::atomic<uintptr_t> M_depot{0};
+	static inline std::atomic<Slab *> M_current{nullptr};
+	static inline godby::Spinlock M_slab_lock; // Serializes mapping slabs
+	static inline thread_local bool M_exited = false; // The cache of this thread is gone, from other thread_local destructors
+
+	static Cache &Local() noexcept
+	{
+		thread_local Cache cache;
+		return cache;
+	}
+
+	GODBY_NOINLINE static void Refill(Cache &cache)
+	{
+		if (cache.spare.count) {
+			std::swap(cache.loaded, cache.spare);
+			return;
+		}
+		if (PopBatch(cache.loaded)) { return; }
+		Carve(cache.loaded);
+	}
+
+	static void PushBatch(Magazine &magazine) noexcept
+	{
+		SlabBlock *first = std::exchange(magazine.head, nullptr);
+		uintptr_t count = std::exchange(magazine.count, 0);
+		uintptr_t head = M_depot.load(std::memory_order_relaxed);
+		do {
+			first->batch.store(SlabPack(SlabPointer(head), count), std::memory_order_relaxed);
+		} while (!M_depot.compare_exchange_weak(head, SlabPack(first, (SlabTag(head) + 1) & 0xffff), std::memory_order_release, std::memory_order_relaxed));
+	}
+
+	GODBY_NOINLINE static void *AllocateExited()
+	{
+		Magazine magazine;
+		if (!PopBatch(magazine)) { Carve(magazine); }
+		void *block = std::exchange(magazine.head, magazine.head->next);
+		if (--magazine.count) { PushBatch(magazine); }
+		return block;
+	}
+
+	static bool PopBatch(Magazine &magazine) noexcept
+	{
+		uintptr_t head = M_depot.load(std::memory_order_acquire);
+		while (SlabBlock *first = SlabPointer(head)) {
+			// Stale if another thread popped the batch meanwhile, then the tag fails the CAS
+			uintptr_t link = first->batch.load(std::memory_order_relaxed);
+			if (M_depot.compare_exchange_weak(head, SlabPack(SlabPointer(link), (SlabTag(head) + 1) & 0xffff), std::memory_order_acquire, std::memory_order_acquire)) {
+				magazine.head = first;
+				magazine.count = SlabTag(link);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	static void Carve(Magazine &magazine)
+	{
+		for (;;) {
+			Slab *slab = M_current.load(std::memory_order_acquire);
+			if (slab != nullptr) {
+				size_t offset = slab->used.fetch_add(BATCH * BlockSize, std::memory_order_relaxed);
+				if (offset < slab->capacity) {
+					size_t count = std::min(BATCH, (slab->capacity - offset) / BlockSize);
+					char *begin = slab->base + offset;
+					SlabBlock *head = nullptr;
+					for (size_t i = count; i-- > 0;) { head = new (begin + i * BlockSize) SlabBlock{head, 0}; }
+					magazine.head = head;
+					magazine.count = count;
+					return;
+				}
+			}
+
+			std::lock_guard guard(M_slab_lock);
+			if (M_current.load(std::memory_order_relaxed) != slab) { continue; } // Another thread mapped one
+			M_current.store(MapSlab(), std::memory_order_release);
+		}
+	}
+
+	static Slab *MapSlab()
+	{
+		void *region = MAP_FAILED;
+		if constexpr (HugePages) { region = mmap(nullptr, SLAB_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0); }
+		if (region == MAP_FAILED) {
+			if constexpr (HugePages) {
+				// No reserved huge pages, ask for transparent ones on an aligned mapping instead
+				void *wide = mmap(nullptr, 2 * SLAB_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+				if (wide == MAP_FAILED) { throw std::bad_alloc(); }
+				auto start = reinterpret_cast<uintptr_t>(wide);
+				auto aligned = (start + SLAB_SIZE - 1) & ~(SLAB_SIZE - 1);
+				if (aligned > start) { munmap(wide, aligned - start); }
+				munmap(reinterpret_cast<void *>(aligned + SLAB_SIZE), start + SLAB_SIZE - aligned);
+				region = reinterpret_cast<void *>(aligned);
+				madvise(region, SLAB_SIZE, MADV_HUGEPAGE);
+			} else {
+				region = mmap(nullptr, SLAB_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+				if (region == MAP_FAILED) { throw std::bad_alloc(); }
+			}
+		}
+
+		GODBY_SLAB_ROOT_REGION(region, SLAB_SIZE); // Leak checkers do not scan mmap, what live blocks point to is not leaked
+		constexpr size_t alignment = std::max<size_t>(Align, CACHE_LINE_SIZE);
+		auto start = reinterpret_cast<uintptr_t>(region);
+		auto base = (start + sizeof(Slab) + alignment - 1) & ~(alignment - 1);
+		return new (region) Slab{reinterpret_cast<char *>(base), (start + SLAB_SIZE - base) / BlockSize * BlockSize};
+	}
+};
+} // namespace details
+
+/**
+ * @class: SlabAllocator
+ * @brief: Thread-caching slab allocator, usable as a std allocator.
+ *
+ * Single objects come from the SlabPool of their size class: no lock and no shared write on the
+ * fast path, and a CAS per BATCH blocks on the slow one. Arrays and objects too large for a slab
+ * go to operator new. With HugePages, slabs are 2MiB huge pages, MAP_HUGETLB when some are
+ * reserved and transparent huge pages otherwise.
+ *
+ *     std::list<Order, godby::SlabAllocator<Order>> orders;
+ *
+ *     struct Node {
+ *         static void *operator new(size_t) { return godby::SlabAllocator<Node>::Allocate(); }
+ *         static void operator delete(void *p) noexcept { godby::SlabAllocator<Node>::Deallocate(p); }
+ *     };
+ */
+template <typename T, bool HugePages = false>
+class SlabAllocator {
+	static constexpr size_t ALIGN = std::max<size_t>(alignof(T), 16);
+	static constexpr size_t BLOCK_SIZE = (std::max(sizeof(T), sizeof(details::SlabBlock)) + ALIGN - 1) / ALIGN * ALIGN;
+	static constexpr bool SLABBED = BLOCK_SIZE <= 4096;
+
+	using Pool = details::SlabPool<BLOCK_SIZE, ALIGN, HugePages>;
+
+  public:
+	using value_type = T;
+	using is_always_equal = std::true_type;
+	using propagate_on_container_move_assignment = std::true_type;
+
+	template <typename U>
+	struct rebind {
+		using other = SlabAllocator<U, HugePages>;
+	};
+
+	SlabAllocator() noexcept = default;
+
+	template <typename U>
+	SlabAllocator(const SlabAllocator<U, HugePages> &) noexcept
+	{
+	}
+
+	// Storage for one T, from the calling thread's magazine.
+	static void *Allocate()
+	{
+		if constexpr (SLABBED) {
+			return Pool::Allocate();
+		} else {
+			return ::operator new(sizeof(T), std::align_val_t{alignof(T)});
+		}
+	}
+
+	// From any thread.
+	static void Deallocate(void *p) noexcept
+	{
+		if constexpr (SLABBED) {
+			Pool::Deallocate(p);
+		} else {
+			::operator delete(p, std::align_val_t{alignof(T)});
+		}
+	}
+
+	T *allocate(size_t n)
+	{
+		if (GODBY_LIKELY(n == 1)) { return static_cast<T *>(Allocate()); }
+		return static_cast<T *>(::operator new(n * sizeof(T), std::align_val_t{alignof(T)}));
+	}
+
+	void deallocate(T *p, size_t n) noexcept
+	{
+		if (GODBY_LIKELY(n == 1)) {
+			Deallocate(p);
+		} else {
+			::operator delete(p, std::align_val_t{alignof(T)});
+		}
+	}
+
+	template <typename U>
+	bool operator==(const SlabAllocator<U, HugePages> &) const noexcept
+	{
+		return true;
+	}
+};
+} // namespace godby
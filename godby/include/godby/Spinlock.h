@@ -1,10 +1,21 @@
 #pragma once
 
+#include <algorithm>		   // std::min
 #include <atomic>			   // std::atomic
+#include <concepts>			   // std::convertible_to
+#include <utility>			   // std::exchange
 #include <godby/Portability.h> // Portability
 
 namespace godby
 {
+// The standard Lockable requirement, what executors and signals accept as their lock.
+template <typename L>
+concept Lockable = requires(L &l) {
+	{ l.lock() };
+	{ l.try_lock() } -> std::convertible_to<bool>;
+	{ l.unlock() };
+};
+
 class Spinlock final {
   public:
 	inline void lock()
@@ -16,6 +27,12 @@ class Spinlock final {
 		}
 	}
 
+	inline bool try_lock()
+	{
+		bool expected = false;
+		return M_locked.compare_exchange_strong(expected, true, std::memory_order_acquire);
+	}
+
 	inline void unlock()
 	{
 		M_locked.store(false, std::memory_order_release);
@@ -24,4 +41,143 @@ class Spinlock final {
   protected:
 	std::atomic<bool> M_locked{false};
 };
+
+/**
+ * Test-and-test-and-set spinlock with exponential backoff.
+ *
+ * Waiters spin on a plain load, so the line stays shared in their caches until the owner releases
+ * it, and only then race with an exchange. Losers back off for twice as many pauses as last time,
+ * up to MaxBackoff, which spreads the retries out when many threads contend.
+ */
+template <unsigned MaxBackoff = 1024>
+class TtasSpinlock final {
+  public:
+	inline void lock() noexcept
+	{
+		unsigned backoff = 1;
+		while (M_locked.exchange(true, std::memory_order_acquire)) {
+			do {
+				for (unsigned i = 0; i < backoff; ++i) { spin_loop_pause(); }
+				backoff = std::min(backoff * 2, MaxBackoff);
+			} while (M_locked.load(std::memory_order_relaxed));
+		}
+	}
+
+	inline bool try_lock() noexcept
+	{
+		return !M_locked.load(std::memory_order_relaxed) && !M_locked.exchange(true, std::memory_order_acquire);
+	}
+
+	inline void unlock() noexcept
+	{
+		M_locked.store(false, std::memory_order_release);
+	}
+
+  private:
+	std::atomic<bool> M_locked{false};
+};
+
+namespace details
+{
+struct alignas(CACHE_LINE_SIZE) McsNode {
+	std::atomic<McsNode *> next{nullptr};
+	std::atomic<bool> locked{false};
+	McsNode *free_next{nullptr};
+};
+
+// Nodes of the calling thread, one per MCS lock it holds or waits for.
+struct McsNodeCache {
+	~McsNodeCache()
+	{
+		while (head) { delete std::exchange(head, head->free_next); }
+	}
+
+	McsNode *get()
+	{
+		if (!head) { return new McsNode{}; }
+		return std::exchange(head, head->free_next);
+	}
+
+	void put(McsNode *node) noexcept
+	{
+		node->free_next = head;
+		head = node;
+	}
+
+	McsNode *head{nullptr};
+};
+} // namespace details
+
+/**
+ * MCS queue lock: fair (FIFO) and each waiter spins on its own cache line.
+ *
+ * A waiter appends a node to the queue with a single exchange on the tail and spins on a flag in
+ * that node, which its predecessor clears when unlocking, so a release touches one waiter's line
+ * instead of invalidating every spinner. Nodes come from a per-thread cache, so lock() takes no
+ * argument and the lock fits std::lock_guard.
+ *
+ * The thread that locked must be the one that unlocks.
+ */
+class McsLock final {
+  public:
+	McsLock() = default;
+	McsLock(const McsLock &) = delete;
+	McsLock &operator=(const McsLock &) = delete;
+
+	inline void lock()
+	{
+		details::McsNode *node = Cache().get();
+		node->next.store(nullptr, std::memory_order_relaxed);
+		node->locked.store(true, std::memory_order_relaxed);
+
+		details::McsNode *pred = M_tail.exchange(node, std::memory_order_acq_rel);
+		if (pred) {
+			pred->next.store(node, std::memory_order_release);
+			while (node->locked.load(std::memory_order_acquire)) { spin_loop_pause(); }
+		}
+		M_owner = node;
+	}
+
+	inline bool try_lock()
+	{
+		details::McsNode *node = Cache().get();
+		node->next.store(nullptr, std::memory_order_relaxed);
+
+		details::McsNode *expected = nullptr;
+		if (!M_tail.compare_exchange_strong(expected, node, std::memory_order_acquire, std::memory_order_relaxed)) {
+			Cache().put(node);
+			return false;
+		}
+		M_owner = node;
+		return true;
+	}
+
+	inline void unlock() noexcept
+	{
+		details::McsNode *node = M_owner;
+		details::McsNode *next = node->next.load(std::memory_order_acquire);
+		if (!next) {
+			details::McsNode *expected = node;
+			if (M_tail.compare_exchange_strong(expected, nullptr, std::memory_order_release, std::memory_order_relaxed)) {
+				Cache().put(node);
+				return;
+			}
+			// A waiter swapped the tail but has not linked itself yet
+			while (!(next = node->next.load(std::memory_order_acquire))) { spin_loop_pause(); }
+		}
+		next->locked.store(false, std::memory_order_release);
+		Cache().put(node);
+	}
+
+  private:
+	alignas(CACHE_LINE_SIZE) std::atomic<details::McsNode *> M_tail{nullptr};
+	details::McsNode *M_owner{nullptr}; // Only accessed by the thread holding the lock
+
+	// Function-local: a thread_local static member next to another header's trips GCC 12 (duplicate __tls_guard)
+	static details::McsNodeCache &Cache() noexcept
+	{
+		thread_local details::McsNodeCache cache;
+		return cache;
+	}
+};
 } // namespace godby
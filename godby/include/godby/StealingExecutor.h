@@ -1,17 +1,27 @@
 #pragma once
 
+#include <algorithm>			 // std::max
 #include <cstddef>				 // std::size_t
+#include <csignal>				 // SIGINT
 #include <atomic>				 // std::atomic
+#include <chrono>				 // std::chrono::steady_clock
+#include <cstdint>				 // uint64_t
+#include <functional>			 // std::function
 #include <thread>				 // std::this_thread
-#include <utility>				 // std::forward
+#include <utility>				 // std::forward, std::index_sequence
 #include <vector>				 // std::vector
 #include <mutex>				 // std::mutex
 #include <condition_variable>	 // std::condition_variable
+#include <memory>				 // std::unique_ptr
+#include <optional>				 // std::optional
+#include <array>				 // std::array
 #include <godby/Atomic.h>		 // godby::Atomic
+#include <godby/EventCount.h>	 // godby::EventCount
 #include <godby/Math.h>			 // godby::NextPowerOfTwo
-#include <godby/Spinlock.h>		 // godby::Spinlock
+#include <godby/Spinlock.h>		 // godby::TtasSpinlock
 #include <godby/Signal.h>		 // godby::Signal
 #include <godby/StealingQueue.h> // godby::StealingQueue
+#include <godby/Topology.h>		 // godby::CpuTopology
 
 static_assert(__cplusplus >= 202002L, "Requires C++20 or higher");
 
@@ -23,6 +33,10 @@ namespace details
 class NonLock final {
   public:
 	inline void lock() {}
+	inline bool try_lock()
+	{
+		return true;
+	}
 	inline void unlock() {}
 };
 } // namespace details
@@ -81,22 +95,102 @@ class WaitGroup {
  *
  * This class implements the work stealing queue based multi-threading pool.
  *
- * Only the executor owner can perform Submit operation.
+ * Every worker owns a StealingQueue: tasks submitted from a worker (e.g. from Consume) go to its
+ * own deque, which it pops from the bottom, tasks submitted by the owner go to the shared deque.
+ * Workers without local work steal from the shared deque, then from random victims.
+ *
+ * Spawned with a CpuTopology, worker i is pinned to the i-th CPU of it and steals hierarchically:
+ * from workers on SMT siblings of its core first, then from workers on the same NUMA node, and
+ * only then across nodes. Restricting the topology to a cpuset keeps the executor on those CPUs.
+ *
+ * With Config::lanes > 1 every deque is split into priority lanes, Submit(value, priority) picks one
+ * (0 is the most urgent) and workers always look for work in lower-numbered lanes first. To keep
+ * background work from starving, every Config::starvation_budget-th pick starts at a lower lane,
+ * round robin over them.
+ *
+ * Only the executor owner and its workers can perform Submit operation.
  */
 
-template <size_t MaxStealSize = 10, size_t PauseCheckGap = 4>
+template <size_t MaxStealSize = 10, size_t PauseCheckGap = 4, size_t IdleSpins = 256, size_t Lanes = 1, size_t StarvationBudget = 64, bool Metrics = true>
 struct StealingConfig {
+	static_assert(Lanes >= 1 && StarvationBudget >= 1, "Need at least one lane and a positive budget");
+
 	static constexpr size_t max_steal_size = MaxStealSize;
 	static constexpr size_t pause_check_mask = godby::NextPowerOfTwo(PauseCheckGap) - 1;
+	static constexpr size_t idle_spins = IdleSpins;				  // Polls for work before a consumer parks
+	static constexpr size_t lanes = Lanes;						  // Priority lanes, 0 is the most urgent
+	static constexpr size_t starvation_budget = StarvationBudget; // Picks a worker makes before favouring a lower lane once
+	static constexpr bool metrics = Metrics;					  // Per-worker counters, see StealingMetrics
+};
+
+// What a worker has done since it was spawned, see StealingExecutor::Metrics().
+struct StealingMetrics {
+	uint64_t executed = 0;		 // Items consumed
+	uint64_t steal_attempts = 0; // Steals tried on the owner's deque or on other workers
+	uint64_t steals = 0;		 // Steals that got at least one item
+	uint64_t stolen = 0;		 // Items those steals got
+	uint64_t parks = 0;			 // Times the worker went to sleep
+	uint64_t wakeups = 0;		 // Times the worker left its idle loop to look for work
+	uint64_t idle_ns = 0;		 // Time spent spinning or sleeping in the idle loop
+	size_t queue_depth = 0;		 // Items in the worker's deques when the snapshot was taken
+
+	StealingMetrics &operator+=(const StealingMetrics &b) noexcept
+	{
+		executed += b.executed, steal_attempts += b.steal_attempts, steals += b.steals, stolen += b.stolen;
+		parks += b.parks, wakeups += b.wakeups, idle_ns += b.idle_ns, queue_depth += b.queue_depth;
+		return *this;
+	}
+};
+
+namespace details
+{
+// Counters of a single worker: written by the worker only, so a relaxed load and store is enough,
+// and read by snapshots from any thread. Compiled to nothing when disabled.
+template <bool Enabled>
+class StealingCounters {
+  public:
+	enum Counter { EXECUTED, STEAL_ATTEMPTS, STEALS, STOLEN, PARKS, WAKEUPS, IDLE_NS, COUNT };
+
+	inline void add(Counter counter, uint64_t n = 1) noexcept
+	{
+		M_counters[counter].store(M_counters[counter].load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+	}
+
+	StealingMetrics snapshot() const noexcept
+	{
+		auto get = [this](Counter counter) { return M_counters[counter].load(std::memory_order_relaxed); };
+		StealingMetrics metrics;
+		metrics.executed = get(EXECUTED), metrics.steal_attempts = get(STEAL_ATTEMPTS), metrics.steals = get(STEALS), metrics.stolen = get(STOLEN);
+		metrics.parks = get(PARKS), metrics.wakeups = get(WAKEUPS), metrics.idle_ns = get(IDLE_NS);
+		return metrics;
+	}
+
+  private:
+	alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> M_counters[COUNT] = {};
 };
 
-template <bool Waitable = false, bool Sharing = false, typename Waiter = WaitGroup, typename ThreadType = std::thread>
+template <>
+class StealingCounters<false> {
+  public:
+	enum Counter { EXECUTED, STEAL_ATTEMPTS, STEALS, STOLEN, PARKS, WAKEUPS, IDLE_NS, COUNT };
+
+	inline void add(Counter, uint64_t = 1) noexcept {}
+
+	StealingMetrics snapshot() const noexcept
+	{
+		return {};
+	}
+};
+} // namespace details
+
+template <bool Waitable = false, bool Sharing = false, typename Waiter = WaitGroup, typename ThreadType = std::thread, Lockable Lock = TtasSpinlock<>>
 struct StealingPolicy {
 	static constexpr bool sharing = Sharing;
 	static constexpr bool waitable = Waitable;
 
 	using waiter_type = Waiter;
 	using thread_type = ThreadType;
+	using lock_type = Lock; // Serializes Submit() between threads when sharing
 
 	template <typename T>
 	using composed_type = typename std::conditional<waitable, std::tuple<waiter_type *, T>, T>::type;
@@ -170,13 +264,11 @@ class StealingExecutor {
 	StealingExecutor(size_t queue_capacity = 1024)
 		: M_pause{false},
 		  M_shutdown{false},
-		  M_should_notify{true},
-		  M_done_spinlock{false},
 		  M_owner(std::this_thread::get_id()),
 		  M_working_size{0},
 		  M_waiting_size{0},
 		  M_initialized_size{0},
-		  M_queue(godby::NextPowerOfTwo(queue_capacity))
+		  M_queues(MakeLanes(godby::NextPowerOfTwo(queue_capacity), std::make_index_sequence<Config::lanes>()))
 	{
 	}
 
@@ -185,8 +277,28 @@ class StealingExecutor {
 		Shutdown();
 	}
 
+	// Not thread-safe, call it while no worker is running.
 	void Spawn(size_t concurrency)
 	{
+		Spawn(concurrency, nullptr);
+	}
+
+	// One worker per CPU of the topology by default, wrapping around if concurrency is larger.
+	void Spawn(CpuTopology const &topology, size_t concurrency = 0)
+	{
+		Spawn(concurrency ? concurrency : topology.size(), topology.size() ? &topology : nullptr);
+	}
+
+	void Spawn(size_t concurrency, CpuTopology const *topology)
+	{
+		size_t capacity = M_queues[0].capacity();
+		for (size_t i = 0; i < concurrency; ++i) {
+			auto worker = std::make_unique<Worker>(capacity, 0x9e3779b97f4a7c15ull * (M_workers.size() + 1));
+			if (topology) { worker->cpu = topology->cpus()[i % topology->size()]; }
+			M_workers.emplace_back(std::move(worker));
+		}
+		Arrange();
+
 		for (size_t i = 0; i < concurrency; ++i) {
 			// create consumer threads
 			M_consumer_threads.emplace_back(&StealingExecutor::Consumer, this, i);
@@ -206,43 +318,24 @@ class StealingExecutor {
 	void Resume()
 	{
 		M_pause.store(false);
-		M_should_notify.store(false);
-
-		size_t wqsize = M_queue.size();
-		if (wqsize >= M_consumer_threads.size()) {
-			M_wakeup_cond.notify_all();
-		} else {
-			for (size_t i = 0; i < wqsize; i += 1) { M_wakeup_cond.notify_one(); }
-		}
+		M_idle.notify_all();
 	}
 
 	void WaitAll()
 	{
-		M_should_notify.store(true);
-
-		// tell threads to begin working
-		size_t wqsize = M_queue.size();
-		if (wqsize >= M_consumer_threads.size()) {
-			M_wakeup_cond.notify_all();
-		} else {
-			for (size_t i = 0; i < wqsize; i += 1) { M_wakeup_cond.notify_one(); }
-		}
-
 		// sleep main thread until work is done
-		std::unique_lock<std::mutex> suspend_latch(M_suspend_mutex, std::defer_lock);
-		suspend_latch.lock();
-
-		while ((!M_pause.load() && !M_queue.empty()) || M_working_size.load() != 0) { M_suspend_cond.wait(suspend_latch); }
-		suspend_latch.unlock();
-
-		// notify the notifying thread that we are awakened
-		M_done_spinlock.store(true);
+		auto busy = [this]() { return (!M_pause.load() && HasWork()) || M_working_size.load() != 0; };
+		while (busy()) {
+			auto key = M_done.prepare_wait();
+			if (!busy()) {
+				M_done.cancel_wait();
+				break;
+			}
+			M_done.wait(key);
+		}
 
 		// wait until all threads have gone back to the waiting state
 		while (M_waiting_size.load() != M_consumer_threads.size()) { std::this_thread::yield(); }
-
-		// reset previous spin lock state
-		M_done_spinlock.store(false);
 	}
 
 	void Shutdown()
@@ -257,86 +350,63 @@ class StealingExecutor {
 
 		// spin lock until all threads are going to quit, and spam notify to
 		// make sure they all get the message
-		while (M_initialized_size.load() != 0) { M_wakeup_cond.notify_all(); }
+		while (M_initialized_size.load() != 0) {
+			M_idle.notify_all();
+			std::this_thread::yield();
+		}
 
 		for (auto &consumer : M_consumer_threads) {
 			if (consumer.joinable()) { consumer.join(); }
 		}
 		M_consumer_threads.clear();
+		M_workers.clear();
 
 		M_shutdown.store(false);
 	}
 
-	void Submit(const value_type &value)
+	// A priority beyond the last lane goes to the last lane.
+	void Submit(const value_type &value, size_t priority = 0)
 	{
-		{
-			M_owner_lock.lock();
-			if constexpr (Policy::waitable) {
-				M_queue.push(std::make_tuple(nullptr, value));
-			} else {
-				M_queue.push(value);
-			}
-			M_owner_lock.unlock();
+		if constexpr (Policy::waitable) {
+			Enqueue(priority, std::make_tuple(nullptr, value));
+		} else {
+			Enqueue(priority, value);
 		}
 
-		if (!M_pause.load(std::memory_order_relaxed) && M_consumer_threads.size() - M_waiting_size.load(std::memory_order_relaxed) <= M_min_active_consumer) {
-			// No consumers are consuming, so wake one up
-			std::lock_guard<std::mutex> lock(M_wakeup_mutex);
-			M_wakeup_cond.notify_one();
-		}
+		// Wake a parked consumer, free unless one is parked
+		if (!M_pause.load(std::memory_order_relaxed)) { M_idle.notify_one(); }
 	}
 
-	void Submit(value_type &&value)
+	void Submit(value_type &&value, size_t priority = 0)
 	{
-		{
-			M_owner_lock.lock();
-			if constexpr (Policy::waitable) {
-				M_queue.push(std::make_tuple(nullptr, std::forward<value_type>(value)));
-			} else {
-				M_queue.push(std::forward<value_type>(value));
-			}
-			M_owner_lock.unlock();
+		if constexpr (Policy::waitable) {
+			Enqueue(priority, std::make_tuple(nullptr, std::forward<value_type>(value)));
+		} else {
+			Enqueue(priority, std::forward<value_type>(value));
 		}
 
-		if (!M_pause.load(std::memory_order_relaxed) && M_consumer_threads.size() - M_waiting_size.load(std::memory_order_relaxed) <= M_min_active_consumer) {
-			// No consumers are consuming, so wake one up
-			std::lock_guard<std::mutex> lock(M_wakeup_mutex);
-			M_wakeup_cond.notify_one();
-		}
+		// Wake a parked consumer, free unless one is parked
+		if (!M_pause.load(std::memory_order_relaxed)) { M_idle.notify_one(); }
 	}
 
 	template <bool Waitable = Policy::waitable>
-	typename std::enable_if<Waitable, void>::type Submit(waiter_type &waiter, const value_type &value)
+	typename std::enable_if<Waitable, void>::type Submit(waiter_type &waiter, const value_type &value, size_t priority = 0)
 	{
-		{
-			waiter.add();
-			M_owner_lock.lock();
-			M_queue.push(std::make_tuple(&waiter, value));
-			M_owner_lock.unlock();
-		}
+		waiter.add();
+		Enqueue(priority, std::make_tuple(&waiter, value));
 
-		if (!M_pause.load(std::memory_order_relaxed) && M_consumer_threads.size() - M_waiting_size.load(std::memory_order_relaxed) <= M_min_active_consumer) {
-			// No consumers are consuming, so wake one up
-			std::lock_guard<std::mutex> lock(M_wakeup_mutex);
-			M_wakeup_cond.notify_one();
-		}
+		// Wake a parked consumer, free unless one is parked
+		if (!M_pause.load(std::memory_order_relaxed)) { M_idle.notify_one(); }
 	}
 
 	template <bool Waitable = Policy::waitable>
-	typename std::enable_if<Waitable, void>::type Submit(waiter_type &waiter, value_type &&value)
+	typename std::enable_if<Waitable, void>::type Submit(waiter_type &waiter, value_type &&value, size_t priority = 0)
 	{
-		{
-			waiter.add();
-			M_owner_lock.lock();
-			M_queue.push(std::make_tuple(&waiter, std::forward<value_type>(value)));
-			M_owner_lock.unlock();
-		}
+		waiter.add();
+		Enqueue(priority, std::make_tuple(&waiter, std::forward<value_type>(value)));
 
-		if (!M_pause.load(std::memory_order_relaxed) && M_consumer_threads.size() - M_waiting_size.load(std::memory_order_relaxed) <= M_min_active_consumer) {
-			// No consumers are consuming, so wake one up
-			std::lock_guard<std::mutex> lock(M_wakeup_mutex);
-			M_wakeup_cond.notify_one();
-		}
+		// Wake a parked consumer, free unless one is parked
+		if (!M_pause.load(std::memory_order_relaxed)) { M_idle.notify_one(); }
 	}
 
 	template <typename Iterator, bool Waitable = Policy::waitable>
@@ -347,28 +417,80 @@ class StealingExecutor {
 		waiter.wait();
 	}
 
+	// Run one queued item on the calling thread, so that a thread waiting for other items keeps busy.
+	// Workers look in their own deques first, other threads only steal. An item run by a thread that
+	// is not a worker is consumed with cid == the number of workers. Returns false if nothing was found.
+	bool Help()
+	{
+		Local &local = Current();
+		bool worker = local.executor == this;
+		size_t cid = worker ? local.cid : M_workers.size();
+
+		M_working_size.fetch_add(1);
+		auto work = worker ? Next(cid) : Steal();
+		if (work.has_value()) {
+			size_t nth = 1;
+			if (worker) { M_workers[cid]->counters.add(details::StealingCounters<Config::metrics>::EXECUTED); }
+			if (Controller::Cancelled()) {
+				Callback_Cleanup(cid, nth, std::move(work.value()));
+			} else {
+				Callback_Consume(cid, nth, std::move(work.value()));
+			}
+		}
+		M_working_size.fetch_sub(1);
+		return work.has_value();
+	}
+
 	void Purge()
 	{
 		M_owner_lock.lock();
-		while (!M_queue.empty()) { M_queue.pop(); }
+		for (auto &queue : M_queues) {
+			while (!queue.empty()) { queue.pop(); }
+		}
 		M_owner_lock.unlock();
+		for (auto &worker : M_workers) {
+			for (auto &queue : worker->queues) {
+				while (!queue.empty()) { queue.steal(); }
+			}
+		}
 	}
 
 	inline bool IsEmpty()
 	{
-		return M_queue.empty() && M_working_size.load() == 0;
+		return !HasWork() && M_working_size.load() == 0;
+	}
+
+	// Per-worker counters, read while the workers keep running. Call it between Spawn() and Shutdown().
+	std::vector<StealingMetrics> Metrics() const
+	{
+		std::vector<StealingMetrics> metrics;
+		for (auto &worker : M_workers) {
+			metrics.push_back(worker->counters.snapshot());
+			for (auto &queue : worker->queues) { metrics.back().queue_depth += queue.size(); }
+		}
+		return metrics;
+	}
+
+	StealingMetrics TotalMetrics() const
+	{
+		StealingMetrics total;
+		for (auto const &metrics : Metrics()) { total += metrics; }
+		return total;
 	}
 
 	inline size_t QueueSize() const
 	{
-		return M_queue.size();
+		size_t size = 0;
+		for (auto &queue : M_queues) { size += queue.size(); }
+		for (auto &worker : M_workers) {
+			for (auto &queue : worker->queues) { size += queue.size(); }
+		}
+		return size;
 	}
 
   protected:
 	std::atomic<bool> M_pause;
 	std::atomic<bool> M_shutdown;
-	std::atomic<bool> M_should_notify;
-	std::atomic<bool> M_done_spinlock;
 
 	std::thread::id M_owner;
 	std::atomic<size_t> M_working_size;
@@ -376,19 +498,185 @@ class StealingExecutor {
 	std::atomic<size_t> M_initialized_size;
 	std::vector<typename Policy::thread_type> M_consumer_threads;
 
-	size_t M_min_active_consumer = 3;
-
 	template <bool Enabled>
-	using ConditionalSpinlock = std::conditional_t<Enabled, godby::Spinlock, details::NonLock>;
+	using ConditionalSpinlock = std::conditional_t<Enabled, typename Policy::lock_type, details::NonLock>;
 	ConditionalSpinlock<Policy::sharing> M_owner_lock;
 
-	std::mutex M_wakeup_mutex;
-	std::condition_variable M_wakeup_cond;
+	EventCount M_idle; // Consumers park here when there is no work
+	EventCount M_done; // WaitAll parks here until the last consumer runs out of work
+
+	// Steal up to half a victim's items at once, as many as a worker may run in a row.
+	static constexpr size_t steal_batch = Config::max_steal_size > 1 ? Config::max_steal_size : 1;
+	using queue_type = StealingQueue<composed_type, steal_batch>;
+	using lanes_type = std::array<queue_type, Config::lanes>;
+
+	// Deques shrink back to queue_capacity once a burst is over.
+	static queue_type MakeQueue(size_t capacity, size_t /* lane */)
+	{
+		return queue_type(capacity, true);
+	}
+
+	template <size_t... Lane>
+	static lanes_type MakeLanes(size_t capacity, std::index_sequence<Lane...>)
+	{
+		return {{MakeQueue(capacity, Lane)...}};
+	}
+
+	lanes_type M_queues; // Filled by the owner, stolen from by the workers
+
+	struct alignas(CACHE_LINE_SIZE) Worker {
+		explicit Worker(size_t capacity, uint64_t seed) : queues(MakeLanes(capacity, std::make_index_sequence<Config::lanes>())), seed(seed) {}
+
+		lanes_type queues;			// Pushed and popped by the worker only, stolen from by the others
+		uint64_t seed;				// Victim selection, xorshift
+		std::optional<CpuInfo> cpu; // Where the worker is pinned, if anywhere
+		size_t picks = 0;			// Items taken since a lower lane was last favoured
+		size_t starved = 0;			// The lower lane favoured last
+
+		details::StealingCounters<Config::metrics> counters;
+
+		// Other workers the worker steals from, closest first: victims[0, tiers[0]) share its core,
+		// victims[tiers[0], tiers[1]) its NUMA node, the rest are remote.
+		std::vector<size_t> victims;
+		size_t tiers[2] = {0, 0};
+	};
+	std::vector<std::unique_ptr<Worker>> M_workers;
+
+	struct Local {
+		StealingExecutor *executor = nullptr;
+		size_t cid = 0;
+	};
 
-	std::mutex M_suspend_mutex;
-	std::condition_variable M_suspend_cond;
+	static inline Local &Current() noexcept
+	{
+		static thread_local Local local;
+		return local;
+	}
 
-	StealingQueue<composed_type> M_queue;
+	template <typename U>
+	inline void Enqueue(size_t priority, U &&item)
+	{
+		size_t lane = priority < Config::lanes ? priority : Config::lanes - 1;
+		Local &local = Current();
+		if (local.executor == this) {
+			M_workers[local.cid]->queues[lane].push(std::forward<U>(item));
+		} else {
+			M_owner_lock.lock();
+			M_queues[lane].push(std::forward<U>(item));
+			M_owner_lock.unlock();
+		}
+	}
+
+	inline bool HasWork() const noexcept
+	{
+		for (auto &queue : M_queues) {
+			if (!queue.empty()) { return true; }
+		}
+		for (auto &worker : M_workers) {
+			for (auto &queue : worker->queues) {
+				if (!queue.empty()) { return true; }
+			}
+		}
+		return false;
+	}
+
+	// Fill in every worker's victims, ordered by distance when the workers are pinned.
+	void Arrange()
+	{
+		size_t n = M_workers.size();
+		for (size_t cid = 0; cid < n; ++cid) {
+			Worker &self = *M_workers[cid];
+			auto distance = [&](size_t other) -> int {
+				auto const &a = self.cpu, &b = M_workers[other]->cpu;
+				if (!a || !b) { return 2; }
+				return a->core == b->core ? 0 : a->node == b->node ? 1 : 2;
+			};
+
+			self.victims.clear();
+			for (int tier = 0; tier <= 2; ++tier) {
+				for (size_t other = 0; other < n; ++other) {
+					if (other != cid && distance(other) == tier) { self.victims.push_back(other); }
+				}
+				if (tier < 2) { self.tiers[tier] = self.victims.size(); }
+			}
+		}
+	}
+
+	// Run the oldest stolen item and move the others to our own deque. Fewer than steal_batch items
+	// pop oldest first, so they keep their order.
+	inline std::optional<composed_type> Steal(Worker &self, size_t lane, queue_type &victim)
+	{
+		using counters = details::StealingCounters<Config::metrics>;
+		self.counters.add(counters::STEAL_ATTEMPTS);
+		if constexpr (steal_batch == 1) {
+			auto work = victim.steal();
+			if (work.has_value()) { self.counters.add(counters::STEALS), self.counters.add(counters::STOLEN); }
+			return work;
+		} else {
+			std::optional<composed_type> items[steal_batch];
+			size_t n = victim.steal_batch(items, steal_batch);
+			if (n == 0) { return std::nullopt; }
+			for (size_t i = 1; i < n; ++i) { self.queues[lane].push(std::move(*items[i])); }
+			self.counters.add(counters::STEALS), self.counters.add(counters::STOLEN, n);
+			return std::move(items[0]);
+		}
+	}
+
+	// Steal for a thread that is not a worker: lane by lane, the owner's deque, then every worker's.
+	inline std::optional<composed_type> Steal()
+	{
+		for (size_t lane = 0; lane < Config::lanes; ++lane) {
+			auto work = M_queues[lane].steal();
+			if (work.has_value()) { return work; }
+			for (auto &worker : M_workers) {
+				work = worker->queues[lane].steal();
+				if (work.has_value()) { return work; }
+			}
+		}
+		return std::nullopt;
+	}
+
+	// Lane by lane, most urgent first unless a lower lane is due.
+	inline std::optional<composed_type> Next(size_t cid)
+	{
+		Worker &self = *M_workers[cid];
+		size_t first = 0;
+		if constexpr (Config::lanes > 1) {
+			if (++self.picks >= Config::starvation_budget) {
+				self.picks = 0;
+				self.starved = self.starved % (Config::lanes - 1) + 1;
+				first = self.starved;
+			}
+		}
+
+		self.seed ^= self.seed << 13, self.seed ^= self.seed >> 7, self.seed ^= self.seed << 17;
+		for (size_t i = 0; i < Config::lanes; ++i) {
+			size_t lane = first + i < Config::lanes ? first + i : first + i - Config::lanes;
+			auto work = Next(self, lane);
+			if (work.has_value()) { return work; }
+		}
+		return std::nullopt;
+	}
+
+	// Own deque first, then the owner's, then victims tier by tier, from a random one within each tier.
+	inline std::optional<composed_type> Next(Worker &self, size_t lane)
+	{
+		auto work = self.queues[lane].pop();
+		if (work.has_value()) { return work; }
+
+		work = Steal(self, lane, M_queues[lane]);
+		if (work.has_value()) { return work; }
+
+		size_t const bounds[] = {0, self.tiers[0], self.tiers[1], self.victims.size()};
+		for (size_t tier = 0; tier < 3; ++tier) {
+			size_t begin = bounds[tier], n = bounds[tier + 1] - begin;
+			for (size_t i = 0, k = n ? self.seed % n : 0; i < n; ++i, k = k + 1 == n ? 0 : k + 1) {
+				work = Steal(self, lane, M_workers[self.victims[begin + k]]->queues[lane]);
+				if (work.has_value()) { return work; }
+			}
+		}
+		return std::nullopt;
+	}
 
 	virtual void Consume(value_type &&) {}
 
@@ -427,10 +715,14 @@ class StealingExecutor {
 
 	virtual void Callback_Execute(size_t cid, size_t &nth)
 	{
-		auto work = M_queue.steal();
-		if (work.has_value()) {
+		// Count ourselves as working before taking the item, so WaitAll never sees the queues empty
+		// while an item is in flight outside of them.
+		M_working_size.fetch_add(1);
+		auto work = Next(cid);
+		if (!work.has_value()) {
+			M_working_size.fetch_sub(1);
+		} else {
 			++nth;
-			M_working_size.fetch_add(1);
 
 			if (Controller::Cancelled()) {
 				Callback_Cleanup(cid, nth, std::move(work.value()));
@@ -438,7 +730,7 @@ class StealingExecutor {
 				Callback_Consume(cid, nth, std::move(work.value()));
 			}
 
-			work = M_queue.steal();
+			work = Next(cid);
 			while (work.has_value()) {
 				++nth;
 
@@ -451,7 +743,7 @@ class StealingExecutor {
 					if (Callback_IsLimited(cid, nth)) { break; }
 				}
 
-				work = M_queue.steal();
+				work = Next(cid);
 			}
 
 			M_working_size.fetch_sub(1);
@@ -460,19 +752,42 @@ class StealingExecutor {
 
 	virtual void Consumer(size_t cid)
 	{
+		using counters = details::StealingCounters<Config::metrics>;
+		Current() = Local{this, cid};
+		Worker &self = *M_workers[cid];
+		if (auto const &cpu = self.cpu) { CpuTopology::Pin(cpu->cpu); }
 		Callback_Setup(cid);
 		M_initialized_size.fetch_add(1);
 
-		std::unique_lock<std::mutex> wakeup_latch(M_wakeup_mutex, std::defer_lock);
-
 		while (true) {
-			wakeup_latch.lock();
 			M_waiting_size.fetch_add(1); // tell main thread we are waiting
 
-			// sleep until we have work to do or we need to exit
-			while (M_queue.empty() && !M_shutdown.load()) { M_wakeup_cond.wait(wakeup_latch); }
+			// spin a little, then sleep until we have work to do or we need to exit
+			auto ready = [this]() { return (!M_pause.load(std::memory_order_relaxed) && HasWork()) || M_shutdown.load(); };
+			if (!ready()) {
+				std::chrono::steady_clock::time_point idle_since;
+				if constexpr (Config::metrics) { idle_since = std::chrono::steady_clock::now(); }
+				for (size_t spins = 0; !ready();) {
+					if (spins < Config::idle_spins) {
+						++spins;
+						spin_loop_pause();
+						continue;
+					}
+					auto key = M_idle.prepare_wait();
+					if (ready()) {
+						M_idle.cancel_wait();
+						break;
+					}
+					self.counters.add(counters::PARKS);
+					M_idle.wait(key);
+				}
+				if constexpr (Config::metrics) {
+					auto idle = std::chrono::steady_clock::now() - idle_since;
+					self.counters.add(counters::IDLE_NS, std::chrono::duration_cast<std::chrono::nanoseconds>(idle).count());
+				}
+			}
+			self.counters.add(counters::WAKEUPS);
 
-			wakeup_latch.unlock();
 			M_waiting_size.fetch_sub(1); // tell main thread we are no longer waiting
 
 			// exit the thread
@@ -483,20 +798,55 @@ class StealingExecutor {
 
 			// grab the queued while there is queue remaining and consume it
 			Callback_Execute(cid, nth);
+			self.counters.add(counters::EXECUTED, nth);
 
 			Callback_Suspend(cid, nth);
 
 			// if we are the last thread to finish, tell the main thread that
 			// all threads have finished
-			if (M_queue.empty() && M_working_size.load() == 0) {
-				// spin lock until we have confirmation from the main thread that
-				// it knows we are done working
-				while (M_should_notify.load() && !M_done_spinlock.load() && M_working_size.load() == 0 && M_queue.empty()) { M_suspend_cond.notify_all(); }
-			}
+			if (M_working_size.load() == 0 && !HasWork()) { M_done.notify_all(); }
 		}
 
 		Callback_Teardown(cid);
+		Current() = Local{};
 		M_initialized_size.fetch_sub(1);
 	}
 };
+
+/**
+ * @class: TaskExecutor
+ *
+ * @tparam Task callable type, invoked with no arguments
+ *
+ * @brief: waitable StealingExecutor running the submitted callables
+ *
+ * Used by data-parallel helpers such as AtomicHashmap::ParallelWalk, which submit one task per range
+ * and wait on a WaitGroup.
+ */
+template <typename Task = std::function<void()>, typename Config = DefaultStealingConfig>
+class TaskExecutor : public StealingExecutor<Task, StealingPolicy<true>, Config> {
+  public:
+	using SUPER = StealingExecutor<Task, StealingPolicy<true>, Config>;
+
+	TaskExecutor(size_t concurrency = std::thread::hardware_concurrency(), size_t queue_capacity = 1024) : SUPER(queue_capacity)
+	{
+		this->Spawn(concurrency ? concurrency : 1);
+	}
+
+	explicit TaskExecutor(CpuTopology const &topology, size_t concurrency = 0, size_t queue_capacity = 1024) : SUPER(queue_capacity)
+	{
+		this->Spawn(topology, concurrency ? concurrency : std::max<size_t>(topology.size(), 1));
+	}
+
+	~TaskExecutor() override
+	{
+		this->Shutdown(); // Workers must be gone before Consume() stops being ours.
+	}
+
+  protected:
+	void Consume(Task &&task) override
+	{
+		task();
+	}
+};
 } // namespace godby
@@ -1,26 +1,138 @@
 #pragma once
 
-#include <cstddef>		  // std::size_t
-#include <atomic>		  // std::atomic
-#include <utility>		  // std::forward
-#include <optional>		  // std::optional, std::nullopt
-#include <vector>		  // std::vector
-#include <godby/Atomic.h> // godby::Atomic
+#include <algorithm>			  // std::min
+#include <cstddef>				  // std::size_t, std::ptrdiff_t
+#include <cstdint>				  // uint64_t
+#include <cstring>				  // std::memcpy
+#include <atomic>				  // std::atomic
+#include <new>					  // std::launder
+#include <type_traits>			  // std::is_trivially_copyable_v
+#include <utility>				  // std::forward
+#include <optional>				  // std::optional, std::nullopt
+#include <godby/HazardPointers.h> // godby::HazardPointers
+#include <godby/Portability.h>	  // Portability
 
 static_assert(__cplusplus >= 202002L, "Requires C++20 or higher");
 
 //! StealingQueue
 namespace godby
 {
+namespace details
+{
+// Thieves read a slot before they know whether they have won it, so slots only hold trivially
+// copyable data accessed through relaxed atomics: a copy of the item word by word when T is
+// trivially copyable, otherwise a pointer to a heap copy that the winner moves out of and frees.
+template <typename T, bool Inline = std::is_trivially_copyable_v<T>>
+class StealingSlot {
+  public:
+	using raw_type = T *;
+
+	template <typename O>
+	static raw_type wrap(O &&o)
+	{
+		return new T(std::forward<O>(o));
+	}
+
+	static T unwrap(raw_type raw)
+	{
+		T item(std::move(*raw));
+		delete raw;
+		return item;
+	}
+
+	static void discard(raw_type raw) noexcept
+	{
+		delete raw;
+	}
+
+	inline void put(raw_type raw) noexcept
+	{
+		M_item.store(raw, std::memory_order_relaxed);
+	}
+
+	inline raw_type get() const noexcept
+	{
+		return M_item.load(std::memory_order_relaxed);
+	}
+
+  private:
+	std::atomic<T *> M_item{nullptr};
+};
+
 template <typename T>
+class StealingSlot<T, true> {
+	static constexpr size_t WORDS = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+  public:
+	using raw_type = T;
+
+	template <typename O>
+	static raw_type wrap(O &&o)
+	{
+		return T(std::forward<O>(o));
+	}
+
+	static T unwrap(raw_type raw) noexcept
+	{
+		return raw;
+	}
+
+	static void discard(raw_type) noexcept {}
+
+	inline void put(const T &item) noexcept
+	{
+		uint64_t words[WORDS] = {};
+		std::memcpy(words, &item, sizeof(T));
+		for (size_t i = 0; i < WORDS; ++i) { M_words[i].store(words[i], std::memory_order_relaxed); }
+	}
+
+	inline T get() const noexcept
+	{
+		uint64_t words[WORDS];
+		for (size_t i = 0; i < WORDS; ++i) { words[i] = M_words[i].load(std::memory_order_relaxed); }
+		alignas(T) unsigned char storage[sizeof(T)];
+		std::memcpy(storage, words, sizeof(T));
+		return *std::launder(reinterpret_cast<T *>(storage));
+	}
+
+  private:
+	std::atomic<uint64_t> M_words[WORDS];
+};
+} // namespace details
+
+/**
+ * @class: StealingQueue
+ *
+ * @tparam T item type
+ * @tparam MaxBatch the most items steal_batch() takes at once
+ *
+ * @brief: Chase-Lev work-stealing deque, the owner pushes and pops at the bottom, thieves steal at the top
+ *
+ * A thief holding a stale view of the bottom may claim any of the MaxBatch items above the top it
+ * read, so the owner only pops the bottom without a CAS while more than MaxBatch items are left. With
+ * fewer items it takes the top item with a CAS instead, as it does for the very last item when
+ * MaxBatch is 1: the last MaxBatch items come out oldest first.
+ *
+ * The owner replaces the slot array when it fills up and, if the queue is shrinkable, halves it
+ * after as many sparse pops (below 1/8 full) as the array has slots. Thieves read the array under a
+ * hazard pointer, so replaced arrays are retired through godby::HazardPointers and freed as soon
+ * as no thief reads them anymore.
+ */
+template <typename T, size_t MaxBatch = 1>
 class StealingQueue {
+	static_assert(MaxBatch >= 1, "MaxBatch must be positive");
+
   protected:
+	using slot_type = details::StealingSlot<T>;
+	using raw_type = typename slot_type::raw_type;
+
 	struct Array {
 		size_t C;
 		size_t M;
-		godby::Atomic<T> *S;
+		slot_type *S;
+		Array *retired_next{nullptr}; // Intrusive link used by HazardPointers
 
-		explicit Array(size_t c) : C{c}, M{c - 1}, S{new godby::Atomic<T>[C]} {}
+		explicit Array(size_t c) : C{c}, M{c - 1}, S{new slot_type[C]} {}
 
 		~Array()
 		{
@@ -32,49 +144,61 @@ class StealingQueue {
 			return C;
 		}
 
-		template <typename O>
-		inline void push(size_t i, const O &o) noexcept
+		inline void push(size_t i, raw_type raw) noexcept
 		{
-			S[i & M].store(o, std::memory_order_relaxed);
+			S[i & M].put(raw);
 		}
 
-		template <typename O>
-		inline void push(size_t i, O &&o) noexcept
+		inline raw_type pop(size_t i) const noexcept
 		{
-			S[i & M].store(std::forward<O>(o), std::memory_order_relaxed);
+			return S[i & M].get();
 		}
 
-		inline T pop(size_t i) noexcept
+		Array *resize(size_t b, size_t t, size_t c) const
 		{
-			return S[i & M].load(std::memory_order_relaxed);
+			Array *ptr = new Array{c};
+			for (size_t i = t; i != b; ++i) { ptr->push(i, pop(i)); }
+			return ptr;
 		}
 
-		Array *resize(size_t b, size_t t)
+		Array *get_next() const noexcept
 		{
-			Array *ptr = new Array{2 * C};
-			for (size_t i = t; i != b; ++i) { ptr->push(i, pop(i)); }
-			return ptr;
+			return retired_next;
+		}
+
+		void set_next(Array *next) noexcept
+		{
+			retired_next = next;
+		}
+
+		void destroy() noexcept
+		{
+			delete this;
 		}
 	};
 
 	std::atomic<size_t> M_top;
 	std::atomic<size_t> M_bottom;
 	std::atomic<Array *> M_array;
-	std::vector<Array *> M_garbage;
+
+	// Owner-only
+	const size_t M_min_capacity;
+	const bool M_shrinkable;
+	size_t M_sparse_pops{0};
 
   public:
 	/**
 	@brief constructs the queue with a given capacity
 
 	@param capacity the capacity of the queue (must be power of 2)
+	@param shrinkable whether the array may shrink back towards capacity once the queue stays sparse
 	*/
-	explicit StealingQueue(size_t capacity = 1024)
+	explicit StealingQueue(size_t capacity = 1024, bool shrinkable = false) : M_min_capacity(capacity), M_shrinkable(shrinkable)
 	{
 		GODBY_ASSERT(capacity && (!(capacity & (capacity - 1))));
 		M_top.store(0, std::memory_order_relaxed);
 		M_bottom.store(0, std::memory_order_relaxed);
 		M_array.store(new Array{capacity}, std::memory_order_relaxed);
-		M_garbage.reserve(32);
 	}
 
 	/**
@@ -82,8 +206,10 @@ class StealingQueue {
 	*/
 	~StealingQueue()
 	{
-		for (auto a : M_garbage) { delete a; }
-		delete M_array.load();
+		Array *a = M_array.load(std::memory_order_relaxed);
+		size_t b = M_bottom.load(std::memory_order_relaxed);
+		for (size_t i = M_top.load(std::memory_order_relaxed); i < b; ++i) { slot_type::discard(a->pop(i)); }
+		delete a;
 	}
 
 	/**
@@ -93,7 +219,7 @@ class StealingQueue {
 	{
 		size_t b = M_bottom.load(std::memory_order_relaxed);
 		size_t t = M_top.load(std::memory_order_relaxed);
-		return b <= t;
+		return static_cast<std::ptrdiff_t>(b - t) <= 0;
 	}
 
 	/**
@@ -111,7 +237,10 @@ class StealingQueue {
 	*/
 	size_t capacity() const noexcept
 	{
-		return M_array.load(std::memory_order_relaxed)->capacity();
+		auto &hazptr = get_hazard_list<Array>();
+		size_t c = hazptr.protect(M_array)->capacity();
+		hazptr.release();
+		return c;
 	}
 
 	/**
@@ -133,14 +262,9 @@ class StealingQueue {
 		Array *a = M_array.load(std::memory_order_relaxed);
 
 		// queue is full
-		if (a->capacity() - 1 < (b - t)) {
-			Array *tmp = a->resize(b, t);
-			M_garbage.push_back(a);
-			std::swap(a, tmp);
-			M_array.store(a, std::memory_order_relaxed);
-		}
+		if (a->capacity() - 1 < (b - t)) { a = replace(a, b, t, 2 * a->capacity()); }
 
-		a->push(b, std::forward<O>(item));
+		a->push(b, slot_type::wrap(std::forward<O>(item)));
 		std::atomic_thread_fence(std::memory_order_release);
 		M_bottom.store(b + 1, std::memory_order_relaxed);
 	}
@@ -153,26 +277,31 @@ class StealingQueue {
 	*/
 	std::optional<T> pop()
 	{
-		size_t b = M_bottom.load(std::memory_order_relaxed) - 1;
-		Array *a = M_array.load(std::memory_order_relaxed);
-		M_bottom.store(b, std::memory_order_relaxed);
-		std::atomic_thread_fence(std::memory_order_seq_cst);
-		size_t t = M_top.load(std::memory_order_relaxed);
+		if (M_shrinkable) { maybe_shrink(); }
+
+		for (;;) {
+			size_t b = M_bottom.load(std::memory_order_relaxed) - 1;
+			Array *a = M_array.load(std::memory_order_relaxed);
+			M_bottom.store(b, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			size_t t = M_top.load(std::memory_order_relaxed);
 
-		std::optional<T> item;
+			// Indices are unsigned, compare their distance so that popping an empty queue at bottom 0 fails.
+			std::ptrdiff_t distance = static_cast<std::ptrdiff_t>(b - t);
+			if (distance >= static_cast<std::ptrdiff_t>(MaxBatch)) { return slot_type::unwrap(a->pop(b)); }
 
-		if (t <= b) {
-			item = a->pop(b);
-			if (t == b) {
-				// the last item just got stolen
-				if (!M_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) { item = std::nullopt; }
+			if (distance < 0) {
 				M_bottom.store(b + 1, std::memory_order_relaxed);
+				return std::nullopt;
 			}
-		} else {
+
+			// within reach of a thief: race for the top item
+			raw_type raw = a->pop(t);
+			bool taken = M_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
 			M_bottom.store(b + 1, std::memory_order_relaxed);
+			if (taken) { return slot_type::unwrap(raw); }
+			if (MaxBatch == 1) { return std::nullopt; } // the last item just got stolen
 		}
-
-		return item;
 	}
 
 	/**
@@ -187,15 +316,78 @@ class StealingQueue {
 		std::atomic_thread_fence(std::memory_order_seq_cst);
 		size_t b = M_bottom.load(std::memory_order_acquire);
 
-		std::optional<T> item;
-
-		if (t < b) {
-			Array *a = M_array.load(std::memory_order_consume);
-			item = a->pop(t);
-			if (!M_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) { return std::nullopt; }
+		// Indices are unsigned, compare their distance: an owner popping its empty queue briefly leaves bottom below top.
+		if (static_cast<std::ptrdiff_t>(b - t) > 0) {
+			auto &hazptr = get_hazard_list<Array>();
+			raw_type raw = hazptr.protect(M_array)->pop(t);
+			hazptr.release();
+			if (M_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) { return slot_type::unwrap(raw); }
 		}
 
-		return item;
+		return std::nullopt;
+	}
+
+	/**
+	@brief steals up to half of the items from the queue with a single CAS
+
+	Any threads can try to steal. Writes the stolen items, oldest first, to @p out and returns
+	their number, which is zero if this operation failed (not necessary empty).
+
+	@param out output iterator receiving the items
+	@param max the most items to steal, capped at MaxBatch
+	*/
+	template <typename OutputIt>
+	size_t steal_batch(OutputIt out, size_t max = MaxBatch)
+	{
+		size_t t = M_top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		size_t b = M_bottom.load(std::memory_order_acquire);
+
+		std::ptrdiff_t available = static_cast<std::ptrdiff_t>(b - t);
+		if (available <= 0 || max == 0) { return 0; }
+		size_t n = std::min({max, MaxBatch, static_cast<size_t>(available + 1) / 2});
+
+		// Copy before claiming: once the top moves, the owner may reuse the slots.
+		auto &hazptr = get_hazard_list<Array>();
+		Array *a = hazptr.protect(M_array);
+		std::optional<raw_type> raws[MaxBatch];
+		for (size_t i = 0; i < n; ++i) { raws[i].emplace(a->pop(t + i)); }
+		hazptr.release();
+		if (!M_top.compare_exchange_strong(t, t + n, std::memory_order_seq_cst, std::memory_order_relaxed)) { return 0; }
+
+		for (size_t i = 0; i < n; ++i) { *out++ = slot_type::unwrap(std::move(*raws[i])); }
+		return n;
+	}
+
+  private:
+	// Publish a copy of the items in [t, b) in an array of capacity c, and retire the old one.
+	Array *replace(Array *a, size_t b, size_t t, size_t c)
+	{
+		Array *fresh = a->resize(b, t, c);
+		M_array.store(fresh, std::memory_order_release);
+
+		auto &hazptr = get_hazard_list<Array>();
+		hazptr.retire(a);
+		hazptr.reclaim(); // Few but large objects, do not wait for a batch of retires
+		return fresh;
+	}
+
+	GODBY_NOINLINE void shrink(Array *a, size_t b, size_t t)
+	{
+		M_sparse_pops = 0;
+		replace(a, b, t, a->capacity() / 2);
+	}
+
+	inline void maybe_shrink()
+	{
+		Array *a = M_array.load(std::memory_order_relaxed);
+		size_t b = M_bottom.load(std::memory_order_relaxed);
+		size_t t = M_top.load(std::memory_order_acquire);
+		if (a->capacity() <= M_min_capacity || (b - t) * 8 >= a->capacity()) {
+			M_sparse_pops = 0;
+		} else if (GODBY_UNLIKELY(++M_sparse_pops >= a->capacity())) {
+			shrink(a, b, t);
+		}
 	}
 };
 } // namespace godby
@@ -1,11 +1,19 @@
 #pragma once
 
+#include <atomic>
+#include <bit>
 #include <cassert>
 #include <cstdint>
 #include <limits>
 #include <functional>
 #include <memory>
 #include <algorithm>
+#include <optional>
+#include <utility>
+#include <thread>
+#include <vector>
+#include <godby/Portability.h>	 // Portability
+#include <godby/SlabAllocator.h> // godby::SlabAllocator
 
 namespace godby
 {
@@ -13,6 +21,8 @@ template <typename TickType>
 class TimerSlotTpl;
 template <typename TickType>
 class TimerWheelTpl;
+template <typename TickType>
+class TimerShardTpl;
 
 template <typename TickType>
 class TimerEventTpl {
@@ -67,14 +77,34 @@ class TimerEventTpl {
 	TimerEventTpl *M_next = nullptr;
 	TimerEventTpl *M_prev = nullptr;
 
+	// Latest command posted by another thread (absolute tick to run at, 0 to cancel), and the link
+	// of the shard inbox this event is queued in while M_queued is set.
+	std::atomic<TickType> M_request{0};
+	std::atomic<bool> M_queued{false};
+	TimerEventTpl *M_inbox_next = nullptr;
+
 	friend class TimerSlotTpl<TickType>;
+	friend class TimerShardTpl<TickType>;
 };
 
+// Events created per request come and go at the rate of the requests, so they live in the slab
+// of their size class rather than on the heap. The slab blocks are sized for exactly these classes,
+// hence final.
 template <typename TickType, typename CallbackType>
-class CallbackTimerEventTpl : public TimerEventTpl<TickType> {
+class CallbackTimerEventTpl final : public TimerEventTpl<TickType> {
   public:
 	explicit CallbackTimerEventTpl(const CallbackType &callback) : callback_(callback) {}
 
+	static void *operator new(size_t)
+	{
+		return SlabAllocator<CallbackTimerEventTpl>::Allocate();
+	}
+
+	static void operator delete(void *p) noexcept
+	{
+		SlabAllocator<CallbackTimerEventTpl>::Deallocate(p);
+	}
+
   protected:
 	void execute() override
 	{
@@ -86,10 +116,20 @@ class CallbackTimerEventTpl : public TimerEventTpl<TickType> {
 };
 
 template <typename TickType, typename T, void (T::*MemberFunction)()>
-class MemberTimerEventTpl : public TimerEventTpl<TickType> {
+class MemberTimerEventTpl final : public TimerEventTpl<TickType> {
   public:
 	explicit MemberTimerEventTpl(T *obj) : M_obj(obj) {}
 
+	static void *operator new(size_t)
+	{
+		return SlabAllocator<MemberTimerEventTpl>::Allocate();
+	}
+
+	static void operator delete(void *p) noexcept
+	{
+		SlabAllocator<MemberTimerEventTpl>::Deallocate(p);
+	}
+
   protected:
 	void execute() override
 	{
@@ -114,7 +154,11 @@ class TimerSlotTpl {
 	{
 		auto event = M_events;
 		M_events = event->M_next;
-		if (M_events) { M_events->M_prev = nullptr; }
+		if (M_events) {
+			M_events->M_prev = nullptr;
+		} else {
+			*M_occupancy &= ~M_bit;
+		}
 		event->M_next = nullptr;
 		event->M_slot = nullptr;
 		return event;
@@ -125,6 +169,10 @@ class TimerSlotTpl {
 	friend class TimerWheelTpl<TickType>;
 
 	TimerEventTpl<TickType> *M_events = nullptr;
+
+	// The bit of this slot in the occupancy bitmap of its level, set while M_events is not empty.
+	uint64_t *M_occupancy = nullptr;
+	uint64_t M_bit = 0;
 };
 
 template <typename TickType>
@@ -134,8 +182,18 @@ class TimerWheelTpl {
 	{
 		for (int i = 0; i < LEVEL_NUM; ++i) { M_now[i] = start_tick >> (BIT_WIDTH * i); }
 		M_ticks_pending = 0;
+		for (int level = 0; level < LEVEL_NUM; ++level) {
+			for (int i = 0; i < NUM_SLOTS; ++i) {
+				M_slots[level][i].M_occupancy = &M_occupancy[level][i / 64];
+				M_slots[level][i].M_bit = uint64_t(1) << (i % 64);
+			}
+		}
 	}
 
+	// Slots point into the wheel's bitmaps
+	TimerWheelTpl(const TimerWheelTpl &) = delete;
+	TimerWheelTpl &operator=(const TimerWheelTpl &) = delete;
+
 	bool advance(TickType delta, size_t max_execute = std::numeric_limits<size_t>::max(), int level = 0);
 
 	void schedule(TimerEventTpl<TickType> *event, TickType delta);
@@ -152,6 +210,9 @@ class TimerWheelTpl {
   private:
 	bool process_current_slot(TickType now, size_t &max_events, int level);
 
+	// The first occupied slot at or after index from (not wrapping around), NUM_SLOTS if none.
+	int next_occupied(int level, int from) const;
+
 	inline static constexpr int BIT_WIDTH = 8;
 	inline static constexpr int LEVEL_NUM = (sizeof(TickType) * 8 + BIT_WIDTH - 1) / BIT_WIDTH;
 	inline static constexpr int MAX_LEVEL = LEVEL_NUM - 1;
@@ -161,6 +222,7 @@ class TimerWheelTpl {
 	TickType M_ticks_pending;
 	TickType M_now[LEVEL_NUM];
 	TimerSlotTpl<TickType> M_slots[LEVEL_NUM][NUM_SLOTS];
+	uint64_t M_occupancy[LEVEL_NUM][NUM_SLOTS / 64] = {}; // Non-empty slots, one bit each
 };
 
 // TimerEventTpl method definitions
@@ -176,12 +238,17 @@ void TimerEventTpl<TickType>::relink(TimerSlotTpl<TickType> *new_slot)
 			prev->M_next = next;
 		} else {
 			M_slot->M_events = next;
+			if (!next) { *M_slot->M_occupancy &= ~M_slot->M_bit; }
 		}
 	}
 	if (new_slot) {
 		auto old = new_slot->M_events;
 		M_next = old;
-		if (old) { old->M_prev = this; }
+		if (old) {
+			old->M_prev = this;
+		} else {
+			*new_slot->M_occupancy |= new_slot->M_bit;
+		}
 		new_slot->M_events = this;
 	} else {
 		M_next = nullptr;
@@ -207,7 +274,19 @@ bool TimerWheelTpl<TickType>::advance(TickType delta, size_t max_execute, int le
 		assert(delta > 0);
 	}
 
-	while (delta--) {
+	while (delta) {
+		// Jump over the empty slots before the next occupied one, stopping at the rollover to slot 0
+		TickType start = (M_now[level] + 1) & SLOT_MASK;
+		if (start != 0) {
+			TickType empty = std::min<TickType>(next_occupied(level, start) - start, delta);
+			if (empty) {
+				M_now[level] += empty;
+				delta -= empty;
+				continue;
+			}
+		}
+
+		--delta;
 		TickType now = ++M_now[level];
 		if (!process_current_slot(now, max_execute, level)) {
 			M_ticks_pending = (delta + 1);
@@ -255,9 +334,20 @@ TickType TimerWheelTpl<TickType>::ticks_to_wakeup(TickType max, int level)
 {
 	if (M_ticks_pending) { return 0; }
 
+	// Only the occupied slots and the rollover to slot 0 (where the level above cascades) can hold
+	// the next event, visit them in order and skip the rest.
+	int base = (M_now[level] + 1) & SLOT_MASK;
+	auto next_candidate = [&](int i) {
+		if (i >= NUM_SLOTS) { return NUM_SLOTS; }
+		int from = (base + i) & SLOT_MASK;
+		if (from == 0) { return i; }
+		int found = next_occupied(level, from);
+		return std::min(NUM_SLOTS, i + (found < NUM_SLOTS ? found - from : NUM_SLOTS - from));
+	};
+
 	TickType now = M_now[0];
 	TickType min_tick = max;
-	for (int i = 0; i < NUM_SLOTS; ++i) {
+	for (int i = next_candidate(0); i < NUM_SLOTS; i = next_candidate(i + 1)) {
 		auto slot_index = (M_now[level] + 1 + i) & SLOT_MASK;
 		if (slot_index == 0 && level < MAX_LEVEL) {
 			if (level > 0 || !M_slots[level][slot_index].events()) {
@@ -284,6 +374,17 @@ TickType TimerWheelTpl<TickType>::ticks_to_wakeup(TickType max, int level)
 	return max;
 }
 
+template <typename TickType>
+int TimerWheelTpl<TickType>::next_occupied(int level, int from) const
+{
+	for (int word = from / 64; word < NUM_SLOTS / 64; ++word) {
+		uint64_t bits = M_occupancy[level][word];
+		if (word == from / 64) { bits &= ~uint64_t(0) << (from % 64); }
+		if (bits) { return word * 64 + std::countr_zero(bits); }
+	}
+	return NUM_SLOTS;
+}
+
 template <typename TickType>
 bool TimerWheelTpl<TickType>::process_current_slot(TickType now, size_t &max_events, int level)
 {
@@ -310,6 +411,257 @@ bool TimerWheelTpl<TickType>::process_current_slot(TickType now, size_t &max_eve
 	return true;
 }
 
-using TimerEvent = TimerEventTpl<uint64_t>;
-using TimerWheel = TimerWheelTpl<uint64_t>;
+/**
+ * @class: TimerShardTpl
+ *
+ * @brief: a TimerWheelTpl owned by one thread that any thread may schedule on
+ *
+ * The owner (the thread that constructed the shard, or the last one to call bind()) schedules and
+ * cancels directly on its wheel. Other threads post the command into the event itself and push the
+ * event onto the shard's inbox, a lock-free intrusive stack, unless it is already queued there: a
+ * CAS on the inbox and no lock. The owner applies the inbox in a batch at the start of advance()
+ * and ticks_to_wakeup(), the last command posted for an event wins.
+ *
+ * An event must stay on one shard, and must outlive the commands posted for it: cancel it from the
+ * owner (or let the owner run it) before destroying it.
+ */
+template <typename TickType>
+class TimerShardTpl {
+  public:
+	explicit TimerShardTpl(TickType start_tick = 0) : M_wheel(start_tick), M_now(start_tick), M_owner(std::this_thread::get_id()) {}
+
+	TimerShardTpl(const TimerShardTpl &) = delete;
+	TimerShardTpl &operator=(const TimerShardTpl &) = delete;
+
+	// Make the calling thread the owner, the one calling advance(), before other threads use the shard.
+	void bind()
+	{
+		M_owner = std::this_thread::get_id();
+	}
+
+	bool owned() const
+	{
+		return std::this_thread::get_id() == M_owner;
+	}
+
+	void schedule(TimerEventTpl<TickType> *event, TickType delta)
+	{
+		assert(delta > 0);
+		if (owned()) {
+			M_wheel.schedule(event, delta);
+		} else {
+			post(event, M_now.load(std::memory_order_acquire) + delta);
+		}
+	}
+
+	void cancel(TimerEventTpl<TickType> *event)
+	{
+		if (owned()) {
+			event->cancel();
+		} else {
+			post(event, 0);
+		}
+	}
+
+	// Owner only.
+	bool advance(TickType delta, size_t max_execute = std::numeric_limits<size_t>::max())
+	{
+		drain();
+		bool done = M_wheel.advance(delta, max_execute);
+		M_now.store(M_wheel.now(), std::memory_order_release);
+		return done;
+	}
+
+	// Owner only.
+	TickType ticks_to_wakeup(TickType max = std::numeric_limits<TickType>::max())
+	{
+		drain();
+		return M_wheel.ticks_to_wakeup(max);
+	}
+
+	// The tick the owner last advanced to.
+	TickType now() const
+	{
+		return M_now.load(std::memory_order_acquire);
+	}
+
+	// Owner only.
+	TimerWheelTpl<TickType> &wheel()
+	{
+		return M_wheel;
+	}
+
+  private:
+	void post(TimerEventTpl<TickType> *event, TickType request)
+	{
+		event->M_request.store(request, std::memory_order_relaxed);
+		if (event->M_queued.exchange(true, std::memory_order_acq_rel)) { return; } // Already queued, the owner will read the new request
+
+		TimerEventTpl<TickType> *head = M_inbox.load(std::memory_order_relaxed);
+		do { event->M_inbox_next = head; } while (!M_inbox.compare_exchange_weak(head, event, std::memory_order_release, std::memory_order_relaxed));
+	}
+
+	void drain()
+	{
+		TimerEventTpl<TickType> *head = M_inbox.exchange(nullptr, std::memory_order_acquire);
+		if (GODBY_LIKELY(!head)) { return; }
+
+		// Oldest first
+		TimerEventTpl<TickType> *ordered = nullptr;
+		while (head) {
+			TimerEventTpl<TickType> *next = head->M_inbox_next;
+			head->M_inbox_next = ordered;
+			ordered = head;
+			head = next;
+		}
+
+		while (ordered) {
+			TimerEventTpl<TickType> *event = ordered;
+			ordered = event->M_inbox_next;
+			event->M_inbox_next = nullptr;
+			event->M_queued.exchange(false, std::memory_order_acq_rel); // Synchronizes with the last post that found it queued
+			TickType request = event->M_request.load(std::memory_order_relaxed);
+			if (request == 0) {
+				event->cancel();
+			} else {
+				TickType now = M_wheel.now();
+				M_wheel.schedule(event, request > now ? request - now : 1);
+			}
+		}
+	}
+
+	TimerWheelTpl<TickType> M_wheel;
+	alignas(CACHE_LINE_SIZE) std::atomic<TickType> M_now;
+	std::thread::id M_owner;
+	alignas(CACHE_LINE_SIZE) std::atomic<TimerEventTpl<TickType> *> M_inbox{nullptr};
+};
+
+/**
+ * @class: ShardedTimerWheelTpl
+ *
+ * @brief: one TimerShardTpl per worker
+ *
+ * Each worker binds its shard and advances it from its own loop, while any thread arms timeouts
+ * on any shard without taking a lock, usually the shard of the worker that handles the event.
+ */
+template <typename TickType>
+class ShardedTimerWheelTpl {
+  public:
+	explicit ShardedTimerWheelTpl(size_t shards, TickType start_tick = 0)
+	{
+		M_shards.reserve(shards);
+		for (size_t i = 0; i < shards; ++i) { M_shards.emplace_back(std::make_unique<TimerShardTpl<TickType>>(start_tick)); }
+	}
+
+	size_t size() const
+	{
+		return M_shards.size();
+	}
+
+	TimerShardTpl<TickType> &shard(size_t index)
+	{
+		return *M_shards[index];
+	}
+
+  private:
+	std::vector<std::unique_ptr<TimerShardTpl<TickType>>> M_shards;
+};
+
+/**
+ * @class: TimerEventPoolTpl
+ *
+ * @brief: one-shot callback events from a free list, so arming a timer does not allocate
+ *
+ * Events are carved out of blocks of BlockSize at a time, and go back to the free list right
+ * before their callback runs (which may then acquire again) or when released without running.
+ * Not thread-safe, use one pool per wheel or shard, from its owner, and destroy it before the wheel.
+ *
+ *     godby::TimerEventPool<std::function<void()>> pool;
+ *     auto *event = pool.acquire([conn]() { conn->timeout(); });
+ *     wheel.schedule(event, 30);
+ *     ...
+ *     pool.release(event); // Answered in time
+ */
+template <typename TickType, typename CallbackType, size_t BlockSize = 64>
+class TimerEventPoolTpl {
+	static_assert(BlockSize > 0, "Blocks must hold at least one event");
+
+  public:
+	class Event final : public TimerEventTpl<TickType> {
+	  protected:
+		void execute() override
+		{
+			CallbackType callback = std::move(*M_callback);
+			M_pool->put(this);
+			callback();
+		}
+
+	  private:
+		friend class TimerEventPoolTpl;
+
+		TimerEventPoolTpl *M_pool = nullptr;
+		std::optional<CallbackType> M_callback;
+		Event *M_free_next = nullptr;
+	};
+
+	TimerEventPoolTpl() = default;
+	TimerEventPoolTpl(const TimerEventPoolTpl &) = delete;
+	TimerEventPoolTpl &operator=(const TimerEventPoolTpl &) = delete;
+
+	// An unscheduled event that will run callback, returned to the pool once it did.
+	Event *acquire(CallbackType callback)
+	{
+		if (!M_free) { grow(); }
+		Event *event = std::exchange(M_free, M_free->M_free_next);
+		event->M_callback.emplace(std::move(callback));
+		return event;
+	}
+
+	// Cancel an event that did not run yet and return it to the pool.
+	void release(Event *event)
+	{
+		event->cancel();
+		put(event);
+	}
+
+	// Events allocated so far, in use or free.
+	size_t capacity() const
+	{
+		return M_blocks.size() * BlockSize;
+	}
+
+  private:
+	void grow()
+	{
+		auto &block = M_blocks.emplace_back(std::make_unique<Event[]>(BlockSize));
+		for (size_t i = BlockSize; i-- > 0;) {
+			block[i].M_pool = this;
+			block[i].M_free_next = std::exchange(M_free, &block[i]);
+		}
+	}
+
+	void put(Event *event)
+	{
+		event->M_callback.reset();
+		event->M_free_next = std::exchange(M_free, event);
+	}
+
+	Event *M_free = nullptr;
+	std::vector<std::unique_ptr<Event[]>> M_blocks;
+};
+
+using TickType = uint64_t;
+using TimerEvent = TimerEventTpl<TickType>;
+using TimerWheel = TimerWheelTpl<TickType>;
+using TimerShard = TimerShardTpl<TickType>;
+using ShardedTimerWheel = ShardedTimerWheelTpl<TickType>;
+
+template <typename CallbackType>
+using CallbackTimerEvent = CallbackTimerEventTpl<TickType, CallbackType>;
+
+template <typename T, void (T::*MemberFunction)()>
+using MemberTimerEvent = MemberTimerEventTpl<TickType, T, MemberFunction>;
+
+template <typename CallbackType, size_t BlockSize = 64>
+using TimerEventPool = TimerEventPoolTpl<TickType, CallbackType, BlockSize>;
 } // namespace godby
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>			   // std::size_t
+#include <utility>			   // std::move
+#include <vector>			   // std::vector
+#include <godby/Portability.h> // Portability
+
+static_assert(__cplusplus >= 202002L, "Requires C++20 or higher");
+
+//! Topology
+namespace godby
+{
+struct CpuInfo {
+	int cpu;  // Logical CPU number, as used by sched_setaffinity
+	int core; // Physical core, shared by SMT siblings (unique across packages)
+	int node; // NUMA node
+};
+
+/**
+ * @class: CpuTopology
+ *
+ * @brief: the logical CPUs a process may run on, with their SMT core and NUMA node
+ *
+ * Read from /sys/devices/system on Linux. CPUs are ordered by node, then core, then CPU number,
+ * so handing them out in order fills one node before the next and keeps SMT siblings adjacent.
+ * Elsewhere, or if sysfs is not readable, every CPU is its own core on node 0.
+ */
+class CpuTopology {
+  public:
+	// All CPUs of the calling thread's affinity mask.
+	static CpuTopology Detect();
+
+	// Only the given CPUs (e.g. a cpuset reserved for the executor), CPUs the system does not have are dropped.
+	static CpuTopology Detect(std::vector<int> const &cpus);
+
+	std::vector<CpuInfo> const &cpus() const noexcept
+	{
+		return M_cpus;
+	}
+
+	std::size_t size() const noexcept
+	{
+		return M_cpus.size();
+	}
+
+	std::size_t nodes() const noexcept;
+
+	// Bind the calling thread to a single CPU, returns 0 or -errno.
+	static int Pin(int cpu);
+
+  private:
+	explicit CpuTopology(std::vector<CpuInfo> cpus) noexcept : M_cpus(std::move(cpus)) {}
+
+	std::vector<CpuInfo> M_cpus;
+};
+} // namespace godby
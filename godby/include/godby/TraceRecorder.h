@@ -0,0 +1,195 @@
+#pragma once
+
+#include <atomic>			   // std::atomic
+#include <cstddef>			   // std::size_t
+#include <cstdint>			   // uint64_t, uint32_t
+#include <span>				   // std::span
+#include <utility>			   // std::exchange, std::swap
+#include <godby/Expected.h>	   // godby::Expected
+#include <godby/Histogram.h>   // godby::Histogram
+#include <godby/Portability.h> // godby::TscClock, godby::hashmap
+
+static_assert(__cplusplus >= 202002L, "Requires C++20 or higher");
+
+//! TraceRecorder
+namespace godby
+{
+struct TraceRecord {
+	uint64_t sequence;
+	uint64_t timestamp; // TscClock::Ticks()
+	uint32_t checkcode;
+	uint32_t tag;
+};
+
+namespace details
+{
+struct alignas(64) TraceHeader {
+	static constexpr uint64_t MAGIC = 0x79626f4465636172; // "raceDoby"
+	static constexpr uint32_t VERSION = 1;
+
+	uint64_t magic;
+	uint32_t version;
+	uint32_t record_size;
+	double ticks_per_second;
+	std::atomic<uint64_t> count; // Records written, published after each of them
+};
+} // namespace details
+
+/**
+ * @class: TraceWriter
+ *
+ * @brief: append-only binary trace of timestamped records, in a file mapped into memory
+ *
+ * Records are stamped with TscClock::Ticks(). Append() is a store into the mapping and a release store of the record count in the file
+ * header, no system call, so a trace survives the process crashing and can be read while it is
+ * being written. The file doubles (ftruncate and mremap) when full, on the appending thread.
+ *
+ * One writer per file, typically one per thread:
+ *
+ *     auto trace = TraceWriter::Create("sender.trace");
+ *     trace->Append(sequence, crc);
+ *     ...
+ *     auto sent = TraceFile::Open("sender.trace"), received = TraceFile::Open("receiver.trace");
+ *     Histogram<> latencies;
+ *     TraceJoinStats stats = TraceLatencies(*sent, *received, latencies);
+ */
+class TraceWriter {
+  public:
+	// Failures are errno values. capacity is the number of records the file starts with.
+	static Expected<TraceWriter, int> Create(const char *path, std::size_t capacity = 1 << 16);
+
+	TraceWriter(TraceWriter &&b) noexcept
+		: M_header(std::exchange(b.M_header, nullptr)), M_records(b.M_records), M_size(b.M_size), M_capacity(b.M_capacity), M_fd(std::exchange(b.M_fd, -1))
+	{
+	}
+
+	TraceWriter &operator=(TraceWriter &&b) noexcept
+	{
+		std::swap(M_header, b.M_header), std::swap(M_records, b.M_records);
+		std::swap(M_size, b.M_size), std::swap(M_capacity, b.M_capacity), std::swap(M_fd, b.M_fd);
+		return *this;
+	}
+
+	~TraceWriter();
+
+	// False if the file could not grow, the record is dropped.
+	inline bool Append(const TraceRecord &record) noexcept
+	{
+		if (GODBY_UNLIKELY(M_size == M_capacity) && !Grow()) { return false; }
+		M_records[M_size] = record;
+		M_header->count.store(++M_size, std::memory_order_release);
+		return true;
+	}
+
+	inline bool Append(uint64_t sequence, uint32_t checkcode, uint32_t tag = 0) noexcept
+	{
+		return Append({sequence, TscClock::Ticks(), checkcode, tag});
+	}
+
+	std::size_t size() const noexcept
+	{
+		return M_size;
+	}
+
+	// Trim the file to the records written and unmap it; also done by the destructor.
+	int Close() noexcept;
+
+  private:
+	TraceWriter(details::TraceHeader *header, std::size_t capacity, int fd) noexcept
+		: M_header(header), M_records(reinterpret_cast<TraceRecord *>(header + 1)), M_size(0), M_capacity(capacity), M_fd(fd)
+	{
+	}
+
+	GODBY_NOINLINE bool Grow() noexcept;
+
+	details::TraceHeader *M_header;
+	TraceRecord *M_records;
+	std::size_t M_size;
+	std::size_t M_capacity;
+	int M_fd;
+};
+
+// A trace mapped read-only, complete or still being written (records() is what was published at Open()).
+class TraceFile {
+  public:
+	static Expected<TraceFile, int> Open(const char *path);
+
+	TraceFile(TraceFile &&b) noexcept : M_header(std::exchange(b.M_header, nullptr)), M_length(b.M_length), M_mapped(b.M_mapped) {}
+
+	TraceFile &operator=(TraceFile &&b) noexcept
+	{
+		std::swap(M_header, b.M_header), std::swap(M_length, b.M_length), std::swap(M_mapped, b.M_mapped);
+		return *this;
+	}
+
+	~TraceFile();
+
+	std::span<const TraceRecord> records() const noexcept
+	{
+		return {reinterpret_cast<const TraceRecord *>(M_header + 1), (M_length - sizeof(details::TraceHeader)) / sizeof(TraceRecord)};
+	}
+
+	double ticks_per_second() const noexcept
+	{
+		return M_header->ticks_per_second;
+	}
+
+  private:
+	TraceFile(const details::TraceHeader *header, std::size_t length, std::size_t mapped) noexcept : M_header(header), M_length(length), M_mapped(mapped) {}
+
+	const details::TraceHeader *M_header;
+	std::size_t M_length; // Of the header and the records published
+	std::size_t M_mapped;
+};
+
+struct TraceJoinStats {
+	uint64_t matched = 0;	 // Received with the checkcode it was sent with
+	uint64_t corrupted = 0;	 // Received with another checkcode
+	uint64_t lost = 0;		 // Sent, never received
+	uint64_t duplicates = 0; // Received again, after the first record of the sequence
+	uint64_t unexpected = 0; // Received, never sent
+};
+
+/**
+ * Match the records of a sender and a receiver by sequence: a hash join, building on the receiver
+ * and probing with the sender, linear in the number of records. Calls f(sent, received) for each
+ * sent record, received is nullptr if it was lost. Sequences are expected to be unique per sender.
+ */
+template <typename F>
+TraceJoinStats JoinTraces(std::span<const TraceRecord> sent, std::span<const TraceRecord> received, F &&f)
+{
+	TraceJoinStats stats;
+	godby::hashmap<uint64_t, uint64_t> index; // sequence -> position in received
+	index.reserve(received.size());
+	for (uint64_t i = 0; i < received.size(); ++i) {
+		if (!index.emplace(received[i].sequence, i).second) { ++stats.duplicates; }
+	}
+
+	for (const TraceRecord &record : sent) {
+		auto it = index.find(record.sequence);
+		if (it == index.end()) {
+			++stats.lost;
+			f(record, static_cast<const TraceRecord *>(nullptr));
+			continue;
+		}
+		const TraceRecord &match = received[it->second];
+		++(match.checkcode == record.checkcode ? stats.matched : stats.corrupted);
+		f(record, &match);
+	}
+	stats.unexpected = index.size() - stats.matched - stats.corrupted;
+	return stats;
+}
+
+// Record the latency in nanoseconds of every record that was received intact.
+template <unsigned Precision>
+TraceJoinStats TraceLatencies(const TraceFile &sent, const TraceFile &received, Histogram<Precision> &latencies)
+{
+	const double ns_per_tick = 1e9 / sent.ticks_per_second();
+	return JoinTraces(sent.records(), received.records(), [&](const TraceRecord &s, const TraceRecord *r) {
+		if (r && r->checkcode == s.checkcode) {
+			int64_t ticks = static_cast<int64_t>(r->timestamp - s.timestamp);
+			latencies.Record(ticks > 0 ? static_cast<uint64_t>(ticks * ns_per_tick) : 0);
+		}
+	});
+}
+} // namespace godby
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <atomic>				  // std::atomic
+#include <vector>				  // std::vector
+#include <godby/Portability.h>	  // Portability
+#include <godby/AtomicQueue.h>	  // godby::AtomicQueueB
+#include <godby/HazardPointers.h> // godby::HazardPointers
+
+static_assert(__cplusplus >= 202002L, "Requires C++20 or higher");
+
+//! UnboundedAtomicQueue
+namespace godby
+{
+/**
+ * @class: UnboundedAtomicQueue
+ *
+ * @tparam T element type, must be atomic (see AtomicQueueB)
+ * @tparam NIL the value denoting an empty slot, it can not be pushed
+ *
+ * @brief: unbounded MPMC queue made of a linked list of AtomicQueueB ring segments
+ *
+ * While consumers keep up, producers and consumers share a single ring and the cost is that of one
+ * AtomicQueueB plus a hazard pointer announcement. When the tail ring fills up, the producer links a
+ * new segment instead of failing. Consumers move on to the next segment once the current one is
+ * drained, and retire it through godby::HazardPointers.
+ *
+ * A ring is reused in place until it overflows, so a straggling producer may still push into a
+ * segment that consumers have just abandoned. Abandoning a segment raises its `abandoned` flag
+ * followed by a heavy asymmetric fence; producers check the flag after every push (behind a light
+ * fence) and re-push whatever they find in an abandoned segment, so no element is ever lost.
+ * FIFO order is only relaxed for elements caught in that race.
+ */
+template <class T, T NIL = details::nil<T>(), bool MAXIMIZE_THROUGHPUT = true>
+class UnboundedAtomicQueue {
+	using Ring = AtomicQueueB<T, std::allocator<T>, NIL, MAXIMIZE_THROUGHPUT>;
+
+	struct Segment {
+		explicit Segment(unsigned size) : ring(size) {}
+
+		Ring ring;
+		std::atomic<Segment *> next{nullptr};
+		std::atomic<bool> abandoned{false};
+
+		// Intrusive link used by HazardPointers once the segment has been retired.
+		Segment *retired_next{nullptr};
+
+		Segment *get_next() const noexcept
+		{
+			return retired_next;
+		}
+
+		void set_next(Segment *next_) noexcept
+		{
+			retired_next = next_;
+		}
+
+		void destroy() noexcept
+		{
+			delete this;
+		}
+	};
+
+  public:
+	using value_type = T;
+
+	// The special member functions are not thread-safe.
+
+	explicit UnboundedAtomicQueue(unsigned segment_size = 4096) : M_segment_size(segment_size)
+	{
+		Segment *segment = new Segment(M_segment_size);
+		M_head.store(segment, std::memory_order_relaxed);
+		M_tail.store(segment, std::memory_order_relaxed);
+	}
+
+	UnboundedAtomicQueue(UnboundedAtomicQueue const &) = delete;
+	UnboundedAtomicQueue &operator=(UnboundedAtomicQueue const &) = delete;
+
+	~UnboundedAtomicQueue()
+	{
+		Segment *segment = M_head.load(std::memory_order_relaxed);
+		while (segment) { delete std::exchange(segment, segment->next.load(std::memory_order_relaxed)); }
+	}
+
+	// Never fails, a new segment is linked when the tail segment is full.
+	void push(T element)
+	{
+		auto &hazptr = get_hazard_list<Segment>();
+		for (;;) {
+			Segment *segment = hazptr.protect(M_tail);
+			Segment *next = segment->next.load(std::memory_order_acquire);
+			if (next == nullptr) {
+				if (GODBY_LIKELY(segment->ring.try_push(element))) {
+					details::asymmetric_thread_fence_light(std::memory_order_seq_cst);
+					if (GODBY_UNLIKELY(segment->abandoned.load(std::memory_order_relaxed))) {
+						rescue(segment); // releases the hazard pointer
+					} else {
+						hazptr.release();
+					}
+					return;
+				}
+
+				// The tail segment is full, publish a fresh one which already holds the element.
+				Segment *fresh = new Segment(M_segment_size);
+				fresh->ring.try_push(element);
+				if (segment->next.compare_exchange_strong(next, fresh, std::memory_order_release, std::memory_order_acquire)) {
+					M_tail.compare_exchange_strong(segment, fresh, std::memory_order_release, std::memory_order_relaxed);
+					hazptr.release();
+					return;
+				}
+				delete fresh; // Lost the race, somebody else linked a segment: help and retry.
+			}
+			M_tail.compare_exchange_strong(segment, next, std::memory_order_release, std::memory_order_relaxed);
+		}
+	}
+
+	bool try_push(T element)
+	{
+		push(element);
+		return true;
+	}
+
+	bool try_pop(T &element) noexcept
+	{
+		auto &hazptr = get_hazard_list<Segment>();
+		for (;;) {
+			Segment *segment = hazptr.protect(M_head);
+			if (segment->ring.try_pop(element)) {
+				hazptr.release();
+				return true;
+			}
+
+			Segment *next = segment->next.load(std::memory_order_acquire);
+			if (next == nullptr) {
+				hazptr.release();
+				return false;
+			}
+
+			// Seal the drained segment, then look once more for elements pushed before the seal became visible.
+			segment->abandoned.store(true, std::memory_order_relaxed);
+			details::asymmetric_thread_fence_heavy(std::memory_order_seq_cst);
+			if (segment->ring.try_pop(element)) {
+				hazptr.release();
+				return true;
+			}
+
+			if (M_head.compare_exchange_strong(segment, next, std::memory_order_release, std::memory_order_relaxed)) {
+				// The segment must be unreachable from both ends before it can be retired.
+				Segment *expected = segment;
+				M_tail.compare_exchange_strong(expected, next, std::memory_order_release, std::memory_order_relaxed);
+				hazptr.release();
+				hazptr.retire(segment);
+			}
+		}
+	}
+
+	bool was_empty() const noexcept
+	{
+		Segment *segment = M_head.load(std::memory_order_relaxed);
+		return segment == M_tail.load(std::memory_order_relaxed) && segment->ring.was_empty();
+	}
+
+	unsigned segment_size() const noexcept
+	{
+		return M_segment_size;
+	}
+
+  private:
+	// Re-push the elements stranded in an abandoned segment. Each thread owns a single hazard pointer,
+	// so the segment is drained while still protected and the elements are pushed after releasing it.
+	GODBY_NOINLINE void rescue(Segment *segment)
+	{
+		std::vector<T> stranded;
+		for (T element; segment->ring.try_pop(element);) { stranded.push_back(element); }
+		get_hazard_list<Segment>().release();
+		for (T element : stranded) { push(element); }
+	}
+
+	// Consumers and producers work on different ends, keep them on different cache lines.
+	alignas(CACHE_LINE_SIZE) std::atomic<Segment *> M_head;
+	alignas(CACHE_LINE_SIZE) std::atomic<Segment *> M_tail;
+	alignas(CACHE_LINE_SIZE) unsigned M_segment_size;
+};
+} // namespace godby
@@ -0,0 +1,24 @@
+#pragma once
+
+static_assert(__cplusplus >= 202002L, "Requires C++20 or higher");
+
+//! WaitPolicy
+namespace godby
+{
+// Waiting policies for blocking operations (AtomicQueue push()/pop(), barriers) whose condition is not met yet.
+//
+// BusyWait spins until the condition holds, which gives the lowest latency but burns a core while idle.
+// SpinThenPark spins for SPIN_BUDGET iterations and then parks the thread with std::atomic::wait.
+// The opposite side only issues a wake (futex syscall) when it observes a registered sleeper.
+struct BusyWait {
+	static constexpr bool parking = false;
+	static constexpr unsigned spin_budget = 0;
+};
+
+template <unsigned SPIN_BUDGET = 4096>
+struct SpinThenPark {
+	static_assert(SPIN_BUDGET > 0, "SpinThenPark requires a non-zero spin budget.");
+	static constexpr bool parking = true;
+	static constexpr unsigned spin_budget = SPIN_BUDGET;
+};
+} // namespace godby
@@ -0,0 +1,628 @@
+#include <cerrno>
+#include <system_error>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <godby/IoService.h>
+
+namespace godby::co
+{
+thread_local unsigned int scheduler::M_thread_id = 0;
+thread_local unsigned int scheduler::M_coro_scheduler_id = 0;
+std::atomic_uint scheduler::M_coro_scheduler_count{0};
+
+scheduler::scheduler() : scheduler(std::thread::hardware_concurrency()) {}
+
+scheduler::scheduler(unsigned int threads) : M_id{++M_coro_scheduler_count}, M_thread_contexts(MAX_WORKERS + 1)
+{
+	spawn_workers(threads);
+}
+
+scheduler::scheduler(const ring_options &rings, unsigned int threads) : M_id{++M_coro_scheduler_count}, M_thread_contexts(MAX_WORKERS + 1), M_ring_options{rings}
+{
+	spawn_workers(threads);
+}
+
+scheduler::~scheduler()
+{
+	M_stop_requested.store(true);
+	M_idle.notify_all();
+	unsigned int total_threads = M_total_threads.load(std::memory_order_acquire);
+	for (unsigned int id = 1; id <= total_threads; ++id) {
+		if (auto cxt = context(id); cxt != nullptr) {
+			if (auto ring = cxt->M_ring.load(std::memory_order_acquire)) { ring->wake(); }
+		}
+	}
+	for (unsigned int id = 1; id <= total_threads; ++id) {
+		if (auto cxt = context(id); cxt != nullptr && cxt->M_thread.joinable()) { cxt->M_thread.join(); }
+	}
+	for (auto &cxt : M_thread_contexts) { delete cxt.load(std::memory_order_relaxed); }
+}
+
+bool scheduler::steal_task(std::coroutine_handle<> &handle) noexcept
+{
+	void *address = nullptr;
+	if (M_inject.try_pop(address)) {
+		handle = std::coroutine_handle<>::from_address(address);
+		return true;
+	}
+
+	unsigned int total_threads = M_total_threads.load(std::memory_order_acquire);
+	thread_context *self = context(M_thread_id);
+	self->M_seed ^= self->M_seed << 13, self->M_seed ^= self->M_seed >> 7, self->M_seed ^= self->M_seed << 17;
+
+	// From a random victim on, again while some looked busy, a steal can lose to another thief
+	bool busy = false;
+	do {
+		busy = false;
+		unsigned int start = static_cast<unsigned int>(self->M_seed % total_threads);
+		for (unsigned int k = 0; k < total_threads; ++k) {
+			unsigned int id = (start + k) % total_threads + 1;
+			thread_context *victim = id == M_thread_id ? nullptr : context(id);
+			if (victim == nullptr) { continue; }
+			if (auto stolen = victim->M_tasks.steal()) {
+				handle = *stolen;
+				return true;
+			}
+			busy = busy | !victim->M_tasks.empty();
+		}
+	} while (busy);
+
+	return false;
+}
+
+void scheduler::schedule(const std::coroutine_handle<> &handle) noexcept
+{
+	if (M_thread_id && M_coro_scheduler_id == M_id) {
+		thread_context *self = context(M_thread_id);
+		if (auto displaced = std::exchange(self->M_lifo, handle)) { self->M_tasks.push(displaced); }
+		if (self->M_ring.load(std::memory_order_relaxed) != nullptr) { return; } // Runs when this worker next looks for work, peers do not sleep on M_idle
+	} else {
+		M_inject.push(handle.address());
+		if (M_ring_options) { wake_ring(); }
+	}
+	M_idle.notify_one(); // Free unless a worker is parked
+}
+
+io_context *scheduler::local_ring() const noexcept
+{
+	return (M_thread_id && M_coro_scheduler_id == M_id) ? context(M_thread_id)->M_ring.load(std::memory_order_relaxed) : nullptr;
+}
+
+void scheduler::wake_ring() noexcept
+{
+	auto total_threads = M_total_threads.load(std::memory_order_acquire);
+	if (total_threads == 0) { return; }
+	unsigned int id = M_next_ring.fetch_add(1, std::memory_order_relaxed) % total_threads + 1;
+	if (auto cxt = context(id); cxt != nullptr) {
+		if (auto ring = cxt->M_ring.load(std::memory_order_acquire)) { ring->wake(); }
+	}
+}
+
+bool scheduler::peek_next_coroutine(std::coroutine_handle<> &handle) noexcept
+{
+	thread_context *self = context(M_thread_id);
+	if (self->M_lifo && self->M_lifo_streak < LIFO_BUDGET) {
+		++self->M_lifo_streak;
+		handle = std::exchange(self->M_lifo, nullptr);
+		return true;
+	}
+
+	self->M_lifo_streak = 0;
+	if (auto next = self->M_tasks.pop()) {
+		handle = *next;
+		return true;
+	}
+	if (self->M_lifo) {
+		self->M_lifo_streak = 1;
+		handle = std::exchange(self->M_lifo, nullptr);
+		return true;
+	}
+	return steal_task(handle);
+}
+
+std::coroutine_handle<> scheduler::get_waiting_channel() noexcept
+{
+	return context(M_thread_id)->M_waiting_channel;
+}
+
+auto scheduler::get_next_coroutine() noexcept -> std::coroutine_handle<>
+{
+	// Hand what the suspending coroutine submitted to the kernel, and queue what completed
+	if (auto ring = local_ring()) { ring->poll(); }
+	std::coroutine_handle<> handle;
+	return peek_next_coroutine(handle) ? handle : get_waiting_channel();
+}
+
+scheduler_task scheduler::awaiter()
+{
+	struct thread_awaiter {
+		std::coroutine_handle<> &M_handle_ref;
+
+		constexpr bool await_ready() const noexcept
+		{
+			return false;
+		}
+
+		auto await_suspend(const std::coroutine_handle<> &) const noexcept
+		{
+			return M_handle_ref;
+		}
+
+		constexpr void await_resume() const noexcept {}
+	};
+
+	while (!M_stop_requested.load(std::memory_order_relaxed)) {
+		std::coroutine_handle<> handle;
+
+		while (!peek_next_coroutine(handle)) {
+			if (auto ring = local_ring()) {
+				if (M_stop_requested.load()) [[unlikely]] { co_return; }
+				ring->wait(); // Completions queue their coroutines here, handoffs and wake() also end it
+				continue;
+			}
+
+			// Look once more after announcing ourselves, so a schedule() in between wakes us up
+			auto key = M_idle.prepare_wait();
+			if (peek_next_coroutine(handle)) {
+				M_idle.cancel_wait();
+				break;
+			}
+			if (M_stop_requested.load()) [[unlikely]] {
+				M_idle.cancel_wait();
+				co_return;
+			}
+			M_idle.wait(key);
+		}
+
+		co_await thread_awaiter{handle};
+	}
+}
+
+void scheduler::spawn_workers(const unsigned int &count)
+{
+	for (unsigned int i = 0; i < count; ++i) {
+		// Claim a slot, workers spawning concurrently take the next ones
+		unsigned int id = M_total_threads.load(std::memory_order_relaxed);
+		do {
+			if (id >= MAX_WORKERS) { return; }
+		} while (!M_total_threads.compare_exchange_weak(id, id + 1, std::memory_order_acq_rel, std::memory_order_relaxed));
+		thread_context *cxt = init_thread(++id);
+
+		cxt->M_thread = std::thread([this, cxt, id] {
+			M_thread_id = id;
+			M_coro_scheduler_id = M_id;
+			io_context *ring = nullptr;
+			if (M_ring_options) {
+				// Created by the worker that will enter it, as SINGLE_ISSUER wants; without it the
+				// worker falls back to M_idle
+				try {
+					ring = new io_context(*M_ring_options, this);
+				} catch (const std::system_error &e) {
+					std::cerr << "io_context: " << e.what() << "\n";
+				}
+				cxt->M_ring.store(ring, std::memory_order_release);
+			}
+			cxt->M_started.store(true, std::memory_order_release);
+			cxt->M_started.notify_one();
+			cxt->M_waiting_channel.resume();
+			cxt->M_ring.store(nullptr, std::memory_order_relaxed);
+			delete ring;
+		});
+		cxt->M_started.wait(false, std::memory_order_acquire); // The destructor must see the ring to wake it
+	}
+}
+
+thread_context *scheduler::init_thread(unsigned int id)
+{
+	thread_context *cxt = new thread_context;
+	cxt->M_thread_status.M_status = thread_status::STATUS::READY;
+	cxt->M_seed = 0x9e3779b97f4a7c15ull * id;
+	cxt->M_waiting_channel = awaiter().handle();
+	M_thread_contexts[id].store(cxt, std::memory_order_release);
+	return cxt;
+}
+
+void scheduler::set_thread_status(thread_status::STATUS status) noexcept
+{
+	switch (status) {
+		case thread_status::STATUS::READY:
+			set_thread_ready();
+			break;
+		case thread_status::STATUS::RUNNING:
+			set_thread_running();
+			break;
+		case thread_status::STATUS::SUSPENDED:
+			set_thread_suspended();
+			break;
+		default:
+			break;
+	}
+}
+
+void scheduler::set_thread_suspended() noexcept
+{
+	this->M_total_running_threads.fetch_sub(1, std::memory_order_relaxed);
+	if ((this->M_total_suspended_threads.fetch_add(1, std::memory_order_relaxed) + 1) >= M_total_threads.load(std::memory_order_relaxed)) { spawn_workers(1); }
+	context(M_thread_id)->M_thread_status.M_status.store(thread_status::STATUS::SUSPENDED, std::memory_order_relaxed);
+}
+
+void scheduler::set_thread_ready() noexcept
+{
+	this->M_total_running_threads.fetch_sub(1, std::memory_order_relaxed);
+	this->M_total_ready_threads.fetch_add(1, std::memory_order_relaxed);
+	context(M_thread_id)->M_thread_status.M_status.store(thread_status::STATUS::READY, std::memory_order_relaxed);
+}
+
+void scheduler::set_thread_running() noexcept
+{
+	if (context(M_thread_id)->M_thread_status.M_status.load(std::memory_order_relaxed) == thread_status::STATUS::SUSPENDED) {
+		this->M_total_suspended_threads.fetch_sub(1, std::memory_order_relaxed);
+	} else {
+		this->M_total_ready_threads.fetch_sub(1, std::memory_order_relaxed);
+	}
+	this->M_total_running_threads.fetch_add(1, std::memory_order_relaxed);
+	context(M_thread_id)->M_thread_status.M_status.store(thread_status::STATUS::RUNNING, std::memory_order_relaxed);
+}
+
+thread_local unsigned int io_service::M_thread_id = 0;
+thread_local uring_data::allocator *io_service::M_uio_data_allocator = nullptr;
+thread_local io_op_pipeline *io_service::M_io_queue = nullptr;
+
+io_service::io_service(const u_int &entries, const u_int &flags) : io_operation(this), M_entries(entries), M_flags(flags), M_timer_epoch(std::chrono::steady_clock::now())
+{
+	io_uring_queue_init(entries, &M_uring, flags);
+	M_io_cq_thread = std::move(std::thread([&] { this->loop(); }));
+	M_timers_bound.wait(false); // Until then the constructing thread would be taken for the owner of the wheel
+}
+
+io_service::io_service(const u_int &entries, io_uring_params &params) : io_operation(this), M_entries(entries), M_timer_epoch(std::chrono::steady_clock::now())
+{
+	io_uring_queue_init_params(entries, &M_uring, &params);
+	M_io_cq_thread = std::move(std::thread([&] { this->loop(); }));
+	M_timers_bound.wait(false);
+}
+
+io_service::~io_service()
+{
+	M_stop_requested.store(true, std::memory_order_relaxed);
+	nop(IOSQE_IO_DRAIN);
+	M_io_cq_thread.join();
+}
+
+void io_service::loop() noexcept
+{
+	M_timers.bind();
+	M_timers_bound.store(true);
+	M_timers_bound.notify_all();
+
+	while (!M_stop_requested.load(std::memory_order_relaxed)) {
+		run_timers();
+
+		io_uring_cqe *cqe = nullptr;
+		if (io_uring_wait_cqe(&M_uring, &cqe) == 0) {
+			handle_completion(cqe);
+			io_uring_cqe_seen(&M_uring, cqe);
+		} else {
+			std::cerr << "Wait CQE Failed\n";
+		}
+		unsigned completed = 0;
+		unsigned head;
+
+		io_uring_for_each_cqe(&M_uring, head, cqe)
+		{
+			++completed;
+			handle_completion(cqe);
+		}
+		if (completed) { io_uring_cq_advance(&M_uring, completed); }
+		if (M_io_queue_overflow.load(std::memory_order_relaxed) != nullptr) [[unlikely]] { submit(); }
+	}
+	io_uring_queue_exit(&M_uring);
+	return;
+}
+
+void io_service::run_timers()
+{
+	TickType now = timer_now();
+	if (now > M_timers.now()) { M_timers.advance(now - M_timers.now()); }
+
+	std::erase_if(M_armed_timeouts, [](const auto &armed) { return armed->M_wait->get_data()->M_handle_ctl.load(std::memory_order_acquire); });
+	TickType armed_at = std::numeric_limits<TickType>::max();
+	for (const auto &armed : M_armed_timeouts) { armed_at = std::min(armed_at, armed->M_deadline); }
+	M_timer_armed_at.store(armed_at, std::memory_order_relaxed);
+
+	// Pairs with the fence in schedule_timer_at(): either ticks_to_wakeup() sees the event the
+	// other thread posted, or that thread sees no timeout in flight for it and wakes us up.
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	TickType wakeup = M_timers.ticks_to_wakeup();
+	if (wakeup == std::numeric_limits<TickType>::max()) { return; } // Nothing scheduled
+
+	TickType deadline = M_timers.now() + std::max<TickType>(wakeup, 1);
+	if (deadline >= armed_at) { return; }
+
+	TickType current = timer_now();
+	auto armed = std::make_unique<armed_timeout>();
+	auto delay = std::chrono::duration_cast<std::chrono::nanoseconds>(timer_tick(deadline > current ? deadline - current : 0));
+	armed->M_time.tv_sec = delay.count() / 1000000000;
+	armed->M_time.tv_nsec = delay.count() % 1000000000;
+	armed->M_deadline = deadline;
+	armed->M_wait.emplace(timeout(&armed->M_time));
+	M_armed_timeouts.push_back(std::move(armed));
+	M_timer_armed_at.store(deadline, std::memory_order_relaxed);
+}
+
+void io_service::schedule_timer_at(TimerEvent *event, TickType tick)
+{
+	TickType now = M_timers.now();
+	M_timers.schedule(event, tick > now ? tick - now : 1);
+	if (M_timers.owned()) { return; } // run_timers() comes next
+
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (tick < M_timer_armed_at.load(std::memory_order_relaxed)) { nop(); } // Wake the completion thread up to arm an earlier timeout
+}
+
+bool io_service::io_queue_empty() const noexcept
+{
+	bool is_empty = true;
+	for (auto &q : this->M_io_queues) { is_empty = is_empty & q->empty(); }
+	return is_empty;
+}
+
+void io_service::setup_thread_context()
+{
+	if (M_thread_id == 0) {
+		M_thread_id = M_threads.fetch_add(1, std::memory_order_relaxed) + 1;
+		M_uio_data_allocator = new uring_data::allocator;
+		M_uio_data_allocators.push_back(M_uio_data_allocator);
+		M_io_queue = new io_op_pipeline(128);
+		M_io_queues.push_back(M_io_queue);
+	}
+}
+
+void io_service::submit()
+{
+	while (!io_queue_empty() && !M_io_sq_running.exchange(true, std::memory_order_seq_cst)) {
+		auto overflow_queue = M_io_queue_overflow.load(std::memory_order_relaxed);
+		if (overflow_queue != nullptr) [[unlikely]] {
+			int res = overflow_queue->init_io_uring_ops(&M_uring);
+			if (res >= 0) {
+				M_io_queue_overflow.store(nullptr, std::memory_order_relaxed);
+			} else {
+				return;
+			}
+		}
+
+		unsigned int completed = 0;
+		while (!io_queue_empty()) {
+			for (auto &q : M_io_queues) {
+				int res = q->init_io_uring_ops(&M_uring);
+				if (res < 0) [[unlikely]] {
+					M_io_queue_overflow.store(q, std::memory_order_relaxed);
+					return;
+				} else {
+					completed += res;
+				}
+			}
+		}
+		if (completed) { io_uring_submit(&M_uring); }
+		M_io_sq_running.store(false, std::memory_order_relaxed);
+	}
+}
+
+// Completions of io_service and io_context alike, on the thread reaping them
+static void complete(io_uring_cqe *cqe)
+{
+	void *user_data = io_uring_cqe_get_data(cqe);
+	if (auto stream = multishot_data::from(user_data)) {
+		stream->push(cqe->res, cqe->flags);
+		return;
+	}
+
+	auto data = static_cast<uring_data *>(user_data);
+	if (data != nullptr) {
+		if (cqe->flags & IORING_CQE_F_MORE) {
+			// A zero-copy send completed, its buffer is pinned until the notification follows
+			data->M_result = cqe->res;
+			data->M_flags = cqe->flags;
+			return;
+		}
+		if (!(cqe->flags & IORING_CQE_F_NOTIF)) {
+			data->M_result = cqe->res;
+			data->M_flags = cqe->flags;
+		}
+		if (data->M_handle_ctl.exchange(true, std::memory_order_acq_rel)) { data->M_scheduler->schedule(data->M_handle); }
+		if (data->M_destroy_ctl.exchange(true, std::memory_order_relaxed)) { data->destroy(); }
+	}
+}
+
+void io_service::handle_completion(io_uring_cqe *cqe)
+{
+	complete(cqe);
+}
+
+auto io_service::create_buffer_ring(int bgid, unsigned int entries, unsigned int buffer_size) -> std::unique_ptr<buffer_ring>
+{
+	int err = 0;
+	io_uring_buf_ring *ring = io_uring_setup_buf_ring(&M_uring, entries, bgid, 0, &err);
+	if (ring == nullptr) { return nullptr; }
+	return std::make_unique<buffer_ring>(&M_uring, ring, bgid, entries, buffer_size);
+}
+
+auto io_service::accept_multishot(const int &fd, unsigned char sqe_flags) -> multishot_stream
+{
+	auto data = new multishot_data;
+	setup_thread_context();
+	M_io_queue->enqueue(io_uring_op_accept_multishot_t(fd, data, sqe_flags));
+	submit();
+	return multishot_stream(this, data);
+}
+
+auto io_service::recv_multishot(const int &fd, buffer_ring &buffers, const int &flags, unsigned char sqe_flags) -> multishot_stream
+{
+	auto data = new multishot_data;
+	data->M_buffers = &buffers;
+	setup_thread_context();
+	M_io_queue->enqueue(io_uring_op_recv_multishot_t(fd, data, flags, sqe_flags));
+	submit();
+	return multishot_stream(this, data);
+}
+
+void io_service::submit(io_batch<io_service> &batch)
+{
+	M_io_queue->enqueue(batch.operations());
+	submit();
+}
+
+void io_service::submit(io_link<io_service> &io_link)
+{
+	auto &operations = io_link.operations();
+	size_t op_count = operations.size() - 1;
+
+	for (size_t i = 0; i < op_count; ++i) {
+		std::visit([](auto &&op) { op.M_sqe_flags |= IOSQE_IO_HARDLINK; }, operations[i]);
+	}
+
+	M_io_queue->enqueue(operations);
+
+	submit();
+}
+
+thread_local io_context *io_context::M_current = nullptr;
+
+io_context::io_context(const ring_options &options, scheduler *owner) : io_operation(this), M_scheduler{owner}
+{
+	io_uring_params params{};
+	params.flags = options.flags;
+	// Have the kernel flag deferred completions in the SQ ring, so that poll() only enters for them
+	if (params.flags & IORING_SETUP_DEFER_TASKRUN) { params.flags |= IORING_SETUP_TASKRUN_FLAG; }
+	params.sq_thread_idle = options.sq_thread_idle;
+	if (int err = io_uring_queue_init_params(options.entries, &M_uring, &params); err < 0) { throw std::system_error(-err, std::system_category(), "io_uring_queue_init_params"); }
+	M_wake_fd = eventfd(0, EFD_CLOEXEC);
+	if (M_wake_fd < 0) {
+		int err = errno;
+		io_uring_queue_exit(&M_uring);
+		throw std::system_error(err, std::system_category(), "eventfd");
+	}
+	M_current = this;
+	arm_wake();
+	io_uring_submit(&M_uring);
+}
+
+io_context::~io_context()
+{
+	if (M_current == this) { M_current = nullptr; }
+	io_uring_queue_exit(&M_uring);
+	::close(M_wake_fd);
+}
+
+void io_context::arm_wake()
+{
+	io_uring_sqe *sqe;
+	while ((sqe = io_uring_get_sqe(&M_uring)) == nullptr) { io_uring_submit(&M_uring); }
+	io_uring_prep_read(sqe, M_wake_fd, &M_wake_value, sizeof(M_wake_value), 0);
+	sqe->user_data = M_wake_tag;
+}
+
+void io_context::wake() noexcept
+{
+	uint64_t one = 1;
+	[[maybe_unused]] ssize_t n = ::write(M_wake_fd, &one, sizeof(one));
+}
+
+void io_context::post(std::coroutine_handle<> handle)
+{
+	io_context *source = M_current;
+	if (source == this) {
+		M_scheduler->schedule(handle);
+		return;
+	}
+	if (source == nullptr) {
+		{
+			std::lock_guard guard(M_inbox_lock);
+			M_inbox.push_back(handle);
+		}
+		wake();
+		return;
+	}
+
+	// The target gets a CQE carrying the handle, the source one with no data, which is dropped
+	io_uring_sqe *sqe;
+	while ((sqe = io_uring_get_sqe(&source->M_uring)) == nullptr) { io_uring_submit(&source->M_uring); }
+	io_uring_prep_msg_ring(sqe, M_uring.ring_fd, 0, reinterpret_cast<uintptr_t>(handle.address()) | M_wake_tag, 0);
+	io_uring_sqe_set_data(sqe, nullptr);
+	io_uring_submit(&source->M_uring); // The target may be asleep, do not wait for the source's next poll()
+}
+
+unsigned int io_context::poll()
+{
+	if (io_uring_sq_ready(&M_uring)) {
+		io_uring_submit_and_get_events(&M_uring);
+	} else if (M_uring.flags & IORING_SETUP_DEFER_TASKRUN) {
+		// Deferred completions only reach the CQ when the owner enters for them, a worker that keeps
+		// finding coroutines to run would otherwise never see its I/O complete
+		bool flagged = M_uring.flags & IORING_SETUP_TASKRUN_FLAG;
+		if (!flagged || (io_uring_smp_load_acquire(M_uring.sq.kflags) & IORING_SQ_TASKRUN)) { io_uring_get_events(&M_uring); }
+	}
+	return reap();
+}
+
+unsigned int io_context::wait()
+{
+	io_uring_submit_and_wait(&M_uring, 1);
+	return reap();
+}
+
+unsigned int io_context::reap()
+{
+	unsigned int completed = 0;
+	unsigned head;
+	io_uring_cqe *cqe;
+	bool woken = false;
+
+	io_uring_for_each_cqe(&M_uring, head, cqe)
+	{
+		++completed;
+		auto value = static_cast<uintptr_t>(cqe->user_data);
+		if (value == M_wake_tag) {
+			woken = true;
+		} else if (value & M_wake_tag) {
+			M_scheduler->schedule(std::coroutine_handle<>::from_address(reinterpret_cast<void *>(value & ~M_wake_tag)));
+		} else {
+			complete(cqe);
+		}
+	}
+	if (completed) { io_uring_cq_advance(&M_uring, completed); }
+
+	if (woken) {
+		std::vector<std::coroutine_handle<>> inbox;
+		{
+			std::lock_guard guard(M_inbox_lock);
+			inbox.swap(M_inbox);
+		}
+		for (auto handle : inbox) { M_scheduler->schedule(handle); }
+		arm_wake();
+	}
+	return completed;
+}
+
+async<void> timer(io_service *io, itimerspec spec, std::function<void()> func)
+{
+	int tfd = timerfd_create(CLOCK_REALTIME, 0);
+	timerfd_settime(tfd, 0, &spec, NULL);
+	std::stop_token st = co_await get_stop_token();
+	std::stop_callback scb(st, [&] { io->close(tfd); });
+
+	while (!st.stop_requested()) {
+		std::cerr << "Waiting for timer to trigger\n";
+		unsigned long u;
+		co_await io->read(tfd, &u, sizeof(u), 0);
+		func();
+	}
+	co_await io->close(tfd);
+}
+
+async<> sleep(io_service *io, unsigned long sec, unsigned long nsec)
+{
+	co_await io->sleep_for(std::chrono::seconds(sec) + std::chrono::nanoseconds(nsec));
+}
+} // namespace godby::co
+
@@ -0,0 +1,103 @@
+#include <cerrno>				// errno
+#include <cstring>				// memset
+#include <unistd.h>				// close, read, syscall
+#include <sys/ioctl.h>			// ioctl
+#include <sys/syscall.h>		// SYS_perf_event_open
+#include <linux/perf_event.h>	// perf_event_attr
+#include <godby/PerfCounters.h>	// godby::PerfCounters
+
+namespace godby
+{
+namespace
+{
+void Configure(PerfEvent event, perf_event_attr &attr) noexcept
+{
+	constexpr uint64_t READ_MISS = (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+	switch (event) {
+		case PerfEvent::Cycles: attr.type = PERF_TYPE_HARDWARE, attr.config = PERF_COUNT_HW_CPU_CYCLES; break;
+		case PerfEvent::Instructions: attr.type = PERF_TYPE_HARDWARE, attr.config = PERF_COUNT_HW_INSTRUCTIONS; break;
+		case PerfEvent::L1dMisses: attr.type = PERF_TYPE_HW_CACHE, attr.config = PERF_COUNT_HW_CACHE_L1D | READ_MISS; break;
+		case PerfEvent::LlcMisses: attr.type = PERF_TYPE_HW_CACHE, attr.config = PERF_COUNT_HW_CACHE_LL | READ_MISS; break;
+		case PerfEvent::BranchMisses: attr.type = PERF_TYPE_HARDWARE, attr.config = PERF_COUNT_HW_BRANCH_MISSES; break;
+	}
+}
+
+int OpenEvent(PerfEvent event, int group) noexcept
+{
+	perf_event_attr attr;
+	memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	Configure(event, attr);
+	attr.disabled = group < 0; // The leader starts and stops the whole group
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+	return static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, group, PERF_FLAG_FD_CLOEXEC));
+}
+} // namespace
+
+const char *PerfEventName(PerfEvent event) noexcept
+{
+	switch (event) {
+		case PerfEvent::Cycles: return "cycles";
+		case PerfEvent::Instructions: return "instructions";
+		case PerfEvent::L1dMisses: return "l1d-misses";
+		case PerfEvent::LlcMisses: return "llc-misses";
+		case PerfEvent::BranchMisses: return "branch-misses";
+	}
+	return "unknown";
+}
+
+Expected<PerfCounters, int> PerfCounters::Open(std::initializer_list<PerfEvent> events)
+{
+	PerfCounters counters;
+	int error = EINVAL;
+	for (PerfEvent event : events) {
+		if (counters.M_reading.size == PerfReading::MAX_EVENTS) { break; }
+		int fd = OpenEvent(event, counters.M_fds[0]);
+		if (fd < 0) {
+			error = errno;
+			continue;
+		}
+		counters.M_fds[counters.M_reading.size] = fd;
+		counters.M_reading.events[counters.M_reading.size++] = event;
+	}
+	if (counters.M_reading.size == 0) { return Unexpected<int>(error); }
+	return counters;
+}
+
+PerfCounters::~PerfCounters()
+{
+	for (int fd : M_fds) {
+		if (fd >= 0) { ::close(fd); }
+	}
+}
+
+void PerfCounters::Start() noexcept
+{
+	::ioctl(M_fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+	::ioctl(M_fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+void PerfCounters::Stop() noexcept
+{
+	::ioctl(M_fds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+}
+
+PerfReading PerfCounters::Read() const noexcept
+{
+	// PERF_FORMAT_GROUP: nr, time_enabled, time_running, then one value per event in opening order
+	uint64_t buffer[3 + PerfReading::MAX_EVENTS];
+	PerfReading reading = M_reading;
+	ssize_t n = ::read(M_fds[0], buffer, sizeof(buffer));
+	if (n < static_cast<ssize_t>(3 * sizeof(uint64_t)) || buffer[0] != reading.size) { return reading; }
+
+	uint64_t enabled = buffer[1], running = buffer[2];
+	reading.multiplexed = running < enabled;
+	for (unsigned i = 0; i < reading.size; ++i) {
+		uint64_t value = buffer[3 + i];
+		reading.values[i] = reading.multiplexed && running ? static_cast<uint64_t>(static_cast<double>(value) * enabled / running) : value;
+	}
+	return reading;
+}
+} // namespace godby
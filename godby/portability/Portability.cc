@@ -0,0 +1,64 @@
+#include <thread>			   // std::this_thread::sleep_for
+#include <godby/Portability.h> // godby::TscClock
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <cpuid.h> // __get_cpuid, __get_cpuid_count
+#endif
+
+namespace godby
+{
+namespace
+{
+int64_t SteadyNanoseconds() noexcept
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// The counter rate, from two pairs of readings 10ms apart. Each pair is taken closest together out of
+// a few tries, so a preemption between the two reads does not skew it.
+double MeasureTicksPerSecond() noexcept
+{
+	auto Pair = [](uint64_t &ticks, int64_t &ns) {
+		int64_t best = INT64_MAX;
+		for (int i = 0; i < 16; ++i) {
+			int64_t before = SteadyNanoseconds();
+			uint64_t t = details::ReadTsc();
+			int64_t after = SteadyNanoseconds();
+			if (after - before < best) { best = after - before, ticks = t, ns = before + (after - before) / 2; }
+		}
+	};
+
+	uint64_t t0 = 0, t1 = 0;
+	int64_t ns0 = 0, ns1 = 0;
+	Pair(t0, ns0);
+	std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	Pair(t1, ns1);
+	return (t1 - t0) * 1e9 / (ns1 - ns0);
+}
+} // namespace
+
+details::TscCalibration details::CalibrateTsc() noexcept
+{
+	TscCalibration calibration{};
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+	unsigned eax, ebx, ecx, edx;
+	calibration.invariant = __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) && (edx & (1u << 8));
+	calibration.waitpkg = calibration.invariant && __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) && (ecx & (1u << 5));
+	calibration.ticks_per_second = calibration.invariant ? MeasureTicksPerSecond() : 1e9;
+#elif defined(__aarch64__)
+	// The generic timer runs at a fixed frequency the firmware reports
+	uint64_t frequency;
+	asm volatile("mrs %0, cntfrq_el0" : "=r"(frequency));
+	calibration.invariant = frequency != 0;
+	calibration.ticks_per_second = frequency ? static_cast<double>(frequency) : 1e9;
+#else
+	calibration.ticks_per_second = 1e9;
+#endif
+
+	calibration.to_ns = static_cast<uint64_t>(1e9 / calibration.ticks_per_second * 4294967296.0);
+	calibration.to_tick = static_cast<uint64_t>(calibration.ticks_per_second / 1e9 * 4294967296.0);
+	calibration.ticks = calibration.invariant ? ReadTsc() : SteadyNanoseconds();
+	calibration.system_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+	return calibration;
+}
+} // namespace godby
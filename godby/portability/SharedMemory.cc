@@ -0,0 +1,139 @@
+#include <cerrno>				// errno
+#include <string>				// std::string
+#include <fcntl.h>				// O_CREAT, O_RDWR
+#include <unistd.h>				// close, ftruncate
+#include <sys/mman.h>			// mmap, munmap, shm_open, memfd_create
+#include <sys/stat.h>			// fstat
+#include <godby/SharedMemory.h> // godby::SharedMemory
+
+#ifndef MAP_FIXED_NOREPLACE
+#define MAP_FIXED_NOREPLACE 0x100000
+#endif
+
+namespace godby
+{
+namespace
+{
+// Default huge page size on x86-64 and aarch64, segments backed by huge pages are rounded up to it.
+constexpr std::size_t HUGE_PAGE_SIZE = 2 << 20;
+
+std::string HugetlbfsPath(const char *name)
+{
+	return std::string("/dev/hugepages/") + (name[0] == '/' ? name + 1 : name);
+}
+
+int OpenFile(const char *name, bool huge_pages, int flags)
+{
+	if (huge_pages) { return ::open(HugetlbfsPath(name).c_str(), flags | O_CLOEXEC, 0600); }
+	return ::shm_open(name, flags, 0600);
+}
+} // namespace
+
+Expected<SharedMemory, int> SharedMemory::Create(const char *name, std::size_t size, Options options)
+{
+	if (size < sizeof(details::SharedMemoryHeader)) { return Unexpected<int>(EINVAL); }
+	if (options.huge_pages) { size = (size + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1); }
+
+	int fd = -1;
+	if (name == nullptr) {
+		fd = ::memfd_create("godby", MFD_CLOEXEC | (options.huge_pages ? MFD_HUGETLB : 0));
+	} else {
+		fd = OpenFile(name, options.huge_pages, O_CREAT | O_EXCL | O_RDWR);
+	}
+	if (fd < 0) { return Unexpected<int>(errno); }
+
+	if (::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+		int error = errno;
+		::close(fd);
+		if (name) { Unlink(name, options.huge_pages); }
+		return Unexpected<int>(error);
+	}
+
+	auto shm = Map(fd, size, options, true);
+	if (!shm && name) { Unlink(name, options.huge_pages); }
+	return shm;
+}
+
+Expected<SharedMemory, int> SharedMemory::Open(const char *name, Options options)
+{
+	int fd = OpenFile(name, options.huge_pages, O_RDWR);
+	if (fd < 0) { return Unexpected<int>(errno); }
+	return Open(fd, options);
+}
+
+Expected<SharedMemory, int> SharedMemory::Open(int fd, Options options)
+{
+	struct stat st;
+	if (::fstat(fd, &st) != 0) {
+		int error = errno;
+		::close(fd);
+		return Unexpected<int>(error);
+	}
+
+	std::size_t size = static_cast<std::size_t>(st.st_size);
+	if (size < sizeof(details::SharedMemoryHeader)) {
+		::close(fd);
+		return Unexpected<int>(EINVAL);
+	}
+
+	// Peek at the header to learn where the creator mapped the segment.
+	void *p = ::mmap(nullptr, sizeof(details::SharedMemoryHeader), PROT_READ, MAP_SHARED, fd, 0);
+	if (p == MAP_FAILED) {
+		int error = errno;
+		::close(fd);
+		return Unexpected<int>(error);
+	}
+	auto const *header = static_cast<details::SharedMemoryHeader const *>(p);
+	bool valid = header->magic.load(std::memory_order_acquire) == details::SharedMemoryHeader::MAGIC && header->size == size;
+	options.address = header->base;
+	::munmap(p, sizeof(details::SharedMemoryHeader));
+
+	if (!valid) {
+		::close(fd);
+		return Unexpected<int>(EINVAL);
+	}
+	return Map(fd, size, options, false);
+}
+
+int SharedMemory::Unlink(const char *name, bool huge_pages)
+{
+	int rc = huge_pages ? ::unlink(HugetlbfsPath(name).c_str()) : ::shm_unlink(name);
+	return rc == 0 ? 0 : errno;
+}
+
+Expected<SharedMemory, int> SharedMemory::Map(int fd, std::size_t size, Options options, bool create)
+{
+	int flags = MAP_SHARED;
+	if (options.address) { flags |= MAP_FIXED_NOREPLACE; }
+	if (options.populate) { flags |= MAP_POPULATE; }
+
+	void *p = ::mmap(options.address, size, PROT_READ | PROT_WRITE, flags, fd, 0);
+	if (p == MAP_FAILED) {
+		int error = errno;
+		::close(fd);
+		return Unexpected<int>(error);
+	}
+	if (options.address && p != options.address) { // Kernels before 4.17 treat MAP_FIXED_NOREPLACE as a hint
+		::munmap(p, size);
+		::close(fd);
+		return Unexpected<int>(EEXIST);
+	}
+
+	auto *header = static_cast<details::SharedMemoryHeader *>(p);
+	if (create) {
+		// Publish the magic last: an Open() racing with us must not see it before the other fields.
+		header->size = size;
+		header->base = p;
+		header->used.store(sizeof(details::SharedMemoryHeader), std::memory_order_relaxed);
+		header->root.store(nullptr, std::memory_order_relaxed);
+		header->magic.store(details::SharedMemoryHeader::MAGIC, std::memory_order_release);
+	}
+	return SharedMemory(header, fd);
+}
+
+SharedMemory::~SharedMemory()
+{
+	if (M_header) { ::munmap(M_header, M_header->size); }
+	if (M_fd >= 0) { ::close(M_fd); }
+}
+} // namespace godby
@@ -1,12 +1,31 @@
 #include <functional>	  // std::function
 #include <vector>		  // std::vector
+#include <utility>		  // std::exchange
+#include <algorithm>	  // std::remove
 #include <mutex>		  // std::unique_lock
+#include <cerrno>		  // errno
 #include <cstdio>		  // fprintf, stderr
 #include <signal.h>		  // sigaction, sigemptyset
+#include <poll.h>		  // poll
+#include <pthread.h>	  // pthread_sigmask
+#include <unistd.h>		  // read, write, close
+#include <sys/eventfd.h>  // eventfd
+#include <sys/signalfd.h> // signalfd
 #include <godby/Signal.h> // godby::Signal
 
 namespace godby
 {
+Signal::Signal()
+{
+	sigemptyset(&blocked);
+}
+
+Signal::~Signal()
+{
+	StopDispatcher();
+	if (signal_fd >= 0) { close(signal_fd); }
+}
+
 Signal &Signal::Instance()
 {
 	static Signal instance;
@@ -36,6 +55,82 @@ int Signal::Install(int sig)
 	return 0;
 }
 
+int Signal::Block(int sig)
+{
+	auto &ins = Instance();
+	std::unique_lock guard(ins.lock);
+
+	sigset_t set;
+	sigemptyset(&set);
+	sigaddset(&set, sig);
+	if (int err = pthread_sigmask(SIG_BLOCK, &set, nullptr); err != 0) { return -err; }
+
+	sigaddset(&ins.blocked, sig);
+	int fd = signalfd(ins.signal_fd.load(std::memory_order_relaxed), &ins.blocked, SFD_NONBLOCK | SFD_CLOEXEC);
+	if (fd < 0) { return -errno; }
+	ins.signal_fd.store(fd, std::memory_order_release);
+	return 0;
+}
+
+int Signal::Fd()
+{
+	return Instance().signal_fd.load(std::memory_order_acquire);
+}
+
+int Signal::Dispatch()
+{
+	auto &ins = Instance();
+	int fd = ins.signal_fd.load(std::memory_order_acquire);
+	if (fd < 0) { return 0; }
+
+	int count = 0;
+	signalfd_siginfo infos[16];
+	for (;;) {
+		ssize_t n = read(fd, infos, sizeof(infos));
+		if (n <= 0) {
+			if (n < 0 && errno == EINTR) { continue; }
+			if (n < 0 && errno != EAGAIN) { return -errno; }
+			return count;
+		}
+		for (size_t i = 0; i < n / sizeof(signalfd_siginfo); ++i, ++count) { ins.OnSignal(static_cast<int>(infos[i].ssi_signo)); }
+	}
+}
+
+int Signal::StartDispatcher()
+{
+	auto &ins = Instance();
+	std::unique_lock guard(ins.lock);
+	if (ins.dispatcher.joinable()) { return 0; }
+
+	ins.stop_fd = eventfd(0, EFD_CLOEXEC);
+	if (ins.stop_fd < 0) { return -errno; }
+	ins.dispatcher = std::thread([&ins] {
+		for (;;) {
+			// Re-read the signalfd each round, Block() may create it after we started
+			pollfd fds[2] = {{ins.stop_fd, POLLIN, 0}, {ins.signal_fd.load(std::memory_order_acquire), POLLIN, 0}};
+			if (poll(fds, fds[1].fd >= 0 ? 2 : 1, fds[1].fd >= 0 ? -1 : 10) < 0 && errno != EINTR) { break; }
+			if (fds[0].revents & POLLIN) { break; }
+			if (fds[1].fd >= 0 && (fds[1].revents & POLLIN)) { Dispatch(); }
+		}
+	});
+	return 0;
+}
+
+void Signal::StopDispatcher()
+{
+	auto &ins = Instance();
+	std::thread dispatcher;
+	{
+		std::unique_lock guard(ins.lock);
+		if (!ins.dispatcher.joinable()) { return; }
+		uint64_t one = 1;
+		[[maybe_unused]] ssize_t n = write(ins.stop_fd, &one, sizeof(one));
+		dispatcher = std::move(ins.dispatcher);
+	}
+	dispatcher.join();
+	close(std::exchange(ins.stop_fd, -1));
+}
+
 int Signal::Register(std::function<void(int)> handler)
 {
 	return Instance().Add(handler);
@@ -52,45 +147,59 @@ int Signal::Unregister(int id, const char *file, int line)
 	return Instance().Remove(id);
 }
 
-int Signal::Add(std::function<void(int)> handler)
+template <typename Update>
+void Signal::Modify(Update &&update)
 {
 	std::unique_lock guard(lock);
-	id_to_handler[++id] = handler;
-	return id;
+	auto current = table.load();
+	auto next = current ? godby::make_shared<Table>(*current) : godby::make_shared<Table>();
+	update(*next);
+	table.store(std::move(next));
+}
+
+int Signal::Add(std::function<void(int)> handler)
+{
+	int added = 0;
+	Modify([&](Table &t) { t.id_to_handler[added = ++id] = handler; });
+	return added;
 }
 
 int Signal::Add(int sig, std::function<void()> handler)
 {
-	std::unique_lock guard(lock);
-	id_to_handler[++id] = handler;
-	handlers_by_sig[sig].push_back(id);
-	return id;
+	int added = 0;
+	Modify([&](Table &t) {
+		t.id_to_handler[added = ++id] = handler;
+		t.handlers_by_sig[sig].push_back(added);
+	});
+	return added;
 }
 
 int Signal::Remove(int id)
 {
-	std::unique_lock guard(lock);
-	auto it = id_to_handler.find(id);
-	if (it != id_to_handler.end()) {
-		if (std::holds_alternative<std::function<void()>>(it->second)) {
-			for (auto &[sig, handlers] : handlers_by_sig) { handlers.erase(std::remove(handlers.begin(), handlers.end(), id), handlers.end()); }
-		} else {
-			for (auto &[sig, handler_ids] : handlers_by_sig) { handler_ids.erase(std::remove(handler_ids.begin(), handler_ids.end(), id), handler_ids.end()); }
+	Modify([&](Table &t) {
+		auto it = t.id_to_handler.find(id);
+		if (it != t.id_to_handler.end()) {
+			for (auto &[sig, handler_ids] : t.handlers_by_sig) { handler_ids.erase(std::remove(handler_ids.begin(), handler_ids.end(), id), handler_ids.end()); }
+			t.id_to_handler.erase(it);
 		}
-		id_to_handler.erase(it);
-	}
+	});
 	return 0;
 }
 
 void Signal::OnSignal(int sig)
 {
-	std::unique_lock guard(lock);
-	if (handlers_by_sig.find(sig) != handlers_by_sig.end()) {
-		for (int id : handlers_by_sig[sig]) {
-			if (std::holds_alternative<std::function<void()>>(id_to_handler[id])) { std::get<std::function<void()>>(id_to_handler[id])(); }
+	auto snapshot = table.snapshot();
+	if (!snapshot) { return; }
+
+	if (auto it = snapshot->handlers_by_sig.find(sig); it != snapshot->handlers_by_sig.end()) {
+		for (int id : it->second) {
+			auto handler = snapshot->id_to_handler.find(id);
+			if (handler != snapshot->id_to_handler.end() && std::holds_alternative<std::function<void()>>(handler->second)) {
+				std::get<std::function<void()>>(handler->second)();
+			}
 		}
 	}
-	for (const auto &[id, handler] : id_to_handler) {
+	for (const auto &[id, handler] : snapshot->id_to_handler) {
 		if (std::holds_alternative<std::function<void(int)>>(handler)) { std::get<std::function<void(int)>>(handler)(sig); }
 	}
 }
@@ -0,0 +1,131 @@
+#include <algorithm>		// std::sort
+#include <cerrno>			// errno
+#include <cstdio>			// fopen, fscanf
+#include <string>			// std::string
+#include <thread>			// std::thread::hardware_concurrency
+#include <godby/Topology.h>	// godby::CpuTopology
+
+#if defined(__linux__)
+#include <dirent.h>	 // opendir, readdir
+#include <pthread.h> // pthread_setaffinity_np
+#include <sched.h>	 // sched_getaffinity, CPU_SET
+#include <unistd.h>	 // access
+#endif
+
+namespace godby
+{
+namespace
+{
+#if defined(__linux__)
+// Parse a sysfs cpulist ("0-3,8,10-11"), returns false if the file can not be read.
+bool ReadCpuList(std::string const &path, std::vector<int> &cpus)
+{
+	FILE *file = ::fopen(path.c_str(), "r");
+	if (file == nullptr) { return false; }
+
+	int first, last;
+	while (::fscanf(file, "%d", &first) == 1) {
+		last = first;
+		int c = ::fgetc(file);
+		if (c == '-') {
+			if (::fscanf(file, "%d", &last) != 1) { break; }
+			c = ::fgetc(file);
+		}
+		for (int cpu = first; cpu <= last; ++cpu) { cpus.push_back(cpu); }
+		if (c != ',') { break; }
+	}
+	::fclose(file);
+	return true;
+}
+
+std::vector<CpuInfo> Describe(std::vector<int> const &cpus)
+{
+	std::vector<CpuInfo> infos;
+	for (int cpu : cpus) {
+		// SMT siblings share a core: name the core after its first sibling.
+		std::vector<int> siblings;
+		std::string base = "/sys/devices/system/cpu/cpu" + std::to_string(cpu);
+		if (!ReadCpuList(base + "/topology/thread_siblings_list", siblings) || siblings.empty()) {
+			if (::access(base.c_str(), F_OK) != 0) { continue; } // Not a CPU of this system
+			siblings.push_back(cpu);
+		}
+		infos.push_back(CpuInfo{cpu, siblings.front(), 0});
+	}
+
+	if (DIR *dir = ::opendir("/sys/devices/system/node")) {
+		while (struct dirent *entry = ::readdir(dir)) {
+			int node;
+			if (::sscanf(entry->d_name, "node%d", &node) != 1) { continue; }
+
+			std::vector<int> members;
+			ReadCpuList(std::string("/sys/devices/system/node/") + entry->d_name + "/cpulist", members);
+			for (auto &info : infos) {
+				if (std::find(members.begin(), members.end(), info.cpu) != members.end()) { info.node = node; }
+			}
+		}
+		::closedir(dir);
+	}
+	return infos;
+}
+#else
+std::vector<CpuInfo> Describe(std::vector<int> const &cpus)
+{
+	std::vector<CpuInfo> infos;
+	for (int cpu : cpus) { infos.push_back(CpuInfo{cpu, cpu, 0}); }
+	return infos;
+}
+#endif
+} // namespace
+
+CpuTopology CpuTopology::Detect()
+{
+	std::vector<int> cpus;
+#if defined(__linux__)
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	if (::sched_getaffinity(0, sizeof(set), &set) == 0) {
+		for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+			if (CPU_ISSET(cpu, &set)) { cpus.push_back(cpu); }
+		}
+	}
+#endif
+	if (cpus.empty()) {
+		for (int cpu = 0, n = static_cast<int>(std::thread::hardware_concurrency()); cpu < n; ++cpu) { cpus.push_back(cpu); }
+	}
+	return Detect(cpus);
+}
+
+CpuTopology CpuTopology::Detect(std::vector<int> const &cpus)
+{
+	std::vector<CpuInfo> infos = Describe(cpus);
+	std::sort(infos.begin(), infos.end(), [](CpuInfo const &a, CpuInfo const &b) {
+		if (a.node != b.node) { return a.node < b.node; }
+		if (a.core != b.core) { return a.core < b.core; }
+		return a.cpu < b.cpu;
+	});
+	return CpuTopology(std::move(infos));
+}
+
+std::size_t CpuTopology::nodes() const noexcept
+{
+	std::vector<int> seen;
+	for (auto const &info : M_cpus) {
+		if (std::find(seen.begin(), seen.end(), info.node) == seen.end()) { seen.push_back(info.node); }
+	}
+	return seen.size();
+}
+
+int CpuTopology::Pin(int cpu)
+{
+#if defined(__linux__)
+	if (cpu < 0 || cpu >= CPU_SETSIZE) { return -EINVAL; }
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+	return -::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set);
+#else
+	(void)cpu;
+	return -ENOSYS;
+#endif
+}
+} // namespace godby
@@ -0,0 +1,113 @@
+#include <cerrno>				 // errno
+#include <fcntl.h>				 // open, O_CREAT, O_RDWR
+#include <unistd.h>				 // close, ftruncate, sysconf
+#include <sys/mman.h>			 // mmap, mremap, munmap
+#include <sys/stat.h>			 // fstat
+#include <godby/TraceRecorder.h> // godby::TraceWriter, godby::TraceFile
+
+namespace godby
+{
+namespace
+{
+std::size_t FileLength(std::size_t records)
+{
+	return sizeof(details::TraceHeader) + records * sizeof(TraceRecord);
+}
+} // namespace
+
+Expected<TraceWriter, int> TraceWriter::Create(const char *path, std::size_t capacity)
+{
+	// Round the file up to whole pages, the tail of the last one holds records too
+	std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+	std::size_t length = (FileLength(capacity ? capacity : 1) + page - 1) & ~(page - 1);
+	capacity = (length - sizeof(details::TraceHeader)) / sizeof(TraceRecord);
+
+	int fd = ::open(path, O_CREAT | O_TRUNC | O_RDWR | O_CLOEXEC, 0644);
+	if (fd < 0) { return Unexpected<int>(errno); }
+	if (::ftruncate(fd, static_cast<off_t>(length)) != 0) {
+		int error = errno;
+		::close(fd);
+		return Unexpected<int>(error);
+	}
+
+	void *p = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (p == MAP_FAILED) {
+		int error = errno;
+		::close(fd);
+		return Unexpected<int>(error);
+	}
+
+	auto header = new (p) details::TraceHeader{details::TraceHeader::MAGIC, details::TraceHeader::VERSION, sizeof(TraceRecord), TscClock::TicksPerSecond(), {0}};
+	return TraceWriter(header, capacity, fd);
+}
+
+TraceWriter::~TraceWriter()
+{
+	Close();
+}
+
+bool TraceWriter::Grow() noexcept
+{
+	std::size_t length = FileLength(M_capacity), grown = FileLength(M_capacity * 2);
+	if (::ftruncate(M_fd, static_cast<off_t>(grown)) != 0) { return false; }
+	void *p = ::mremap(M_header, length, grown, MREMAP_MAYMOVE);
+	if (p == MAP_FAILED) { return false; }
+
+	M_header = static_cast<details::TraceHeader *>(p);
+	M_records = reinterpret_cast<TraceRecord *>(M_header + 1);
+	M_capacity *= 2;
+	return true;
+}
+
+int TraceWriter::Close() noexcept
+{
+	if (!M_header) { return 0; }
+	int error = 0;
+	if (::munmap(M_header, FileLength(M_capacity)) != 0) { error = errno; }
+	if (::ftruncate(M_fd, static_cast<off_t>(FileLength(M_size))) != 0 && !error) { error = errno; }
+	::close(M_fd);
+	M_header = nullptr, M_fd = -1;
+	return error;
+}
+
+Expected<TraceFile, int> TraceFile::Open(const char *path)
+{
+	int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0) { return Unexpected<int>(errno); }
+
+	struct stat st;
+	if (::fstat(fd, &st) != 0) {
+		int error = errno;
+		::close(fd);
+		return Unexpected<int>(error);
+	}
+	std::size_t length = static_cast<std::size_t>(st.st_size);
+	if (length < sizeof(details::TraceHeader)) {
+		::close(fd);
+		return Unexpected<int>(EINVAL);
+	}
+
+	void *p = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+	::close(fd);
+	if (p == MAP_FAILED) { return Unexpected<int>(errno); }
+
+	auto header = static_cast<const details::TraceHeader *>(p);
+	if (header->magic != details::TraceHeader::MAGIC || header->version != details::TraceHeader::VERSION || header->record_size != sizeof(TraceRecord)) {
+		::munmap(p, length);
+		return Unexpected<int>(EINVAL);
+	}
+
+	// Only what the writer had published, a live trace is longer than its records
+	std::size_t count = header->count.load(std::memory_order_acquire);
+	if (FileLength(count) > length) {
+		::munmap(p, length);
+		return Unexpected<int>(EINVAL);
+	}
+	return TraceFile(header, FileLength(count), length);
+}
+
+TraceFile::~TraceFile()
+{
+	if (M_header) { ::munmap(const_cast<details::TraceHeader *>(M_header), M_mapped); }
+}
+} // namespace godby
@@ -1,354 +1,12 @@
-#include "io_service.h"
-
-namespace godby::co
-{
-thread_local unsigned int scheduler::M_thread_id = 0;
-thread_local unsigned int scheduler::M_coro_scheduler_id = 0;
-unsigned int scheduler::M_coro_scheduler_count = 0;
-
-scheduler::scheduler()
-{
-	M_id = ++M_coro_scheduler_count;
-	M_thread_contexts.reserve(128);
-	thread_context *io_cxt = new thread_context;
-	io_cxt->M_tasks = new task_queue(64);
-	M_thread_contexts.push_back(io_cxt);
-	spawn_workers(std::thread::hardware_concurrency());
-}
-
-scheduler::~scheduler()
-{
-	M_stop_requested = true;
-	M_task_wait_flag.test_and_set(std::memory_order_relaxed);
-	M_task_wait_flag.notify_all();
-	for (auto &t_cxt : this->M_thread_contexts) {
-		if (t_cxt->M_thread.joinable()) { t_cxt->M_thread.join(); }
-	}
-}
-
-bool scheduler::steal_task(std::coroutine_handle<> &handle) noexcept
-{
-	auto total_threads = M_total_threads.load(std::memory_order_relaxed);
-
-	bool c = false;
-	do {
-		c = false;
-		unsigned int i = (M_thread_id + 1) % (total_threads + 1);
-		do {
-			task_queue *queue = M_thread_contexts[i]->M_tasks;
-			if (queue->steal(handle)) { return true; }
-			c = c | !queue->empty();
-			i = (i + 1) % (total_threads + 1);
-		} while (i != M_thread_id);
-	} while (c);
-
-	return false;
-}
-
-void scheduler::schedule(const std::coroutine_handle<> &handle) noexcept
-{
-	if (!M_thread_id | (M_coro_scheduler_id != M_id)) {
-		std::unique_lock lk(M_global_task_queue_mutex);
-		M_thread_contexts[0]->M_tasks->enqueue(handle);
-	} else {
-		M_thread_contexts[M_thread_id]->M_tasks->enqueue(handle);
-	}
-	if (!M_task_wait_flag.test_and_set(std::memory_order_relaxed)) { M_task_wait_flag.notify_one(); }
-}
-
-bool scheduler::peek_next_coroutine(std::coroutine_handle<> &handle) noexcept
-{
-	return M_thread_contexts[M_thread_id]->M_tasks->dequeue(handle) ? true : steal_task(handle);
-}
-
-std::coroutine_handle<> scheduler::get_waiting_channel() noexcept
-{
-	return M_thread_contexts[M_thread_id]->M_waiting_channel;
-}
-
-auto scheduler::get_next_coroutine() noexcept -> std::coroutine_handle<>
-{
-	std::coroutine_handle<> handle;
-	return peek_next_coroutine(handle) ? handle : get_waiting_channel();
-}
-
-scheduler_task scheduler::awaiter()
-{
-	struct thread_awaiter {
-		std::coroutine_handle<> &M_handle_ref;
-
-		constexpr bool await_ready() const noexcept
-		{
-			return false;
-		}
-
-		auto await_suspend(const std::coroutine_handle<> &) const noexcept
-		{
-			return M_handle_ref;
-		}
-
-		constexpr void await_resume() const noexcept {}
-	};
-
-	while (!M_stop_requested) {
-		std::coroutine_handle<> handle;
-
-		while (!peek_next_coroutine(handle)) {
-			std::unique_lock<std::mutex> lk(M_task_mutex);
-			M_task_wait_flag.wait(false, std::memory_order_relaxed);
-			lk.unlock();
-			if (M_stop_requested) [[unlikely]] { co_return; }
-			M_task_wait_flag.clear(std::memory_order_relaxed);
-		}
-
-		co_await thread_awaiter{handle};
-	}
-}
-
-void scheduler::spawn_workers(const unsigned int &count)
-{
-	std::unique_lock<std::mutex> lk(M_spawn_thread_mutex);
-	for (unsigned int i = 0; i < count; ++i) {
-		init_thread();
-		M_thread_contexts[M_total_threads]->M_thread = std::thread([&](unsigned int id) {
-			M_thread_id = id;
-			M_coro_scheduler_id = M_id;
-			M_thread_contexts[id]->M_waiting_channel.resume();
-		}, ++M_total_threads);
-	}
-}
-
-void scheduler::init_thread()
-{
-	thread_context *cxt = new thread_context;
-	cxt->M_thread_status.M_status = thread_status::STATUS::READY;
-	cxt->M_tasks = new task_queue(64);
-	cxt->M_waiting_channel = awaiter().handle();
-	M_thread_contexts.push_back(cxt);
-}
-
-void scheduler::set_thread_status(thread_status::STATUS status) noexcept
-{
-	switch (status) {
-		case thread_status::STATUS::READY:
-			set_thread_ready();
-			break;
-		case thread_status::STATUS::RUNNING:
-			set_thread_running();
-			break;
-		case thread_status::STATUS::SUSPENDED:
-			set_thread_suspended();
-			break;
-		default:
-			break;
-	}
-}
-
-void scheduler::set_thread_suspended() noexcept
-{
-	this->M_total_running_threads.fetch_sub(1, std::memory_order_relaxed);
-	if ((this->M_total_suspended_threads.fetch_add(1, std::memory_order_relaxed) + 1) >= M_total_threads.load(std::memory_order_relaxed)) { spawn_workers(1); }
-	M_thread_contexts[M_thread_id]->M_thread_status.M_status.store(thread_status::STATUS::SUSPENDED, std::memory_order_relaxed);
-}
-
-void scheduler::set_thread_ready() noexcept
-{
-	this->M_total_running_threads.fetch_sub(1, std::memory_order_relaxed);
-	this->M_total_ready_threads.fetch_add(1, std::memory_order_relaxed);
-	M_thread_contexts[M_thread_id]->M_thread_status.M_status.store(thread_status::STATUS::READY, std::memory_order_relaxed);
-}
-
-void scheduler::set_thread_running() noexcept
-{
-	if (M_thread_contexts[M_thread_id]->M_thread_status.M_status.load(std::memory_order_relaxed) == thread_status::STATUS::SUSPENDED) {
-		this->M_total_suspended_threads.fetch_sub(1, std::memory_order_relaxed);
-	} else {
-		this->M_total_ready_threads.fetch_sub(1, std::memory_order_relaxed);
-	}
-	this->M_total_running_threads.fetch_add(1, std::memory_order_relaxed);
-	M_thread_contexts[M_thread_id]->M_thread_status.M_status.store(thread_status::STATUS::RUNNING, std::memory_order_relaxed);
-}
-
-thread_local unsigned int io_service::M_thread_id = 0;
-thread_local uring_data::allocator *io_service::M_uio_data_allocator = nullptr;
-thread_local io_op_pipeline *io_service::M_io_queue = nullptr;
-
-io_service::io_service(const u_int &entries, const u_int &flags) : io_operation(this), M_entries(entries), M_flags(flags)
-{
-	io_uring_queue_init(entries, &M_uring, flags);
-	M_io_cq_thread = std::move(std::thread([&] { this->loop(); }));
-}
-
-io_service::io_service(const u_int &entries, io_uring_params &params) : io_operation(this), M_entries(entries)
-{
-	io_uring_queue_init_params(entries, &M_uring, &params);
-	M_io_cq_thread = std::move(std::thread([&] { this->loop(); }));
-}
-
-io_service::~io_service()
-{
-	M_stop_requested.store(true, std::memory_order_relaxed);
-	nop(IOSQE_IO_DRAIN);
-	M_io_cq_thread.join();
-}
-
-void io_service::loop() noexcept
-{
-	while (!M_stop_requested.load(std::memory_order_relaxed)) {
-		io_uring_cqe *cqe = nullptr;
-		if (io_uring_wait_cqe(&M_uring, &cqe) == 0) {
-			handle_completion(cqe);
-			io_uring_cqe_seen(&M_uring, cqe);
-		} else {
-			std::cerr << "Wait CQE Failed\n";
-		}
-		unsigned completed = 0;
-		unsigned head;
-
-		io_uring_for_each_cqe(&M_uring, head, cqe)
-		{
-			++completed;
-			handle_completion(cqe);
-		}
-		if (completed) { io_uring_cq_advance(&M_uring, completed); }
-		if (M_io_queue_overflow.load(std::memory_order_relaxed) != nullptr) [[unlikely]] { submit(); }
-	}
-	io_uring_queue_exit(&M_uring);
-	return;
-}
-
-bool io_service::io_queue_empty() const noexcept
-{
-	bool is_empty = true;
-	for (auto &q : this->M_io_queues) { is_empty = is_empty & q->empty(); }
-	return is_empty;
-}
-
-void io_service::setup_thread_context()
-{
-	if (M_thread_id == 0) {
-		M_thread_id = M_threads.fetch_add(1, std::memory_order_relaxed) + 1;
-		M_uio_data_allocator = new uring_data::allocator;
-		M_uio_data_allocators.push_back(M_uio_data_allocator);
-		M_io_queue = new io_op_pipeline(128);
-		M_io_queues.push_back(M_io_queue);
-	}
-}
-
-void io_service::submit()
-{
-	while (!io_queue_empty() && !M_io_sq_running.exchange(true, std::memory_order_seq_cst)) {
-		auto overflow_queue = M_io_queue_overflow.load(std::memory_order_relaxed);
-		if (overflow_queue != nullptr) [[unlikely]] {
-			int res = overflow_queue->init_io_uring_ops(&M_uring);
-			if (res >= 0) {
-				M_io_queue_overflow.store(nullptr, std::memory_order_relaxed);
-			} else {
-				return;
-			}
-		}
-
-		unsigned int completed = 0;
-		while (!io_queue_empty()) {
-			for (auto &q : M_io_queues) {
-				int res = q->init_io_uring_ops(&M_uring);
-				if (res < 0) [[unlikely]] {
-					M_io_queue_overflow.store(q, std::memory_order_relaxed);
-					return;
-				} else {
-					completed += res;
-				}
-			}
-		}
-		if (completed) { io_uring_submit(&M_uring); }
-		M_io_sq_running.store(false, std::memory_order_relaxed);
-	}
-}
-
-void io_service::handle_completion(io_uring_cqe *cqe)
-{
-	auto data = static_cast<uring_data *>(io_uring_cqe_get_data(cqe));
-	if (data != nullptr) {
-		data->M_result = cqe->res;
-		data->M_flags = cqe->flags;
-		if (data->M_handle_ctl.exchange(true, std::memory_order_acq_rel)) { data->M_scheduler->schedule(data->M_handle); }
-		if (data->M_destroy_ctl.exchange(true, std::memory_order_relaxed)) { data->destroy(); }
-	}
-}
-
-void io_service::submit(io_batch<io_service> &batch)
-{
-	M_io_queue->enqueue(batch.operations());
-	submit();
-}
-
-void io_service::submit(io_link<io_service> &io_link)
-{
-	auto &operations = io_link.operations();
-	size_t op_count = operations.size() - 1;
-
-	for (size_t i = 0; i < op_count; ++i) {
-		std::visit([](auto &&op) { op.M_sqe_flags |= IOSQE_IO_HARDLINK; }, operations[i]);
-	}
-
-	M_io_queue->enqueue(operations);
-
-	submit();
-}
-
-async<void> timer(io_service *io, itimerspec spec, std::function<void()> func)
-{
-	int tfd = timerfd_create(CLOCK_REALTIME, 0);
-	timerfd_settime(tfd, 0, &spec, NULL);
-	std::stop_token st = co_await get_stop_token();
-	std::stop_callback scb(st, [&] { io->close(tfd); });
-
-	while (!st.stop_requested()) {
-		std::cerr << "Waiting for timer to trigger\n";
-		unsigned long u;
-		co_await io->read(tfd, &u, sizeof(u), 0);
-		func();
-	}
-	co_await io->close(tfd);
-}
-
-async<> sleep(io_service *io, unsigned long sec, unsigned long nsec)
-{
-	int tfd = timerfd_create(CLOCK_REALTIME, 0);
-	itimerspec spec;
-	spec.it_value.tv_sec = sec;
-	spec.it_value.tv_nsec = nsec;
-	spec.it_interval.tv_sec = 0;
-	spec.it_interval.tv_nsec = 0;
-	timerfd_settime(tfd, 0, &spec, NULL);
-
-	std::stop_token st = co_await get_stop_token();
-	std::stop_callback scb(st, [&] { io->close(tfd); });
-
-	unsigned long u;
-	co_await io->read(tfd, &u, sizeof(u), 0);
-	co_await io->close(tfd);
-}
-} // namespace godby::co
-
-
-// examples
-#include <fcntl.h>
-#include <string.h>
 #include <cstdlib>
 #include <cstring>
-#include <fcntl.h>
 #include <iostream>
-#include <linux/time_types.h>
-#include <netinet/in.h>
-#include <sys/socket.h>
-#include <cstdlib>
-#include <cstring>
 #include <fcntl.h>
-#include <iostream>
+#include <string.h>
 #include <linux/time_types.h>
 #include <netinet/in.h>
 #include <sys/socket.h>
+#include <godby/IoService.h>
 
 using namespace godby::co;
 
@@ -851,6 +509,50 @@ launch<> coroutine_2(io_service *io)
 }
 } // namespace example13
 
+namespace example14
+{
+// One multishot recv into ring-mapped buffers, the socket registered as a fixed file
+launch<int> coroutine_1(io_service *io, int fds[2])
+{
+	auto buffers = io->create_buffer_ring(1, 8, 64);
+	if (!buffers || !io->register_files(&fds[1], 1)) { co_return -1; }
+
+	auto chunks = io->recv_multishot(0, *buffers, 0, IOSQE_FIXED_FILE);
+	for (const char *message : {"Hello", " multishot", " world\n"}) { co_await io->send(fds[0], (void *)message, strlen(message), 0); }
+	::shutdown(fds[0], SHUT_WR);
+
+	int received = 0;
+	while (auto chunk = co_await chunks.next()) {
+		if (chunk->result <= 0) { break; }
+		unsigned int bid = buffer_ring::buffer_id(chunk->flags);
+		std::cout.write(buffers->buffer(bid), chunk->result);
+		received += chunk->result;
+		buffers->recycle(bid);
+	}
+	io->unregister_files();
+	co_return received;
+}
+} // namespace example14
+
+namespace example15
+{
+// A scheduler with a ring per worker: every read is submitted to and completed on the ring of the
+// worker running the coroutine, which then hops back to the worker it started on
+launch<int> coroutine_1()
+{
+	io_context *home = io_context::current();
+	char buffer[16];
+	int total = 0;
+	for (int i = 0; i < 4; ++i) {
+		int fd = ::open("/dev/zero", O_RDONLY);
+		total += co_await io_context::current()->read(fd, buffer, sizeof(buffer), 0);
+		co_await io_context::current()->close(fd);
+		co_await home->resume_here();
+	}
+	co_return total;
+}
+} // namespace example15
+
 int main(int argc, char **argv)
 {
 	{
@@ -1019,5 +721,30 @@ int main(int argc, char **argv)
 	}
 	std::cout << "\x1b[31mexample 13 done\x1b[0m" << std::endl;
 
+	{
+		using namespace example14;
+
+		scheduler scheduler;
+		io_service io(100, 0);
+
+		int fds[2];
+		socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+		int len = coroutine_1(&io, fds).schedule_on(&scheduler);
+		std::cout << "Received : " << len << std::endl;
+		::close(fds[0]);
+		::close(fds[1]);
+	}
+	std::cout << "\x1b[31mexample 14 done\x1b[0m" << std::endl;
+
+	{
+		using namespace example15;
+
+		scheduler scheduler(ring_options{}, 4);
+
+		int len = coroutine_1().schedule_on(&scheduler);
+		std::cout << "Read : " << len << std::endl;
+	}
+	std::cout << "\x1b[31mexample 15 done\x1b[0m" << std::endl;
+
 	return 0;
 }
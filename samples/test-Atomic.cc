@@ -92,6 +92,42 @@ void bench_load(int n_threads, int num_iterations)
 	show_statistics(all_times);
 }
 
+void bench_snapshot(int n_threads, int num_iterations)
+{
+	godby::AtomicSharedPtr<int> src;
+	src.store(godby::SharedPtr<int>(new int(42)));
+
+	std::atomic<bool> stop{false};
+	std::vector<std::thread> enemies;
+	enemies.reserve(n_threads - 1);
+	for (int i = 0; i < n_threads - 1; i++) {
+		enemies.emplace_back([&src, &stop]() {
+			while (!stop.load(std::memory_order_relaxed)) {
+				auto snapshot = src.snapshot();
+				ankerl::nanobench::doNotOptimizeAway(*snapshot);
+			}
+		});
+	}
+
+	std::vector<double> all_times;
+	for (int i = 0; i < num_iterations; i++) {
+		auto start = std::chrono::high_resolution_clock::now();
+		{
+			auto snapshot = src.snapshot();
+			ankerl::nanobench::doNotOptimizeAway(*snapshot);
+		}
+		auto finish = std::chrono::high_resolution_clock::now();
+
+		auto elapsed_time = std::chrono::duration_cast<std::chrono::duration<double>>(finish - start);
+		all_times.push_back(elapsed_time.count());
+	}
+
+	stop.store(true);
+	for (auto &t : enemies) { t.join(); }
+
+	show_statistics(all_times);
+}
+
 template <template <typename> typename AtomicSharedPtr, template <typename> typename SharedPtr>
 void bench_store_delete(int n_threads, int num_iterations)
 {
@@ -171,6 +207,64 @@ int main(int argc, char **argv)
 		godby::Atomic<std::string> sa;
 		sa.store("hello");
 		ASSERT_EQ(sa.load(), "hello");
+
+		std::string expected = "world";
+		ASSERT_BOOL(sa.compare_exchange_strong(expected, "again"), false);
+		ASSERT_EQ(expected, "hello");
+		ASSERT_BOOL(sa.compare_exchange_strong(expected, "again"), true);
+		ASSERT_EQ(sa.exchange("done"), "again");
+		ASSERT_EQ(sa.load(), "done");
+	}
+
+	// Atomic, trivially copyable
+	{
+		int x = 1, y = 2;
+		godby::Atomic<int *> pa{&x};
+		int *expected = &y;
+		ASSERT_BOOL(pa.compare_exchange_strong(expected, &y), false);
+		ASSERT_BOOL(expected == &x, true);
+		ASSERT_BOOL(pa.exchange(&y) == &x, true);
+		ASSERT_EQ(*pa.load(), 2);
+
+		struct Triple {
+			uint64_t a, b, c;
+		};
+		static_assert(!std::atomic<Triple>::is_always_lock_free);
+
+		godby::Atomic<Triple> ta{Triple{0, 0, 0}};
+		std::atomic<bool> stop{false};
+		std::vector<std::thread> writers;
+		for (uint64_t w = 1; w <= 2; ++w) {
+			writers.emplace_back([&, w]() {
+				for (uint64_t i = 1; !stop.load(std::memory_order_relaxed); ++i) { ta.store(Triple{w * i, w * i, w * i}); }
+			});
+		}
+		for (int i = 0; i < 100000; ++i) {
+			Triple t = ta.load();
+			ASSERT_BOOL(t.a == t.b && t.b == t.c, true);
+		}
+		stop.store(true);
+		for (auto &t : writers) { t.join(); }
+
+		Triple before = ta.load(), after{7, 8, 9};
+		ASSERT_BOOL(ta.compare_exchange_strong(before, after), true);
+		ASSERT_EQ(ta.load().b, 8);
+	}
+
+	// Atomic, readers racing writers
+	{
+		godby::Atomic<std::string> sa{std::string(64, 'a')};
+		std::atomic<bool> stop{false};
+		std::thread writer([&]() {
+			for (char c = 'a'; !stop.load(std::memory_order_relaxed); c = c == 'z' ? 'a' : c + 1) { sa.store(std::string(64, c)); }
+		});
+		for (int i = 0; i < 100000; ++i) {
+			std::string s = sa.load();
+			ASSERT_EQ(s.size(), 64);
+			ASSERT_EQ(s.find_first_not_of(s[0]), std::string::npos);
+		}
+		stop.store(true);
+		writer.join();
 	}
 
 	// RelaxedAtomic
@@ -200,6 +294,62 @@ int main(int argc, char **argv)
 		ASSERT_EQ(sa.value(), "hello");
 	}
 
+	// HazardPointers
+	{
+		struct Node {
+			std::atomic<int> &alive;
+			Node *next{nullptr};
+			explicit Node(std::atomic<int> &alive_) : alive(alive_)
+			{
+				alive.fetch_add(1);
+			}
+			Node *get_next() const noexcept
+			{
+				return next;
+			}
+			void set_next(Node *next_) noexcept
+			{
+				next = next_;
+			}
+			void destroy() noexcept
+			{
+				alive.fetch_sub(1);
+				delete this;
+			}
+		};
+
+		std::atomic<int> alive{0};
+		std::atomic<Node *> first{new Node(alive)}, second{new Node(alive)};
+		auto &hazptr = godby::get_hazard_list<Node>();
+		{
+			auto a = hazptr.make_holder(), b = hazptr.make_holder();
+			ASSERT_BOOL(a.protect(first) == first.load(), true);
+			ASSERT_BOOL(b.protect(second) == second.load(), true);
+			hazptr.retire(first.exchange(nullptr));
+			hazptr.retire(second.exchange(nullptr));
+			hazptr.reclaim();
+			ASSERT_EQ(alive.load(), 2);
+
+			a.release();
+			hazptr.reclaim();
+			ASSERT_EQ(alive.load(), 1);
+		}
+		hazptr.reclaim();
+		ASSERT_EQ(alive.load(), 0);
+
+		std::vector<godby::HazardPointers<Node>::Holder> holders;
+		for (size_t i = 1; i < godby::HazardPointers<Node>::hazard_pointers_per_thread; ++i) { holders.push_back(hazptr.make_holder()); }
+		bool exhausted = false;
+		try {
+			hazptr.make_holder();
+		} catch (std::length_error const &) {
+			exhausted = true;
+		}
+		ASSERT_BOOL(exhausted, true);
+		holders.pop_back();
+		ASSERT_BOOL(static_cast<bool>(hazptr.make_holder()), true);
+	}
+
 	// AtomicSharedPtr
 	{
 		godby::AtomicSharedPtr<int> p;
@@ -212,6 +362,60 @@ int main(int argc, char **argv)
 		ASSERT_EQ(s2.use_count(), 3);
 		ASSERT_EQ(*s2, 5);
 
+		{
+			auto snapshot = p.snapshot();
+			ASSERT_EQ(*snapshot, 5);
+			ASSERT_EQ(s.use_count(), 3); // No reference taken
+			auto s3 = snapshot.shared();
+			ASSERT_EQ(s3.use_count(), 4);
+
+			auto other = p.snapshot(); // Snapshots and loads on one thread do not share a hazard pointer
+			auto s4 = p.load();
+			ASSERT_EQ(*snapshot + *other + *s4, 15);
+		}
+		ASSERT_BOOL(godby::AtomicSharedPtr<int>().snapshot().get() == nullptr, true);
+
+		// Replaced and released while a snapshot reads it
+		{
+			struct Tracked {
+				std::atomic<int> &alive;
+				explicit Tracked(std::atomic<int> &alive_) : alive(alive_)
+				{
+					alive.fetch_add(1);
+				}
+				~Tracked()
+				{
+					alive.fetch_sub(1);
+				}
+			};
+			std::atomic<int> alive{0};
+			godby::AtomicSharedPtr<Tracked> t{godby::SharedPtr<Tracked>(new Tracked(alive))};
+			auto &hazptr = godby::get_hazard_list<godby::details::ControlBlockBase>();
+			auto snapshot = t.snapshot();
+			t.store(godby::SharedPtr<Tracked>(new Tracked(alive)));
+			hazptr.reclaim();
+			ASSERT_EQ(alive.load(), 2);
+			ASSERT_BOOL(snapshot.shared() == nullptr, true);
+
+			snapshot.reset();
+			hazptr.reclaim();
+			ASSERT_EQ(alive.load(), 1);
+			t.store(nullptr);
+			hazptr.reclaim();
+			ASSERT_EQ(alive.load(), 0);
+		}
+
+		std::atomic<bool> stop{false};
+		std::thread writer([&]() {
+			for (int i = 0; !stop.load(std::memory_order_relaxed); ++i) { p.store(godby::SharedPtr<int>(new int(i))); }
+		});
+		for (int i = 0; i < 100000; ++i) {
+			auto snapshot = p.snapshot();
+			ankerl::nanobench::doNotOptimizeAway(*snapshot);
+		}
+		stop.store(true);
+		writer.join();
+
 		bench_lock<std::shared_mutex, std::shared_lock>(8, 100000);
 		bench_lock<std::shared_mutex, std::unique_lock>(8, 100000);
 
@@ -220,6 +424,7 @@ int main(int argc, char **argv)
 		bench_lock<godby::Spinlock, std::lock_guard>(8, 100000);
 
 		bench_load<godby::AtomicSharedPtr, godby::SharedPtr>(8, 100000);
+		bench_snapshot(8, 100000);
 		bench_store_delete<godby::AtomicSharedPtr, godby::SharedPtr>(8, 100000);
 		bench_store_copy<godby::AtomicSharedPtr, godby::SharedPtr>(8, 100000);
 
@@ -1,5 +1,17 @@
 #include "godbytest.h"
+#include <string_view>
+#include <thread>
 #include <godby/AtomicHashmap.h>
+#include <godby/StealingExecutor.h>
+
+struct StringHash {
+	using is_transparent = void;
+
+	size_t operator()(std::string_view key) const noexcept
+	{
+		return std::hash<std::string_view>()(key);
+	}
+};
 
 int main(int argc, char **argv)
 {
@@ -50,6 +62,32 @@ int main(int argc, char **argv)
 			}
 		}
 
+		{
+			int visited = 0;
+			map.WalkKey("1234", [&](auto key, auto value) {
+				ASSERT_EQ(key.value(), "1234");
+				ASSERT_EQ(value.value(), 1234);
+				++visited;
+			});
+			ASSERT_EQ(visited, 1);
+			map.WalkKey("-1", [&](auto *) { ++visited; });
+			ASSERT_EQ(visited, 1);
+		}
+
+		{
+			godby::TaskExecutor<> executor(4);
+			std::atomic<size_t> count{0}, sum{0};
+			map.ParallelWalk(
+				executor,
+				[&](auto key, auto value) {
+					count.fetch_add(1, std::memory_order_relaxed);
+					sum.fetch_add(value.value() - (std::stoi(key.value()) < 500 ? 10000 : 0), std::memory_order_relaxed);
+				},
+				1024);
+			ASSERT_EQ(count.load(), 4096u);
+			ASSERT_EQ(sum.load(), 4096u * 4095 / 2);
+		}
+
 		map.Cleanup();
 
 		{
@@ -58,5 +96,112 @@ int main(int argc, char **argv)
 		}
 	}
 
+	// Heterogeneous lookup and precomputed hashes
+	{
+		godby::AtomicHashmap<std::string, int, StringHash> map(1024);
+		std::string_view wire = "request:42";
+
+		size_t hash = map.Hash(wire);
+		ASSERT_EQ(hash, map.Hash(std::string(wire)));
+		ASSERT_EQ(map.Get(wire, hash).has(), false);
+		ASSERT_EQ(map.Set(wire, hash, 42), 0);
+		ASSERT_EQ(map.Get(wire, hash).value(), 42);
+		ASSERT_EQ(map.Get(std::string("request:42")).value(), 42);
+		ASSERT_EQ(map.Set(wire, 43), 0);
+		ASSERT_EQ(map.Get(wire).value(), 43);
+
+		int visited = 0;
+		map.WalkKey(wire, hash, [&visited](auto *) { ++visited; });
+		ASSERT_EQ(visited, 1);
+
+		map.Delete(wire, hash);
+		ASSERT_EQ(map.Get(wire).has(), false);
+	}
+
+	// Inline buckets
+	{
+		struct Pair {
+			uint32_t a, b;
+		};
+		using Map = godby::AtomicHashmap<int, Pair>;
+		static_assert(std::is_same_v<Map::Bucket, godby::details::InlineMapBucket<int, Pair>>);
+		static_assert(std::is_same_v<godby::AtomicHashmap<std::string, int>::Bucket, godby::details::ConcurrentMapBucket<std::string, int>>);
+
+		Map map(1024);
+		ASSERT_EQ(map.Set(7, Pair{0, ~0u}), 0);
+
+		std::atomic<bool> stop{false};
+		std::thread reader([&map, &stop]() {
+			while (!stop.load(std::memory_order_relaxed)) {
+				auto accessor = map.Get(7);
+				ASSERT_EQ(accessor.has(), true);
+				ASSERT_EQ(accessor.value().b, ~accessor.value().a); // Never torn
+			}
+		});
+		for (uint32_t i = 0; i < 1000000; ++i) { map.Set(7, Pair{i, ~i}); }
+		stop.store(true);
+		reader.join();
+
+		map.Delete(7);
+		ASSERT_EQ(map.Get(7).has(), false);
+	}
+
+	// Snapshot and mmap warm-start
+	{
+		const char *path = "/tmp/test-AtomicHashmap.snapshot";
+		{
+			godby::AtomicHashmap<uint64_t, uint64_t> map(64);
+			for (uint64_t i = 1; i <= 10000; ++i) { map.Set(i, i * i); }
+			map.Delete(5);
+			ASSERT_EQ(map.Snapshot(path), 0);
+		}
+
+		auto loaded = godby::AtomicHashmap<uint64_t, uint64_t>::Load(path);
+		ASSERT_BOOL(loaded.has_value(), true);
+		auto &map = **loaded;
+		for (uint64_t i = 1; i <= 10000; ++i) {
+			auto accessor = map.Get(i);
+			ASSERT_EQ(accessor.has(), i != 5);
+			if (accessor) { ASSERT_EQ(accessor.value(), i * i); }
+		}
+
+		// The loaded map stays fully writable, copy-on-write
+		ASSERT_EQ(map.Set(5, 25), 0);
+		ASSERT_EQ(map.Set(20000, 1), 0);
+		ASSERT_EQ(map.Get(5).value(), 25u);
+		ASSERT_EQ(map.Get(20000).value(), 1u);
+		ASSERT_BOOL((godby::AtomicHashmap<uint64_t, uint32_t>::Load(path).has_value()), false); // Layout mismatch
+		std::remove(path);
+	}
+
+	// Online growth
+	{
+		godby::AtomicHashmap<int, int> map(64);
+		size_t levels = map.LevelCount();
+
+		constexpr int THREADS = 4, N = 50000;
+		std::thread threads[THREADS];
+		for (int t = 0; t < THREADS; ++t) {
+			threads[t] = std::thread([&map, t]() {
+				for (int i = t * N; i < (t + 1) * N; ++i) {
+					ASSERT_EQ(map.Set(i, i), 0);
+					ASSERT_EQ(map.Get(i).has(), true);
+				}
+			});
+		}
+		for (auto &thread : threads) { thread.join(); }
+
+		ASSERT_BOOL(map.LevelCount() > levels, true);
+		for (int i = 0; i < THREADS * N; ++i) {
+			auto accessor = map.Get(i);
+			ASSERT_EQ(accessor.has(), true);
+			ASSERT_EQ(accessor.value(), i);
+		}
+
+		size_t count = 0;
+		map.WalkAll([&count](auto *) { ++count; });
+		ASSERT_EQ(count, size_t(THREADS * N));
+	}
+
 	return 0;
 }
@@ -1,10 +1,15 @@
 #include "godbytest.h"
 #include <godby/Barrier.h>
 #include <godby/AtomicQueue.h>
+#include <godby/SharedMemory.h>
+#include <godby/UnboundedAtomicQueue.h>
 
 #define BOOST_TEST_MODULE AtomicQueue
 #include <boost/test/unit_test.hpp>
 
+#include <sys/wait.h>
+#include <unistd.h>
+
 using namespace godby;
 
 template <class Queue>
@@ -251,3 +256,194 @@ BOOST_AUTO_TEST_CASE(power_of_2)
 	static_assert(NextPowerOfTwo(0x40000000u) == 0x40000000u, "");
 	static_assert(NextPowerOfTwo(0x40000000u + 1) == 0x80000000u, "");
 }
+
+template <class Q>
+void test_batch(Q &q)
+{
+	unsigned const capacity = q.capacity();
+
+	std::vector<unsigned> in(capacity + 16);
+	for (unsigned i = 0; i < in.size(); ++i) { in[i] = i + 1; }
+
+	// Only as many elements as there are free slots get pushed.
+	BOOST_CHECK_EQUAL(q.try_push_n(in.begin(), in.begin() + 8), 8u);
+	BOOST_CHECK_EQUAL(q.was_size(), 8u);
+	BOOST_CHECK_EQUAL(q.try_push_n(in.begin() + 8, in.end()), capacity - 8);
+	BOOST_CHECK(q.was_full());
+	BOOST_CHECK_EQUAL(q.try_push_n(in.begin(), in.begin() + 1), 0u);
+
+	std::vector<unsigned> out;
+	BOOST_CHECK_EQUAL(q.try_pop_n(std::back_inserter(out), 5), 5u);
+	BOOST_CHECK_EQUAL(q.try_pop_n(std::back_inserter(out), capacity), capacity - 5);
+	BOOST_CHECK(q.was_empty());
+	BOOST_CHECK_EQUAL(q.try_pop_n(std::back_inserter(out), 1), 0u);
+
+	BOOST_REQUIRE_EQUAL(out.size(), capacity);
+	for (unsigned i = 0; i < capacity; ++i) { BOOST_CHECK_EQUAL(out[i], i + 1); }
+}
+
+BOOST_AUTO_TEST_CASE(batch_b)
+{
+	AtomicQueueB<unsigned> q(CAPACITY);
+	test_batch(q);
+}
+
+BOOST_AUTO_TEST_CASE(batch_b2)
+{
+	AtomicQueueB2<unsigned> q(CAPACITY);
+	test_batch(q);
+}
+
+BOOST_AUTO_TEST_CASE(batch_spsc)
+{
+	AtomicQueueB2<unsigned, std::allocator<unsigned>, true, false, true> q(CAPACITY);
+	test_batch(q);
+}
+
+BOOST_AUTO_TEST_CASE(batch_move_only_2)
+{
+	AtomicQueue2<std::unique_ptr<int>, 4> q;
+	std::unique_ptr<int> in[] = {std::make_unique<int>(1), std::make_unique<int>(2), std::make_unique<int>(3)};
+	BOOST_CHECK_EQUAL(q.try_push_n(std::make_move_iterator(std::begin(in)), std::make_move_iterator(std::end(in))), 3u);
+	BOOST_CHECK(!in[0] && !in[1] && !in[2]);
+
+	std::unique_ptr<int> out[3];
+	BOOST_CHECK_EQUAL(q.try_pop_n(out, 3), 3u);
+	for (int i = 0; i < 3; ++i) { BOOST_CHECK_EQUAL(*out[i], i + 1); }
+}
+
+BOOST_AUTO_TEST_CASE(stress_ParkingAtomicQueue)
+{
+	stress<AtomicQueue<unsigned, CAPACITY, 0u, true, true, false, false, SpinThenPark<>>>();
+}
+
+BOOST_AUTO_TEST_CASE(stress_ParkingAtomicQueueB2)
+{
+	struct Queue : AtomicQueueB2<unsigned, std::allocator<unsigned>, true, false, false, SpinThenPark<64>> {
+		Queue() : AtomicQueueB2(CAPACITY) {}
+	};
+	stress<Queue>();
+}
+
+BOOST_AUTO_TEST_CASE(park_and_wake)
+{
+	AtomicQueueB<unsigned, std::allocator<unsigned>, 0u, true, false, true, SpinThenPark<16>> q(CAPACITY);
+
+	// The consumer exhausts its spin budget and parks, the producer must wake it up.
+	std::thread consumer([&q]() {
+		for (unsigned n = 1; n <= 3; ++n) { BOOST_CHECK_EQUAL(q.pop(), n); }
+	});
+	for (unsigned n = 1; n <= 3; ++n) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		q.push(n);
+	}
+	consumer.join();
+	BOOST_CHECK(q.was_empty());
+}
+
+BOOST_AUTO_TEST_CASE(unbounded_overflow)
+{
+	UnboundedAtomicQueue<unsigned> q(256);
+	BOOST_CHECK(q.was_empty());
+
+	// Overflow into many segments, then drain in FIFO order.
+	constexpr unsigned N = 256 * 10 + 7;
+	for (unsigned n = 1; n <= N; ++n) { q.push(n); }
+	BOOST_CHECK(!q.was_empty());
+
+	unsigned element = 0;
+	for (unsigned n = 1; n <= N; ++n) {
+		BOOST_REQUIRE(q.try_pop(element));
+		BOOST_CHECK_EQUAL(element, n);
+	}
+	BOOST_CHECK(!q.try_pop(element));
+	BOOST_CHECK(q.was_empty());
+
+	// Steady state stays in a single segment.
+	for (unsigned n = 1; n <= N; ++n) {
+		q.push(n);
+		BOOST_REQUIRE(q.try_pop(element));
+		BOOST_CHECK_EQUAL(element, n);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(stress_UnboundedAtomicQueue)
+{
+	struct Queue : RetryDecorator<UnboundedAtomicQueue<unsigned>> {
+		Queue() : RetryDecorator(256) {}
+	};
+	stress<Queue>();
+}
+
+// Consume N elements in a forked child and report the checksum through its exit status.
+template <class Queue>
+void cross_process(Queue *q)
+{
+	constexpr unsigned N = 100000;
+
+	pid_t pid = fork();
+	BOOST_REQUIRE(pid >= 0);
+	if (pid == 0) {
+		uint64_t sum = 0;
+		for (unsigned n = N; n; --n) { sum += q->pop(); }
+		_exit(sum == uint64_t(N) * (N + 1) / 2 ? 0 : 1);
+	}
+
+	for (unsigned n = N; n; --n) { q->push(n); }
+	int status = 0;
+	BOOST_REQUIRE_EQUAL(waitpid(pid, &status, 0), pid);
+	BOOST_CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+	BOOST_CHECK(q->was_empty());
+}
+
+BOOST_AUTO_TEST_CASE(shared_memory_anonymous_b2)
+{
+	using Queue = RetryDecorator<AtomicQueueB2<uint64_t, SharedMemoryAllocator<uint64_t>>>;
+	auto shm = SharedMemory::Create(nullptr, 1 << 20);
+	BOOST_REQUIRE(shm.has_value());
+	Queue *q = shm->construct<Queue>(1024, shm->get_allocator<uint64_t>());
+	BOOST_CHECK_EQUAL(shm->root<Queue>(), q);
+	cross_process(q);
+}
+
+BOOST_AUTO_TEST_CASE(shared_memory_named_b)
+{
+	using Queue = RetryDecorator<AtomicQueueB<unsigned, SharedMemoryAllocator<unsigned>>>;
+	char const *name = "/godby-test-AtomicQueue";
+	SharedMemory::Unlink(name);
+
+	int fds[2];
+	BOOST_REQUIRE_EQUAL(pipe(fds), 0);
+	pid_t pid = fork();
+	BOOST_REQUIRE(pid >= 0);
+	if (pid == 0) {
+		// Attach by name from a process that did not inherit the mapping.
+		close(fds[1]);
+		char c;
+		if (read(fds[0], &c, 1) != 1) { _exit(2); }
+		auto shm = SharedMemory::Open(name);
+		if (!shm.has_value() || shm->root<Queue>() == nullptr) { _exit(3); }
+		unsigned element;
+		for (unsigned n = 1000; n; --n) {
+			element = shm->root<Queue>()->pop();
+			if (element != 1001 - n) { _exit(1); }
+		}
+		_exit(0);
+	}
+
+	close(fds[0]);
+	auto shm = SharedMemory::Create(name, 1 << 20);
+	BOOST_REQUIRE(shm.has_value());
+	Queue *q = shm->construct<Queue>(256, shm->get_allocator<unsigned>());
+	BOOST_REQUIRE_EQUAL(write(fds[1], "x", 1), 1);
+	for (unsigned n = 1; n <= 1000; ++n) { q->push(n); }
+	close(fds[1]);
+
+	int status = 0;
+	BOOST_REQUIRE_EQUAL(waitpid(pid, &status, 0), pid);
+	BOOST_CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+	BOOST_CHECK_EQUAL(SharedMemory::Unlink(name), 0);
+
+	// Attaching fails once the address range is taken, here by the mapping we still hold.
+	BOOST_CHECK_EQUAL(SharedMemory::Open(dup(shm->fd())).error(), EEXIST);
+}
@@ -0,0 +1,69 @@
+#include <atomic>
+#include <exception>
+#include <thread>
+#include <vector>
+#include <godby/Barrier.h>
+
+namespace
+{
+// Every thread stamps its slot with the round, and after the barrier checks that everyone did.
+template <typename B>
+void Rounds(unsigned threads, unsigned rounds, B &barrier)
+{
+	std::vector<std::atomic<unsigned>> stamps(threads);
+	auto arrive = [&](unsigned id) {
+		if constexpr (requires { barrier.arrive_and_wait(id); }) {
+			barrier.arrive_and_wait(id);
+		} else {
+			barrier.arrive_and_wait();
+		}
+	};
+
+	std::vector<std::thread> workers;
+	for (unsigned id = 0; id < threads; ++id) {
+		workers.emplace_back([&, id]() {
+			for (unsigned round = 1; round <= rounds; ++round) {
+				stamps[id].store(round, std::memory_order_relaxed);
+				arrive(id);
+				for (auto &stamp : stamps) {
+					if (stamp.load(std::memory_order_relaxed) != round) { std::terminate(); }
+				}
+				arrive(id);
+			}
+		});
+	}
+	for (auto &t : workers) { t.join(); }
+}
+} // namespace
+
+int main(int, char *[])
+{
+	using namespace godby;
+
+	{
+		SenseBarrier<> barrier(2);
+		Rounds(2, 100, barrier);
+	}
+
+	{
+		SenseBarrier<SpinThenPark<64>> barrier(5);
+		Rounds(5, 2000, barrier);
+	}
+
+	{
+		TreeBarrier<> barrier(1);
+		Rounds(1, 10, barrier);
+	}
+
+	{
+		TreeBarrier<SpinThenPark<64>, 2> barrier(7); // Uneven levels
+		Rounds(7, 2000, barrier);
+	}
+
+	{
+		TreeBarrier<SpinThenPark<64>> barrier(17);
+		Rounds(17, 500, barrier);
+	}
+
+	return 0;
+}
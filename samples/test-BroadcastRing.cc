@@ -0,0 +1,86 @@
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <godby/BroadcastRing.h>
+
+int main(int, char *[])
+{
+	using namespace godby;
+
+	struct Item {
+		uint64_t index;
+		uint64_t check;
+	};
+
+	// Every reader sees every item while it keeps up
+	{
+		BroadcastRing<Item, 8> ring;
+		auto first = ring.subscribe();
+		auto second = ring.subscribe();
+
+		Item item;
+		if (first.try_read(item)) { std::terminate(); }
+		for (uint64_t i = 0; i < 5; ++i) { ring.publish(Item{i, ~i}); }
+		for (auto *reader : {&first, &second}) {
+			for (uint64_t i = 0; i < 5; ++i) {
+				if (!reader->try_read(item) || item.index != i || item.check != ~i) { std::terminate(); }
+			}
+			if (reader->try_read(item) || reader->lost() != 0) { std::terminate(); }
+		}
+	}
+
+	// A lapped reader jumps to the oldest item left and counts what it missed
+	{
+		BroadcastRing<Item, 8> ring;
+		auto reader = ring.subscribe();
+		for (uint64_t i = 0; i < 20; ++i) { ring.publish(Item{i, ~i}); }
+		if (reader.lag() != 20) { std::terminate(); }
+
+		Item item;
+		if (!reader.try_read(item) || item.index != 13) { std::terminate(); }
+		if (reader.lost() != 13) { std::terminate(); }
+		for (uint64_t i = 14; i < 20; ++i) {
+			if (!reader.try_read(item) || item.index != i) { std::terminate(); }
+		}
+		if (reader.try_read(item)) { std::terminate(); }
+
+		auto late = ring.subscribe_oldest();
+		if (!late.try_read(item) || item.index != 13) { std::terminate(); }
+	}
+
+	// Readers racing a writer that never waits
+	{
+		auto ring = std::make_unique<BroadcastRing<Item, 64>>();
+		constexpr uint64_t COUNT = 200000;
+		std::atomic<bool> stop{false};
+
+		std::vector<std::thread> readers;
+		for (int i = 0; i < 4; ++i) {
+			readers.emplace_back([&, reader = ring->subscribe(), slow = i % 2 == 1]() mutable {
+				uint64_t seen = 0, last = 0;
+				Item item;
+				for (;;) {
+					bool done = stop.load(std::memory_order_acquire);
+					while (reader.try_read(item)) {
+						if (item.check != ~item.index) { std::terminate(); } // Torn
+						if (seen && item.index <= last) { std::terminate(); }
+						last = item.index;
+						++seen;
+						if (slow) { std::this_thread::yield(); }
+					}
+					if (done) { break; }
+				}
+				if (last != COUNT - 1 || seen + reader.lost() != COUNT) { std::terminate(); }
+			});
+		}
+
+		for (uint64_t i = 0; i < COUNT; ++i) { ring->publish(Item{i, ~i}); }
+		stop.store(true, std::memory_order_release);
+		for (auto &t : readers) { t.join(); }
+	}
+
+	return 0;
+}
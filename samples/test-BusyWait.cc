@@ -1,81 +1,48 @@
 #include <stdio.h>
 #include <stdint.h>
-#include <time.h>
-#include <array>
-#include <algorithm>
 #include <chrono>
-#include <iostream>
-#include <sys/time.h>
-
-class HighResolutionSleeper final {
-  private:
-	static inline size_t nanoseconds()
-	{
-		struct timespec ts;
-		clock_gettime(CLOCK_MONOTONIC, &ts);
-		return ts.tv_sec * 1000000000 + ts.tv_nsec;
-	}
-
-  public:
-	double factor = 0.0;
-
-	HighResolutionSleeper() = default;
-
-	HighResolutionSleeper(double scale)
-	{
-		calibrate(scale);
-	}
-
-	// Calibrate to initialize factor
-	void calibrate(double scale = 1.0)
-	{
-		size_t N = 1e9 * scale;
-		auto ts = nanoseconds();
-		for (size_t i = 0; i < N; ++i) {
-			__asm__ __volatile__(""); // Assembly no-op to avoid optimization
-		}
-		auto te = nanoseconds();
-		factor = N / double(te - ts);
-	}
-
-	inline void sleep(size_t ns)
-	{
-		size_t N = ns * factor;
-		for (size_t i = 0; i < N; ++i) {
-			__asm__ __volatile__(""); // Assembly no-op to avoid optimization
-		}
-	}
-};
-
-template <typename Clock = std::chrono::high_resolution_clock>
-inline uint64_t Milliseconds()
-{
-	return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now().time_since_epoch()).count();
-}
+#include <vector>
+#include <godby/Portability.h>
 
 int main()
 {
-	HighResolutionSleeper sleeper(1.0);
-	printf("Factor: %.3f\n", sleeper.factor);
-
-	sleeper.calibrate(5.0);
-	printf("Factor: %.3f\n", sleeper.factor);
+	using namespace std::chrono;
+	using godby::TscClock;
 
-	sleeper.calibrate(10.0);
-	printf("Factor: %.3f\n", sleeper.factor);
+	printf("Invariant: %s, %.3f GHz\n", TscClock::Invariant() ? "yes" : "no", TscClock::TicksPerSecond() * 1e-9);
 
-	sleeper.calibrate(50.0);
-	printf("Factor: %.3f\n\n", sleeper.factor);
+	// Agrees with steady_clock over a second
+	auto tsc = TscClock::now();
+	auto steady = steady_clock::now();
+	godby::spin_for(1s);
+	double drift = duration<double, std::micro>((TscClock::now() - tsc) - (steady_clock::now() - steady)).count();
+	printf("Drift over 1s: %.3f us\n\n", drift);
 
-	std::vector<uint64_t> gaps{1, 5, 10, 20, 50, 100, 200, 500, 1000, 2000};
+	// Pace with absolute deadlines, as a sender would, so an overshoot is not carried to the next gap
+	std::vector<uint64_t> gaps{20, 50, 100, 200, 500, 1000, 2000};
 	for (auto gap : gaps) {
 		size_t times = 0.2 * 1e9 / gap;
-		auto ts = Milliseconds();
-		for (size_t i = 0; i < times; ++i) { sleeper.sleep(gap); }
-		auto te = Milliseconds();
+		auto ts = steady_clock::now();
+		auto deadline = TscClock::now();
+		for (size_t i = 0; i < times; ++i) { godby::spin_until(deadline += nanoseconds(gap)); }
+		double elapsed = duration<double, std::milli>(steady_clock::now() - ts).count();
 
-		printf("Gap: %4lu, Elapsed: %3lu ms, Factor: %.3f\n", gap, te - ts, double(te - ts) / double(times * gap * 1e-6));
+		printf("Gap: %4lu, Elapsed: %7.3f ms, Factor: %.3f\n", gap, elapsed, elapsed / (times * gap * 1e-6));
 	}
 
+	// What a timestamp costs
+	constexpr int N = 10000000;
+	auto start = steady_clock::now();
+	uint64_t sink = 0;
+	for (int i = 0; i < N; ++i) { sink += TscClock::Ticks(); }
+	double ticks = duration<double, std::nano>(steady_clock::now() - start).count() / N;
+	start = steady_clock::now();
+	for (int i = 0; i < N; ++i) { sink += TscClock::now().time_since_epoch().count(); }
+	double now = duration<double, std::nano>(steady_clock::now() - start).count() / N;
+	start = steady_clock::now();
+	for (int i = 0; i < N; ++i) { sink += steady_clock::now().time_since_epoch().count(); }
+	double clock = duration<double, std::nano>(steady_clock::now() - start).count() / N;
+	printf("\nTscClock::Ticks: %.1f ns, TscClock::now: %.1f ns, steady_clock::now: %.1f ns (%lu)\n", ticks, now, clock, sink & 1);
+
 	return 0;
 }
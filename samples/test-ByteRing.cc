@@ -0,0 +1,104 @@
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <godby/ByteRing.h>
+
+int main(int, char *[])
+{
+	using namespace godby;
+
+	// Basic test
+	{
+		SpscByteRing ring(256);
+		if (!ring.peek().empty()) { std::terminate(); }
+
+		auto span = ring.reserve(5);
+		if (span.size() != 5) { std::terminate(); }
+		std::memcpy(span.data(), "hello", 5);
+		if (!ring.peek().empty()) { std::terminate(); } // Not visible before commit
+		ring.commit();
+
+		auto record = ring.peek();
+		if (record.size() != 5 || std::memcmp(record.data(), "hello", 5) != 0) { std::terminate(); }
+		ring.release();
+		if (!ring.peek().empty() || !ring.was_empty()) { std::terminate(); }
+
+		// Partial commit
+		span = ring.reserve(64);
+		std::memcpy(span.data(), "abc", 3);
+		ring.commit(3);
+		record = ring.peek();
+		if (record.size() != 3 || std::memcmp(record.data(), "abc", 3) != 0) { std::terminate(); }
+		ring.release();
+	}
+
+	// Wrap-around keeps records contiguous
+	{
+		SpscByteRing ring(256);
+		for (std::size_t i = 0; i < 1000; ++i) {
+			std::size_t const n = 1 + i % ring.max_size();
+			auto span = ring.reserve(n);
+			if (span.size() != n) { std::terminate(); }
+			std::memset(span.data(), static_cast<int>(i & 0xff), n);
+			ring.commit();
+
+			auto record = ring.peek();
+			if (record.size() != n) { std::terminate(); }
+			for (std::byte b : record) {
+				if (b != static_cast<std::byte>(i & 0xff)) { std::terminate(); }
+			}
+			ring.release();
+		}
+	}
+
+	// Full ring rejects reservations
+	{
+		SpscByteRing ring(256);
+		std::size_t pushed = 0;
+		while (ring.try_push(&pushed, sizeof(pushed))) { ++pushed; }
+		if (pushed != ring.capacity() / 16) { std::terminate(); }
+		if (ring.try_push(&pushed, 0)) { std::terminate(); } // Neither a full ring nor an empty record
+		for (std::size_t i = 0; i < pushed; ++i) {
+			auto record = ring.peek();
+			std::size_t value;
+			std::memcpy(&value, record.data(), sizeof(value));
+			if (value != i) { std::terminate(); }
+			ring.release();
+		}
+		if (!ring.peek().empty()) { std::terminate(); }
+		if (ring.try_push(&pushed, 0) || !ring.was_empty()) { std::terminate(); }
+	}
+
+	// Producer/consumer test
+	{
+		constexpr std::size_t N = 1000000;
+		SpscByteRing ring(4096);
+
+		std::thread producer([&ring]() {
+			for (std::size_t i = 0; i < N; ++i) {
+				std::size_t const n = sizeof(std::size_t) + i % 200;
+				std::span<std::byte> span;
+				while ((span = ring.reserve(n)).empty()) { std::this_thread::yield(); }
+				std::memcpy(span.data(), &i, sizeof(i));
+				std::memset(span.data() + sizeof(i), static_cast<int>(i & 0xff), n - sizeof(i));
+				ring.commit();
+			}
+		});
+
+		for (std::size_t i = 0; i < N; ++i) {
+			std::span<const std::byte> record;
+			while ((record = ring.peek()).empty()) { std::this_thread::yield(); }
+			std::size_t value;
+			std::memcpy(&value, record.data(), sizeof(value));
+			if (value != i || record.size() != sizeof(std::size_t) + i % 200) { std::terminate(); }
+			for (std::size_t k = sizeof(value); k < record.size(); ++k) {
+				if (record[k] != static_cast<std::byte>(i & 0xff)) { std::terminate(); }
+			}
+			ring.release();
+		}
+		producer.join();
+		std::cout << N << std::endl;
+	}
+
+	return 0;
+}
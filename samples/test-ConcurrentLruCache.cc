@@ -0,0 +1,85 @@
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <string>
+#include <thread>
+#include <vector>
+#include <godby/ConcurrentLruCache.h>
+
+int main(int, char *[])
+{
+	using namespace godby;
+	using namespace std::chrono_literals;
+
+	// Set, replace, get and delete
+	{
+		ConcurrentLruCache<std::string, int> cache(64);
+		std::string key = std::string(100, 'x'); // Not inlined in the string
+		int value = 0;
+		if (cache.Get(key, value)) { std::terminate(); }
+		if (!cache.Set(key, 1) || cache.Set(key, 2)) { std::terminate(); }
+		if (!cache.Get(key, value) || value != 2 || cache.Size() != 1) { std::terminate(); }
+		if (!cache.Delete(key) || cache.Delete(key) || cache.Get(key, value) || cache.Size() != 0) { std::terminate(); }
+
+		auto stats = cache.Stats();
+		if (stats.hits != 1 || stats.misses != 2 || stats.evictions != 0) { std::terminate(); }
+	}
+
+	// A full shard evicts the first entry not looked up since the hand last passed it
+	{
+		ConcurrentLruCache<int, int> cache(4, 0ms, 1);
+		for (int i = 1; i <= 4; ++i) { cache.Set(i, i); }
+		int value = 0;
+		if (!cache.Get(1, value) || !cache.Get(3, value)) { std::terminate(); }
+
+		cache.Set(5, 5); // 1 had a second chance, 2 did not
+		if (cache.Get(2, value) || !cache.Get(1, value) || !cache.Get(5, value)) { std::terminate(); }
+		cache.Set(6, 6); // The hand goes on from 3, which had its chance, to 4
+		if (cache.Get(4, value) || !cache.Get(3, value) || cache.Size() != 4 || cache.Stats().evictions != 2) { std::terminate(); }
+	}
+
+	// Entries expire on the reaper, a Set in between restarts their time to live
+	{
+		ConcurrentLruCache<int, int> cache(1024, 100ms);
+		for (int i = 0; i < 100; ++i) { cache.Set(i, i); }
+		int value = 0;
+		if (!cache.Get(42, value) || value != 42) { std::terminate(); }
+
+		std::this_thread::sleep_for(60ms);
+		cache.Set(7, 70);
+		for (int i = 0; i < 200 && cache.Size() != 1; ++i) { std::this_thread::sleep_for(1ms); }
+		if (cache.Size() != 1 || !cache.Get(7, value) || value != 70) { std::terminate(); }
+
+		for (int i = 0; i < 500 && cache.Size() != 0; ++i) { std::this_thread::sleep_for(1ms); }
+		if (cache.Size() != 0 || cache.Stats().expirations != 100) { std::terminate(); }
+	}
+
+	// Readers and writers on shared keys: any value seen belongs to its key
+	{
+		ConcurrentLruCache<int, int> cache(512, 20ms, 8);
+		std::atomic<uint64_t> found{0};
+		std::vector<std::thread> threads;
+		for (int t = 0; t < 4; ++t) {
+			threads.emplace_back([&, t]() {
+				for (int i = 0; i < 50000; ++i) {
+					int key = (i * 7 + t * 131) % 1024, value = 0;
+					if (cache.Get(key, value)) {
+						if (value != key * 3) { std::terminate(); }
+						found.fetch_add(1, std::memory_order_relaxed);
+					} else if (i % 3 == 0) {
+						cache.Delete(key + 1);
+					} else {
+						cache.Set(key, key * 3);
+					}
+				}
+			});
+		}
+		for (auto &thread : threads) { thread.join(); }
+
+		auto stats = cache.Stats();
+		if (stats.hits != found.load() || stats.hits + stats.misses != 4 * 50000) { std::terminate(); }
+		if (cache.Size() > cache.Capacity()) { std::terminate(); }
+	}
+
+	return 0;
+}
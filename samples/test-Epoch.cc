@@ -0,0 +1,124 @@
+#include <atomic>
+#include <exception>
+#include <thread>
+#include <vector>
+#include <godby/Epoch.h>
+#include <godby/HazardPointers.h>
+
+namespace
+{
+std::atomic<int> alive{0};
+
+struct Node {
+	static constexpr unsigned MAGIC = 0x600db7e5;
+
+	explicit Node(unsigned value_) : value(value_)
+	{
+		alive.fetch_add(1);
+	}
+
+	Node *get_next() const noexcept
+	{
+		return next;
+	}
+
+	void set_next(Node *next_) noexcept
+	{
+		next = next_;
+	}
+
+	void destroy() noexcept
+	{
+		magic = 0;
+		alive.fetch_sub(1);
+		delete this;
+	}
+
+	unsigned magic{MAGIC};
+	unsigned value;
+	Node *next{nullptr};
+};
+
+// One writer replaces the node while readers check it, the same code on either reclamation scheme.
+template <godby::Reclaimer R>
+void Replace(R &reclaimer)
+{
+	std::atomic<Node *> current{new Node(0)};
+	std::atomic<bool> stop{false};
+
+	std::vector<std::thread> readers;
+	for (int i = 0; i < 4; ++i) {
+		readers.emplace_back([&]() {
+			while (!stop.load(std::memory_order_relaxed)) {
+				[[maybe_unused]] auto guard = reclaimer.pin();
+				Node *node = reclaimer.protect(current);
+				if (node->magic != Node::MAGIC) { std::terminate(); }
+				reclaimer.release();
+			}
+		});
+	}
+
+	for (unsigned i = 1; i <= 100000; ++i) { reclaimer.retire(current.exchange(new Node(i))); }
+	stop.store(true);
+	for (auto &t : readers) { t.join(); }
+
+	reclaimer.retire(current.exchange(nullptr));
+}
+} // namespace
+
+int main(int, char *[])
+{
+	using namespace godby;
+
+	static_assert(Reclaimer<Epoch<Node>>);
+	static_assert(Reclaimer<HazardPointers<Node>>);
+
+	// Objects outlive the critical sections that can see them
+	{
+		auto &epoch = get_epoch_domain<Node>();
+		Node *node = new Node(1);
+		{
+			auto guard = epoch.pin();
+			auto nested = epoch.pin();
+			epoch.retire(node);
+			for (int i = 0; i < 4; ++i) { epoch.reclaim(); }
+			if (alive.load() != 1) { std::terminate(); }
+		}
+		if (epoch.pinned()) { std::terminate(); }
+		for (int i = 0; i < 4; ++i) { epoch.reclaim(); }
+		if (alive.load() != 0) { std::terminate(); }
+	}
+
+	// A pinned thread holds back reclamation
+	{
+		auto &epoch = get_epoch_domain<Node>();
+		std::atomic<int> stage{0};
+		std::thread reader([&]() {
+			auto guard = epoch.pin();
+			stage.store(1);
+			while (stage.load() != 2) { std::this_thread::yield(); }
+		});
+		while (stage.load() != 1) { std::this_thread::yield(); }
+
+		epoch.retire(new Node(2));
+		for (int i = 0; i < 4; ++i) { epoch.reclaim(); }
+		if (alive.load() != 1) { std::terminate(); }
+
+		stage.store(2);
+		reader.join();
+		for (int i = 0; i < 4; ++i) { epoch.reclaim(); }
+		if (alive.load() != 0) { std::terminate(); }
+	}
+
+	// Readers racing a writer
+	{
+		Replace(get_epoch_domain<Node>());
+		for (int i = 0; i < 4; ++i) { get_epoch_domain<Node>().reclaim(); }
+		if (alive.load() != 0) { std::terminate(); }
+
+		Replace(get_hazard_list<Node>());
+		get_hazard_list<Node>().reclaim();
+	}
+
+	return 0;
+}
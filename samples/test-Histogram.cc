@@ -0,0 +1,76 @@
+#include <algorithm>
+#include <exception>
+#include <random>
+#include <thread>
+#include <vector>
+#include <godby/Histogram.h>
+
+int main()
+{
+	using namespace godby;
+
+	// Small values are exact, larger ones within 2^-Precision
+	{
+		Histogram<> histogram;
+		for (uint64_t i = 1; i <= 100; ++i) { histogram.Record(i); }
+		auto snapshot = histogram.Snapshot();
+		if (snapshot.Count() != 100 || snapshot.Min() != 1 || snapshot.Max() != 100 || snapshot.Mean() != 50.5) { std::terminate(); }
+		if (snapshot.Percentile(0.5) != 50 || snapshot.Percentile(0.99) != 99 || snapshot.Percentile(1.0) != 100) { std::terminate(); }
+
+		std::mt19937_64 rng(7);
+		std::vector<uint64_t> values;
+		Histogram<> wide;
+		for (int i = 0; i < 100000; ++i) {
+			uint64_t value = rng() >> (rng() % 64);
+			values.push_back(value);
+			wide.Record(value);
+		}
+		std::sort(values.begin(), values.end());
+		auto all = wide.Snapshot();
+		for (double p : {0.5, 0.9, 0.99, 0.999}) {
+			uint64_t exact = values[static_cast<size_t>(p * values.size() + 0.5) - 1], approximate = all.Percentile(p);
+			if (approximate < exact || approximate - exact > exact / 128) { std::terminate(); }
+		}
+		if (all.Max() != values.back() || all.Percentile(1.0) != values.back()) { std::terminate(); }
+
+		uint64_t buckets = 0, previous = 0;
+		all.ForEach([&](uint64_t lowest, uint64_t highest, uint64_t count) {
+			if (lowest > highest || (buckets && lowest <= previous)) { std::terminate(); }
+			previous = highest, buckets += count;
+		});
+		if (buckets != values.size()) { std::terminate(); }
+
+		wide.Reset();
+		if (wide.Snapshot().Count() != 0 || wide.Snapshot().Percentile(0.5) != 0) { std::terminate(); }
+	}
+
+	// Snapshots merge
+	{
+		Histogram<4> a, b;
+		a.Record(10, 3), b.Record(1000);
+		auto merged = a.Snapshot();
+		merged.Merge(b.Snapshot());
+		if (merged.Count() != 4 || merged.Min() != 10 || merged.Max() != 1000 || merged.Percentile(0.75) != 10) { std::terminate(); }
+	}
+
+	// One histogram per thread, snapshots taken while they record
+	{
+		HistogramSet<> set;
+		std::vector<std::thread> threads;
+		for (uint64_t t = 0; t < 4; ++t) {
+			threads.emplace_back([&set, t]() {
+				auto &local = set.Acquire();
+				for (uint64_t i = 0; i < 100000; ++i) { local.Record(t * 1000 + i % 100); }
+			});
+		}
+		for (int i = 0; i < 100; ++i) {
+			if (set.Snapshot().Count() > 400000) { std::terminate(); }
+		}
+		for (auto &thread : threads) { thread.join(); }
+
+		auto snapshot = set.Snapshot();
+		if (snapshot.Count() != 400000 || snapshot.Min() != 0 || snapshot.Max() != 3099) { std::terminate(); }
+	}
+
+	return 0;
+}
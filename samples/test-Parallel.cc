@@ -0,0 +1,71 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <vector>
+#include <godby/Parallel.h>
+
+int main(int, char *[])
+{
+	using namespace godby;
+
+	TaskExecutor<> executor(4);
+
+	// parallel_for visits every index once
+	{
+		std::vector<std::atomic<int>> hits(100000);
+		parallel::parallel_for(executor, size_t(0), hits.size(), [&](size_t i) { hits[i]++; }, 128);
+		for (auto &hit : hits) {
+			if (hit.load() != 1) { std::terminate(); }
+		}
+		parallel::parallel_for(executor, 10, 10, [](int) { std::terminate(); });
+	}
+
+	// parallel_reduce keeps the order of a non-commutative reduction
+	{
+		auto concat = [](std::vector<int> a, std::vector<int> b) {
+			a.insert(a.end(), b.begin(), b.end());
+			return a;
+		};
+		auto digits = parallel::parallel_reduce(executor, 0, 1000, std::vector<int>{}, [](int i) { return std::vector<int>{i}; }, concat, 7);
+		if (digits.size() != 1000) { std::terminate(); }
+		for (int i = 0; i < 1000; ++i) {
+			if (digits[i] != i) { std::terminate(); }
+		}
+
+		auto sum = parallel::parallel_reduce(executor, int64_t(0), int64_t(1000000), int64_t(0), [](int64_t i) { return i; }, std::plus<>(), 1000);
+		if (sum != int64_t(1000000) * 999999 / 2) { std::terminate(); }
+	}
+
+	// parallel_sort, also with many equal keys
+	{
+		std::mt19937 rng(42);
+		for (int range : {1 << 30, 16}) {
+			std::vector<int> values(200000);
+			for (auto &value : values) { value = static_cast<int>(rng() % range); }
+			auto expected = values;
+			std::sort(expected.begin(), expected.end());
+			parallel::parallel_sort(executor, values.begin(), values.end(), std::less<>(), 1024);
+			if (values != expected) { std::terminate(); }
+		}
+	}
+
+	// nested fork-join from inside tasks, joins help instead of blocking the workers
+	{
+		std::atomic<int> leaves{0};
+		std::function<void(int)> tree = [&](int depth) {
+			if (depth == 0) {
+				leaves++;
+				return;
+			}
+			parallel::parallel_invoke(executor, [&]() { tree(depth - 1); }, [&]() { tree(depth - 1); }, [&]() { tree(depth - 1); });
+		};
+		tree(7);
+		if (leaves.load() != 3 * 3 * 3 * 3 * 3 * 3 * 3) { std::terminate(); }
+	}
+
+	std::cout << "Parallel: ok" << std::endl;
+	return 0;
+}
@@ -0,0 +1,50 @@
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <vector>
+#include <godby/PerfCounters.h>
+
+int main()
+{
+	using namespace godby;
+
+	auto counters = PerfCounters::Open();
+	if (!counters) {
+		// No PMU in this VM or counting forbidden: what callers see, nothing to measure
+		printf("perf_event_open: %s, skipped\n", strerror(counters.error()));
+		return 0;
+	}
+
+	auto Measure = [&](size_t stride) {
+		std::vector<char> memory(64 << 20);
+		{
+			PerfScope scope(&*counters);
+			for (size_t i = 0; i < memory.size(); i += stride) { memory[i] += 1; }
+		}
+		return counters->Read();
+	};
+
+	// Touching every cache line of 64MiB misses far more than touching one byte in 64
+	PerfReading lines = Measure(64), bytes = Measure(4096);
+	for (unsigned i = 0; i < lines.size; ++i) {
+		printf("%-14s %12llu %12llu%s\n", PerfEventName(lines.events[i]), (unsigned long long)lines.values[i], (unsigned long long)bytes.values[i], lines.multiplexed ? " (multiplexed)" : "");
+		if (lines.events[i] == PerfEvent::Instructions && lines.values[i] <= bytes.values[i]) { std::terminate(); }
+	}
+
+	// Stopped counters do not move
+	PerfReading before = counters->Read();
+	std::atomic<int> spin{0};
+	while (spin.fetch_add(1, std::memory_order_relaxed) < 1000000) {}
+	PerfReading after = counters->Read();
+	for (unsigned i = 0; i < before.size; ++i) {
+		if (before.values[i] != after.values[i]) { std::terminate(); }
+	}
+
+	PerfReading total = before;
+	total += after;
+	if (total.size != before.size || (total.size && total.values[0] != 2 * before.values[0])) { std::terminate(); }
+
+	PerfScope disabled(nullptr);
+	return 0;
+}
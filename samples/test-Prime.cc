@@ -0,0 +1,72 @@
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <vector>
+#include <godby/Math.h>
+
+using namespace godby;
+
+// Capacities of fixed-size tables can be computed at compile time
+static_assert(ConstexprNextPrime(1000) == 1009);
+static_assert(ConstexprIsPrime(18446744073709551557ull)); // Largest 64-bit prime
+static_assert(!ConstexprIsPrime(3825123056546413051ull)); // Strong pseudoprime to the bases 2 to 23
+static_assert(FastMod(1009).mod(123456789) == 123456789 % 1009);
+
+static bool trial_division(uint64_t n)
+{
+	if (n < 2) { return false; }
+	for (uint64_t d = 2; d * d <= n; ++d) {
+		if (n % d == 0) { return false; }
+	}
+	return true;
+}
+
+int main()
+{
+	for (uint64_t n = 0; n < 200000; ++n) {
+		if (IsPrime(n) != trial_division(n)) {
+			fprintf(stderr, "IsPrime(%llu) is wrong\n", (unsigned long long)n);
+			std::terminate();
+		}
+	}
+
+	// Around and past the 4.7e9 limit of the previous implementation
+	for (uint64_t n = 4759123141ull - 1000; n < 4759123141ull + 1000; ++n) {
+		if (IsPrime(n) != trial_division(n)) { std::terminate(); }
+	}
+
+	std::vector<uint64_t> primes = {2305843009213693951ull, 4611686018427387847ull, 9223372036854775783ull, 1000000000000000003ull};
+	std::vector<uint64_t> composites = {
+		3215031751ull, // Strong pseudoprime to the bases 2, 3, 5 and 7
+		2152302898747ull, // ... to 2 to 11
+		3474749660383ull, // ... to 2 to 13
+		341550071728321ull, // ... to 2 to 17
+		4611686014132420609ull, // (2^31 - 1)^2
+		18446744073709551615ull, // 3 * 5 * 17 * 257 * 641 * 65537 * 6700417
+	};
+	for (auto p : primes) {
+		if (!IsPrime(p)) { std::terminate(); }
+	}
+	for (auto c : composites) {
+		if (IsPrime(c)) { std::terminate(); }
+	}
+
+	if (NextPrime(4294967291ull + 1) != 4294967311ull) { std::terminate(); } // Past unsigned
+	if (NextPrime(1ull << 62) != (1ull << 62) + 135) { std::terminate(); }
+	// FastMod agrees with % for the prime capacities AtomicHashmap levels use, and for the edges
+	uint64_t x = 0x9e3779b97f4a7c15ull;
+	for (uint64_t d : {1ull, 2ull, 3ull, 1009ull, 4294967311ull, (1ull << 62) + 135, 18446744073709551557ull, ~0ull}) {
+		FastMod modulo(d);
+		uint64_t edges[] = {0, 1, d - 1, d, d + 1, ~0ull};
+		for (uint64_t a : edges) {
+			if (modulo.mod(a) != a % d) { std::terminate(); }
+		}
+		for (int i = 0; i < 100000; ++i) {
+			x ^= x << 13, x ^= x >> 7, x ^= x << 17;
+			if (modulo.mod(x) != x % d) { std::terminate(); }
+		}
+	}
+	printf("primes ok\n");
+
+	return 0;
+}
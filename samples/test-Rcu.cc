@@ -0,0 +1,112 @@
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <godby/Rcu.h>
+
+namespace
+{
+std::atomic<int> alive{0};
+
+struct Config {
+	static constexpr unsigned MAGIC = 0xc0ff1e;
+
+	explicit Config(unsigned version_) : version(version_)
+	{
+		alive.fetch_add(1);
+	}
+
+	~Config()
+	{
+		magic = 0;
+		alive.fetch_sub(1);
+	}
+
+	unsigned magic{MAGIC};
+	unsigned version;
+};
+} // namespace
+
+int main(int, char *[])
+{
+	using namespace godby;
+
+	// Nesting and deferred deletion
+	{
+		RcuProtected<Config> config{std::make_unique<Config>(0)};
+		{
+			RcuReadLock outer;
+			{
+				RcuReadLock inner;
+				if (config.read()->version != 0) { std::terminate(); }
+			}
+			if (!Rcu::instance().reading()) { std::terminate(); }
+			config.update(std::make_unique<Config>(1)); // Queued, this thread is still reading
+			if (alive.load() != 2) { std::terminate(); }
+		}
+		if (Rcu::instance().reading()) { std::terminate(); }
+
+		rcu_barrier();
+		if (alive.load() != 1) { std::terminate(); }
+		if (config.read([](Config const *c) { return c->version; }) != 1) { std::terminate(); }
+
+		config.update_sync(std::make_unique<Config>(2));
+		if (alive.load() != 1) { std::terminate(); }
+	}
+	if (alive.load() != 0) { std::terminate(); }
+
+	// synchronize_rcu waits for a reader that started before it
+	{
+		std::atomic<int> stage{0};
+		std::atomic<bool> synchronized{false};
+		std::thread reader([&]() {
+			RcuReadLock lock;
+			stage.store(1);
+			while (stage.load() != 2) { std::this_thread::yield(); }
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+			if (synchronized.load()) { std::terminate(); }
+		});
+		while (stage.load() != 1) { std::this_thread::yield(); }
+		stage.store(2);
+		synchronize_rcu();
+		synchronized.store(true);
+		reader.join();
+	}
+
+	// Readers racing writers
+	{
+		RcuProtected<Config> config{std::make_unique<Config>(0)};
+		std::atomic<bool> stop{false};
+		std::vector<std::thread> readers;
+		for (int i = 0; i < 4; ++i) {
+			readers.emplace_back([&]() {
+				while (!stop.load(std::memory_order_relaxed)) {
+					RcuReadLock lock;
+					if (config.read()->magic != Config::MAGIC) { std::terminate(); }
+				}
+			});
+		}
+
+		std::vector<std::thread> writers;
+		for (int w = 0; w < 2; ++w) {
+			writers.emplace_back([&]() {
+				for (unsigned i = 1; i <= 2000; ++i) {
+					if (i % 2) {
+						config.update(std::make_unique<Config>(i));
+					} else {
+						config.update_sync(std::make_unique<Config>(i));
+					}
+				}
+				rcu_barrier();
+			});
+		}
+		for (auto &t : writers) { t.join(); }
+		stop.store(true);
+		for (auto &t : readers) { t.join(); }
+	}
+	if (alive.load() != 0) { std::terminate(); }
+
+	return 0;
+}
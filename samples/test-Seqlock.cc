@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <atomic>
 #include <iostream>
 #include <thread>
@@ -17,6 +18,68 @@ int main(int, char *[])
 		if (sl.load() != 2) { std::terminate(); }
 	}
 
+	// Visitor reads and in place updates
+	{
+		struct Pair {
+			int a, b;
+		};
+
+		Seqlock<Pair> sl;
+		sl.store(Pair{1, 2});
+		if (sl.read([](const Pair &p) { return p.a + p.b; }) != 3) { std::terminate(); }
+		sl.update([](Pair &p) { p.b = 5; });
+		if (sl.load().b != 5) { std::terminate(); }
+
+		// A throwing update leaves the lock usable
+		try {
+			sl.update([](Pair &p) {
+				p.a = 7;
+				throw p.a;
+			});
+		} catch (int) {
+		}
+		if (sl.load().a != 7) { std::terminate(); }
+	}
+
+	// Multiple writers, large values
+	{
+		struct Page {
+			std::size_t words[1024];
+		};
+
+		Seqlock<Page, true> sl;
+		std::atomic<bool> stop{false};
+		std::vector<std::thread> writers;
+		for (std::size_t w = 1; w <= 4; ++w) {
+			writers.push_back(std::thread([&sl, &stop, w]() {
+				for (std::size_t i = 0; !stop.load(std::memory_order_relaxed); ++i) {
+					if (i % 2) {
+						sl.update([&](Page &page) {
+							for (auto &word : page.words) { word = w; }
+						});
+					} else {
+						Page page;
+						for (auto &word : page.words) { word = w * 1000 + i; }
+						sl.store(page);
+					}
+				}
+			}));
+		}
+
+		for (int i = 0; i < 10000; ++i) {
+			auto copy = sl.load();
+			for (auto word : copy.words) {
+				if (word != copy.words[0]) { std::terminate(); }
+			}
+			bool uniform = sl.read([](const Page &page) {
+				return std::all_of(std::begin(page.words), std::end(page.words), [&](std::size_t word) { return word == page.words[0]; });
+			});
+			if (!uniform) { std::terminate(); }
+		}
+		stop.store(true);
+		for (auto &t : writers) { t.join(); }
+	}
+
 	// Fuzz test
 	{
 		struct Data {
@@ -0,0 +1,69 @@
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+#include <godby/SharedMutex.h>
+
+int main(int, char *[])
+{
+	using namespace godby;
+
+	// Readers share, writers exclude everyone
+	{
+		DistributedSharedMutex<> mutex;
+		{
+			std::shared_lock first(mutex);
+			std::shared_lock second(mutex);
+			if (mutex.try_lock()) { std::terminate(); }
+			std::thread([&]() {
+				if (!mutex.try_lock_shared()) { std::terminate(); }
+				mutex.unlock_shared();
+			}).join();
+		}
+		{
+			std::unique_lock writer(mutex);
+			std::thread([&]() {
+				if (mutex.try_lock_shared() || mutex.try_lock()) { std::terminate(); }
+			}).join();
+		}
+		if (!mutex.try_lock()) { std::terminate(); }
+		mutex.unlock();
+	}
+
+	// Readers never see a half-done update, writers never lose one
+	{
+		DistributedSharedMutex<4> mutex; // Fewer slots than threads, some share one
+		constexpr uint64_t ROUNDS = 20000;
+		uint64_t a = 0, b = 0;
+		std::atomic<bool> stop{false};
+
+		std::vector<std::thread> threads;
+		for (int i = 0; i < 6; ++i) {
+			threads.emplace_back([&]() {
+				while (!stop.load(std::memory_order_relaxed)) {
+					std::shared_lock guard(mutex);
+					if (a != b) { std::terminate(); }
+				}
+			});
+		}
+		std::vector<std::thread> writers;
+		for (int i = 0; i < 2; ++i) {
+			writers.emplace_back([&]() {
+				for (uint64_t j = 0; j < ROUNDS; ++j) {
+					std::unique_lock guard(mutex);
+					++a;
+					++b;
+				}
+			});
+		}
+		for (auto &t : writers) { t.join(); }
+		stop.store(true);
+		for (auto &t : threads) { t.join(); }
+		if (a != 2 * ROUNDS || b != 2 * ROUNDS) { std::terminate(); }
+	}
+
+	return 0;
+}
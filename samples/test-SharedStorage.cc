@@ -45,6 +45,46 @@ int test_main()
 	return 0;
 }
 
+void test_keys()
+{
+	static constexpr StorageKey<int> kCounter("counter", 7);
+	static_assert(kCounter == StorageKey<int>("counter", 7));
+	static_assert(kCounter.value() != StorageKey<long>("counter", 7).value());
+	static_assert(kCounter != StorageKey<int>("counter", 8));
+
+	auto &storage = SharedStorage::Singlon();
+	*storage.GetOrCreate(kCounter) = 1;
+	assert(*storage.GetOrNull<int>("counter", "7") == 1); // Tags hash by their text, as MakeKey streams them
+
+	storage.Deletable<int>("resolved");
+	auto handle = storage.Resolve<int>("resolved");
+	assert(handle && handle.get() == storage.GetOrNull<int>("resolved"));
+	*handle.get() = 3;
+	assert(*storage.GetOrNull<int>("resolved") == 3);
+	assert(storage.Delete<int>("resolved"));
+	assert(!handle && !handle.get());
+}
+
+void test_reload()
+{
+	auto &storage = SharedStorage::Singlon();
+	storage.Publish_Reloadable(godby::make_shared<size_t>(1), "version");
+
+	std::atomic<bool> started{false};
+	std::thread reader([&] {
+		auto first = storage.GetOrCreate_Reloadable<size_t>("version");
+		assert(*first == 1);
+		started.store(true);
+		while (*storage.GetOrCreate_Reloadable<size_t>("version") != 2) { std::this_thread::yield(); }
+		assert(*first == 1); // The old version stays alive while it is held
+	});
+
+	while (!started.load()) { std::this_thread::yield(); }
+	storage.Publish_Reloadable(godby::make_shared<size_t>(2), "version");
+	reader.join();
+	assert(*storage.GetOrNull_Reloadable<size_t>("version") == 2);
+}
+
 int main()
 {
 	auto &storage = SharedStorage::Singlon();
@@ -62,9 +102,10 @@ int main()
 			if (fetchedValue) { std::cout << "Value: " << *fetchedValue << "\n"; }
 		}
 
-		auto value3 = storage.GetOrCreate_Reloadable<std::string>(1);
+		auto value3 = storage.GetOrCreate_Reloadable<std::string>();
 		*value3 = "Hello world [Reloadable]";
-		sleep(10);
+		storage.Publish_Reloadable(godby::make_shared<std::string>("Hello world [Reloaded]"));
+		std::cout << "Value: " << *storage.GetOrCreate_Reloadable<std::string>() << "\n";
 
 		if (storage.Has<std::string>()) {
 			auto fetchedValue = storage.GetOrNull<std::string>();
@@ -89,6 +130,8 @@ int main()
 		std::cerr << "Runtime error: " << e.what() << "\n";
 	}
 
+	test_keys();
+	test_reload();
 	test_main();
 
 	return 0;
@@ -0,0 +1,55 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <exception>
+#include <thread>
+#include <signal.h>
+#include <unistd.h>
+#include <godby/Signal.h>
+
+using namespace godby;
+
+static void wait_for(const std::atomic<int> &counter, int expected)
+{
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+	while (counter.load() < expected) {
+		if (std::chrono::steady_clock::now() > deadline) {
+			fprintf(stderr, "signal not delivered: %d of %d\n", counter.load(), expected);
+			std::terminate();
+		}
+		std::this_thread::yield();
+	}
+}
+
+int main()
+{
+	// Blocked before any thread starts, so no thread can be interrupted by them
+	if (Signal::Block(SIGUSR1) != 0 || Signal::Block(SIGUSR2) != 0 || Signal::Fd() < 0) { std::terminate(); }
+
+	std::atomic<int> usr1{0}, any{0};
+	int usr1_id = Signal::Register(SIGUSR1, [&]() { usr1.fetch_add(1); });
+	int any_id = Signal::Register([&](int) { any.fetch_add(1); });
+
+	// Drained by hand, as an event loop polling Fd() would
+	kill(getpid(), SIGUSR1);
+	if (Signal::Dispatch() != 1 || usr1.load() != 1 || any.load() != 1) { std::terminate(); }
+	if (Signal::Dispatch() != 0) { std::terminate(); }
+
+	// Drained by the dispatcher thread
+	if (Signal::StartDispatcher() != 0) { std::terminate(); }
+	kill(getpid(), SIGUSR2);
+	wait_for(any, 2);
+	if (usr1.load() != 1) { std::terminate(); }
+
+	// Handlers can be removed while the dispatcher runs
+	Signal::Unregister(usr1_id);
+	kill(getpid(), SIGUSR1);
+	wait_for(any, 3);
+	if (usr1.load() != 1) { std::terminate(); }
+
+	Signal::StopDispatcher();
+	Signal::Unregister(any_id);
+	printf("signals dispatched: %d\n", any.load());
+
+	return 0;
+}
@@ -0,0 +1,99 @@
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <set>
+#include <thread>
+#include <vector>
+#include <godby/SlabAllocator.h>
+
+int main(int, char *[])
+{
+	using namespace godby;
+
+	// A freed block is the next one handed out
+	{
+		void *a = SlabAllocator<uint64_t>::Allocate();
+		SlabAllocator<uint64_t>::Deallocate(a);
+		void *b = SlabAllocator<uint64_t>::Allocate();
+		if (a != b) { std::terminate(); }
+		SlabAllocator<uint64_t>::Deallocate(b);
+	}
+
+	// Distinct and aligned, past a few batches and slabs
+	{
+		struct alignas(64) Line {
+			char bytes[64];
+		};
+
+		std::set<void *> blocks;
+		for (int i = 0; i < 20000; ++i) {
+			void *p = SlabAllocator<Line>::Allocate();
+			if (reinterpret_cast<uintptr_t>(p) % 64 != 0) { std::terminate(); }
+			if (!blocks.insert(p).second) { std::terminate(); }
+		}
+		for (void *p : blocks) { SlabAllocator<Line>::Deallocate(p); }
+	}
+
+	// As a std allocator, rebound to the node types of the containers
+	{
+		std::list<int, SlabAllocator<int>> list;
+		for (int i = 0; i < 1000; ++i) { list.push_back(i); }
+		std::map<int, int, std::less<int>, SlabAllocator<std::pair<const int, int>>> map;
+		for (int i = 0; i < 1000; ++i) { map[i] = i * i; }
+		std::vector<int, SlabAllocator<int>> vector(1000, 7); // Arrays go to operator new
+		long sum = 0;
+		for (int i : list) { sum += i; }
+		if (sum != 999 * 1000 / 2 || map[30] != 900 || vector[999] != 7) { std::terminate(); }
+	}
+
+	// Huge page backed, with or without reserved huge pages
+	{
+		std::list<int, SlabAllocator<int, true>> list;
+		for (int i = 0; i < 100000; ++i) { list.push_back(i); }
+		if (list.back() != 99999) { std::terminate(); }
+	}
+
+	// Allocated on one thread, freed on another, through the depot and back
+	{
+		constexpr int COUNT = 100000;
+		std::vector<uint64_t *> blocks(COUNT);
+		std::atomic<int> published{0};
+		std::thread producer([&]() {
+			for (int i = 0; i < COUNT; ++i) {
+				blocks[i] = new (SlabAllocator<uint64_t>::Allocate()) uint64_t(i);
+				published.store(i + 1, std::memory_order_release);
+			}
+		});
+		std::thread consumer([&]() {
+			for (int i = 0; i < COUNT; ++i) {
+				while (published.load(std::memory_order_acquire) <= i) { std::this_thread::yield(); }
+				if (*blocks[i] != uint64_t(i)) { std::terminate(); }
+				SlabAllocator<uint64_t>::Deallocate(blocks[i]);
+			}
+		});
+		producer.join();
+		consumer.join();
+	}
+
+	// Many threads churning the same size class
+	{
+		std::vector<std::thread> threads;
+		for (int t = 0; t < 4; ++t) {
+			threads.emplace_back([t]() {
+				std::vector<uint64_t *> live;
+				for (int round = 0; round < 50; ++round) {
+					for (int i = 0; i < 1000; ++i) { live.push_back(new (SlabAllocator<uint64_t>::Allocate()) uint64_t(t)); }
+					for (auto *p : live) {
+						if (*p != uint64_t(t)) { std::terminate(); }
+						SlabAllocator<uint64_t>::Deallocate(p);
+					}
+					live.clear();
+				}
+			});
+		}
+		for (auto &thread : threads) { thread.join(); }
+	}
+
+	return 0;
+}
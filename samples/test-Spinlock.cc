@@ -0,0 +1,79 @@
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <godby/Spinlock.h>
+
+namespace
+{
+// Threads incrementing a plain counter under the lock, lost updates show up in the total.
+template <godby::Lockable L>
+void Contend(L &lock)
+{
+	constexpr int THREADS = 4;
+	constexpr uint64_t ROUNDS = 50000;
+
+	uint64_t counter = 0;
+	std::vector<std::thread> threads;
+	for (int i = 0; i < THREADS; ++i) {
+		threads.emplace_back([&]() {
+			for (uint64_t j = 0; j < ROUNDS; ++j) {
+				std::lock_guard<L> guard(lock);
+				++counter;
+			}
+		});
+	}
+	for (auto &t : threads) { t.join(); }
+	if (counter != THREADS * ROUNDS) { std::terminate(); }
+}
+
+template <godby::Lockable L>
+void TryLock(L &lock)
+{
+	if (!lock.try_lock()) { std::terminate(); }
+	std::thread([&]() {
+		if (lock.try_lock()) { std::terminate(); }
+	}).join();
+	lock.unlock();
+	std::thread([&]() {
+		if (!lock.try_lock()) { std::terminate(); }
+		lock.unlock();
+	}).join();
+}
+} // namespace
+
+int main(int, char *[])
+{
+	using namespace godby;
+
+	static_assert(Lockable<Spinlock>);
+	static_assert(Lockable<TtasSpinlock<>>);
+	static_assert(Lockable<McsLock>);
+	static_assert(Lockable<std::mutex>);
+
+	{
+		Spinlock lock;
+		TryLock(lock);
+		Contend(lock);
+	}
+
+	{
+		TtasSpinlock<> lock;
+		TryLock(lock);
+		Contend(lock);
+	}
+
+	{
+		McsLock lock;
+		TryLock(lock);
+		Contend(lock);
+
+		// A thread holding several MCS locks at once
+		McsLock other;
+		std::scoped_lock both(lock, other);
+		if (lock.try_lock() || other.try_lock()) { std::terminate(); }
+	}
+
+	return 0;
+}
@@ -1,4 +1,5 @@
 #include <csignal>
+#include <sched.h>
 #include "godbytest.h"
 #include "contrib/function2.hpp"
 #include "contrib/BS_thread_pool.hpp"
@@ -89,6 +90,79 @@ class SimulateTaskExecutor : public godby::StealingExecutor<int> {
 
 int main()
 {
+	{
+		// Tasks spawned from workers go to their own deques and get stolen by idle workers.
+		godby::TaskExecutor<> executor(4);
+		std::atomic<size_t> count{0};
+		std::function<void(int)> spawn = [&](int depth) {
+			count.fetch_add(1, std::memory_order_relaxed);
+			if (depth > 0) {
+				executor.Submit([&spawn, depth]() { spawn(depth - 1); });
+				executor.Submit([&spawn, depth]() { spawn(depth - 1); });
+			}
+		};
+		executor.Submit([&spawn]() { spawn(14); });
+		while (count.load() != (1u << 15) - 1) { std::this_thread::yield(); }
+		executor.WaitAll();
+		if (!executor.IsEmpty()) { std::terminate(); }
+		printf("Nested submissions: %zu\n\n", count.load());
+	}
+
+	{
+		// Workers park on the eventcount between bursts, WaitAll must still cover every submitted task.
+		godby::TaskExecutor<> executor(4);
+		std::atomic<size_t> count{0};
+		for (size_t round = 1; round <= 100; round++) {
+			for (size_t i = 0; i < round; i++) {
+				executor.Submit([&count]() { count.fetch_add(1, std::memory_order_relaxed); });
+			}
+			executor.WaitAll();
+			if (count.load() != round * (round + 1) / 2) { std::terminate(); }
+			if (round % 10 == 0) { std::this_thread::sleep_for(std::chrono::milliseconds(1)); }
+		}
+		auto metrics = executor.TotalMetrics();
+		if (metrics.executed != count.load() || metrics.wakeups == 0 || metrics.queue_depth != 0) { std::terminate(); }
+		if (executor.Metrics().size() != 4) { std::terminate(); }
+		printf("Parked wakeups: %zu, parks: %lu, steals: %lu/%lu\n\n", count.load(), metrics.parks, metrics.steals, metrics.steal_attempts);
+	}
+
+	{
+		// Urgent tasks run first, every 4th pick goes to the background lane.
+		godby::TaskExecutor<std::function<void()>, godby::StealingConfig<10, 4, 256, 2, 4>> executor(1);
+		std::vector<int> order;
+		executor.Pause();
+		for (int i = 0; i < 8; i++) {
+			executor.Submit([&order]() { order.push_back(1); }, 1);
+			executor.Submit([&order]() { order.push_back(0); }, 0);
+		}
+		executor.Resume();
+		executor.WaitAll();
+		if (order != std::vector<int>{0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 1, 1, 1, 1, 1, 1}) { std::terminate(); }
+		if (executor.TotalMetrics().executed != 16) { std::terminate(); }
+		printf("Priority lanes: ok\n\n");
+	}
+
+	{
+		// Workers pinned to the detected CPUs, each one must run where it was put.
+		auto topology = godby::CpuTopology::Detect();
+		if (topology.size() == 0 || topology.nodes() == 0) { std::terminate(); }
+		if (godby::CpuTopology::Detect({topology.cpus()[0].cpu, 1 << 20}).size() != 1) { std::terminate(); }
+		godby::TaskExecutor<> executor(topology, 2 * topology.size());
+		std::atomic<size_t> count{0}, misplaced{0};
+		for (size_t i = 0; i < 4096; i++) {
+			executor.Submit([&]() {
+				int cpu = sched_getcpu();
+				bool known = false;
+				for (auto const &info : topology.cpus()) { known |= info.cpu == cpu; }
+				if (!known) { misplaced.fetch_add(1); }
+				count.fetch_add(1);
+			});
+		}
+		executor.WaitAll();
+		if (count.load() != 4096 || misplaced.load() != 0) { std::terminate(); }
+		printf("Pinned workers: %zu cpus, %zu nodes\n\n", topology.size(), topology.nodes());
+	}
+
 	{
 		auto id1 = godby::Signal::Register(SIGINT, []() { printf("SIGINT\n"); });
 		// auto id2 = godby::Signal::Register([](int sig) { printf("sig=%d\n", sig); });
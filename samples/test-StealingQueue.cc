@@ -1,10 +1,112 @@
 
 #include <thread>
+#include <atomic>
+#include <vector>
+#include <memory>
+#include <exception>
+#include <string>
 #include <iostream>
 #include <godby/StealingQueue.h>
 
 int main()
 {
+	{
+		// batch stealing against an owner popping from the same end: every item is taken exactly once
+		constexpr int N = 1000000;
+		godby::StealingQueue<int, 8> queue(64);
+		std::vector<std::atomic<int>> taken(N);
+		std::atomic<bool> done{false};
+
+		std::thread owner([&]() {
+			for (int i = 0; i < N; i = i + 1) {
+				queue.push(i);
+				if (i % 3 == 0) {
+					if (auto item = queue.pop()) { taken[*item]++; }
+				}
+			}
+			while (auto item = queue.pop()) { taken[*item]++; }
+			done = true;
+		});
+
+		std::vector<std::thread> thieves;
+		for (size_t i = 0; i < 3; ++i) {
+			thieves.emplace_back([&]() {
+				int items[8];
+				while (!done.load() || !queue.empty()) {
+					size_t n = queue.steal_batch(items);
+					for (size_t k = 0; k < n; ++k) { taken[items[k]]++; }
+					if (n == 0) { std::this_thread::yield(); }
+				}
+			});
+		}
+
+		owner.join();
+		for (auto &thief : thieves) { thief.join(); }
+		for (int i = 0; i < N; i = i + 1) {
+			if (taken[i].load() != 1) { std::terminate(); }
+		}
+		std::cout << "steal_batch: ok" << std::endl;
+	}
+
+	{
+		// the owner pops a fresh, empty queue (bottom wraps below zero) while a thief steals:
+		// no phantom items, and the push that follows is not lost
+		constexpr int N = 20000;
+		std::vector<std::unique_ptr<godby::StealingQueue<std::string, 1>>> queues;
+		for (int i = 0; i < N; i = i + 1) { queues.emplace_back(std::make_unique<godby::StealingQueue<std::string, 1>>(2)); }
+		std::vector<std::atomic<int>> taken(N);
+		std::atomic<int> round{0};
+
+		std::thread thief([&]() {
+			for (int r; (r = round.load()) < N;) {
+				if (auto item = queues[r]->steal()) { taken[std::stoi(*item)]++; }
+			}
+		});
+		for (int r = 0; r < N; r = r + 1) {
+			round = r;
+			for (int k = 0; k < 64; k = k + 1) {
+				if (queues[r]->pop()) { std::terminate(); }
+			}
+			queues[r]->push(std::to_string(r));
+			while (auto item = queues[r]->pop()) { taken[std::stoi(*item)]++; }
+			while (!queues[r]->empty()) { std::this_thread::yield(); }
+		}
+		round = N;
+		thief.join();
+		for (int i = 0; i < N; i = i + 1) {
+			if (taken[i].load() != 1) { std::terminate(); }
+		}
+		std::cout << "empty pop vs steal: ok" << std::endl;
+	}
+
+	{
+		// non-trivially copyable items, and the array shrinks back once the burst is drained
+		godby::StealingQueue<std::string, 4> queue(64, true);
+		std::atomic<size_t> stolen{0};
+		size_t popped = 0;
+		for (size_t i = 0; i < 100000; ++i) { queue.push(std::to_string(i) + std::string(32, 'x')); }
+		if (queue.capacity() < 100000) { std::terminate(); }
+
+		std::thread thief([&]() {
+			std::string items[4];
+			for (size_t n; (n = queue.steal_batch(items)) != 0 || !queue.empty();) { stolen += n; }
+		});
+		while (auto item = queue.pop()) {
+			if (item->size() < 33) { std::terminate(); }
+			popped++;
+		}
+		thief.join();
+		if (popped + stolen.load() != 100000) { std::terminate(); }
+
+		for (size_t i = 0; i < 1000000; ++i) {
+			queue.push(std::to_string(i));
+			queue.pop();
+		}
+		if (queue.capacity() != 64) { std::terminate(); }
+		queue.push("left behind"); // released by the destructor
+		std::cout << "shrink: ok" << std::endl;
+	}
+
 	// work-stealing queue of integer items
 	godby::StealingQueue<int> queue;
 
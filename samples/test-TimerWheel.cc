@@ -1,7 +1,9 @@
 #include <algorithm>
 #include <functional>
+#include <memory>
 #include <vector>
 #include <cstdio>
+#include <thread>
 #include <godby/TimerWheel.h>
 
 using namespace godby;
@@ -200,6 +202,78 @@ bool test_ticks_to_next_event() {
     return true;
 }
 
+bool test_sharded_cross_thread_schedule() {
+    using Callback = std::function<void()>;
+    ShardedTimerWheel wheels(2);
+    TimerShard &shard = wheels.shard(0);
+    int count = 0;
+    CallbackTimerEvent<Callback> timer([&count] () { ++count; });
+    CallbackTimerEvent<Callback> timer2([&count] () { count += 10; });
+
+    // Commands from another thread only take effect when the owner advances.
+    std::thread([&] () {
+        shard.schedule(&timer, 5);
+        shard.schedule(&timer2, 3);
+    }).join();
+    EXPECT(!timer.scheduled());
+    EXPECT_INTEQ(shard.ticks_to_wakeup(100), 3);
+    shard.advance(3);
+    EXPECT_INTEQ(count, 10);
+    shard.advance(2);
+    EXPECT_INTEQ(count, 11);
+
+    // The last command posted for an event wins.
+    std::thread([&] () {
+        shard.schedule(&timer, 5);
+        shard.cancel(&timer);
+        shard.schedule(&timer2, 4);
+        shard.schedule(&timer2, 2);
+    }).join();
+    shard.advance(10);
+    EXPECT_INTEQ(count, 21);
+
+    // Many threads arming timeouts at once.
+    std::vector<std::unique_ptr<CallbackTimerEvent<Callback>>> timers;
+    for (int i = 0; i < 64; ++i) { timers.emplace_back(std::make_unique<CallbackTimerEvent<Callback>>([&count] () { ++count; })); }
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.emplace_back([&, i] () {
+            for (int j = i; j < 64; j += 4) { shard.schedule(timers[j].get(), 1 + j % 7); }
+        });
+    }
+    for (auto &t : threads) { t.join(); }
+    shard.advance(7);
+    EXPECT_INTEQ(count, 21 + 64);
+
+    return true;
+}
+
+bool test_pooled_events() {
+    using Callback = std::function<void()>;
+    TimerWheel timers;
+    TimerEventPool<Callback, 4> pool; // Destroyed first
+    int count = 0;
+
+    // Events go back to the pool once they ran, and are reused.
+    for (int round = 0; round < 10; ++round) {
+        for (int i = 0; i < 6; ++i) { timers.schedule(pool.acquire([&count] () { ++count; }), 1 + i * 100); }
+        timers.advance(600);
+        EXPECT_INTEQ(count, 6 * (round + 1));
+    }
+    EXPECT_INTEQ(pool.capacity(), 8);
+
+    // Released events do not run, a callback may arm a new one.
+    auto *event = pool.acquire([&count] () { ++count; });
+    timers.schedule(event, 5);
+    pool.release(event);
+    timers.schedule(pool.acquire([&] () { timers.schedule(pool.acquire([&count] () { count += 100; }), 3); }), 2);
+    timers.advance(10);
+    EXPECT_INTEQ(count, 160);
+    EXPECT_INTEQ(pool.capacity(), 8);
+
+    return true;
+}
+
 // ... other test functions follow the same pattern ...
 
 int main(void) {
@@ -207,6 +281,8 @@ int main(void) {
     TEST(test_single_timer_no_hierarchy);
     TEST(test_single_timer_hierarchy);
     TEST(test_ticks_to_next_event);
+    TEST(test_sharded_cross_thread_schedule);
+    TEST(test_pooled_events);
     // ... other test cases ...
     return ok ? 0 : 1;
 }
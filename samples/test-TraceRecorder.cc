@@ -0,0 +1,95 @@
+#include <cstdio>
+#include <exception>
+#include <random>
+#include <string>
+#include <godby/TraceRecorder.h>
+
+static uint32_t Checkcode(uint64_t sequence)
+{
+	sequence *= 0x9e3779b97f4a7c15ull;
+	return static_cast<uint32_t>(sequence ^ (sequence >> 32));
+}
+
+int main()
+{
+	using namespace godby;
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<> probability(0.0, 1.0);
+	const std::string sender_path = "test-TraceRecorder.sender", receiver_path = "test-TraceRecorder.receiver";
+
+	// Records received as sent, the files grow from a single page
+	{
+		auto sender = TraceWriter::Create(sender_path.c_str(), 1), receiver = TraceWriter::Create(receiver_path.c_str(), 1);
+		if (!sender || !receiver) { std::terminate(); }
+		for (uint64_t i = 0; i < 50000; ++i) {
+			uint64_t now = TscClock::Ticks();
+			if (!sender->Append({i, now, Checkcode(i), 0}) || !receiver->Append({i, now + 1000, Checkcode(i), 0})) { std::terminate(); }
+		}
+
+		// Readable while being written
+		auto live = TraceFile::Open(sender_path.c_str());
+		if (!live || live->records().size() != 50000 || live->records()[49999].sequence != 49999) { std::terminate(); }
+		if (sender->Close() != 0 || receiver->Close() != 0) { std::terminate(); }
+
+		auto sent = TraceFile::Open(sender_path.c_str()), received = TraceFile::Open(receiver_path.c_str());
+		if (!sent || !received || sent->records().size() != 50000 || sent->ticks_per_second() <= 0) { std::terminate(); }
+		Histogram<> latencies;
+		auto stats = TraceLatencies(*sent, *received, latencies);
+		if (stats.matched != 50000 || stats.lost || stats.corrupted || stats.duplicates || stats.unexpected) { std::terminate(); }
+
+		uint64_t expected = static_cast<uint64_t>(1000 * 1e9 / sent->ticks_per_second());
+		auto snapshot = latencies.Snapshot();
+		if (snapshot.Count() != 50000 || snapshot.Percentile(0.5) + 1 < expected || snapshot.Percentile(0.5) > expected + expected / 64 + 1) { std::terminate(); }
+	}
+
+	// Losses, corruptions, duplicates and records nobody sent
+	{
+		TraceJoinStats expected;
+		{
+			auto sender = TraceWriter::Create(sender_path.c_str()), receiver = TraceWriter::Create(receiver_path.c_str());
+			for (uint64_t i = 0; i < 20000; ++i) {
+				sender->Append(i, Checkcode(i));
+				if (probability(rng) < 0.02) {
+					++expected.lost;
+					continue;
+				}
+				bool corrupt = probability(rng) < 0.01;
+				receiver->Append(i, corrupt ? Checkcode(i) + 1 : Checkcode(i));
+				++(corrupt ? expected.corrupted : expected.matched);
+				if (i % 1000 == 0) {
+					receiver->Append(i, Checkcode(i));
+					++expected.duplicates;
+				}
+			}
+			for (uint64_t i = 0; i < 5; ++i) { receiver->Append(1000000 + i, 0); }
+			expected.unexpected = 5;
+		}
+
+		auto sent = TraceFile::Open(sender_path.c_str()), received = TraceFile::Open(receiver_path.c_str());
+		uint64_t calls = 0, missing = 0;
+		auto stats = JoinTraces(sent->records(), received->records(), [&](const TraceRecord &s, const TraceRecord *r) {
+			++calls;
+			if (!r) {
+				++missing;
+			} else if (r->sequence != s.sequence || r->timestamp < s.timestamp) {
+				std::terminate();
+			}
+		});
+		if (calls != 20000 || missing != expected.lost) { std::terminate(); }
+		if (stats.matched != expected.matched || stats.corrupted != expected.corrupted || stats.lost != expected.lost) { std::terminate(); }
+		if (stats.duplicates != expected.duplicates || stats.unexpected != expected.unexpected) { std::terminate(); }
+	}
+
+	// Not a trace
+	{
+		if (TraceFile::Open("test-TraceRecorder.missing")) { std::terminate(); }
+		FILE *file = fopen(sender_path.c_str(), "wb");
+		fprintf(file, "%0128d", 0);
+		fclose(file);
+		if (TraceFile::Open(sender_path.c_str())) { std::terminate(); }
+	}
+
+	std::remove(sender_path.c_str());
+	std::remove(receiver_path.c_str());
+	return 0;
+}